@@ -513,6 +513,7 @@ admin :: coord_backup(const char* path,
 
 int64_t
 admin :: raw_backup(const server_id& sid, const char* name,
+                    uint64_t* checkpoint,
                     enum hyperdex_admin_returncode* status,
                     const char** path)
 {
@@ -523,14 +524,15 @@ admin :: raw_backup(const server_id& sid, const char* name,
 
     e::slice name_s(name, strlen(name) + 1);
     size_t sz = HYPERDEX_ADMIN_HEADER_SIZE_REQ
-              + pack_size(name_s);
+              + pack_size(name_s)
+              + sizeof(uint64_t);
     std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
-    msg->pack_at(HYPERDEX_ADMIN_HEADER_SIZE_REQ) << name_s;
+    msg->pack_at(HYPERDEX_ADMIN_HEADER_SIZE_REQ) << name_s << *checkpoint;
     uint64_t id = m_next_admin_id;
     ++m_next_admin_id;
     uint64_t nonce = m_next_server_nonce;
     ++m_next_server_nonce;
-    e::intrusive_ptr<pending> op = new pending_raw_backup(id, status, path);
+    e::intrusive_ptr<pending> op = new pending_raw_backup(id, status, checkpoint, path);
 
     if (!send(BACKUP, sid, nonce, msg, op, status))
     {
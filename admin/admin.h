@@ -83,7 +83,10 @@ class admin
         int64_t backup(const char* name, enum hyperdex_admin_returncode* status, const char** backups);
         int64_t coord_backup(const char* path,
                              enum hyperdex_admin_returncode* status);
+        // back up one server once "*checkpoint" is stable (zero for the
+        // next one); on success "*checkpoint" is the one the backup covers
         int64_t raw_backup(const server_id& sid, const char* name,
+                           uint64_t* checkpoint,
                            enum hyperdex_admin_returncode* status,
                            const char** path);
         // read performance counters
@@ -45,6 +45,7 @@ backup_state_machine :: backup_state_machine(const char* name,
     , m_nested_rc()
     , m_configuration_version(0)
     , m_servers()
+    , m_checkpoint(0)
     , m_backup(NULL)
     , m_backups()
     , m_backups_str()
@@ -73,11 +74,17 @@ backup_state_machine :: yield(hyperdex_admin_returncode* status)
     return true;
 }
 
+// Backups no longer make the cluster read-only.  Each daemon instead copies
+// a snapshot it took once a common checkpoint was stable, so every replica's
+// backup holds every write issued before that checkpoint, while writes carry
+// on throughout.  Later writes may be in one replica's backup and not
+// another's, so each daemon records where it stood in each region's chain
+// and restore keeps the copy nearest the tail.
 bool
 backup_state_machine :: initialize(admin* adm, hyperdex_admin_returncode* status)
 {
     *status = HYPERDEX_ADMIN_SUCCESS;
-    m_nested_id = adm->read_only(1, &m_nested_rc);
+    m_nested_id = adm->wait_until_stable(&m_nested_rc);
 
     if (!check_nested(adm))
     {
@@ -86,7 +93,7 @@ backup_state_machine :: initialize(admin* adm, hyperdex_admin_returncode* status
     }
 
     adm->m_multi_ops[m_nested_id] = this;
-    m_state = SET_READ_ONLY;
+    m_state = WAIT_TO_START;
     return true;
 }
 
@@ -100,11 +107,8 @@ backup_state_machine :: callback(admin* adm, int64_t id, hyperdex_admin_returnco
         case INITIALIZED:
             callback_unexpected(adm, id);
             return true;
-        case SET_READ_ONLY:
-            callback_set_read_only(adm, id);
-            return true;
-        case WAIT_TO_QUIESCE:
-            callback_wait_to_quiesce(adm, id);
+        case WAIT_TO_START:
+            callback_wait_to_start(adm, id);
             return true;
         case DAEMON_BACKUP:
             callback_daemon_backup(adm, id);
@@ -112,18 +116,12 @@ backup_state_machine :: callback(admin* adm, int64_t id, hyperdex_admin_returnco
         case COORD_BACKUP:
             callback_coord_backup(adm, id);
             return true;
-        case WAIT_TO_QUIESCE_AGAIN:
-            callback_wait_to_quiesce_again(adm, id);
-            return true;
-        case SET_READ_WRITE:
-            callback_set_read_write(adm, id);
+        case WAIT_TO_FINISH:
+            callback_wait_to_finish(adm, id);
             return true;
         case DONE:
             callback_unexpected(adm, id);
             return true;
-        case BACKOUT:
-            callback_backout(adm, id);
-            return true;
         case ERROR:
             callback_unexpected(adm, id);
             return true;
@@ -136,21 +134,6 @@ backup_state_machine :: callback(admin* adm, int64_t id, hyperdex_admin_returnco
     }
 }
 
-void
-backup_state_machine :: backout(admin* adm)
-{
-    m_nested_id = adm->read_only(0, &m_nested_rc);
-
-    if (m_nested_id < 0)
-    {
-        m_state = ERROR;
-    }
-    else
-    {
-        adm->m_multi_ops[m_nested_id] = this;
-    }
-}
-
 bool
 backup_state_machine :: common_callback(admin* adm, int64_t id)
 {
@@ -164,22 +147,17 @@ backup_state_machine :: common_callback(admin* adm, int64_t id)
     {
         YIELDING_ERROR(INTERNAL) << "callback had id=" << id
                                  << " when it should have id=" << m_nested_id;
-        m_state = m_state > SET_READ_ONLY ? BACKOUT : ERROR;
+        m_state = ERROR;
         ret = false;
     }
     else if (m_nested_rc != HYPERDEX_ADMIN_SUCCESS)
     {
         this->set_status(m_nested_rc);
         this->set_error(adm->m_last_error);
-        m_state = m_state > SET_READ_ONLY ? BACKOUT : ERROR;
+        m_state = ERROR;
         ret = false;
     }
 
-    if (!ret && m_state == BACKOUT)
-    {
-        backout(adm);
-    }
-
     return ret;
 }
 
@@ -193,13 +171,7 @@ backup_state_machine :: check_nested(admin* adm)
 
     this->set_status(m_nested_rc);
     this->set_error(adm->m_last_error);
-    m_state = m_state >= SET_READ_ONLY ? BACKOUT : ERROR;
-
-    if (m_state == BACKOUT)
-    {
-        backout(adm);
-    }
-
+    m_state = ERROR;
     return false;
 }
 
@@ -211,35 +183,13 @@ backup_state_machine :: callback_unexpected(admin*, int64_t)
 }
 
 void
-backup_state_machine :: callback_set_read_only(admin* adm, int64_t id)
+backup_state_machine :: callback_wait_to_start(admin* adm, int64_t id)
 {
     if (!common_callback(adm, id))
     {
         return;
     }
 
-    m_nested_id = adm->wait_until_stable(&m_nested_rc);
-
-    if (!check_nested(adm))
-    {
-        return;
-    }
-
-    adm->m_multi_ops[m_nested_id] = this;
-    m_state = WAIT_TO_QUIESCE;
-}
-
-void
-backup_state_machine :: callback_wait_to_quiesce(admin* adm, int64_t id)
-{
-    if (!common_callback(adm, id))
-    {
-        return;
-    }
-
-    // at this point we know that:
-    // 1. the cluster is in read-only mode
-    // 2. every write initiated before setting it to read-only mode is complete
     m_configuration_version = adm->m_coord.config()->version();
 
     // now figure out the servers to take a backup on
@@ -277,10 +227,12 @@ backup_state_machine :: callback_daemon_backup(admin* adm, int64_t id)
         return;
     }
 
+    // the first daemon backs up at the next checkpoint, and the rest at
+    // the same one
     server_id sid = m_servers.back().first;
     po6::net::location loc = m_servers.back().second;
     m_servers.pop_back();
-    m_nested_id = adm->raw_backup(sid, m_name.c_str(), &m_nested_rc, &m_backup);
+    m_nested_id = adm->raw_backup(sid, m_name.c_str(), &m_checkpoint, &m_nested_rc, &m_backup);
     m_backups << sid.get() << " " << loc.address << " ";
 
     if (!check_nested(adm))
@@ -308,39 +260,22 @@ backup_state_machine :: callback_coord_backup(admin* adm, int64_t id)
     }
 
     adm->m_multi_ops[m_nested_id] = this;
-    m_state = WAIT_TO_QUIESCE_AGAIN;
+    m_state = WAIT_TO_FINISH;
 }
 
 void
-backup_state_machine :: callback_wait_to_quiesce_again(admin* adm, int64_t id)
+backup_state_machine :: callback_wait_to_finish(admin* adm, int64_t id)
 {
     if (!common_callback(adm, id))
     {
         return;
     }
 
+    // regions that moved mid-backup may be missing from every daemon's copy
     if (m_configuration_version != adm->m_coord.config()->version())
     {
         YIELDING_ERROR(INTERNAL) << "configuration changed while taking backup";
-        backout(adm);
-    }
-
-    m_nested_id = adm->read_only(0, &m_nested_rc);
-
-    if (!check_nested(adm))
-    {
-        return;
-    }
-
-    adm->m_multi_ops[m_nested_id] = this;
-    m_state = SET_READ_WRITE;
-}
-
-void
-backup_state_machine :: callback_set_read_write(admin* adm, int64_t id)
-{
-    if (!common_callback(adm, id))
-    {
+        m_state = ERROR;
         return;
     }
 
@@ -348,9 +283,3 @@ backup_state_machine :: callback_set_read_write(admin* adm, int64_t id)
     this->set_error(e::error());
     m_state = DONE;
 }
-
-void
-backup_state_machine :: callback_backout(admin*, int64_t)
-{
-    m_state = ERROR;
-}
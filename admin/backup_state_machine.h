@@ -68,35 +68,31 @@ class backup_state_machine : public multi_yieldable
         backup_state_machine& operator = (const backup_state_machine&);
 
     private:
-        void backout(admin* adm);
         bool common_callback(admin* adm, int64_t id);
         bool check_nested(admin* adm);
         void callback_unexpected(admin* adm, int64_t id);
-        void callback_set_read_only(admin* adm, int64_t id);
-        void callback_wait_to_quiesce(admin* adm, int64_t id);
+        void callback_wait_to_start(admin* adm, int64_t id);
         void callback_daemon_backup(admin* adm, int64_t id);
         void callback_coord_backup(admin* adm, int64_t id);
-        void callback_wait_to_quiesce_again(admin* adm, int64_t id);
-        void callback_set_read_write(admin* adm, int64_t id);
-        void callback_backout(admin* adm, int64_t id);
+        void callback_wait_to_finish(admin* adm, int64_t id);
 
     private:
         std::string m_name;
         enum { INITIALIZED,
-               SET_READ_ONLY,
-               WAIT_TO_QUIESCE,
+               WAIT_TO_START,
                DAEMON_BACKUP,
                COORD_BACKUP,
-               WAIT_TO_QUIESCE_AGAIN,
-               SET_READ_WRITE,
+               WAIT_TO_FINISH,
                DONE,
-               BACKOUT,
                ERROR,
                YIELDED } m_state;
         int64_t m_nested_id;
         hyperdex_admin_returncode m_nested_rc;
         uint64_t m_configuration_version;
         std::vector<std::pair<server_id, po6::net::location> > m_servers;
+        // the checkpoint every daemon's backup covers; zero until the first
+        // daemon picks it
+        uint64_t m_checkpoint;
         const char* m_backup;
         std::ostringstream m_backups;
         std::string m_backups_str;
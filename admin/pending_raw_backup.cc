@@ -33,8 +33,10 @@ using hyperdex::pending_raw_backup;
 
 pending_raw_backup :: pending_raw_backup(uint64_t id,
                                          hyperdex_admin_returncode* status,
+                                         uint64_t* checkpoint,
                                          const char** path)
     : pending(id, status)
+    , m_checkpoint(checkpoint)
     , m_path()
     , m_path_c_str(path)
     , m_done(false)
@@ -88,7 +90,8 @@ pending_raw_backup :: handle_message(admin*,
 
     uint16_t rt;
     e::slice path;
-    up = up >> rt >> path;
+    uint64_t checkpoint;
+    up = up >> rt >> path >> checkpoint;
 
     if (up.error())
     {
@@ -108,6 +111,7 @@ pending_raw_backup :: handle_message(admin*,
         return true;
     }
 
+    *m_checkpoint = checkpoint;
     m_path.assign(reinterpret_cast<const char*>(path.data()), path.size());
     *m_path_c_str = m_path.c_str();
     this->set_status(HYPERDEX_ADMIN_SUCCESS);
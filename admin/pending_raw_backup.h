@@ -41,6 +41,7 @@ class pending_raw_backup : public pending
     public:
         pending_raw_backup(uint64_t admin_visible_id,
                            hyperdex_admin_returncode* status,
+                           uint64_t* checkpoint,
                            const char** path);
         virtual ~pending_raw_backup() throw ();
 
@@ -65,6 +66,7 @@ class pending_raw_backup : public pending
         pending_raw_backup& operator = (const pending_raw_backup& rhs);
 
     private:
+        uint64_t* m_checkpoint;
         std::string m_path;
         const char** m_path_c_str;
         bool m_done;
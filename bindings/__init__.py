@@ -31,6 +31,9 @@ class SpaceName(object):
     args = (('const char*', 'space'),)
 class Key(object):
     args = (('const char*', 'key'), ('size_t', 'key_sz'))
+class Keys(object):
+    args = (('const char**', 'keys'), ('const size_t*', 'keys_sz'),
+            ('size_t', 'keys_num'))
 class Predicates(object):
     args = (('const struct hyperdex_client_attribute_check*', 'checks'),
             ('size_t', 'checks_sz'))
@@ -52,6 +55,17 @@ class Count(object):
     args = (('uint64_t', 'count'),)
 class MaxMin(object):
     args = (('int', 'maxmin'),)
+class AttributeNames(object):
+    args = (('const char**', 'attrnames'), ('size_t', 'attrnames_sz'))
+class KeyAttributes(object):
+    args = (('const struct hyperdex_client_attribute*', 'attrs'),
+            ('const size_t*', 'attrs_per_key'))
+class Statuses(object):
+    args = (('enum hyperdex_client_returncode', 'statuses'),)
+class Cursor(object):
+    args = (('const char*', 'cursor'), ('size_t', 'cursor_sz'))
+class NextCursor(object):
+    args = (('const char*', 'next_cursor'), ('size_t', 'next_cursor_sz'))
 
 class Method(object):
 
@@ -63,7 +77,10 @@ class Method(object):
 
 Client = [
     Method('get', AsyncCall, (SpaceName, Key), (Status, Attributes)),
+    Method('get_partial', AsyncCall, (SpaceName, Key, AttributeNames), (Status, Attributes)),
+    Method('get_many', Iterator, (SpaceName, Keys), (Status, Attributes)),
     Method('put', AsyncCall, (SpaceName, Key, Attributes), (Status,)),
+    Method('put_many', AsyncCall, (SpaceName, Keys, KeyAttributes), (Status, Statuses)),
     Method('cond_put', AsyncCall, (SpaceName, Key, Predicates, Attributes), (Status,)),
     Method('put_if_not_exist', AsyncCall, (SpaceName, Key, Attributes), (Status,)),
     Method('del', AsyncCall, (SpaceName, Key), (Status,)),
@@ -125,8 +142,12 @@ Client = [
     Method('map_string_append', AsyncCall, (SpaceName, Key, MapAttributes), (Status,)),
     Method('cond_map_string_append', AsyncCall, (SpaceName, Key, Predicates, MapAttributes), (Status,)),
     Method('search', Iterator, (SpaceName, Predicates), (Status, Attributes)),
+    Method('search_partial', Iterator, (SpaceName, Predicates, AttributeNames), (Status, Attributes)),
+    Method('search_limit', Iterator, (SpaceName, Predicates, Limit), (Status, Attributes)),
     Method('search_describe', AsyncCall, (SpaceName, Predicates), (Status, Description)),
     Method('sorted_search', Iterator, (SpaceName, Predicates, SortBy, Limit, MaxMin), (Status, Attributes)),
+    Method('sorted_search_partial', Iterator, (SpaceName, Predicates, SortBy, Limit, MaxMin, AttributeNames), (Status, Attributes)),
+    Method('sorted_search_page', Iterator, (SpaceName, Predicates, SortBy, Limit, MaxMin, Cursor), (Status, Attributes, NextCursor)),
     Method('group_del', AsyncCall, (SpaceName, Predicates), (Status,)),
     Method('count', AsyncCall, (SpaceName, Predicates), (Status, Count)),
 ]
@@ -80,13 +80,36 @@ DOCS_IN = {(bindings.AsyncCall, bindings.SpaceName): 'The name of the space as a
           ,(bindings.AsyncCall, bindings.Predicates): 'A set of predicates '
            'to check against.  \\code{checks} points to an array of length '
            '\\code{checks\_sz}.'
+          ,(bindings.AsyncCall, bindings.AttributeNames): 'The attributes to '
+           'retrieve.  \\code{attrnames} points to an array of '
+           '\\code{attrnames\_sz} c-strings.'
+          ,(bindings.AsyncCall, bindings.Keys): 'The keys to write.  '
+           '\\code{keys} and \\code{keys\_sz} point to arrays of length '
+           '\\code{keys\_num}; key \\code{i} is the bytestring '
+           '\\code{keys[i]} of \\code{keys\_sz[i]} bytes.'
+          ,(bindings.AsyncCall, bindings.KeyAttributes): 'The attributes to '
+           'write for each key.  \\code{attrs\_per\_key} points to an array '
+           'of length \\code{keys\_num}; key \\code{i} takes the next '
+           '\\code{attrs\_per\_key[i]} entries of \\code{attrs}.'
           ,(bindings.Iterator, bindings.SpaceName): 'The name of the space as a c-string.'
+          ,(bindings.Iterator, bindings.Keys): 'The keys to retrieve.  '
+           '\\code{keys} and \\code{keys\_sz} point to arrays of length '
+           '\\code{keys\_num}; key \\code{i} is the bytestring '
+           '\\code{keys[i]} of \\code{keys\_sz[i]} bytes.'
           ,(bindings.Iterator, bindings.SortBy): 'The attribute to sort by.'
           ,(bindings.Iterator, bindings.Limit): 'The number of results to return.'
           ,(bindings.Iterator, bindings.MaxMin): 'Maximize (!= 0) or minimize (== 0).'
           ,(bindings.Iterator, bindings.Predicates): 'A set of predicates '
            'to check against.  \\code{checks} points to an array of length '
            '\\code{checks\_sz}.'
+          ,(bindings.Iterator, bindings.AttributeNames): 'The attributes to '
+           'retrieve for each object.  \\code{attrnames} points to an array of '
+           '\\code{attrnames\_sz} c-strings.  The key is always returned; '
+           'an empty array returns only the keys.'
+          ,(bindings.Iterator, bindings.Cursor): 'Where to resume the search.  '
+           'An empty cursor starts at the first object; otherwise it must be '
+           'a \\code{next\_cursor} returned by a search with the same '
+           '\\code{sort\_by} and \\code{maxmin}.'
           }
 DOCS_OUT = {(bindings.AsyncCall, bindings.Status): 'The status of the '
             'operation.  The client library will fill in this variable before '
@@ -98,6 +121,12 @@ DOCS_OUT = {(bindings.AsyncCall, bindings.Status): 'The status of the '
             'that comprise a returned object.  The application must free the '
             'returned values with \\code{hyperdex\_client\_destroy\_attrs}.  The '
             'pointers must remain valid until the operation completes.'
+           ,(bindings.AsyncCall, bindings.Statuses): 'The status of each '
+            'key.  \\code{statuses} points to an array of length '
+            '\\code{keys\_num} that the client library fills in before '
+            'returning this operation\'s request id.  \\code{status} is '
+            '\\code{HYPERDEX\_CLIENT\_SUCCESS} only if every key was written; '
+            'otherwise it is the status of the first key that failed.'
            ,(bindings.AsyncCall, bindings.Count): 'The number of objects which '
             'match the predicates.'
            ,(bindings.AsyncCall, bindings.Description): 'The description of '
@@ -112,6 +141,10 @@ DOCS_OUT = {(bindings.AsyncCall, bindings.Status): 'The status of the '
             'that comprise a returned object.  The application must free the '
             'returned values with \\code{hyperdex\_client\_destroy\_attrs}.  The '
             'pointers must remain valid until the operation completes.'
+           ,(bindings.Iterator, bindings.NextCursor): 'The position of the '
+            'returned object, to pass as \\code{cursor} to fetch the objects '
+            'after it.  It points into the client library and is valid until '
+            'the operation next returns.'
            }
 
 def generate_enum(prefix, E):
@@ -164,12 +197,26 @@ def generate_c_wrapper(x):
     func += '    C_WRAP_EXCEPT(\n'
     if x.name == 'get':
         func += '    return cl->get(space, key, key_sz, status, attrs, attrs_sz);\n'
+    elif x.name == 'get_partial':
+        func += '    return cl->get_partial(space, key, key_sz, attrnames, attrnames_sz, status, attrs, attrs_sz);\n'
+    elif x.name == 'get_many':
+        func += '    return cl->get_many(space, keys, keys_sz, keys_num, status, attrs, attrs_sz);\n'
+    elif x.name == 'put_many':
+        func += '    return cl->put_many(space, keys, keys_sz, keys_num, attrs, attrs_per_key, status, statuses);\n'
     elif x.name == 'search':
         func += '    return cl->search(space, checks, checks_sz, status, attrs, attrs_sz);\n'
+    elif x.name == 'search_partial':
+        func += '    return cl->search_partial(space, checks, checks_sz, attrnames, attrnames_sz, status, attrs, attrs_sz);\n'
+    elif x.name == 'search_limit':
+        func += '    return cl->search_limit(space, checks, checks_sz, limit, status, attrs, attrs_sz);\n'
     elif x.name == 'search_describe':
         func += '    return cl->search_describe(space, checks, checks_sz, status, description);\n'
     elif x.name == 'sorted_search':
         func += '    return cl->sorted_search(space, checks, checks_sz, sort_by, limit, maxmin, status, attrs, attrs_sz);\n'
+    elif x.name == 'sorted_search_partial':
+        func += '    return cl->sorted_search_partial(space, checks, checks_sz, sort_by, limit, maxmin, attrnames, attrnames_sz, status, attrs, attrs_sz);\n'
+    elif x.name == 'sorted_search_page':
+        func += '    return cl->sorted_search_page(space, checks, checks_sz, sort_by, limit, maxmin, cursor, cursor_sz, status, attrs, attrs_sz, next_cursor, next_cursor_sz);\n'
     elif x.name == 'group_del':
         func += '    return cl->group_del(space, checks, checks_sz, status);\n'
     elif x.name == 'count':
@@ -300,6 +347,11 @@ hyperdex_client_create(const char* coordinator, uint16_t port);
 void
 hyperdex_client_destroy(struct hyperdex_client* client);
 
+/* Send gets to any replica of a key's region instead of only to its point
+ * leader.  Reads stay consistent with writes.  Off by default. */
+void
+hyperdex_client_set_read_from_replicas(struct hyperdex_client* client, int enable);
+
 '''
 
 HEADER_FOOT = '''
@@ -436,6 +488,13 @@ hyperdex_client_destroy(hyperdex_client* client)
     delete reinterpret_cast<hyperdex::client*>(client);
 }
 
+HYPERDEX_API void
+hyperdex_client_set_read_from_replicas(hyperdex_client* _cl, int enable)
+{
+    hyperdex::client* cl = reinterpret_cast<hyperdex::client*>(_cl);
+    cl->set_read_from_replicas(enable != 0);
+}
+
 HYPERDEX_API const char*
 hyperdex_client_error_message(hyperdex_client* _cl)
 {
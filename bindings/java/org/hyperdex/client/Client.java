@@ -29,6 +29,7 @@
 
 package org.hyperdex.client;
 
+import java.util.List;
 import java.util.Map;
 import java.util.HashMap;
 
@@ -113,6 +114,14 @@ public class Client
         return (Map<String, Object>) async_get(spacename, key).waitForIt();
     }
 
+    public native Deferred async_get_partial(String spacename, Object key, List<String> attributenames) throws HyperDexClientException;
+    public Map<String, Object> get_partial(String spacename, Object key, List<String> attributenames) throws HyperDexClientException
+    {
+        return (Map<String, Object>) async_get_partial(spacename, key, attributenames).waitForIt();
+    }
+
+    public native Iterator get_many(String spacename, List<Object> keys);
+
     public native Deferred async_put(String spacename, Object key, Map<String, Object> attributes) throws HyperDexClientException;
     public Boolean put(String spacename, Object key, Map<String, Object> attributes) throws HyperDexClientException
     {
@@ -481,6 +490,10 @@ public class Client
 
     public native Iterator search(String spacename, Map<String, Object> predicates);
 
+    public native Iterator search_partial(String spacename, Map<String, Object> predicates, List<String> attributenames);
+
+    public native Iterator search_limit(String spacename, Map<String, Object> predicates, int limit);
+
     public native Deferred async_search_describe(String spacename, Map<String, Object> predicates) throws HyperDexClientException;
     public String search_describe(String spacename, Map<String, Object> predicates) throws HyperDexClientException
     {
@@ -489,6 +502,8 @@ public class Client
 
     public native Iterator sorted_search(String spacename, Map<String, Object> predicates, String sortby, int limit, boolean maxmin);
 
+    public native Iterator sorted_search_partial(String spacename, Map<String, Object> predicates, String sortby, int limit, boolean maxmin, List<String> attributenames);
+
     public native Deferred async_group_del(String spacename, Map<String, Object> predicates) throws HyperDexClientException;
     public Boolean group_del(String spacename, Map<String, Object> predicates) throws HyperDexClientException
     {
@@ -74,6 +74,7 @@ static jmethodID _double_doubleValue;
 static jclass _list;
 static jmethodID _list_iterator;
 static jmethodID _list_get;
+static jmethodID _list_size;
 
 static jclass _array_list;
 static jmethodID _array_list_init;
@@ -188,6 +189,7 @@ Java_org_hyperdex_client_Client_initialize(JNIEnv* env, jclass client)
     REF(_list, (*env)->FindClass(env, "java/util/List"));
     _list_iterator = (*env)->GetMethodID(env, _list, "iterator", "()Ljava/util/Iterator;");
     _list_get = (*env)->GetMethodID(env, _list, "get", "(I)Ljava/lang/Object;");
+    _list_size = (*env)->GetMethodID(env, _list, "size", "()I");
     /* cache class ArrayList */
     REF(_array_list, (*env)->FindClass(env, "java/util/ArrayList"));
     _array_list_init = (*env)->GetMethodID(env, _array_list, "<init>", "()V");
@@ -280,6 +282,7 @@ Java_org_hyperdex_client_Client_initialize(JNIEnv* env, jclass client)
     CHECK_CACHE(_list);
     CHECK_CACHE(_list_iterator);
     CHECK_CACHE(_list_get);
+    CHECK_CACHE(_list_size);
     CHECK_CACHE(_array_list);
     CHECK_CACHE(_array_list_init);
     CHECK_CACHE(_array_list_add);
@@ -899,6 +902,95 @@ hyperdex_java_client_convert_key(JNIEnv* env, jobject client,
     return hyperdex_java_client_convert_type(env, arena, x, key, key_sz, &datatype);
 }
 
+static int
+hyperdex_java_client_convert_keys(JNIEnv* env, jobject client,
+                                  struct hyperdex_ds_arena* arena,
+                                  jobject x,
+                                  const char*** _keys,
+                                  const size_t** _keys_sz,
+                                  size_t* _keys_num)
+{
+    const char** keys = NULL;
+    size_t* keys_sz = NULL;
+    size_t keys_num = 0;
+    size_t i = 0;
+    jobject key;
+    enum hyperdatatype datatype;
+
+    keys_num = (*env)->CallIntMethod(env, x, _list_size);
+    ERROR_CHECK(-1);
+    keys = hyperdex_ds_allocate_string_array(arena, keys_num);
+    keys_sz = hyperdex_ds_allocate_size_array(arena, keys_num);
+
+    if (!keys || !keys_sz)
+    {
+        hyperdex_java_out_of_memory(env);
+        return -1;
+    }
+
+    for (i = 0; i < keys_num; ++i)
+    {
+        key = (*env)->CallObjectMethod(env, x, _list_get, (jint)i);
+        ERROR_CHECK(-1);
+
+        if (hyperdex_java_client_convert_type(env, arena, key,
+                                              &keys[i], &keys_sz[i], &datatype) < 0)
+        {
+            return -1;
+        }
+
+        (*env)->DeleteLocalRef(env, key);
+    }
+
+    *_keys = keys;
+    *_keys_sz = keys_sz;
+    *_keys_num = keys_num;
+    (void)client;
+    return 0;
+}
+
+static int
+hyperdex_java_client_convert_attributenames(JNIEnv* env, jobject client,
+                                            struct hyperdex_ds_arena* arena,
+                                            jobject x,
+                                            const char*** _attrnames,
+                                            size_t* _attrnames_sz)
+{
+    const char** attrnames = NULL;
+    size_t attrnames_sz = 0;
+    size_t i = 0;
+    jobject name;
+
+    attrnames_sz = (*env)->CallIntMethod(env, x, _list_size);
+    ERROR_CHECK(-1);
+    attrnames = hyperdex_ds_allocate_string_array(arena, attrnames_sz);
+
+    if (!attrnames)
+    {
+        hyperdex_java_out_of_memory(env);
+        return -1;
+    }
+
+    for (i = 0; i < attrnames_sz; ++i)
+    {
+        name = (*env)->CallObjectMethod(env, x, _list_get, (jint)i);
+        ERROR_CHECK(-1);
+        attrnames[i] = hyperdex_java_client_convert_cstring(env, arena, name);
+
+        if (!attrnames[i])
+        {
+            return -1;
+        }
+
+        (*env)->DeleteLocalRef(env, name);
+    }
+
+    *_attrnames = attrnames;
+    *_attrnames_sz = attrnames_sz;
+    (void)client;
+    return 0;
+}
+
 static int
 hyperdex_java_client_convert_limit(JNIEnv* env, jobject client,
                                    struct hyperdex_ds_arena* arena,
@@ -63,6 +63,79 @@ hyperdex_java_client_asynccall__spacename_key__status_attributes(JNIEnv* env, jo
     return op;
 }
 
+JNIEXPORT HYPERDEX_API jobject JNICALL
+hyperdex_java_client_asynccall__spacename_key_attributenames__status_attributes(JNIEnv* env, jobject obj, int64_t (*f)(struct hyperdex_client* client, const char* space, const char* key, size_t key_sz, const char** attrnames, size_t attrnames_sz, enum hyperdex_client_returncode* status, const struct hyperdex_client_attribute** attrs, size_t* attrs_sz), jstring spacename, jobject key, jobject attributenames);
+
+JNIEXPORT HYPERDEX_API jobject JNICALL
+hyperdex_java_client_asynccall__spacename_key_attributenames__status_attributes(JNIEnv* env, jobject obj, int64_t (*f)(struct hyperdex_client* client, const char* space, const char* key, size_t key_sz, const char** attrnames, size_t attrnames_sz, enum hyperdex_client_returncode* status, const struct hyperdex_client_attribute** attrs, size_t* attrs_sz), jstring spacename, jobject key, jobject attributenames)
+{
+    const char* in_space;
+    const char* in_key;
+    size_t in_key_sz;
+    const char** in_attrnames;
+    size_t in_attrnames_sz;
+    int success = 0;
+    struct hyperdex_client* client = hyperdex_get_client_ptr(env, obj);
+    jobject op = (*env)->NewObject(env, _deferred, _deferred_init, obj);
+    struct hyperdex_java_client_deferred* o = NULL;
+    ERROR_CHECK(0);
+    o = hyperdex_get_deferred_ptr(env, op);
+    ERROR_CHECK(0);
+    success = hyperdex_java_client_convert_spacename(env, obj, o->arena, spacename, &in_space);
+    if (success < 0) return 0;
+    success = hyperdex_java_client_convert_key(env, obj, o->arena, key, &in_key, &in_key_sz);
+    if (success < 0) return 0;
+    success = hyperdex_java_client_convert_attributenames(env, obj, o->arena, attributenames, &in_attrnames, &in_attrnames_sz);
+    if (success < 0) return 0;
+    o->reqid = f(client, in_space, in_key, in_key_sz, in_attrnames, in_attrnames_sz, &o->status, &o->attrs, &o->attrs_sz);
+
+    if (o->reqid < 0)
+    {
+        hyperdex_java_client_throw_exception(env, o->status, hyperdex_client_error_message(client));
+        return 0;
+    }
+
+    o->encode_return = hyperdex_java_client_deferred_encode_status_attributes;
+    (*env)->CallObjectMethod(env, obj, _client_add_op, o->reqid, op);
+    ERROR_CHECK(0);
+    return op;
+}
+
+JNIEXPORT HYPERDEX_API jobject JNICALL
+hyperdex_java_client_iterator__spacename_keys__status_attributes(JNIEnv* env, jobject obj, int64_t (*f)(struct hyperdex_client* client, const char* space, const char** keys, const size_t* keys_sz, size_t keys_num, enum hyperdex_client_returncode* status, const struct hyperdex_client_attribute** attrs, size_t* attrs_sz), jstring spacename, jobject keys);
+
+JNIEXPORT HYPERDEX_API jobject JNICALL
+hyperdex_java_client_iterator__spacename_keys__status_attributes(JNIEnv* env, jobject obj, int64_t (*f)(struct hyperdex_client* client, const char* space, const char** keys, const size_t* keys_sz, size_t keys_num, enum hyperdex_client_returncode* status, const struct hyperdex_client_attribute** attrs, size_t* attrs_sz), jstring spacename, jobject keys)
+{
+    const char* in_space;
+    const char** in_keys;
+    const size_t* in_keys_sz;
+    size_t in_keys_num;
+    int success = 0;
+    struct hyperdex_client* client = hyperdex_get_client_ptr(env, obj);
+    jobject op = (*env)->NewObject(env, _iterator, _iterator_init, obj);
+    struct hyperdex_java_client_iterator* o = NULL;
+    ERROR_CHECK(0);
+    o = hyperdex_get_iterator_ptr(env, op);
+    ERROR_CHECK(0);
+    success = hyperdex_java_client_convert_spacename(env, obj, o->arena, spacename, &in_space);
+    if (success < 0) return 0;
+    success = hyperdex_java_client_convert_keys(env, obj, o->arena, keys, &in_keys, &in_keys_sz, &in_keys_num);
+    if (success < 0) return 0;
+    o->reqid = f(client, in_space, in_keys, in_keys_sz, in_keys_num, &o->status, &o->attrs, &o->attrs_sz);
+
+    if (o->reqid < 0)
+    {
+        hyperdex_java_client_throw_exception(env, o->status, hyperdex_client_error_message(client));
+        return 0;
+    }
+
+    o->encode_return = hyperdex_java_client_iterator_encode_status_attributes;
+    (*env)->CallObjectMethod(env, obj, _client_add_op, o->reqid, op);
+    ERROR_CHECK(0);
+    return op;
+}
+
 JNIEXPORT HYPERDEX_API jobject JNICALL
 hyperdex_java_client_asynccall__spacename_key_attributes__status(JNIEnv* env, jobject obj, int64_t (*f)(struct hyperdex_client* client, const char* space, const char* key, size_t key_sz, const struct hyperdex_client_attribute* attrs, size_t attrs_sz, enum hyperdex_client_returncode* status), jstring spacename, jobject key, jobject attributes);
 
@@ -329,6 +402,81 @@ hyperdex_java_client_iterator__spacename_predicates__status_attributes(JNIEnv* e
     return op;
 }
 
+JNIEXPORT HYPERDEX_API jobject JNICALL
+hyperdex_java_client_iterator__spacename_predicates_attributenames__status_attributes(JNIEnv* env, jobject obj, int64_t (*f)(struct hyperdex_client* client, const char* space, const struct hyperdex_client_attribute_check* checks, size_t checks_sz, const char** attrnames, size_t attrnames_sz, enum hyperdex_client_returncode* status, const struct hyperdex_client_attribute** attrs, size_t* attrs_sz), jstring spacename, jobject predicates, jobject attributenames);
+
+JNIEXPORT HYPERDEX_API jobject JNICALL
+hyperdex_java_client_iterator__spacename_predicates_attributenames__status_attributes(JNIEnv* env, jobject obj, int64_t (*f)(struct hyperdex_client* client, const char* space, const struct hyperdex_client_attribute_check* checks, size_t checks_sz, const char** attrnames, size_t attrnames_sz, enum hyperdex_client_returncode* status, const struct hyperdex_client_attribute** attrs, size_t* attrs_sz), jstring spacename, jobject predicates, jobject attributenames)
+{
+    const char* in_space;
+    const struct hyperdex_client_attribute_check* in_checks;
+    size_t in_checks_sz;
+    const char** in_attrnames;
+    size_t in_attrnames_sz;
+    int success = 0;
+    struct hyperdex_client* client = hyperdex_get_client_ptr(env, obj);
+    jobject op = (*env)->NewObject(env, _iterator, _iterator_init, obj);
+    struct hyperdex_java_client_iterator* o = NULL;
+    ERROR_CHECK(0);
+    o = hyperdex_get_iterator_ptr(env, op);
+    ERROR_CHECK(0);
+    success = hyperdex_java_client_convert_spacename(env, obj, o->arena, spacename, &in_space);
+    if (success < 0) return 0;
+    success = hyperdex_java_client_convert_predicates(env, obj, o->arena, predicates, &in_checks, &in_checks_sz);
+    if (success < 0) return 0;
+    success = hyperdex_java_client_convert_attributenames(env, obj, o->arena, attributenames, &in_attrnames, &in_attrnames_sz);
+    if (success < 0) return 0;
+    o->reqid = f(client, in_space, in_checks, in_checks_sz, in_attrnames, in_attrnames_sz, &o->status, &o->attrs, &o->attrs_sz);
+
+    if (o->reqid < 0)
+    {
+        hyperdex_java_client_throw_exception(env, o->status, hyperdex_client_error_message(client));
+        return 0;
+    }
+
+    o->encode_return = hyperdex_java_client_iterator_encode_status_attributes;
+    (*env)->CallObjectMethod(env, obj, _client_add_op, o->reqid, op);
+    ERROR_CHECK(0);
+    return op;
+}
+
+JNIEXPORT HYPERDEX_API jobject JNICALL
+hyperdex_java_client_iterator__spacename_predicates_limit__status_attributes(JNIEnv* env, jobject obj, int64_t (*f)(struct hyperdex_client* client, const char* space, const struct hyperdex_client_attribute_check* checks, size_t checks_sz, uint64_t limit, enum hyperdex_client_returncode* status, const struct hyperdex_client_attribute** attrs, size_t* attrs_sz), jstring spacename, jobject predicates, jint limit);
+
+JNIEXPORT HYPERDEX_API jobject JNICALL
+hyperdex_java_client_iterator__spacename_predicates_limit__status_attributes(JNIEnv* env, jobject obj, int64_t (*f)(struct hyperdex_client* client, const char* space, const struct hyperdex_client_attribute_check* checks, size_t checks_sz, uint64_t limit, enum hyperdex_client_returncode* status, const struct hyperdex_client_attribute** attrs, size_t* attrs_sz), jstring spacename, jobject predicates, jint limit)
+{
+    const char* in_space;
+    const struct hyperdex_client_attribute_check* in_checks;
+    size_t in_checks_sz;
+    uint64_t in_limit;
+    int success = 0;
+    struct hyperdex_client* client = hyperdex_get_client_ptr(env, obj);
+    jobject op = (*env)->NewObject(env, _iterator, _iterator_init, obj);
+    struct hyperdex_java_client_iterator* o = NULL;
+    ERROR_CHECK(0);
+    o = hyperdex_get_iterator_ptr(env, op);
+    ERROR_CHECK(0);
+    success = hyperdex_java_client_convert_spacename(env, obj, o->arena, spacename, &in_space);
+    if (success < 0) return 0;
+    success = hyperdex_java_client_convert_predicates(env, obj, o->arena, predicates, &in_checks, &in_checks_sz);
+    if (success < 0) return 0;
+    success = hyperdex_java_client_convert_limit(env, obj, o->arena, limit, &in_limit);
+    if (success < 0) return 0;
+    o->reqid = f(client, in_space, in_checks, in_checks_sz, in_limit, &o->status, &o->attrs, &o->attrs_sz);
+
+    if (o->reqid < 0)
+    {
+        hyperdex_java_client_throw_exception(env, o->status, hyperdex_client_error_message(client));
+        return 0;
+    }
+
+    o->encode_return = hyperdex_java_client_iterator_encode_status_attributes;
+    (*env)->CallObjectMethod(env, obj, _client_add_op, o->reqid, op);
+    ERROR_CHECK(0);
+    return op;
+}
+
 JNIEXPORT HYPERDEX_API jobject JNICALL
 hyperdex_java_client_asynccall__spacename_predicates__status_description(JNIEnv* env, jobject obj, int64_t (*f)(struct hyperdex_client* client, const char* space, const struct hyperdex_client_attribute_check* checks, size_t checks_sz, enum hyperdex_client_returncode* status, const char** description), jstring spacename, jobject predicates);
 
@@ -406,6 +554,53 @@ hyperdex_java_client_iterator__spacename_predicates_sortby_limit_maxmin__status_
     return op;
 }
 
+JNIEXPORT HYPERDEX_API jobject JNICALL
+hyperdex_java_client_iterator__spacename_predicates_sortby_limit_maxmin_attributenames__status_attributes(JNIEnv* env, jobject obj, int64_t (*f)(struct hyperdex_client* client, const char* space, const struct hyperdex_client_attribute_check* checks, size_t checks_sz, const char* sort_by, uint64_t limit, int maxmin, const char** attrnames, size_t attrnames_sz, enum hyperdex_client_returncode* status, const struct hyperdex_client_attribute** attrs, size_t* attrs_sz), jstring spacename, jobject predicates, jstring sortby, jint limit, jboolean maxmin, jobject attributenames);
+
+JNIEXPORT HYPERDEX_API jobject JNICALL
+hyperdex_java_client_iterator__spacename_predicates_sortby_limit_maxmin_attributenames__status_attributes(JNIEnv* env, jobject obj, int64_t (*f)(struct hyperdex_client* client, const char* space, const struct hyperdex_client_attribute_check* checks, size_t checks_sz, const char* sort_by, uint64_t limit, int maxmin, const char** attrnames, size_t attrnames_sz, enum hyperdex_client_returncode* status, const struct hyperdex_client_attribute** attrs, size_t* attrs_sz), jstring spacename, jobject predicates, jstring sortby, jint limit, jboolean maxmin, jobject attributenames)
+{
+    const char* in_space;
+    const struct hyperdex_client_attribute_check* in_checks;
+    size_t in_checks_sz;
+    const char* in_sort_by;
+    uint64_t in_limit;
+    int in_maxmin;
+    const char** in_attrnames;
+    size_t in_attrnames_sz;
+    int success = 0;
+    struct hyperdex_client* client = hyperdex_get_client_ptr(env, obj);
+    jobject op = (*env)->NewObject(env, _iterator, _iterator_init, obj);
+    struct hyperdex_java_client_iterator* o = NULL;
+    ERROR_CHECK(0);
+    o = hyperdex_get_iterator_ptr(env, op);
+    ERROR_CHECK(0);
+    success = hyperdex_java_client_convert_spacename(env, obj, o->arena, spacename, &in_space);
+    if (success < 0) return 0;
+    success = hyperdex_java_client_convert_predicates(env, obj, o->arena, predicates, &in_checks, &in_checks_sz);
+    if (success < 0) return 0;
+    success = hyperdex_java_client_convert_sortby(env, obj, o->arena, sortby, &in_sort_by);
+    if (success < 0) return 0;
+    success = hyperdex_java_client_convert_limit(env, obj, o->arena, limit, &in_limit);
+    if (success < 0) return 0;
+    success = hyperdex_java_client_convert_maxmin(env, obj, o->arena, maxmin, &in_maxmin);
+    if (success < 0) return 0;
+    success = hyperdex_java_client_convert_attributenames(env, obj, o->arena, attributenames, &in_attrnames, &in_attrnames_sz);
+    if (success < 0) return 0;
+    o->reqid = f(client, in_space, in_checks, in_checks_sz, in_sort_by, in_limit, in_maxmin, in_attrnames, in_attrnames_sz, &o->status, &o->attrs, &o->attrs_sz);
+
+    if (o->reqid < 0)
+    {
+        hyperdex_java_client_throw_exception(env, o->status, hyperdex_client_error_message(client));
+        return 0;
+    }
+
+    o->encode_return = hyperdex_java_client_iterator_encode_status_attributes;
+    (*env)->CallObjectMethod(env, obj, _client_add_op, o->reqid, op);
+    ERROR_CHECK(0);
+    return op;
+}
+
 JNIEXPORT HYPERDEX_API jobject JNICALL
 hyperdex_java_client_asynccall__spacename_predicates__status(JNIEnv* env, jobject obj, int64_t (*f)(struct hyperdex_client* client, const char* space, const struct hyperdex_client_attribute_check* checks, size_t checks_sz, enum hyperdex_client_returncode* status), jstring spacename, jobject predicates);
 
@@ -479,6 +674,18 @@ Java_org_hyperdex_client_Client_async_1get(JNIEnv* env, jobject obj, jstring spa
     return hyperdex_java_client_asynccall__spacename_key__status_attributes(env, obj, hyperdex_client_get, spacename, key);
 }
 
+JNIEXPORT HYPERDEX_API jobject JNICALL
+Java_org_hyperdex_client_Client_async_1get_1partial(JNIEnv* env, jobject obj, jstring spacename, jobject key, jobject attributenames)
+{
+    return hyperdex_java_client_asynccall__spacename_key_attributenames__status_attributes(env, obj, hyperdex_client_get_partial, spacename, key, attributenames);
+}
+
+JNIEXPORT HYPERDEX_API jobject JNICALL
+Java_org_hyperdex_client_Client_get_1many(JNIEnv* env, jobject obj, jstring spacename, jobject keys)
+{
+    return hyperdex_java_client_iterator__spacename_keys__status_attributes(env, obj, hyperdex_client_get_many, spacename, keys);
+}
+
 JNIEXPORT HYPERDEX_API jobject JNICALL
 Java_org_hyperdex_client_Client_async_1put(JNIEnv* env, jobject obj, jstring spacename, jobject key, jobject attributes)
 {
@@ -851,6 +1058,18 @@ Java_org_hyperdex_client_Client_search(JNIEnv* env, jobject obj, jstring spacena
     return hyperdex_java_client_iterator__spacename_predicates__status_attributes(env, obj, hyperdex_client_search, spacename, predicates);
 }
 
+JNIEXPORT HYPERDEX_API jobject JNICALL
+Java_org_hyperdex_client_Client_search_1partial(JNIEnv* env, jobject obj, jstring spacename, jobject predicates, jobject attributenames)
+{
+    return hyperdex_java_client_iterator__spacename_predicates_attributenames__status_attributes(env, obj, hyperdex_client_search_partial, spacename, predicates, attributenames);
+}
+
+JNIEXPORT HYPERDEX_API jobject JNICALL
+Java_org_hyperdex_client_Client_search_1limit(JNIEnv* env, jobject obj, jstring spacename, jobject predicates, jint limit)
+{
+    return hyperdex_java_client_iterator__spacename_predicates_limit__status_attributes(env, obj, hyperdex_client_search_limit, spacename, predicates, limit);
+}
+
 JNIEXPORT HYPERDEX_API jobject JNICALL
 Java_org_hyperdex_client_Client_async_1search_1describe(JNIEnv* env, jobject obj, jstring spacename, jobject predicates)
 {
@@ -863,6 +1082,12 @@ Java_org_hyperdex_client_Client_sorted_1search(JNIEnv* env, jobject obj, jstring
     return hyperdex_java_client_iterator__spacename_predicates_sortby_limit_maxmin__status_attributes(env, obj, hyperdex_client_sorted_search, spacename, predicates, sortby, limit, maxmin);
 }
 
+JNIEXPORT HYPERDEX_API jobject JNICALL
+Java_org_hyperdex_client_Client_sorted_1search_1partial(JNIEnv* env, jobject obj, jstring spacename, jobject predicates, jstring sortby, jint limit, jboolean maxmin, jobject attributenames)
+{
+    return hyperdex_java_client_iterator__spacename_predicates_sortby_limit_maxmin_attributenames__status_attributes(env, obj, hyperdex_client_sorted_search_partial, spacename, predicates, sortby, limit, maxmin, attributenames);
+}
+
 JNIEXPORT HYPERDEX_API jobject JNICALL
 Java_org_hyperdex_client_Client_async_1group_1del(JNIEnv* env, jobject obj, jstring spacename, jobject predicates)
 {
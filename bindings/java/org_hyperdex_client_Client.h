@@ -55,6 +55,22 @@ JNIEXPORT HYPERDEX_API jlong JNICALL Java_org_hyperdex_client_Client_inner_1loop
 JNIEXPORT HYPERDEX_API jobject JNICALL Java_org_hyperdex_client_Client_async_1get
   (JNIEnv *, jobject, jstring, jobject);
 
+/*
+ * Class:     org_hyperdex_client_Client
+ * Method:    async_get_partial
+ * Signature: (Ljava/lang/String;Ljava/lang/Object;Ljava/util/List;)Lorg/hyperdex/client/Deferred;
+ */
+JNIEXPORT HYPERDEX_API jobject JNICALL Java_org_hyperdex_client_Client_async_1get_1partial
+  (JNIEnv *, jobject, jstring, jobject, jobject);
+
+/*
+ * Class:     org_hyperdex_client_Client
+ * Method:    get_many
+ * Signature: (Ljava/lang/String;Ljava/util/List;)Lorg/hyperdex/client/Iterator;
+ */
+JNIEXPORT HYPERDEX_API jobject JNICALL Java_org_hyperdex_client_Client_get_1many
+  (JNIEnv *, jobject, jstring, jobject);
+
 /*
  * Class:     org_hyperdex_client_Client
  * Method:    async_put
@@ -551,6 +567,22 @@ JNIEXPORT HYPERDEX_API jobject JNICALL Java_org_hyperdex_client_Client_async_1co
 JNIEXPORT HYPERDEX_API jobject JNICALL Java_org_hyperdex_client_Client_search
   (JNIEnv *, jobject, jstring, jobject);
 
+/*
+ * Class:     org_hyperdex_client_Client
+ * Method:    search_partial
+ * Signature: (Ljava/lang/String;Ljava/util/Map;Ljava/util/List;)Lorg/hyperdex/client/Iterator;
+ */
+JNIEXPORT HYPERDEX_API jobject JNICALL Java_org_hyperdex_client_Client_search_1partial
+  (JNIEnv *, jobject, jstring, jobject, jobject);
+
+/*
+ * Class:     org_hyperdex_client_Client
+ * Method:    search_limit
+ * Signature: (Ljava/lang/String;Ljava/util/Map;I)Lorg/hyperdex/client/Iterator;
+ */
+JNIEXPORT HYPERDEX_API jobject JNICALL Java_org_hyperdex_client_Client_search_1limit
+  (JNIEnv *, jobject, jstring, jobject, jint);
+
 /*
  * Class:     org_hyperdex_client_Client
  * Method:    async_search_describe
@@ -567,6 +599,14 @@ JNIEXPORT HYPERDEX_API jobject JNICALL Java_org_hyperdex_client_Client_async_1se
 JNIEXPORT HYPERDEX_API jobject JNICALL Java_org_hyperdex_client_Client_sorted_1search
   (JNIEnv *, jobject, jstring, jobject, jstring, jint, jboolean);
 
+/*
+ * Class:     org_hyperdex_client_Client
+ * Method:    sorted_search_partial
+ * Signature: (Ljava/lang/String;Ljava/util/Map;Ljava/lang/String;IZLjava/util/List;)Lorg/hyperdex/client/Iterator;
+ */
+JNIEXPORT HYPERDEX_API jobject JNICALL Java_org_hyperdex_client_Client_sorted_1search_1partial
+  (JNIEnv *, jobject, jstring, jobject, jstring, jint, jboolean, jobject);
+
 /*
  * Class:     org_hyperdex_client_Client
  * Method:    async_group_del
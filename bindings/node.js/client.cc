@@ -107,6 +107,12 @@ class Operation
                                const char** spacename);
         bool convert_key(v8::Handle<v8::Value>& _key,
                          const char** key, size_t* key_sz);
+        bool convert_keys(v8::Handle<v8::Value>& _keys,
+                          const char*** keys, const size_t** keys_sz,
+                          size_t* keys_num);
+        bool convert_attributenames(v8::Handle<v8::Value>& _attrnames,
+                                    const char*** attrnames,
+                                    size_t* attrnames_sz);
         bool convert_attributes(v8::Handle<v8::Value>& _attributes,
                                 const hyperdex_client_attribute** attrs,
                                 size_t* attrs_sz);
@@ -535,6 +541,82 @@ Operation :: convert_key(v8::Handle<v8::Value>& _key,
     return convert_type(_key, key, key_sz, &datatype);
 }
 
+bool
+Operation :: convert_keys(v8::Handle<v8::Value>& x,
+                          const char*** _keys, const size_t** _keys_sz,
+                          size_t* _keys_num)
+{
+    if (!x->IsArray())
+    {
+        this->callback_error_message("keys must be an array");
+        return false;
+    }
+
+    v8::Local<v8::Array> arr = v8::Local<v8::Array>::Cast(x);
+    size_t keys_num = arr->Length();
+    const char** keys = hyperdex_ds_allocate_string_array(m_arena, keys_num);
+    size_t* keys_sz = hyperdex_ds_allocate_size_array(m_arena, keys_num);
+
+    if (!keys || !keys_sz)
+    {
+        this->callback_error_out_of_memory();
+        return false;
+    }
+
+    *_keys = keys;
+    *_keys_sz = keys_sz;
+    *_keys_num = keys_num;
+
+    for (size_t i = 0; i < keys_num; ++i)
+    {
+        v8::Local<v8::Value> key = arr->Get(i);
+
+        if (!convert_key(key, &keys[i], &keys_sz[i]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool
+Operation :: convert_attributenames(v8::Handle<v8::Value>& x,
+                                    const char*** _attrnames,
+                                    size_t* _attrnames_sz)
+{
+    if (!x->IsArray())
+    {
+        this->callback_error_message("attribute names must be an array");
+        return false;
+    }
+
+    v8::Local<v8::Array> arr = v8::Local<v8::Array>::Cast(x);
+    size_t attrnames_sz = arr->Length();
+    const char** attrnames = hyperdex_ds_allocate_string_array(m_arena, attrnames_sz);
+
+    if (!attrnames)
+    {
+        this->callback_error_out_of_memory();
+        return false;
+    }
+
+    *_attrnames = attrnames;
+    *_attrnames_sz = attrnames_sz;
+
+    for (size_t i = 0; i < attrnames_sz; ++i)
+    {
+        v8::Local<v8::Value> name = arr->Get(i);
+
+        if (!convert_cstring(name, &attrnames[i]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 bool
 Operation :: convert_attributes(v8::Handle<v8::Value>& x,
                                 const hyperdex_client_attribute** _attrs,
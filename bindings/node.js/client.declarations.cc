@@ -27,6 +27,8 @@
 // This file is generated by bindings/nodejs.py
 
 static v8::Handle<v8::Value> asynccall__spacename_key__status_attributes(int64_t (*f)(struct hyperdex_client* client, const char* space, const char* key, size_t key_sz, enum hyperdex_client_returncode* status, const struct hyperdex_client_attribute** attrs, size_t* attrs_sz), const v8::Arguments& args);
+static v8::Handle<v8::Value> asynccall__spacename_key_attributenames__status_attributes(int64_t (*f)(struct hyperdex_client* client, const char* space, const char* key, size_t key_sz, const char** attrnames, size_t attrnames_sz, enum hyperdex_client_returncode* status, const struct hyperdex_client_attribute** attrs, size_t* attrs_sz), const v8::Arguments& args);
+static v8::Handle<v8::Value> iterator__spacename_keys__status_attributes(int64_t (*f)(struct hyperdex_client* client, const char* space, const char** keys, const size_t* keys_sz, size_t keys_num, enum hyperdex_client_returncode* status, const struct hyperdex_client_attribute** attrs, size_t* attrs_sz), const v8::Arguments& args);
 static v8::Handle<v8::Value> asynccall__spacename_key_attributes__status(int64_t (*f)(struct hyperdex_client* client, const char* space, const char* key, size_t key_sz, const struct hyperdex_client_attribute* attrs, size_t attrs_sz, enum hyperdex_client_returncode* status), const v8::Arguments& args);
 static v8::Handle<v8::Value> asynccall__spacename_key_predicates_attributes__status(int64_t (*f)(struct hyperdex_client* client, const char* space, const char* key, size_t key_sz, const struct hyperdex_client_attribute_check* checks, size_t checks_sz, const struct hyperdex_client_attribute* attrs, size_t attrs_sz, enum hyperdex_client_returncode* status), const v8::Arguments& args);
 static v8::Handle<v8::Value> asynccall__spacename_key__status(int64_t (*f)(struct hyperdex_client* client, const char* space, const char* key, size_t key_sz, enum hyperdex_client_returncode* status), const v8::Arguments& args);
@@ -34,12 +36,17 @@ static v8::Handle<v8::Value> asynccall__spacename_key_predicates__status(int64_t
 static v8::Handle<v8::Value> asynccall__spacename_key_mapattributes__status(int64_t (*f)(struct hyperdex_client* client, const char* space, const char* key, size_t key_sz, const struct hyperdex_client_map_attribute* mapattrs, size_t mapattrs_sz, enum hyperdex_client_returncode* status), const v8::Arguments& args);
 static v8::Handle<v8::Value> asynccall__spacename_key_predicates_mapattributes__status(int64_t (*f)(struct hyperdex_client* client, const char* space, const char* key, size_t key_sz, const struct hyperdex_client_attribute_check* checks, size_t checks_sz, const struct hyperdex_client_map_attribute* mapattrs, size_t mapattrs_sz, enum hyperdex_client_returncode* status), const v8::Arguments& args);
 static v8::Handle<v8::Value> iterator__spacename_predicates__status_attributes(int64_t (*f)(struct hyperdex_client* client, const char* space, const struct hyperdex_client_attribute_check* checks, size_t checks_sz, enum hyperdex_client_returncode* status, const struct hyperdex_client_attribute** attrs, size_t* attrs_sz), const v8::Arguments& args);
+static v8::Handle<v8::Value> iterator__spacename_predicates_attributenames__status_attributes(int64_t (*f)(struct hyperdex_client* client, const char* space, const struct hyperdex_client_attribute_check* checks, size_t checks_sz, const char** attrnames, size_t attrnames_sz, enum hyperdex_client_returncode* status, const struct hyperdex_client_attribute** attrs, size_t* attrs_sz), const v8::Arguments& args);
+static v8::Handle<v8::Value> iterator__spacename_predicates_limit__status_attributes(int64_t (*f)(struct hyperdex_client* client, const char* space, const struct hyperdex_client_attribute_check* checks, size_t checks_sz, uint64_t limit, enum hyperdex_client_returncode* status, const struct hyperdex_client_attribute** attrs, size_t* attrs_sz), const v8::Arguments& args);
 static v8::Handle<v8::Value> asynccall__spacename_predicates__status_description(int64_t (*f)(struct hyperdex_client* client, const char* space, const struct hyperdex_client_attribute_check* checks, size_t checks_sz, enum hyperdex_client_returncode* status, const char** description), const v8::Arguments& args);
 static v8::Handle<v8::Value> iterator__spacename_predicates_sortby_limit_maxmin__status_attributes(int64_t (*f)(struct hyperdex_client* client, const char* space, const struct hyperdex_client_attribute_check* checks, size_t checks_sz, const char* sort_by, uint64_t limit, int maxmin, enum hyperdex_client_returncode* status, const struct hyperdex_client_attribute** attrs, size_t* attrs_sz), const v8::Arguments& args);
+static v8::Handle<v8::Value> iterator__spacename_predicates_sortby_limit_maxmin_attributenames__status_attributes(int64_t (*f)(struct hyperdex_client* client, const char* space, const struct hyperdex_client_attribute_check* checks, size_t checks_sz, const char* sort_by, uint64_t limit, int maxmin, const char** attrnames, size_t attrnames_sz, enum hyperdex_client_returncode* status, const struct hyperdex_client_attribute** attrs, size_t* attrs_sz), const v8::Arguments& args);
 static v8::Handle<v8::Value> asynccall__spacename_predicates__status(int64_t (*f)(struct hyperdex_client* client, const char* space, const struct hyperdex_client_attribute_check* checks, size_t checks_sz, enum hyperdex_client_returncode* status), const v8::Arguments& args);
 static v8::Handle<v8::Value> asynccall__spacename_predicates__status_count(int64_t (*f)(struct hyperdex_client* client, const char* space, const struct hyperdex_client_attribute_check* checks, size_t checks_sz, enum hyperdex_client_returncode* status, uint64_t* count), const v8::Arguments& args);
 
 static v8::Handle<v8::Value> get(const v8::Arguments& args);
+static v8::Handle<v8::Value> get_partial(const v8::Arguments& args);
+static v8::Handle<v8::Value> get_many(const v8::Arguments& args);
 static v8::Handle<v8::Value> put(const v8::Arguments& args);
 static v8::Handle<v8::Value> cond_put(const v8::Arguments& args);
 static v8::Handle<v8::Value> put_if_not_exist(const v8::Arguments& args);
@@ -102,7 +109,10 @@ static v8::Handle<v8::Value> cond_map_string_prepend(const v8::Arguments& args);
 static v8::Handle<v8::Value> map_string_append(const v8::Arguments& args);
 static v8::Handle<v8::Value> cond_map_string_append(const v8::Arguments& args);
 static v8::Handle<v8::Value> search(const v8::Arguments& args);
+static v8::Handle<v8::Value> search_partial(const v8::Arguments& args);
+static v8::Handle<v8::Value> search_limit(const v8::Arguments& args);
 static v8::Handle<v8::Value> search_describe(const v8::Arguments& args);
 static v8::Handle<v8::Value> sorted_search(const v8::Arguments& args);
+static v8::Handle<v8::Value> sorted_search_partial(const v8::Arguments& args);
 static v8::Handle<v8::Value> group_del(const v8::Arguments& args);
 static v8::Handle<v8::Value> count(const v8::Arguments& args);
\ No newline at end of file
@@ -62,6 +62,83 @@ HyperDexClient :: asynccall__spacename_key__status_attributes(int64_t (*f)(struc
     return scope.Close(v8::Undefined());
 }
 
+v8::Handle<v8::Value>
+HyperDexClient :: asynccall__spacename_key_attributenames__status_attributes(int64_t (*f)(struct hyperdex_client* client, const char* space, const char* key, size_t key_sz, const char** attrnames, size_t attrnames_sz, enum hyperdex_client_returncode* status, const struct hyperdex_client_attribute** attrs, size_t* attrs_sz), const v8::Arguments& args)
+{
+    v8::HandleScope scope;
+    v8::Local<v8::Object> client_obj = args.This();
+    HyperDexClient* client = node::ObjectWrap::Unwrap<HyperDexClient>(client_obj);
+    e::intrusive_ptr<Operation> op(new Operation(client_obj, client));
+    const char* in_space;
+    v8::Local<v8::Value> spacename = args[0];
+    if (!op->convert_spacename(spacename, &in_space)) return scope.Close(v8::Undefined());
+    const char* in_key;
+    size_t in_key_sz;
+    v8::Local<v8::Value> key = args[1];
+    if (!op->convert_key(key, &in_key, &in_key_sz)) return scope.Close(v8::Undefined());
+    const char** in_attrnames;
+    size_t in_attrnames_sz;
+    v8::Local<v8::Value> attributenames = args[2];
+    if (!op->convert_attributenames(attributenames, &in_attrnames, &in_attrnames_sz)) return scope.Close(v8::Undefined());
+    v8::Local<v8::Function> func = args[3].As<v8::Function>();
+
+    if (func.IsEmpty() || !func->IsFunction())
+    {
+        v8::ThrowException(v8::String::New("Callback must be a function"));
+        return scope.Close(v8::Undefined());
+    }
+
+    if (!op->set_callback(func, 2)) { return scope.Close(v8::Undefined()); }
+    op->reqid = f(client->client(), in_space, in_key, in_key_sz, in_attrnames, in_attrnames_sz, &op->status, &op->attrs, &op->attrs_sz);
+
+    if (op->reqid < 0)
+    {
+        op->callback_error_from_status();
+        return scope.Close(v8::Undefined());
+    }
+
+    op->encode_return = &Operation::encode_asynccall_status_attributes;
+    client->add(op->reqid, op);
+    return scope.Close(v8::Undefined());
+}
+
+v8::Handle<v8::Value>
+HyperDexClient :: iterator__spacename_keys__status_attributes(int64_t (*f)(struct hyperdex_client* client, const char* space, const char** keys, const size_t* keys_sz, size_t keys_num, enum hyperdex_client_returncode* status, const struct hyperdex_client_attribute** attrs, size_t* attrs_sz), const v8::Arguments& args)
+{
+    v8::HandleScope scope;
+    v8::Local<v8::Object> client_obj = args.This();
+    HyperDexClient* client = node::ObjectWrap::Unwrap<HyperDexClient>(client_obj);
+    e::intrusive_ptr<Operation> op(new Operation(client_obj, client));
+    const char* in_space;
+    v8::Local<v8::Value> spacename = args[0];
+    if (!op->convert_spacename(spacename, &in_space)) return scope.Close(v8::Undefined());
+    const char** in_keys;
+    const size_t* in_keys_sz;
+    size_t in_keys_num;
+    v8::Local<v8::Value> keys = args[1];
+    if (!op->convert_keys(keys, &in_keys, &in_keys_sz, &in_keys_num)) return scope.Close(v8::Undefined());
+    v8::Local<v8::Function> func = args[2].As<v8::Function>();
+
+    if (func.IsEmpty() || !func->IsFunction())
+    {
+        v8::ThrowException(v8::String::New("Callback must be a function"));
+        return scope.Close(v8::Undefined());
+    }
+
+    if (!op->set_callback(func, 3)) { return scope.Close(v8::Undefined()); }
+    op->reqid = f(client->client(), in_space, in_keys, in_keys_sz, in_keys_num, &op->status, &op->attrs, &op->attrs_sz);
+
+    if (op->reqid < 0)
+    {
+        op->callback_error_from_status();
+        return scope.Close(v8::Undefined());
+    }
+
+    op->encode_return = &Operation::encode_iterator_status_attributes;
+    client->add(op->reqid, op);
+    return scope.Close(v8::Undefined());
+}
+
 v8::Handle<v8::Value>
 HyperDexClient :: asynccall__spacename_key_attributes__status(int64_t (*f)(struct hyperdex_client* client, const char* space, const char* key, size_t key_sz, const struct hyperdex_client_attribute* attrs, size_t attrs_sz, enum hyperdex_client_returncode* status), const v8::Arguments& args)
 {
@@ -342,6 +419,85 @@ HyperDexClient :: iterator__spacename_predicates__status_attributes(int64_t (*f)
     return scope.Close(v8::Undefined());
 }
 
+v8::Handle<v8::Value>
+HyperDexClient :: iterator__spacename_predicates_attributenames__status_attributes(int64_t (*f)(struct hyperdex_client* client, const char* space, const struct hyperdex_client_attribute_check* checks, size_t checks_sz, const char** attrnames, size_t attrnames_sz, enum hyperdex_client_returncode* status, const struct hyperdex_client_attribute** attrs, size_t* attrs_sz), const v8::Arguments& args)
+{
+    v8::HandleScope scope;
+    v8::Local<v8::Object> client_obj = args.This();
+    HyperDexClient* client = node::ObjectWrap::Unwrap<HyperDexClient>(client_obj);
+    e::intrusive_ptr<Operation> op(new Operation(client_obj, client));
+    const char* in_space;
+    v8::Local<v8::Value> spacename = args[0];
+    if (!op->convert_spacename(spacename, &in_space)) return scope.Close(v8::Undefined());
+    const struct hyperdex_client_attribute_check* in_checks;
+    size_t in_checks_sz;
+    v8::Local<v8::Value> predicates = args[1];
+    if (!op->convert_predicates(predicates, &in_checks, &in_checks_sz)) return scope.Close(v8::Undefined());
+    const char** in_attrnames;
+    size_t in_attrnames_sz;
+    v8::Local<v8::Value> attributenames = args[2];
+    if (!op->convert_attributenames(attributenames, &in_attrnames, &in_attrnames_sz)) return scope.Close(v8::Undefined());
+    v8::Local<v8::Function> func = args[3].As<v8::Function>();
+
+    if (func.IsEmpty() || !func->IsFunction())
+    {
+        v8::ThrowException(v8::String::New("Callback must be a function"));
+        return scope.Close(v8::Undefined());
+    }
+
+    if (!op->set_callback(func, 3)) { return scope.Close(v8::Undefined()); }
+    op->reqid = f(client->client(), in_space, in_checks, in_checks_sz, in_attrnames, in_attrnames_sz, &op->status, &op->attrs, &op->attrs_sz);
+
+    if (op->reqid < 0)
+    {
+        op->callback_error_from_status();
+        return scope.Close(v8::Undefined());
+    }
+
+    op->encode_return = &Operation::encode_iterator_status_attributes;
+    client->add(op->reqid, op);
+    return scope.Close(v8::Undefined());
+}
+
+v8::Handle<v8::Value>
+HyperDexClient :: iterator__spacename_predicates_limit__status_attributes(int64_t (*f)(struct hyperdex_client* client, const char* space, const struct hyperdex_client_attribute_check* checks, size_t checks_sz, uint64_t limit, enum hyperdex_client_returncode* status, const struct hyperdex_client_attribute** attrs, size_t* attrs_sz), const v8::Arguments& args)
+{
+    v8::HandleScope scope;
+    v8::Local<v8::Object> client_obj = args.This();
+    HyperDexClient* client = node::ObjectWrap::Unwrap<HyperDexClient>(client_obj);
+    e::intrusive_ptr<Operation> op(new Operation(client_obj, client));
+    const char* in_space;
+    v8::Local<v8::Value> spacename = args[0];
+    if (!op->convert_spacename(spacename, &in_space)) return scope.Close(v8::Undefined());
+    const struct hyperdex_client_attribute_check* in_checks;
+    size_t in_checks_sz;
+    v8::Local<v8::Value> predicates = args[1];
+    if (!op->convert_predicates(predicates, &in_checks, &in_checks_sz)) return scope.Close(v8::Undefined());
+    uint64_t in_limit;
+    v8::Local<v8::Value> limit = args[2];
+    if (!op->convert_limit(limit, &in_limit)) return scope.Close(v8::Undefined());
+    v8::Local<v8::Function> func = args[3].As<v8::Function>();
+
+    if (func.IsEmpty() || !func->IsFunction())
+    {
+        v8::ThrowException(v8::String::New("Callback must be a function"));
+        return scope.Close(v8::Undefined());
+    }
+
+    if (!op->set_callback(func, 3)) { return scope.Close(v8::Undefined()); }
+    op->reqid = f(client->client(), in_space, in_checks, in_checks_sz, in_limit, &op->status, &op->attrs, &op->attrs_sz);
+
+    if (op->reqid < 0)
+    {
+        op->callback_error_from_status();
+        return scope.Close(v8::Undefined());
+    }
+
+    op->encode_return = &Operation::encode_iterator_status_attributes;
+    client->add(op->reqid, op);
+    return scope.Close(v8::Undefined());
+}
+
 v8::Handle<v8::Value>
 HyperDexClient :: asynccall__spacename_predicates__status_description(int64_t (*f)(struct hyperdex_client* client, const char* space, const struct hyperdex_client_attribute_check* checks, size_t checks_sz, enum hyperdex_client_returncode* status, const char** description), const v8::Arguments& args)
 {
@@ -423,6 +579,55 @@ HyperDexClient :: iterator__spacename_predicates_sortby_limit_maxmin__status_att
     return scope.Close(v8::Undefined());
 }
 
+v8::Handle<v8::Value>
+HyperDexClient :: iterator__spacename_predicates_sortby_limit_maxmin_attributenames__status_attributes(int64_t (*f)(struct hyperdex_client* client, const char* space, const struct hyperdex_client_attribute_check* checks, size_t checks_sz, const char* sort_by, uint64_t limit, int maxmin, const char** attrnames, size_t attrnames_sz, enum hyperdex_client_returncode* status, const struct hyperdex_client_attribute** attrs, size_t* attrs_sz), const v8::Arguments& args)
+{
+    v8::HandleScope scope;
+    v8::Local<v8::Object> client_obj = args.This();
+    HyperDexClient* client = node::ObjectWrap::Unwrap<HyperDexClient>(client_obj);
+    e::intrusive_ptr<Operation> op(new Operation(client_obj, client));
+    const char* in_space;
+    v8::Local<v8::Value> spacename = args[0];
+    if (!op->convert_spacename(spacename, &in_space)) return scope.Close(v8::Undefined());
+    const struct hyperdex_client_attribute_check* in_checks;
+    size_t in_checks_sz;
+    v8::Local<v8::Value> predicates = args[1];
+    if (!op->convert_predicates(predicates, &in_checks, &in_checks_sz)) return scope.Close(v8::Undefined());
+    const char* in_sort_by;
+    v8::Local<v8::Value> sortby = args[2];
+    if (!op->convert_sortby(sortby, &in_sort_by)) return scope.Close(v8::Undefined());
+    uint64_t in_limit;
+    v8::Local<v8::Value> limit = args[3];
+    if (!op->convert_limit(limit, &in_limit)) return scope.Close(v8::Undefined());
+    int in_maxmin;
+    v8::Local<v8::Value> maxmin = args[4];
+    if (!op->convert_maxmin(maxmin, &in_maxmin)) return scope.Close(v8::Undefined());
+    const char** in_attrnames;
+    size_t in_attrnames_sz;
+    v8::Local<v8::Value> attributenames = args[5];
+    if (!op->convert_attributenames(attributenames, &in_attrnames, &in_attrnames_sz)) return scope.Close(v8::Undefined());
+    v8::Local<v8::Function> func = args[6].As<v8::Function>();
+
+    if (func.IsEmpty() || !func->IsFunction())
+    {
+        v8::ThrowException(v8::String::New("Callback must be a function"));
+        return scope.Close(v8::Undefined());
+    }
+
+    if (!op->set_callback(func, 3)) { return scope.Close(v8::Undefined()); }
+    op->reqid = f(client->client(), in_space, in_checks, in_checks_sz, in_sort_by, in_limit, in_maxmin, in_attrnames, in_attrnames_sz, &op->status, &op->attrs, &op->attrs_sz);
+
+    if (op->reqid < 0)
+    {
+        op->callback_error_from_status();
+        return scope.Close(v8::Undefined());
+    }
+
+    op->encode_return = &Operation::encode_iterator_status_attributes;
+    client->add(op->reqid, op);
+    return scope.Close(v8::Undefined());
+}
+
 v8::Handle<v8::Value>
 HyperDexClient :: asynccall__spacename_predicates__status(int64_t (*f)(struct hyperdex_client* client, const char* space, const struct hyperdex_client_attribute_check* checks, size_t checks_sz, enum hyperdex_client_returncode* status), const v8::Arguments& args)
 {
@@ -502,6 +707,18 @@ HyperDexClient :: get(const v8::Arguments& args)
     return asynccall__spacename_key__status_attributes(hyperdex_client_get, args);
 }
 
+v8::Handle<v8::Value>
+HyperDexClient :: get_partial(const v8::Arguments& args)
+{
+    return asynccall__spacename_key_attributenames__status_attributes(hyperdex_client_get_partial, args);
+}
+
+v8::Handle<v8::Value>
+HyperDexClient :: get_many(const v8::Arguments& args)
+{
+    return iterator__spacename_keys__status_attributes(hyperdex_client_get_many, args);
+}
+
 v8::Handle<v8::Value>
 HyperDexClient :: put(const v8::Arguments& args)
 {
@@ -874,6 +1091,18 @@ HyperDexClient :: search(const v8::Arguments& args)
     return iterator__spacename_predicates__status_attributes(hyperdex_client_search, args);
 }
 
+v8::Handle<v8::Value>
+HyperDexClient :: search_partial(const v8::Arguments& args)
+{
+    return iterator__spacename_predicates_attributenames__status_attributes(hyperdex_client_search_partial, args);
+}
+
+v8::Handle<v8::Value>
+HyperDexClient :: search_limit(const v8::Arguments& args)
+{
+    return iterator__spacename_predicates_limit__status_attributes(hyperdex_client_search_limit, args);
+}
+
 v8::Handle<v8::Value>
 HyperDexClient :: search_describe(const v8::Arguments& args)
 {
@@ -886,6 +1115,12 @@ HyperDexClient :: sorted_search(const v8::Arguments& args)
     return iterator__spacename_predicates_sortby_limit_maxmin__status_attributes(hyperdex_client_sorted_search, args);
 }
 
+v8::Handle<v8::Value>
+HyperDexClient :: sorted_search_partial(const v8::Arguments& args)
+{
+    return iterator__spacename_predicates_sortby_limit_maxmin_attributenames__status_attributes(hyperdex_client_sorted_search_partial, args);
+}
+
 v8::Handle<v8::Value>
 HyperDexClient :: group_del(const v8::Arguments& args)
 {
@@ -27,6 +27,8 @@
 // This file is generated by bindings/nodejs.py
 
 NODE_SET_PROTOTYPE_METHOD(tpl, "get", HyperDexClient::get);
+NODE_SET_PROTOTYPE_METHOD(tpl, "get_partial", HyperDexClient::get_partial);
+NODE_SET_PROTOTYPE_METHOD(tpl, "get_many", HyperDexClient::get_many);
 NODE_SET_PROTOTYPE_METHOD(tpl, "put", HyperDexClient::put);
 NODE_SET_PROTOTYPE_METHOD(tpl, "cond_put", HyperDexClient::cond_put);
 NODE_SET_PROTOTYPE_METHOD(tpl, "put_if_not_exist", HyperDexClient::put_if_not_exist);
@@ -89,7 +91,10 @@ NODE_SET_PROTOTYPE_METHOD(tpl, "cond_map_string_prepend", HyperDexClient::cond_m
 NODE_SET_PROTOTYPE_METHOD(tpl, "map_string_append", HyperDexClient::map_string_append);
 NODE_SET_PROTOTYPE_METHOD(tpl, "cond_map_string_append", HyperDexClient::cond_map_string_append);
 NODE_SET_PROTOTYPE_METHOD(tpl, "search", HyperDexClient::search);
+NODE_SET_PROTOTYPE_METHOD(tpl, "search_partial", HyperDexClient::search_partial);
+NODE_SET_PROTOTYPE_METHOD(tpl, "search_limit", HyperDexClient::search_limit);
 NODE_SET_PROTOTYPE_METHOD(tpl, "search_describe", HyperDexClient::search_describe);
 NODE_SET_PROTOTYPE_METHOD(tpl, "sorted_search", HyperDexClient::sorted_search);
+NODE_SET_PROTOTYPE_METHOD(tpl, "sorted_search_partial", HyperDexClient::sorted_search_partial);
 NODE_SET_PROTOTYPE_METHOD(tpl, "group_del", HyperDexClient::group_del);
 NODE_SET_PROTOTYPE_METHOD(tpl, "count", HyperDexClient::count);
\ No newline at end of file
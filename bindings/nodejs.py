@@ -34,6 +34,11 @@ import bindings
 import bindings.c
 import bindings.nodejs
 
+# there are no converters for per-key attributes or cursors yet, so the calls
+# that take them are left out of this binding
+Client = [c for c in bindings.Client
+          if bindings.KeyAttributes not in c.args_in and bindings.Cursor not in c.args_in]
+
 DOCS_IN = {(bindings.AsyncCall, bindings.SpaceName): 'The name of the space as a string or buffer.'
           ,(bindings.AsyncCall, bindings.Key): 'The key for the operation as a Node type'
           ,(bindings.AsyncCall, bindings.Attributes): 'An object specifying attributes '
@@ -42,7 +47,13 @@ DOCS_IN = {(bindings.AsyncCall, bindings.SpaceName): 'The name of the space as a
            'attributes to modify and their respective key/values.'
           ,(bindings.AsyncCall, bindings.Predicates): 'An object of predicates '
            'to check against.'
+          ,(bindings.AsyncCall, bindings.AttributeNames): 'An array of the '
+           'attributes to retrieve, as strings.'
           ,(bindings.Iterator, bindings.SpaceName): 'The name of the space as string or buffer.'
+          ,(bindings.Iterator, bindings.Keys): 'An array of keys, each as a Node type.'
+          ,(bindings.Iterator, bindings.AttributeNames): 'An array of the '
+           'attributes to retrieve for each object, as strings.  The key is '
+           'always returned.'
           ,(bindings.Iterator, bindings.SortBy): 'The attribute to sort by.'
           ,(bindings.Iterator, bindings.Limit): 'The number of results to return.'
           ,(bindings.Iterator, bindings.MaxMin): 'Maximize or minimize '
@@ -167,29 +178,29 @@ def generate_client_declarations():
     fout = open(os.path.join(BASE, 'bindings/node.js/client.declarations.cc'), 'w')
     fout.write(bindings.copyright('/', '2014'))
     fout.write('\n// This file is generated by bindings/nodejs.py\n\n')
-    fout.write('\n'.join(generate_worker_declarations(bindings.Client)))
+    fout.write('\n'.join(generate_worker_declarations(Client)))
     fout.write('\n\n')
-    fout.write('\n'.join([generate_declaration(c) for c in bindings.Client]))
+    fout.write('\n'.join([generate_declaration(c) for c in Client]))
 
 def generate_client_definitions():
     fout = open(os.path.join(BASE, 'bindings/node.js/client.definitions.cc'), 'w')
     fout.write(bindings.copyright('/', '2014'))
     fout.write('\n// This file is generated by bindings/nodejs.py\n\n')
-    fout.write('\n'.join(generate_worker_definitions(bindings.Client)))
+    fout.write('\n'.join(generate_worker_definitions(Client)))
     fout.write('\n\n')
-    fout.write('\n'.join([generate_definition(c) for c in bindings.Client]))
+    fout.write('\n'.join([generate_definition(c) for c in Client]))
 
 def generate_client_prototypes():
     fout = open(os.path.join(BASE, 'bindings/node.js/client.prototypes.cc'), 'w')
     fout.write(bindings.copyright('/', '2014'))
     fout.write('\n// This file is generated by bindings/nodejs.py\n\n')
-    fout.write('\n'.join([generate_prototype(c) for c in bindings.Client]))
+    fout.write('\n'.join([generate_prototype(c) for c in Client]))
 
 def generate_client_doc():
     fout = open(os.path.join(BASE, 'doc/api/node.js.client.tex'), 'w')
     fout.write(bindings.copyright('%', '2014'))
     fout.write('\n% This LaTeX file is generated by bindings/nodejs.py\n\n')
-    fout.write('\n'.join([generate_api_block(c) for c in bindings.Client]))
+    fout.write('\n'.join([generate_api_block(c) for c in Client]))
 
 if __name__ == '__main__':
     generate_client_declarations()
@@ -30,11 +30,15 @@ import sys
 
 BASE = os.path.join(os.path.dirname(__file__), '../..')
 
-sys.path.append(os.path.join(BASE, 'bindings'))
-sys.path.append(os.path.join(BASE, 'bindings/c'))
+sys.path.append(BASE)
 
-import generator
-import gen_client_header
+import bindings as generator
+import bindings.c as gen_client_header
+
+Client = generator.Client
+
+# these arguments are converted into arrays the caller must free
+FREED = (generator.Keys, generator.AttributeNames)
 
 
 def name(x):
@@ -68,6 +72,14 @@ def PYTYPEOF(x):
         return 'int'
     elif x == generator.MaxMin:
         return 'str'
+    elif x == generator.Keys:
+        return 'list'
+    elif x == generator.AttributeNames:
+        return 'list'
+    elif x == generator.KeyAttributes:
+        return 'list'
+    elif x == generator.Cursor:
+        return 'bytes'
     print x
     assert False
 
@@ -99,23 +111,63 @@ def generate_function_ptr(x, name):
     c_func = c_func.replace('hyperdex_client_WXYZ', name)
     return c_func
 
-def generate_worker_asynccall(call, x):
-    typed_args = ', '.join([(PYTYPEOF(arg) + ' ' + arg_name(arg)).strip()
-                             for arg in x.args_in])
-    func  = 'cdef {0}(self, {2} f, {1}):\n'.format(call, typed_args, call + '_fptr')
-    func += '    cdef Deferred d = Deferred(self)\n'
+def out_arg(obj, arg, n):
+    # the statuses are an array the call fills in, not a single value
+    if arg == generator.Statuses:
+        return '{0}.{1}'.format(obj, n)
+    return '&{0}.{1}'.format(obj, n)
+
+def generate_worker_body(obj, x):
+    func = ''
     for arg in x.args_in:
         for p, n in arg.args:
             if p.startswith('const '):
                 p = p[len('const '):]
             if p.startswith('struct '):
                 p = p[len('struct '):]
-            func += '    cdef ' + p + ' in_' + n + '\n'
+            if arg in FREED and p.endswith('*'):
+                func += '    cdef ' + p + ' in_' + n + ' = NULL\n'
+            else:
+                func += '    cdef ' + p + ' in_' + n + '\n'
+    if generator.Keys in x.args_in and generator.KeyAttributes in x.args_in:
+        func += '    if len(keys) != len(keyattributes):\n'
+        func += '        raise ValueError("There must be one dict of attributes per key")\n'
+    freed = [arg for arg in x.args_in if arg in FREED]
     for arg in x.args_in:
+        if arg in freed:
+            continue
         args = ', '.join(['&in_' + n for p, n in arg.args])
-        func += '    self.convert_{0}(d.arena, {0}, {1});\n'.format(arg.__name__.lower(), args)
-    func += '    d.reqid = f(self.client, {0}, {1});\n'.format(', '.join(['in_' + n for p, n in sum([list(a.args) for a in x.args_in], [])]),
-                                                                ', '.join(['&d.' + n for p, n in sum([list(a.args) for a in x.args_out], [])]))
+        func += '    self.convert_{0}({2}.arena, {0}, {1});\n'.format(arg.__name__.lower(), args, obj)
+    call = []
+    if generator.Statuses in x.args_out:
+        call.append('{0}.statuses = <hyperdex_client_returncode*>malloc(sizeof(hyperdex_client_returncode) * max(in_keys_num, 1))'.format(obj))
+        call.append('if {0}.statuses == NULL:'.format(obj))
+        call.append('    raise MemoryError()')
+        call.append('{0}.statuses_sz = in_keys_num'.format(obj))
+    call.append('{0}.reqid = f(self.client, {1}, {2});'.format(obj,
+                ', '.join(['in_' + n for p, n in sum([list(a.args) for a in x.args_in], [])]),
+                ', '.join([out_arg(obj, a, n) for a in x.args_out for p, n in a.args])))
+    if freed:
+        func += '    try:\n'
+        for arg in freed:
+            args = ', '.join(['&in_' + n for p, n in arg.args])
+            func += '        self.convert_{0}({2}.arena, {0}, {1});\n'.format(arg.__name__.lower(), args, obj)
+        func += ''.join(['        ' + line + '\n' for line in call])
+        func += '    finally:\n'
+        for arg in freed:
+            for p, n in arg.args:
+                if p.endswith('*'):
+                    func += '        free(in_' + n + ')\n'
+    else:
+        func += ''.join(['    ' + line + '\n' for line in call])
+    return func
+
+def generate_worker_asynccall(call, x):
+    typed_args = ', '.join([(PYTYPEOF(arg) + ' ' + arg_name(arg)).strip()
+                             for arg in x.args_in])
+    func  = 'cdef {0}(self, {2} f, {1}):\n'.format(call, typed_args, call + '_fptr')
+    func += '    cdef Deferred d = Deferred(self)\n'
+    func += generate_worker_body('d', x)
     func += '    if d.reqid < 0:\n'
     func += '        raise HyperDexClientException(d.status, hyperdex_client_error_message(self.client))\n'
     func += '    d.encode_return = hyperdex_python_client_deferred_encode_' + '_'.join([arg.__name__.lower() for arg in x.args_out]) + '\n'
@@ -128,20 +180,7 @@ def generate_worker_iterator(call, x):
                              for arg in x.args_in])
     func  = 'cdef {0}(self, {2} f, {1}):\n'.format(call, typed_args, call + '_fptr')
     func += '    cdef Iterator it = Iterator(self)\n'
-
-    for arg in x.args_in:
-        for p, n in arg.args:
-            if p.startswith('const '):
-                p = p[len('const '):]
-            if p.startswith('struct '):
-                p = p[len('struct '):]
-            func += '    cdef ' + p + ' in_' + n + '\n'
-    for arg in x.args_in:
-        args = ', '.join(['&in_' + n for p, n in arg.args])
-        func += '    self.convert_{0}(it.arena, {0}, {1});\n'.format(arg.__name__.lower(), args)
-
-    func += '    it.reqid = f(self.client, {0}, {1});\n'.format(', '.join(['in_' + n for p, n in sum([list(a.args) for a in x.args_in], [])]),
-                                                                 ', '.join(['&it.' + n for p, n in sum([list(a.args) for a in x.args_out], [])]))
+    func += generate_worker_body('it', x)
     func += '    if it.reqid < 0:\n'
     func += '        raise HyperDexClientException(it.status, hyperdex_client_error_message(self.client))\n'
     func += '    it.encode_return = hyperdex_python_client_iterator_encode_' + '_'.join([arg.__name__.lower() for arg in x.args_out]) + '\n'
@@ -190,9 +229,9 @@ def generate_method(x):
 if __name__ == '__main__':
     with open(os.path.join(BASE, 'bindings/python/hyperdex/client.pyx'), 'w') as fout:
         template = open(os.path.join(BASE, 'bindings/python/hyperdex/client.pyx.in')).read()
-        prototypes = indent('\n'.join([generate_prototype(c) for c in generator.Client]))
-        fps = '\n'.join(generate_function_pointer_typedefs(generator.Client))
+        prototypes = indent('\n'.join([generate_prototype(c) for c in Client]))
+        fps = '\n'.join(generate_function_pointer_typedefs(Client))
         fout.write(template.format(prototypes=prototypes, function_pointers=fps))
-        fout.write('\n'.join(generate_workers(generator.Client)))
+        fout.write('\n'.join(generate_workers(Client)))
         fout.write('\n')
-        fout.write('\n'.join([generate_method(c) for c in generator.Client]))
+        fout.write('\n'.join([generate_method(c) for c in Client]))
@@ -142,13 +142,17 @@ cdef extern from "hyperdex/client.h":
 
     hyperdex_client* hyperdex_client_create(char* coordinator, uint16_t port)
     void hyperdex_client_destroy(hyperdex_client* client)
+    void hyperdex_client_set_read_from_replicas(hyperdex_client* client, int enable)
     int64_t hyperdex_client_loop(hyperdex_client* client, int timeout, hyperdex_client_returncode* status)
     void hyperdex_client_destroy_attrs(hyperdex_client_attribute* attrs, size_t attrs_sz)
     char* hyperdex_client_error_message(hyperdex_client* client)
     char* hyperdex_client_error_location(hyperdex_client* client)
     char* hyperdex_client_returncode_to_string(hyperdex_client_returncode)
     int64_t hyperdex_client_get(hyperdex_client* client, char* space, char* key, size_t key_sz, hyperdex_client_returncode* status, hyperdex_client_attribute** attrs, size_t* attrs_sz)
+    int64_t hyperdex_client_get_partial(hyperdex_client* client, char* space, char* key, size_t key_sz, char** attrnames, size_t attrnames_sz, hyperdex_client_returncode* status, hyperdex_client_attribute** attrs, size_t* attrs_sz)
+    int64_t hyperdex_client_get_many(hyperdex_client* client, char* space, char** keys, size_t* keys_sz, size_t keys_num, hyperdex_client_returncode* status, hyperdex_client_attribute** attrs, size_t* attrs_sz)
     int64_t hyperdex_client_put(hyperdex_client* client, char* space, char* key, size_t key_sz, hyperdex_client_attribute* attrs, size_t attrs_sz, hyperdex_client_returncode* status)
+    int64_t hyperdex_client_put_many(hyperdex_client* client, char* space, char** keys, size_t* keys_sz, size_t keys_num, hyperdex_client_attribute* attrs, size_t* attrs_per_key, hyperdex_client_returncode* status, hyperdex_client_returncode* statuses)
     int64_t hyperdex_client_cond_put(hyperdex_client* client, char* space, char* key, size_t key_sz, hyperdex_client_attribute_check* checks, size_t checks_sz, hyperdex_client_attribute* attrs, size_t attrs_sz, hyperdex_client_returncode* status)
     int64_t hyperdex_client_put_if_not_exist(hyperdex_client* client, char* space, char* key, size_t key_sz, hyperdex_client_attribute* attrs, size_t attrs_sz, hyperdex_client_returncode* status)
     int64_t hyperdex_client_del(hyperdex_client* client, char* space, char* key, size_t key_sz, hyperdex_client_returncode* status)
@@ -210,8 +214,12 @@ cdef extern from "hyperdex/client.h":
     int64_t hyperdex_client_map_string_append(hyperdex_client* client, char* space, char* key, size_t key_sz, hyperdex_client_map_attribute* mapattrs, size_t mapattrs_sz, hyperdex_client_returncode* status)
     int64_t hyperdex_client_cond_map_string_append(hyperdex_client* client, char* space, char* key, size_t key_sz, hyperdex_client_attribute_check* checks, size_t checks_sz, hyperdex_client_map_attribute* mapattrs, size_t mapattrs_sz, hyperdex_client_returncode* status)
     int64_t hyperdex_client_search(hyperdex_client* client, char* space, hyperdex_client_attribute_check* checks, size_t checks_sz, hyperdex_client_returncode* status, hyperdex_client_attribute** attrs, size_t* attrs_sz)
+    int64_t hyperdex_client_search_partial(hyperdex_client* client, char* space, hyperdex_client_attribute_check* checks, size_t checks_sz, char** attrnames, size_t attrnames_sz, hyperdex_client_returncode* status, hyperdex_client_attribute** attrs, size_t* attrs_sz)
+    int64_t hyperdex_client_search_limit(hyperdex_client* client, char* space, hyperdex_client_attribute_check* checks, size_t checks_sz, uint64_t limit, hyperdex_client_returncode* status, hyperdex_client_attribute** attrs, size_t* attrs_sz)
     int64_t hyperdex_client_search_describe(hyperdex_client* client, char* space, hyperdex_client_attribute_check* checks, size_t checks_sz, hyperdex_client_returncode* status, char** description)
     int64_t hyperdex_client_sorted_search(hyperdex_client* client, char* space, hyperdex_client_attribute_check* checks, size_t checks_sz, char* sort_by, uint64_t limit, int maxmin, hyperdex_client_returncode* status, hyperdex_client_attribute** attrs, size_t* attrs_sz)
+    int64_t hyperdex_client_sorted_search_partial(hyperdex_client* client, char* space, hyperdex_client_attribute_check* checks, size_t checks_sz, char* sort_by, uint64_t limit, int maxmin, char** attrnames, size_t attrnames_sz, hyperdex_client_returncode* status, hyperdex_client_attribute** attrs, size_t* attrs_sz)
+    int64_t hyperdex_client_sorted_search_page(hyperdex_client* client, char* space, hyperdex_client_attribute_check* checks, size_t checks_sz, char* sort_by, uint64_t limit, int maxmin, char* cursor, size_t cursor_sz, hyperdex_client_returncode* status, hyperdex_client_attribute** attrs, size_t* attrs_sz, char** next_cursor, size_t* next_cursor_sz)
     int64_t hyperdex_client_group_del(hyperdex_client* client, char* space, hyperdex_client_attribute_check* checks, size_t checks_sz, hyperdex_client_returncode* status)
     int64_t hyperdex_client_count(hyperdex_client* client, char* space, hyperdex_client_attribute_check* checks, size_t checks_sz, hyperdex_client_returncode* status, uint64_t* count)
 
@@ -233,6 +241,7 @@ cdef extern from "hyperdex/datastructures.h":
     hyperdex_client_attribute* hyperdex_ds_allocate_attribute(hyperdex_ds_arena* arena, size_t sz)
     hyperdex_client_attribute_check* hyperdex_ds_allocate_attribute_check(hyperdex_ds_arena* arena, size_t sz)
     hyperdex_client_map_attribute* hyperdex_ds_allocate_map_attribute(hyperdex_ds_arena* arena, size_t sz)
+    size_t* hyperdex_ds_allocate_size_array(hyperdex_ds_arena* arena, size_t sz)
 
     int hyperdex_ds_unpack_int(char* buf, size_t buf_sz, int64_t* num)
     int hyperdex_ds_unpack_float(char* buf, size_t buf_sz, double* num)
@@ -288,15 +297,22 @@ cdef extern from "hyperdex/datastructures.h":
 ctypedef object (*encret_deferred_fptr)(Deferred d)
 ctypedef object (*encret_iterator_fptr)(Iterator it)
 ctypedef int64_t asynccall__spacename_key__status_attributes_fptr(hyperdex_client* client, char* space, char* key, size_t key_sz, hyperdex_client_returncode* status, hyperdex_client_attribute** attrs, size_t* attrs_sz)
+ctypedef int64_t asynccall__spacename_key_attributenames__status_attributes_fptr(hyperdex_client* client, char* space, char* key, size_t key_sz, char** attrnames, size_t attrnames_sz, hyperdex_client_returncode* status, hyperdex_client_attribute** attrs, size_t* attrs_sz)
+ctypedef int64_t iterator__spacename_keys__status_attributes_fptr(hyperdex_client* client, char* space, char** keys, size_t* keys_sz, size_t keys_num, hyperdex_client_returncode* status, hyperdex_client_attribute** attrs, size_t* attrs_sz)
 ctypedef int64_t asynccall__spacename_key_attributes__status_fptr(hyperdex_client* client, char* space, char* key, size_t key_sz, hyperdex_client_attribute* attrs, size_t attrs_sz, hyperdex_client_returncode* status)
+ctypedef int64_t asynccall__spacename_keys_keyattributes__status_statuses_fptr(hyperdex_client* client, char* space, char** keys, size_t* keys_sz, size_t keys_num, hyperdex_client_attribute* attrs, size_t* attrs_per_key, hyperdex_client_returncode* status, hyperdex_client_returncode* statuses)
 ctypedef int64_t asynccall__spacename_key_predicates_attributes__status_fptr(hyperdex_client* client, char* space, char* key, size_t key_sz, hyperdex_client_attribute_check* checks, size_t checks_sz, hyperdex_client_attribute* attrs, size_t attrs_sz, hyperdex_client_returncode* status)
 ctypedef int64_t asynccall__spacename_key__status_fptr(hyperdex_client* client, char* space, char* key, size_t key_sz, hyperdex_client_returncode* status)
 ctypedef int64_t asynccall__spacename_key_predicates__status_fptr(hyperdex_client* client, char* space, char* key, size_t key_sz, hyperdex_client_attribute_check* checks, size_t checks_sz, hyperdex_client_returncode* status)
 ctypedef int64_t asynccall__spacename_key_mapattributes__status_fptr(hyperdex_client* client, char* space, char* key, size_t key_sz, hyperdex_client_map_attribute* mapattrs, size_t mapattrs_sz, hyperdex_client_returncode* status)
 ctypedef int64_t asynccall__spacename_key_predicates_mapattributes__status_fptr(hyperdex_client* client, char* space, char* key, size_t key_sz, hyperdex_client_attribute_check* checks, size_t checks_sz, hyperdex_client_map_attribute* mapattrs, size_t mapattrs_sz, hyperdex_client_returncode* status)
 ctypedef int64_t iterator__spacename_predicates__status_attributes_fptr(hyperdex_client* client, char* space, hyperdex_client_attribute_check* checks, size_t checks_sz, hyperdex_client_returncode* status, hyperdex_client_attribute** attrs, size_t* attrs_sz)
+ctypedef int64_t iterator__spacename_predicates_attributenames__status_attributes_fptr(hyperdex_client* client, char* space, hyperdex_client_attribute_check* checks, size_t checks_sz, char** attrnames, size_t attrnames_sz, hyperdex_client_returncode* status, hyperdex_client_attribute** attrs, size_t* attrs_sz)
+ctypedef int64_t iterator__spacename_predicates_limit__status_attributes_fptr(hyperdex_client* client, char* space, hyperdex_client_attribute_check* checks, size_t checks_sz, uint64_t limit, hyperdex_client_returncode* status, hyperdex_client_attribute** attrs, size_t* attrs_sz)
 ctypedef int64_t asynccall__spacename_predicates__status_description_fptr(hyperdex_client* client, char* space, hyperdex_client_attribute_check* checks, size_t checks_sz, hyperdex_client_returncode* status, char** description)
 ctypedef int64_t iterator__spacename_predicates_sortby_limit_maxmin__status_attributes_fptr(hyperdex_client* client, char* space, hyperdex_client_attribute_check* checks, size_t checks_sz, char* sort_by, uint64_t limit, int maxmin, hyperdex_client_returncode* status, hyperdex_client_attribute** attrs, size_t* attrs_sz)
+ctypedef int64_t iterator__spacename_predicates_sortby_limit_maxmin_attributenames__status_attributes_fptr(hyperdex_client* client, char* space, hyperdex_client_attribute_check* checks, size_t checks_sz, char* sort_by, uint64_t limit, int maxmin, char** attrnames, size_t attrnames_sz, hyperdex_client_returncode* status, hyperdex_client_attribute** attrs, size_t* attrs_sz)
+ctypedef int64_t iterator__spacename_predicates_sortby_limit_maxmin_cursor__status_attributes_nextcursor_fptr(hyperdex_client* client, char* space, hyperdex_client_attribute_check* checks, size_t checks_sz, char* sort_by, uint64_t limit, int maxmin, char* cursor, size_t cursor_sz, hyperdex_client_returncode* status, hyperdex_client_attribute** attrs, size_t* attrs_sz, char** next_cursor, size_t* next_cursor_sz)
 ctypedef int64_t asynccall__spacename_predicates__status_fptr(hyperdex_client* client, char* space, hyperdex_client_attribute_check* checks, size_t checks_sz, hyperdex_client_returncode* status)
 ctypedef int64_t asynccall__spacename_predicates__status_count_fptr(hyperdex_client* client, char* space, hyperdex_client_attribute_check* checks, size_t checks_sz, hyperdex_client_returncode* status, uint64_t* count)
 
@@ -835,6 +851,19 @@ cdef hyperdex_python_client_deferred_encode_status_description(Deferred d):
     else:
         raise HyperDexClientException(d.status, hyperdex_client_error_message(d.client.client))
 
+# One entry per key, in the order the keys were given:  True if the key was
+# written, otherwise the exception that explains why it was not.
+cdef hyperdex_python_client_deferred_encode_status_statuses(Deferred d):
+    if d.status == HYPERDEX_CLIENT_SUCCESS:
+        return [True] * d.statuses_sz
+    ret = []
+    for i in range(d.statuses_sz):
+        if d.statuses[i] == HYPERDEX_CLIENT_SUCCESS:
+            ret.append(True)
+        else:
+            ret.append(HyperDexClientException(d.statuses[i], hyperdex_client_returncode_to_string(d.statuses[i])))
+    return ret
+
 cdef hyperdex_python_client_iterator_encode_status_attributes(Iterator it):
     if it.status == HYPERDEX_CLIENT_SUCCESS:
         return hyperdex_python_client_build_attributes(it.attrs, it.attrs_sz)
@@ -845,6 +874,19 @@ cdef hyperdex_python_client_iterator_encode_status_attributes(Iterator it):
     else:
         raise HyperDexClientException(it.status, hyperdex_client_error_message(it.client.client))
 
+# The cursor points into the search's own buffer and changes with every
+# object, so it is copied out alongside the object it names.
+cdef hyperdex_python_client_iterator_encode_status_attributes_nextcursor(Iterator it):
+    if it.status == HYPERDEX_CLIENT_SUCCESS:
+        return (hyperdex_python_client_build_attributes(it.attrs, it.attrs_sz),
+                it.next_cursor[:it.next_cursor_sz])
+    elif it.status == HYPERDEX_CLIENT_NOTFOUND:
+        return None
+    elif it.status == HYPERDEX_CLIENT_CMPFAIL:
+        return False
+    else:
+        raise HyperDexClientException(it.status, hyperdex_client_error_message(it.client.client))
+
 
 cdef class Predicate:
 
@@ -923,6 +965,8 @@ cdef class Deferred:
     cdef size_t attrs_sz
     cdef char* description
     cdef uint64_t count
+    cdef hyperdex_client_returncode* statuses
+    cdef size_t statuses_sz
     cdef bint finished
 
     def __cinit__(self, Client client):
@@ -936,6 +980,8 @@ cdef class Deferred:
         self.attrs_sz = 0
         self.description = NULL
         self.count = 0
+        self.statuses = NULL
+        self.statuses_sz = 0
         self.finished = False
 
     def __dealloc__(self):
@@ -947,6 +993,8 @@ cdef class Deferred:
             self.attrs_sz = 0
         if self.description:
             free(self.description)
+        if self.statuses:
+            free(self.statuses)
 
     def _callback(self):
         self.finished = True
@@ -967,6 +1015,8 @@ cdef class Iterator:
     cdef hyperdex_client_returncode status
     cdef hyperdex_client_attribute* attrs
     cdef size_t attrs_sz
+    cdef char* next_cursor
+    cdef size_t next_cursor_sz
     cdef list backlogged
     cdef bint finished
 
@@ -979,6 +1029,8 @@ cdef class Iterator:
         self.status = HYPERDEX_CLIENT_GARBAGE
         self.attrs = NULL
         self.attrs_sz = 0
+        self.next_cursor = NULL
+        self.next_cursor_sz = 0
         self.backlogged = []
         self.finished = False
 
@@ -1029,6 +1081,9 @@ cdef class Client:
         if self.client:
             hyperdex_client_destroy(self.client)
 
+    def set_read_from_replicas(self, enable):
+        hyperdex_client_set_read_from_replicas(self.client, 1 if enable else 0)
+
     cdef convert_spacename(self, hyperdex_ds_arena* arena, bytes spacename, char** spacename_str):
         spacename_str[0] = spacename
 
@@ -1049,6 +1104,25 @@ cdef class Client:
                                                 &_attrs[0][i].datatype)
         _attrs_sz[0] = len(attrs)
 
+    # One dict of attributes per key, flattened into a single array with the
+    # number of attributes for each key alongside it.
+    cdef convert_keyattributes(self, hyperdex_ds_arena* arena, list keyattrs,
+                               hyperdex_client_attribute** _attrs, size_t** _attrs_per_key):
+        _attrs_per_key[0] = hyperdex_ds_allocate_size_array(arena, max(len(keyattrs), 1))
+        _attrs[0] = hyperdex_ds_allocate_attribute(arena, max(sum([len(a) for a in keyattrs]), 1))
+        if _attrs_per_key[0] == NULL or _attrs[0] == NULL:
+            raise MemoryError()
+        i = 0
+        for k, attrs in enumerate(keyattrs):
+            _attrs_per_key[0][k] = len(attrs)
+            for name, value in attrs.iteritems():
+                _attrs[0][i].attr = name
+                hyperdex_python_client_convert_type(arena, value,
+                                                    &_attrs[0][i].value,
+                                                    &_attrs[0][i].value_sz,
+                                                    &_attrs[0][i].datatype)
+                i += 1
+
     cdef convert_predicate(self, attr, pred):
         if isinstance(pred, tuple) and len(pred) == 2 and \
            type(pred[0]) == type(pred[1]):
@@ -1113,6 +1187,36 @@ cdef class Client:
             raise ValueError("Comparison must be either 'max' or 'min'")
         maximize[0] = 1 if compare in ('max', 'maximize') else 0
 
+    # The client resolves the names before returning, so the array only needs
+    # to outlive the call; the caller frees it.
+    cdef convert_attributenames(self, hyperdex_ds_arena* arena, list attrnames, char*** names, size_t* names_sz):
+        names_sz[0] = len(attrnames)
+        names[0] = <char**>malloc(sizeof(char*) * max(len(attrnames), 1))
+        if names[0] == NULL:
+            raise MemoryError()
+        for i, name in enumerate(attrnames):
+            names[0][i] = name
+
+    # The keys themselves live in the arena; the two arrays that point at them
+    # only need to outlive the call and are freed by the caller.
+    cdef convert_keys(self, hyperdex_ds_arena* arena, list keys, char*** ks, size_t** ks_sz, size_t* ks_num):
+        ks_num[0] = len(keys)
+        ks[0] = <char**>malloc(sizeof(char*) * max(len(keys), 1))
+        ks_sz[0] = <size_t*>malloc(sizeof(size_t) * max(len(keys), 1))
+        if ks[0] == NULL or ks_sz[0] == NULL:
+            raise MemoryError()
+        for i, key in enumerate(keys):
+            self.convert_key(arena, key, &ks[0][i], &ks_sz[0][i])
+
+    # An empty cursor (or None) starts at the first page.
+    cdef convert_cursor(self, hyperdex_ds_arena* arena, bytes cursor, char** _cursor, size_t* _cursor_sz):
+        if cursor is None:
+            _cursor[0] = NULL
+            _cursor_sz[0] = 0
+        else:
+            _cursor[0] = cursor
+            _cursor_sz[0] = len(cursor)
+
     def loop(self):
         cdef hyperdex_client_returncode status
         ret = hyperdex_client_loop(self.client, -1, &status)
@@ -1139,6 +1243,45 @@ cdef class Client:
         self.ops[d.reqid] = d
         return d
 
+    cdef asynccall__spacename_key_attributenames__status_attributes(self, asynccall__spacename_key_attributenames__status_attributes_fptr f, bytes spacename, key, list attributenames):
+        cdef Deferred d = Deferred(self)
+        cdef char* in_space
+        cdef char* in_key
+        cdef size_t in_key_sz
+        cdef char** in_attrnames = NULL
+        cdef size_t in_attrnames_sz
+        self.convert_spacename(d.arena, spacename, &in_space);
+        self.convert_key(d.arena, key, &in_key, &in_key_sz);
+        try:
+            self.convert_attributenames(d.arena, attributenames, &in_attrnames, &in_attrnames_sz);
+            d.reqid = f(self.client, in_space, in_key, in_key_sz, in_attrnames, in_attrnames_sz, &d.status, &d.attrs, &d.attrs_sz);
+        finally:
+            free(in_attrnames)
+        if d.reqid < 0:
+            raise HyperDexClientException(d.status, hyperdex_client_error_message(self.client))
+        d.encode_return = hyperdex_python_client_deferred_encode_status_attributes
+        self.ops[d.reqid] = d
+        return d
+
+    cdef iterator__spacename_keys__status_attributes(self, iterator__spacename_keys__status_attributes_fptr f, bytes spacename, list keys):
+        cdef Iterator it = Iterator(self)
+        cdef char* in_space
+        cdef char** in_keys = NULL
+        cdef size_t* in_keys_sz = NULL
+        cdef size_t in_keys_num
+        self.convert_spacename(it.arena, spacename, &in_space);
+        try:
+            self.convert_keys(it.arena, keys, &in_keys, &in_keys_sz, &in_keys_num);
+            it.reqid = f(self.client, in_space, in_keys, in_keys_sz, in_keys_num, &it.status, &it.attrs, &it.attrs_sz);
+        finally:
+            free(in_keys)
+            free(in_keys_sz)
+        if it.reqid < 0:
+            raise HyperDexClientException(it.status, hyperdex_client_error_message(self.client))
+        it.encode_return = hyperdex_python_client_iterator_encode_status_attributes
+        self.ops[it.reqid] = it
+        return it
+
     cdef asynccall__spacename_key_attributes__status(self, asynccall__spacename_key_attributes__status_fptr f, bytes spacename, key, dict attributes):
         cdef Deferred d = Deferred(self)
         cdef char* in_space
@@ -1156,6 +1299,34 @@ cdef class Client:
         self.ops[d.reqid] = d
         return d
 
+    cdef asynccall__spacename_keys_keyattributes__status_statuses(self, asynccall__spacename_keys_keyattributes__status_statuses_fptr f, bytes spacename, list keys, list keyattributes):
+        cdef Deferred d = Deferred(self)
+        cdef char* in_space
+        cdef char** in_keys = NULL
+        cdef size_t* in_keys_sz = NULL
+        cdef size_t in_keys_num
+        cdef hyperdex_client_attribute* in_attrs
+        cdef size_t* in_attrs_per_key
+        if len(keys) != len(keyattributes):
+            raise ValueError("There must be one dict of attributes per key")
+        self.convert_spacename(d.arena, spacename, &in_space);
+        self.convert_keyattributes(d.arena, keyattributes, &in_attrs, &in_attrs_per_key);
+        try:
+            self.convert_keys(d.arena, keys, &in_keys, &in_keys_sz, &in_keys_num);
+            d.statuses = <hyperdex_client_returncode*>malloc(sizeof(hyperdex_client_returncode) * max(in_keys_num, 1))
+            if d.statuses == NULL:
+                raise MemoryError()
+            d.statuses_sz = in_keys_num
+            d.reqid = f(self.client, in_space, in_keys, in_keys_sz, in_keys_num, in_attrs, in_attrs_per_key, &d.status, d.statuses);
+        finally:
+            free(in_keys)
+            free(in_keys_sz)
+        if d.reqid < 0:
+            raise HyperDexClientException(d.status, hyperdex_client_error_message(self.client))
+        d.encode_return = hyperdex_python_client_deferred_encode_status_statuses
+        self.ops[d.reqid] = d
+        return d
+
     cdef asynccall__spacename_key_predicates_attributes__status(self, asynccall__spacename_key_predicates_attributes__status_fptr f, bytes spacename, key, dict predicates, dict attributes):
         cdef Deferred d = Deferred(self)
         cdef char* in_space
@@ -1258,6 +1429,42 @@ cdef class Client:
         self.ops[it.reqid] = it
         return it
 
+    cdef iterator__spacename_predicates_attributenames__status_attributes(self, iterator__spacename_predicates_attributenames__status_attributes_fptr f, bytes spacename, dict predicates, list attributenames):
+        cdef Iterator it = Iterator(self)
+        cdef char* in_space
+        cdef hyperdex_client_attribute_check* in_checks
+        cdef size_t in_checks_sz
+        cdef char** in_attrnames = NULL
+        cdef size_t in_attrnames_sz
+        self.convert_spacename(it.arena, spacename, &in_space);
+        self.convert_predicates(it.arena, predicates, &in_checks, &in_checks_sz);
+        try:
+            self.convert_attributenames(it.arena, attributenames, &in_attrnames, &in_attrnames_sz);
+            it.reqid = f(self.client, in_space, in_checks, in_checks_sz, in_attrnames, in_attrnames_sz, &it.status, &it.attrs, &it.attrs_sz);
+        finally:
+            free(in_attrnames)
+        if it.reqid < 0:
+            raise HyperDexClientException(it.status, hyperdex_client_error_message(self.client))
+        it.encode_return = hyperdex_python_client_iterator_encode_status_attributes
+        self.ops[it.reqid] = it
+        return it
+
+    cdef iterator__spacename_predicates_limit__status_attributes(self, iterator__spacename_predicates_limit__status_attributes_fptr f, bytes spacename, dict predicates, int limit):
+        cdef Iterator it = Iterator(self)
+        cdef char* in_space
+        cdef hyperdex_client_attribute_check* in_checks
+        cdef size_t in_checks_sz
+        cdef uint64_t in_limit
+        self.convert_spacename(it.arena, spacename, &in_space);
+        self.convert_predicates(it.arena, predicates, &in_checks, &in_checks_sz);
+        self.convert_limit(it.arena, limit, &in_limit);
+        it.reqid = f(self.client, in_space, in_checks, in_checks_sz, in_limit, &it.status, &it.attrs, &it.attrs_sz);
+        if it.reqid < 0:
+            raise HyperDexClientException(it.status, hyperdex_client_error_message(self.client))
+        it.encode_return = hyperdex_python_client_iterator_encode_status_attributes
+        self.ops[it.reqid] = it
+        return it
+
     cdef asynccall__spacename_predicates__status_description(self, asynccall__spacename_predicates__status_description_fptr f, bytes spacename, dict predicates):
         cdef Deferred d = Deferred(self)
         cdef char* in_space
@@ -1292,6 +1499,55 @@ cdef class Client:
         self.ops[it.reqid] = it
         return it
 
+    cdef iterator__spacename_predicates_sortby_limit_maxmin_attributenames__status_attributes(self, iterator__spacename_predicates_sortby_limit_maxmin_attributenames__status_attributes_fptr f, bytes spacename, dict predicates, bytes sortby, int limit, str maxmin, list attributenames):
+        cdef Iterator it = Iterator(self)
+        cdef char* in_space
+        cdef hyperdex_client_attribute_check* in_checks
+        cdef size_t in_checks_sz
+        cdef char* in_sort_by
+        cdef uint64_t in_limit
+        cdef int in_maxmin
+        cdef char** in_attrnames = NULL
+        cdef size_t in_attrnames_sz
+        self.convert_spacename(it.arena, spacename, &in_space);
+        self.convert_predicates(it.arena, predicates, &in_checks, &in_checks_sz);
+        self.convert_sortby(it.arena, sortby, &in_sort_by);
+        self.convert_limit(it.arena, limit, &in_limit);
+        self.convert_maxmin(it.arena, maxmin, &in_maxmin);
+        try:
+            self.convert_attributenames(it.arena, attributenames, &in_attrnames, &in_attrnames_sz);
+            it.reqid = f(self.client, in_space, in_checks, in_checks_sz, in_sort_by, in_limit, in_maxmin, in_attrnames, in_attrnames_sz, &it.status, &it.attrs, &it.attrs_sz);
+        finally:
+            free(in_attrnames)
+        if it.reqid < 0:
+            raise HyperDexClientException(it.status, hyperdex_client_error_message(self.client))
+        it.encode_return = hyperdex_python_client_iterator_encode_status_attributes
+        self.ops[it.reqid] = it
+        return it
+
+    cdef iterator__spacename_predicates_sortby_limit_maxmin_cursor__status_attributes_nextcursor(self, iterator__spacename_predicates_sortby_limit_maxmin_cursor__status_attributes_nextcursor_fptr f, bytes spacename, dict predicates, bytes sortby, int limit, str maxmin, bytes cursor):
+        cdef Iterator it = Iterator(self)
+        cdef char* in_space
+        cdef hyperdex_client_attribute_check* in_checks
+        cdef size_t in_checks_sz
+        cdef char* in_sort_by
+        cdef uint64_t in_limit
+        cdef int in_maxmin
+        cdef char* in_cursor
+        cdef size_t in_cursor_sz
+        self.convert_spacename(it.arena, spacename, &in_space);
+        self.convert_predicates(it.arena, predicates, &in_checks, &in_checks_sz);
+        self.convert_sortby(it.arena, sortby, &in_sort_by);
+        self.convert_limit(it.arena, limit, &in_limit);
+        self.convert_maxmin(it.arena, maxmin, &in_maxmin);
+        self.convert_cursor(it.arena, cursor, &in_cursor, &in_cursor_sz);
+        it.reqid = f(self.client, in_space, in_checks, in_checks_sz, in_sort_by, in_limit, in_maxmin, in_cursor, in_cursor_sz, &it.status, &it.attrs, &it.attrs_sz, &it.next_cursor, &it.next_cursor_sz);
+        if it.reqid < 0:
+            raise HyperDexClientException(it.status, hyperdex_client_error_message(self.client))
+        it.encode_return = hyperdex_python_client_iterator_encode_status_attributes_nextcursor
+        self.ops[it.reqid] = it
+        return it
+
     cdef asynccall__spacename_predicates__status(self, asynccall__spacename_predicates__status_fptr f, bytes spacename, dict predicates):
         cdef Deferred d = Deferred(self)
         cdef char* in_space
@@ -1325,11 +1581,24 @@ cdef class Client:
     def get(self, bytes spacename, key):
         return self.async_get(spacename, key).wait()
 
+    def async_get_partial(self, bytes spacename, key, list attributenames):
+        return self.asynccall__spacename_key_attributenames__status_attributes(hyperdex_client_get_partial, spacename, key, attributenames)
+    def get_partial(self, bytes spacename, key, list attributenames):
+        return self.async_get_partial(spacename, key, attributenames).wait()
+
+    def get_many(self, bytes spacename, list keys):
+        return self.iterator__spacename_keys__status_attributes(hyperdex_client_get_many, spacename, keys)
+
     def async_put(self, bytes spacename, key, dict attributes):
         return self.asynccall__spacename_key_attributes__status(hyperdex_client_put, spacename, key, attributes)
     def put(self, bytes spacename, key, dict attributes):
         return self.async_put(spacename, key, attributes).wait()
 
+    def async_put_many(self, bytes spacename, list keys, list keyattributes):
+        return self.asynccall__spacename_keys_keyattributes__status_statuses(hyperdex_client_put_many, spacename, keys, keyattributes)
+    def put_many(self, bytes spacename, list keys, list keyattributes):
+        return self.async_put_many(spacename, keys, keyattributes).wait()
+
     def async_cond_put(self, bytes spacename, key, dict predicates, dict attributes):
         return self.asynccall__spacename_key_predicates_attributes__status(hyperdex_client_cond_put, spacename, key, predicates, attributes)
     def cond_put(self, bytes spacename, key, dict predicates, dict attributes):
@@ -1633,6 +1902,12 @@ cdef class Client:
     def search(self, bytes spacename, dict predicates):
         return self.iterator__spacename_predicates__status_attributes(hyperdex_client_search, spacename, predicates)
 
+    def search_partial(self, bytes spacename, dict predicates, list attributenames):
+        return self.iterator__spacename_predicates_attributenames__status_attributes(hyperdex_client_search_partial, spacename, predicates, attributenames)
+
+    def search_limit(self, bytes spacename, dict predicates, int limit):
+        return self.iterator__spacename_predicates_limit__status_attributes(hyperdex_client_search_limit, spacename, predicates, limit)
+
     def async_search_describe(self, bytes spacename, dict predicates):
         return self.asynccall__spacename_predicates__status_description(hyperdex_client_search_describe, spacename, predicates)
     def search_describe(self, bytes spacename, dict predicates):
@@ -1641,6 +1916,12 @@ cdef class Client:
     def sorted_search(self, bytes spacename, dict predicates, bytes sortby, int limit, str maxmin):
         return self.iterator__spacename_predicates_sortby_limit_maxmin__status_attributes(hyperdex_client_sorted_search, spacename, predicates, sortby, limit, maxmin)
 
+    def sorted_search_partial(self, bytes spacename, dict predicates, bytes sortby, int limit, str maxmin, list attributenames):
+        return self.iterator__spacename_predicates_sortby_limit_maxmin_attributenames__status_attributes(hyperdex_client_sorted_search_partial, spacename, predicates, sortby, limit, maxmin, attributenames)
+
+    def sorted_search_page(self, bytes spacename, dict predicates, bytes sortby, int limit, str maxmin, bytes cursor):
+        return self.iterator__spacename_predicates_sortby_limit_maxmin_cursor__status_attributes_nextcursor(hyperdex_client_sorted_search_page, spacename, predicates, sortby, limit, maxmin, cursor)
+
     def async_group_del(self, bytes spacename, dict predicates):
         return self.asynccall__spacename_predicates__status(hyperdex_client_group_del, spacename, predicates)
     def group_del(self, bytes spacename, dict predicates):
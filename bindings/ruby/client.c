@@ -439,6 +439,77 @@ hyperdex_ruby_client_convert_key(struct hyperdex_ds_arena* arena,
     hyperdex_ruby_client_convert_type(arena, x, key, key_sz, &datatype);
 }
 
+static void
+hyperdex_ruby_client_convert_keys(struct hyperdex_ds_arena* arena,
+                                  VALUE x,
+                                  const char*** _keys,
+                                  const size_t** _keys_sz,
+                                  size_t* _keys_num)
+{
+    const char** keys;
+    size_t* keys_sz;
+    size_t keys_num;
+    enum hyperdatatype datatype;
+    ssize_t i;
+
+    if (TYPE(x) != T_ARRAY)
+    {
+        rb_exc_raise(rb_exc_new2(rb_eTypeError, "Keys must be specified as an array"));
+        abort(); /* unreachable? */
+    }
+
+    keys_num = RARRAY_LEN(x);
+    keys = hyperdex_ds_allocate_string_array(arena, keys_num);
+    keys_sz = hyperdex_ds_allocate_size_array(arena, keys_num);
+
+    if (!keys || !keys_sz)
+    {
+        hyperdex_ruby_out_of_memory();
+    }
+
+    *_keys = keys;
+    *_keys_sz = keys_sz;
+    *_keys_num = keys_num;
+
+    for (i = 0; i < RARRAY_LEN(x); ++i)
+    {
+        hyperdex_ruby_client_convert_type(arena, rb_ary_entry(x, i), &keys[i], &keys_sz[i], &datatype);
+    }
+}
+
+static void
+hyperdex_ruby_client_convert_attributenames(struct hyperdex_ds_arena* arena,
+                                            VALUE x,
+                                            const char*** _attrnames,
+                                            size_t* _attrnames_sz)
+{
+    const char** attrnames;
+    size_t attrnames_sz;
+    ssize_t i;
+
+    if (TYPE(x) != T_ARRAY)
+    {
+        rb_exc_raise(rb_exc_new2(rb_eTypeError, "Attribute names must be specified as an array"));
+        abort(); /* unreachable? */
+    }
+
+    attrnames_sz = RARRAY_LEN(x);
+    attrnames = hyperdex_ds_allocate_string_array(arena, attrnames_sz);
+
+    if (!attrnames)
+    {
+        hyperdex_ruby_out_of_memory();
+    }
+
+    *_attrnames = attrnames;
+    *_attrnames_sz = attrnames_sz;
+
+    for (i = 0; i < RARRAY_LEN(x); ++i)
+    {
+        attrnames[i] = hyperdex_ruby_client_convert_cstring(rb_ary_entry(x, i), "Attribute name must be a string or symbol");
+    }
+}
+
 static void
 hyperdex_ruby_client_convert_limit(struct hyperdex_ds_arena* arena,
                                    VALUE x,
@@ -55,6 +55,66 @@ hyperdex_ruby_client_asynccall__spacename_key__status_attributes(int64_t (*f)(st
     return op;
 }
 
+static VALUE
+hyperdex_ruby_client_asynccall__spacename_key_attributenames__status_attributes(int64_t (*f)(struct hyperdex_client* client, const char* space, const char* key, size_t key_sz, const char** attrnames, size_t attrnames_sz, enum hyperdex_client_returncode* status, const struct hyperdex_client_attribute** attrs, size_t* attrs_sz), VALUE self, VALUE spacename, VALUE key, VALUE attributenames)
+{
+    VALUE op;
+    const char* in_space;
+    const char* in_key;
+    size_t in_key_sz;
+    const char** in_attrnames;
+    size_t in_attrnames_sz;
+    struct hyperdex_client* client;
+    struct hyperdex_ruby_client_deferred* o;
+    op = rb_class_new_instance(1, &self, class_deferred);
+    rb_iv_set(self, "tmp", op);
+    Data_Get_Struct(self, struct hyperdex_client, client);
+    Data_Get_Struct(op, struct hyperdex_ruby_client_deferred, o);
+    hyperdex_ruby_client_convert_spacename(o->arena, spacename, &in_space);
+    hyperdex_ruby_client_convert_key(o->arena, key, &in_key, &in_key_sz);
+    hyperdex_ruby_client_convert_attributenames(o->arena, attributenames, &in_attrnames, &in_attrnames_sz);
+    o->reqid = f(client, in_space, in_key, in_key_sz, in_attrnames, in_attrnames_sz, &o->status, &o->attrs, &o->attrs_sz);
+
+    if (o->reqid < 0)
+    {
+        hyperdex_ruby_client_throw_exception(o->status, hyperdex_client_error_message(client));
+    }
+
+    o->encode_return = hyperdex_ruby_client_deferred_encode_status_attributes;
+    rb_hash_aset(rb_iv_get(self, "ops"), LONG2NUM(o->reqid), op);
+    rb_iv_set(self, "tmp", Qnil);
+    return op;
+}
+
+static VALUE
+hyperdex_ruby_client_iterator__spacename_keys__status_attributes(int64_t (*f)(struct hyperdex_client* client, const char* space, const char** keys, const size_t* keys_sz, size_t keys_num, enum hyperdex_client_returncode* status, const struct hyperdex_client_attribute** attrs, size_t* attrs_sz), VALUE self, VALUE spacename, VALUE keys)
+{
+    VALUE op;
+    const char* in_space;
+    const char** in_keys;
+    const size_t* in_keys_sz;
+    size_t in_keys_num;
+    struct hyperdex_client* client;
+    struct hyperdex_ruby_client_iterator* o;
+    op = rb_class_new_instance(1, &self, class_iterator);
+    rb_iv_set(self, "tmp", op);
+    Data_Get_Struct(self, struct hyperdex_client, client);
+    Data_Get_Struct(op, struct hyperdex_ruby_client_iterator, o);
+    hyperdex_ruby_client_convert_spacename(o->arena, spacename, &in_space);
+    hyperdex_ruby_client_convert_keys(o->arena, keys, &in_keys, &in_keys_sz, &in_keys_num);
+    o->reqid = f(client, in_space, in_keys, in_keys_sz, in_keys_num, &o->status, &o->attrs, &o->attrs_sz);
+
+    if (o->reqid < 0)
+    {
+        hyperdex_ruby_client_throw_exception(o->status, hyperdex_client_error_message(client));
+    }
+
+    o->encode_return = hyperdex_ruby_client_iterator_encode_status_attributes;
+    rb_hash_aset(rb_iv_get(self, "ops"), LONG2NUM(o->reqid), op);
+    rb_iv_set(self, "tmp", Qnil);
+    return op;
+}
+
 static VALUE
 hyperdex_ruby_client_asynccall__spacename_key_attributes__status(int64_t (*f)(struct hyperdex_client* client, const char* space, const char* key, size_t key_sz, const struct hyperdex_client_attribute* attrs, size_t attrs_sz, enum hyperdex_client_returncode* status), VALUE self, VALUE spacename, VALUE key, VALUE attributes)
 {
@@ -272,6 +332,67 @@ hyperdex_ruby_client_iterator__spacename_predicates__status_attributes(int64_t (
     return op;
 }
 
+static VALUE
+hyperdex_ruby_client_iterator__spacename_predicates_attributenames__status_attributes(int64_t (*f)(struct hyperdex_client* client, const char* space, const struct hyperdex_client_attribute_check* checks, size_t checks_sz, const char** attrnames, size_t attrnames_sz, enum hyperdex_client_returncode* status, const struct hyperdex_client_attribute** attrs, size_t* attrs_sz), VALUE self, VALUE spacename, VALUE predicates, VALUE attributenames)
+{
+    VALUE op;
+    const char* in_space;
+    const struct hyperdex_client_attribute_check* in_checks;
+    size_t in_checks_sz;
+    const char** in_attrnames;
+    size_t in_attrnames_sz;
+    struct hyperdex_client* client;
+    struct hyperdex_ruby_client_iterator* o;
+    op = rb_class_new_instance(1, &self, class_iterator);
+    rb_iv_set(self, "tmp", op);
+    Data_Get_Struct(self, struct hyperdex_client, client);
+    Data_Get_Struct(op, struct hyperdex_ruby_client_iterator, o);
+    hyperdex_ruby_client_convert_spacename(o->arena, spacename, &in_space);
+    hyperdex_ruby_client_convert_predicates(o->arena, predicates, &in_checks, &in_checks_sz);
+    hyperdex_ruby_client_convert_attributenames(o->arena, attributenames, &in_attrnames, &in_attrnames_sz);
+    o->reqid = f(client, in_space, in_checks, in_checks_sz, in_attrnames, in_attrnames_sz, &o->status, &o->attrs, &o->attrs_sz);
+
+    if (o->reqid < 0)
+    {
+        hyperdex_ruby_client_throw_exception(o->status, hyperdex_client_error_message(client));
+    }
+
+    o->encode_return = hyperdex_ruby_client_iterator_encode_status_attributes;
+    rb_hash_aset(rb_iv_get(self, "ops"), LONG2NUM(o->reqid), op);
+    rb_iv_set(self, "tmp", Qnil);
+    return op;
+}
+
+static VALUE
+hyperdex_ruby_client_iterator__spacename_predicates_limit__status_attributes(int64_t (*f)(struct hyperdex_client* client, const char* space, const struct hyperdex_client_attribute_check* checks, size_t checks_sz, uint64_t limit, enum hyperdex_client_returncode* status, const struct hyperdex_client_attribute** attrs, size_t* attrs_sz), VALUE self, VALUE spacename, VALUE predicates, VALUE limit)
+{
+    VALUE op;
+    const char* in_space;
+    const struct hyperdex_client_attribute_check* in_checks;
+    size_t in_checks_sz;
+    uint64_t in_limit;
+    struct hyperdex_client* client;
+    struct hyperdex_ruby_client_iterator* o;
+    op = rb_class_new_instance(1, &self, class_iterator);
+    rb_iv_set(self, "tmp", op);
+    Data_Get_Struct(self, struct hyperdex_client, client);
+    Data_Get_Struct(op, struct hyperdex_ruby_client_iterator, o);
+    hyperdex_ruby_client_convert_spacename(o->arena, spacename, &in_space);
+    hyperdex_ruby_client_convert_predicates(o->arena, predicates, &in_checks, &in_checks_sz);
+    hyperdex_ruby_client_convert_limit(o->arena, limit, &in_limit);
+    o->reqid = f(client, in_space, in_checks, in_checks_sz, in_limit, &o->status, &o->attrs, &o->attrs_sz);
+
+    if (o->reqid < 0)
+    {
+        hyperdex_ruby_client_throw_exception(o->status, hyperdex_client_error_message(client));
+    }
+
+    o->encode_return = hyperdex_ruby_client_iterator_encode_status_attributes;
+    rb_hash_aset(rb_iv_get(self, "ops"), LONG2NUM(o->reqid), op);
+    rb_iv_set(self, "tmp", Qnil);
+    return op;
+}
+
 static VALUE
 hyperdex_ruby_client_asynccall__spacename_predicates__status_description(int64_t (*f)(struct hyperdex_client* client, const char* space, const struct hyperdex_client_attribute_check* checks, size_t checks_sz, enum hyperdex_client_returncode* status, const char** description), VALUE self, VALUE spacename, VALUE predicates)
 {
@@ -334,6 +455,43 @@ hyperdex_ruby_client_iterator__spacename_predicates_sortby_limit_maxmin__status_
     return op;
 }
 
+static VALUE
+hyperdex_ruby_client_iterator__spacename_predicates_sortby_limit_maxmin_attributenames__status_attributes(int64_t (*f)(struct hyperdex_client* client, const char* space, const struct hyperdex_client_attribute_check* checks, size_t checks_sz, const char* sort_by, uint64_t limit, int maxmin, const char** attrnames, size_t attrnames_sz, enum hyperdex_client_returncode* status, const struct hyperdex_client_attribute** attrs, size_t* attrs_sz), VALUE self, VALUE spacename, VALUE predicates, VALUE sortby, VALUE limit, VALUE maxmin, VALUE attributenames)
+{
+    VALUE op;
+    const char* in_space;
+    const struct hyperdex_client_attribute_check* in_checks;
+    size_t in_checks_sz;
+    const char* in_sort_by;
+    uint64_t in_limit;
+    int in_maxmin;
+    const char** in_attrnames;
+    size_t in_attrnames_sz;
+    struct hyperdex_client* client;
+    struct hyperdex_ruby_client_iterator* o;
+    op = rb_class_new_instance(1, &self, class_iterator);
+    rb_iv_set(self, "tmp", op);
+    Data_Get_Struct(self, struct hyperdex_client, client);
+    Data_Get_Struct(op, struct hyperdex_ruby_client_iterator, o);
+    hyperdex_ruby_client_convert_spacename(o->arena, spacename, &in_space);
+    hyperdex_ruby_client_convert_predicates(o->arena, predicates, &in_checks, &in_checks_sz);
+    hyperdex_ruby_client_convert_sortby(o->arena, sortby, &in_sort_by);
+    hyperdex_ruby_client_convert_limit(o->arena, limit, &in_limit);
+    hyperdex_ruby_client_convert_maxmin(o->arena, maxmin, &in_maxmin);
+    hyperdex_ruby_client_convert_attributenames(o->arena, attributenames, &in_attrnames, &in_attrnames_sz);
+    o->reqid = f(client, in_space, in_checks, in_checks_sz, in_sort_by, in_limit, in_maxmin, in_attrnames, in_attrnames_sz, &o->status, &o->attrs, &o->attrs_sz);
+
+    if (o->reqid < 0)
+    {
+        hyperdex_ruby_client_throw_exception(o->status, hyperdex_client_error_message(client));
+    }
+
+    o->encode_return = hyperdex_ruby_client_iterator_encode_status_attributes;
+    rb_hash_aset(rb_iv_get(self, "ops"), LONG2NUM(o->reqid), op);
+    rb_iv_set(self, "tmp", Qnil);
+    return op;
+}
+
 static VALUE
 hyperdex_ruby_client_asynccall__spacename_predicates__status(int64_t (*f)(struct hyperdex_client* client, const char* space, const struct hyperdex_client_attribute_check* checks, size_t checks_sz, enum hyperdex_client_returncode* status), VALUE self, VALUE spacename, VALUE predicates)
 {
@@ -401,6 +559,24 @@ hyperdex_ruby_client_wait_get(VALUE self, VALUE spacename, VALUE key)
     return rb_funcall(deferred, rb_intern("wait"), 0);
 }
 
+static VALUE
+hyperdex_ruby_client_get_partial(VALUE self, VALUE spacename, VALUE key, VALUE attributenames)
+{
+    return hyperdex_ruby_client_asynccall__spacename_key_attributenames__status_attributes(hyperdex_client_get_partial, self, spacename, key, attributenames);
+}
+VALUE
+hyperdex_ruby_client_wait_get_partial(VALUE self, VALUE spacename, VALUE key, VALUE attributenames)
+{
+    VALUE deferred = hyperdex_ruby_client_get_partial(self, spacename, key, attributenames);
+    return rb_funcall(deferred, rb_intern("wait"), 0);
+}
+
+static VALUE
+hyperdex_ruby_client_get_many(VALUE self, VALUE spacename, VALUE keys)
+{
+    return hyperdex_ruby_client_iterator__spacename_keys__status_attributes(hyperdex_client_get_many, self, spacename, keys);
+}
+
 static VALUE
 hyperdex_ruby_client_put(VALUE self, VALUE spacename, VALUE key, VALUE attributes)
 {
@@ -1139,6 +1315,18 @@ hyperdex_ruby_client_search(VALUE self, VALUE spacename, VALUE predicates)
     return hyperdex_ruby_client_iterator__spacename_predicates__status_attributes(hyperdex_client_search, self, spacename, predicates);
 }
 
+static VALUE
+hyperdex_ruby_client_search_partial(VALUE self, VALUE spacename, VALUE predicates, VALUE attributenames)
+{
+    return hyperdex_ruby_client_iterator__spacename_predicates_attributenames__status_attributes(hyperdex_client_search_partial, self, spacename, predicates, attributenames);
+}
+
+static VALUE
+hyperdex_ruby_client_search_limit(VALUE self, VALUE spacename, VALUE predicates, VALUE limit)
+{
+    return hyperdex_ruby_client_iterator__spacename_predicates_limit__status_attributes(hyperdex_client_search_limit, self, spacename, predicates, limit);
+}
+
 static VALUE
 hyperdex_ruby_client_search_describe(VALUE self, VALUE spacename, VALUE predicates)
 {
@@ -1157,6 +1345,12 @@ hyperdex_ruby_client_sorted_search(VALUE self, VALUE spacename, VALUE predicates
     return hyperdex_ruby_client_iterator__spacename_predicates_sortby_limit_maxmin__status_attributes(hyperdex_client_sorted_search, self, spacename, predicates, sortby, limit, maxmin);
 }
 
+static VALUE
+hyperdex_ruby_client_sorted_search_partial(VALUE self, VALUE spacename, VALUE predicates, VALUE sortby, VALUE limit, VALUE maxmin, VALUE attributenames)
+{
+    return hyperdex_ruby_client_iterator__spacename_predicates_sortby_limit_maxmin_attributenames__status_attributes(hyperdex_client_sorted_search_partial, self, spacename, predicates, sortby, limit, maxmin, attributenames);
+}
+
 static VALUE
 hyperdex_ruby_client_group_del(VALUE self, VALUE spacename, VALUE predicates)
 {
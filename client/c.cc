@@ -124,6 +124,13 @@ hyperdex_client_destroy(hyperdex_client* client)
     delete reinterpret_cast<hyperdex::client*>(client);
 }
 
+HYPERDEX_API void
+hyperdex_client_set_read_from_replicas(hyperdex_client* _cl, int enable)
+{
+    hyperdex::client* cl = reinterpret_cast<hyperdex::client*>(_cl);
+    cl->set_read_from_replicas(enable != 0);
+}
+
 HYPERDEX_API const char*
 hyperdex_client_error_message(hyperdex_client* _cl)
 {
@@ -232,6 +239,31 @@ hyperdex_client_get(hyperdex_client* _cl,
     );
 }
 
+HYPERDEX_API int64_t
+hyperdex_client_get_partial(hyperdex_client* _cl,
+                            const char* space,
+                            const char* key, size_t key_sz,
+                            const char** attrnames, size_t attrnames_sz,
+                            hyperdex_client_returncode* status,
+                            const hyperdex_client_attribute** attrs, size_t* attrs_sz)
+{
+    C_WRAP_EXCEPT(
+    return cl->get_partial(space, key, key_sz, attrnames, attrnames_sz, status, attrs, attrs_sz);
+    );
+}
+
+HYPERDEX_API int64_t
+hyperdex_client_get_many(hyperdex_client* _cl,
+                         const char* space,
+                         const char** keys, const size_t* keys_sz, size_t keys_num,
+                         hyperdex_client_returncode* status,
+                         const hyperdex_client_attribute** attrs, size_t* attrs_sz)
+{
+    C_WRAP_EXCEPT(
+    return cl->get_many(space, keys, keys_sz, keys_num, status, attrs, attrs_sz);
+    );
+}
+
 HYPERDEX_API int64_t
 hyperdex_client_put(hyperdex_client* _cl,
                     const char* space,
@@ -246,6 +278,19 @@ hyperdex_client_put(hyperdex_client* _cl,
     );
 }
 
+HYPERDEX_API int64_t
+hyperdex_client_put_many(hyperdex_client* _cl,
+                         const char* space,
+                         const char** keys, const size_t* keys_sz, size_t keys_num,
+                         const hyperdex_client_attribute* attrs, const size_t* attrs_per_key,
+                         hyperdex_client_returncode* status,
+                         hyperdex_client_returncode* statuses)
+{
+    C_WRAP_EXCEPT(
+    return cl->put_many(space, keys, keys_sz, keys_num, attrs, attrs_per_key, status, statuses);
+    );
+}
+
 HYPERDEX_API int64_t
 hyperdex_client_cond_put(hyperdex_client* _cl,
                          const char* space,
@@ -1126,6 +1171,32 @@ hyperdex_client_search(hyperdex_client* _cl,
     );
 }
 
+HYPERDEX_API int64_t
+hyperdex_client_search_partial(hyperdex_client* _cl,
+                               const char* space,
+                               const hyperdex_client_attribute_check* checks, size_t checks_sz,
+                               const char** attrnames, size_t attrnames_sz,
+                               hyperdex_client_returncode* status,
+                               const hyperdex_client_attribute** attrs, size_t* attrs_sz)
+{
+    C_WRAP_EXCEPT(
+    return cl->search_partial(space, checks, checks_sz, attrnames, attrnames_sz, status, attrs, attrs_sz);
+    );
+}
+
+HYPERDEX_API int64_t
+hyperdex_client_search_limit(hyperdex_client* _cl,
+                             const char* space,
+                             const hyperdex_client_attribute_check* checks, size_t checks_sz,
+                             uint64_t limit,
+                             hyperdex_client_returncode* status,
+                             const hyperdex_client_attribute** attrs, size_t* attrs_sz)
+{
+    C_WRAP_EXCEPT(
+    return cl->search_limit(space, checks, checks_sz, limit, status, attrs, attrs_sz);
+    );
+}
+
 HYPERDEX_API int64_t
 hyperdex_client_search_describe(hyperdex_client* _cl,
                                 const char* space,
@@ -1153,6 +1224,39 @@ hyperdex_client_sorted_search(hyperdex_client* _cl,
     );
 }
 
+HYPERDEX_API int64_t
+hyperdex_client_sorted_search_partial(hyperdex_client* _cl,
+                                      const char* space,
+                                      const hyperdex_client_attribute_check* checks, size_t checks_sz,
+                                      const char* sort_by,
+                                      uint64_t limit,
+                                      int maxmin,
+                                      const char** attrnames, size_t attrnames_sz,
+                                      hyperdex_client_returncode* status,
+                                      const hyperdex_client_attribute** attrs, size_t* attrs_sz)
+{
+    C_WRAP_EXCEPT(
+    return cl->sorted_search_partial(space, checks, checks_sz, sort_by, limit, maxmin, attrnames, attrnames_sz, status, attrs, attrs_sz);
+    );
+}
+
+HYPERDEX_API int64_t
+hyperdex_client_sorted_search_page(hyperdex_client* _cl,
+                                   const char* space,
+                                   const hyperdex_client_attribute_check* checks, size_t checks_sz,
+                                   const char* sort_by,
+                                   uint64_t limit,
+                                   int maxmin,
+                                   const char* cursor, size_t cursor_sz,
+                                   hyperdex_client_returncode* status,
+                                   const hyperdex_client_attribute** attrs, size_t* attrs_sz,
+                                   const char** next_cursor, size_t* next_cursor_sz)
+{
+    C_WRAP_EXCEPT(
+    return cl->sorted_search_page(space, checks, checks_sz, sort_by, limit, maxmin, cursor, cursor_sz, status, attrs, attrs_sz, next_cursor, next_cursor_sz);
+    );
+}
+
 HYPERDEX_API int64_t
 hyperdex_client_group_del(hyperdex_client* _cl,
                           const char* space,
@@ -48,10 +48,13 @@
 #include "client/pending_atomic.h"
 #include "client/pending_count.h"
 #include "client/pending_get.h"
+#include "client/pending_get_many.h"
 #include "client/pending_group_del.h"
+#include "client/pending_put_many.h"
 #include "client/pending_search.h"
 #include "client/pending_search_describe.h"
 #include "client/pending_sorted_search.h"
+#include "client/util.h"
 
 #define ERROR(CODE) \
     *status = HYPERDEX_CLIENT_ ## CODE; \
@@ -83,6 +86,8 @@ client :: client(const char* coordinator, uint16_t port)
     , m_yielding()
     , m_yielded()
     , m_last_error()
+    , m_read_from_replicas(false)
+    , m_next_replica(0)
 {
 }
 
@@ -123,7 +128,306 @@ client :: get(const char* space, const char* _key, size_t _key_sz,
     size_t sz = HYPERDEX_CLIENT_HEADER_SIZE_REQ + sizeof(uint32_t) + key.size();
     std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
     msg->pack_at(HYPERDEX_CLIENT_HEADER_SIZE_REQ) << key;
-    return send_keyop(space, key, REQ_GET, msg, op, status);
+    return send_readop(space, key, REQ_GET, msg, op, status);
+}
+
+int64_t
+client :: get_partial(const char* space, const char* _key, size_t _key_sz,
+                      const char** attrnames, size_t attrnames_sz,
+                      hyperdex_client_returncode* status,
+                      const hyperdex_client_attribute** attrs, size_t* attrs_sz)
+{
+    if (!maintain_coord_connection(status))
+    {
+        return -1;
+    }
+
+    const schema* sc = m_coord.config()->get_schema(space);
+
+    if (!sc)
+    {
+        ERROR(UNKNOWNSPACE) << "space \"" << e::strescape(space) << "\" does not exist";
+        return -1;
+    }
+
+    datatype_info* di = datatype_info::lookup(sc->attrs[0].type);
+    assert(di);
+    e::slice key(_key, _key_sz);
+
+    if (!di->validate(key))
+    {
+        ERROR(WRONGTYPE) << "key must be type " << sc->attrs[0].type;
+        return -1;
+    }
+
+    std::vector<uint16_t> attrnums;
+
+    if (!prepare_projection(space, *sc, true, attrnames, attrnames_sz, status, &attrnums))
+    {
+        return -1;
+    }
+
+    e::intrusive_ptr<pending> op;
+    op = new pending_get(m_next_client_id++, attrnums, status, attrs, attrs_sz);
+    size_t sz = HYPERDEX_CLIENT_HEADER_SIZE_REQ
+              + sizeof(uint32_t) + key.size()
+              + sizeof(uint32_t) + sizeof(uint16_t) * attrnums.size();
+    std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
+    msg->pack_at(HYPERDEX_CLIENT_HEADER_SIZE_REQ) << key << attrnums;
+    return send_readop(space, key, REQ_GET_PARTIAL, msg, op, status);
+}
+
+int64_t
+client :: get_many(const char* space,
+                   const char** keys, const size_t* keys_sz, size_t keys_num,
+                   hyperdex_client_returncode* status,
+                   const hyperdex_client_attribute** attrs, size_t* attrs_sz)
+{
+    if (!maintain_coord_connection(status))
+    {
+        return -1;
+    }
+
+    const schema* sc = m_coord.config()->get_schema(space);
+
+    if (!sc)
+    {
+        ERROR(UNKNOWNSPACE) << "space \"" << e::strescape(space) << "\" does not exist";
+        return -1;
+    }
+
+    if (keys_num == 0)
+    {
+        ERROR(NONEPENDING) << "get_many was given no keys";
+        return -1;
+    }
+
+    datatype_info* di = datatype_info::lookup(sc->attrs[0].type);
+    assert(di);
+    // group the keys by the server that leads them; the point leader is
+    // specific to a region, so each group is read from a single region
+    typedef std::map<virtual_server_id, std::vector<e::slice> > key_groups_t;
+    key_groups_t groups;
+
+    for (size_t i = 0; i < keys_num; ++i)
+    {
+        e::slice key(keys[i], keys_sz[i]);
+
+        if (!di->validate(key))
+        {
+            ERROR(WRONGTYPE) << "key " << i << " must be type " << sc->attrs[0].type;
+            return -1;
+        }
+
+        virtual_server_id vsi = m_coord.config()->point_leader(space, key);
+
+        if (vsi == virtual_server_id())
+        {
+            ERROR(OFFLINE) << "all servers for key \""
+                           << e::strescape(std::string(keys[i], keys_sz[i]))
+                           << "\" in space \"" << e::strescape(space)
+                           << "\" are offline: bring one or more online to remedy the issue";
+            return -1;
+        }
+
+        groups[vsi].push_back(key);
+    }
+
+    int64_t client_id = m_next_client_id++;
+    e::intrusive_ptr<pending_get_many> gm;
+    gm = new pending_get_many(this, client_id, status, attrs, attrs_sz);
+    e::intrusive_ptr<pending> op(gm.get());
+
+    for (key_groups_t::iterator it = groups.begin(); it != groups.end(); ++it)
+    {
+        const virtual_server_id& vsi(it->first);
+        region_id ri(m_coord.config()->get_region_id(vsi));
+        std::vector<e::slice>& group(it->second);
+
+        for (size_t start = 0; start < group.size(); start += HYPERDEX_CLIENT_GET_MANY_BATCH)
+        {
+            size_t end = std::min(start + HYPERDEX_CLIENT_GET_MANY_BATCH, group.size());
+            std::vector<e::slice> batch(group.begin() + start, group.begin() + end);
+            uint64_t batch_id = gm->add_batch(ri, vsi, batch);
+            size_t sz = HYPERDEX_CLIENT_HEADER_SIZE_REQ
+                      + sizeof(uint64_t)
+                      + pack_size(batch);
+            std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
+            msg->pack_at(HYPERDEX_CLIENT_HEADER_SIZE_REQ) << batch_id << batch;
+            uint64_t nonce = m_next_server_nonce++;
+
+            if (!send(REQ_GET_MANY, vsi, nonce, msg, op, status))
+            {
+                m_failed.push_back(pending_server_pair(m_coord.config()->get_server_id(vsi), vsi, op));
+            }
+        }
+    }
+
+    return op->client_visible_id();
+}
+
+namespace
+{
+
+// orders positions in the caller's key array by the key they refer to
+class key_index_less
+{
+    public:
+        key_index_less(const char** keys, const size_t* keys_sz)
+            : m_keys(keys), m_keys_sz(keys_sz) {}
+
+    public:
+        bool operator () (size_t lhs, size_t rhs) const
+        {
+            return e::slice(m_keys[lhs], m_keys_sz[lhs]) <
+                   e::slice(m_keys[rhs], m_keys_sz[rhs]);
+        }
+
+    private:
+        const char** m_keys;
+        const size_t* m_keys_sz;
+};
+
+} // namespace
+
+int64_t
+client :: put_many(const char* space,
+                   const char** keys, const size_t* keys_sz, size_t keys_num,
+                   const hyperdex_client_attribute* attrs, const size_t* attrs_per_key,
+                   hyperdex_client_returncode* status,
+                   hyperdex_client_returncode* statuses)
+{
+    if (!maintain_coord_connection(status))
+    {
+        return -1;
+    }
+
+    const schema* sc = m_coord.config()->get_schema(space);
+
+    if (!sc)
+    {
+        ERROR(UNKNOWNSPACE) << "space \"" << e::strescape(space) << "\" does not exist";
+        return -1;
+    }
+
+    if (keys_num == 0)
+    {
+        ERROR(NONEPENDING) << "put_many was given no keys";
+        return -1;
+    }
+
+    const hyperdex_client_keyop_info* opinfo;
+    opinfo = hyperdex_client_keyop_info_lookup("put", 3);
+    assert(opinfo);
+    datatype_info* di = datatype_info::lookup(sc->attrs[0].type);
+    assert(di);
+    // every key is validated and its funcalls prepared before anything is
+    // sent, so that a bad argument fails the whole call up front
+    std::vector<std::vector<funcall> > funcs(keys_num);
+    typedef std::map<virtual_server_id, std::vector<size_t> > key_groups_t;
+    key_groups_t groups;
+    size_t attrs_off = 0;
+
+    for (size_t i = 0; i < keys_num; ++i)
+    {
+        e::slice key(keys[i], keys_sz[i]);
+
+        if (!di->validate(key))
+        {
+            ERROR(WRONGTYPE) << "key " << i << " must be type " << sc->attrs[0].type;
+            return -1;
+        }
+
+        size_t idx = prepare_funcs(space, *sc, opinfo, attrs + attrs_off,
+                                   attrs_per_key[i], status, &funcs[i]);
+
+        if (idx < attrs_per_key[i])
+        {
+            return -2 - attrs_off - idx;
+        }
+
+        attrs_off += attrs_per_key[i];
+        std::stable_sort(funcs[i].begin(), funcs[i].end());
+        virtual_server_id vsi = m_coord.config()->point_leader(space, key);
+
+        if (vsi == virtual_server_id())
+        {
+            ERROR(OFFLINE) << "all servers for key \""
+                           << e::strescape(std::string(keys[i], keys_sz[i]))
+                           << "\" in space \"" << e::strescape(space)
+                           << "\" are offline: bring one or more online to remedy the issue";
+            return -1;
+        }
+
+        groups[vsi].push_back(i);
+    }
+
+    int64_t client_id = m_next_client_id++;
+    e::intrusive_ptr<pending_put_many> pm;
+    pm = new pending_put_many(client_id, status, statuses, keys_num);
+    e::intrusive_ptr<pending> op(pm.get());
+    const uint8_t flags = (opinfo->fail_if_not_found ? 1 : 0)
+                        | (opinfo->fail_if_found ? 2 : 0)
+                        | (opinfo->erase ? 0 : 128);
+    const std::vector<attribute_check> checks;
+
+    for (key_groups_t::iterator it = groups.begin(); it != groups.end(); ++it)
+    {
+        const virtual_server_id& vsi(it->first);
+        std::vector<size_t>& group(it->second);
+        // keep repeated keys adjacent and in the caller's order so that a
+        // batch boundary never separates them; the server applies the ops
+        // within a batch in order
+        std::stable_sort(group.begin(), group.end(), key_index_less(keys, keys_sz));
+        size_t start = 0;
+
+        while (start < group.size())
+        {
+            size_t end = std::min(start + HYPERDEX_CLIENT_PUT_MANY_BATCH, group.size());
+
+            while (end < group.size() &&
+                   e::slice(keys[group[end]], keys_sz[group[end]]) ==
+                   e::slice(keys[group[end - 1]], keys_sz[group[end - 1]]))
+            {
+                ++end;
+            }
+
+            std::vector<size_t> batch(group.begin() + start, group.begin() + end);
+            uint64_t batch_id = pm->add_batch(vsi, batch);
+            size_t sz = HYPERDEX_CLIENT_HEADER_SIZE_REQ
+                      + sizeof(uint64_t)
+                      + sizeof(uint32_t);
+
+            for (size_t i = 0; i < batch.size(); ++i)
+            {
+                sz += pack_size(e::slice(keys[batch[i]], keys_sz[batch[i]]))
+                    + sizeof(uint8_t)
+                    + pack_size(checks)
+                    + pack_size(funcs[batch[i]]);
+            }
+
+            std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
+            e::buffer::packer pa = msg->pack_at(HYPERDEX_CLIENT_HEADER_SIZE_REQ);
+            pa = pa << batch_id << static_cast<uint32_t>(batch.size());
+
+            for (size_t i = 0; i < batch.size(); ++i)
+            {
+                pa = pa << e::slice(keys[batch[i]], keys_sz[batch[i]])
+                        << flags << checks << funcs[batch[i]];
+            }
+
+            uint64_t nonce = m_next_server_nonce++;
+
+            if (!send(REQ_ATOMIC_MANY, vsi, nonce, msg, op, status))
+            {
+                m_failed.push_back(pending_server_pair(m_coord.config()->get_server_id(vsi), vsi, op));
+            }
+
+            start = end;
+        }
+    }
+
+    return op->client_visible_id();
 }
 
 #define SEARCH_BOILERPLATE \
@@ -151,16 +455,28 @@ client :: search(const char* space,
                  hyperdex_client_returncode* status,
                  const hyperdex_client_attribute** attrs, size_t* attrs_sz)
 {
-    SEARCH_BOILERPLATE
-    int64_t client_id = m_next_client_id++;
-    e::intrusive_ptr<pending_aggregation> op;
-    op = new pending_search(client_id, status, attrs, attrs_sz);
-    size_t sz = HYPERDEX_CLIENT_HEADER_SIZE_REQ
-              + sizeof(uint64_t)
-              + pack_size(checks);
-    std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
-    msg->pack_at(HYPERDEX_CLIENT_HEADER_SIZE_REQ) << client_id << checks;
-    return perform_aggregation(servers, op, REQ_SEARCH_START, msg, status);
+    return perform_search(space, chks, chks_sz, false, NULL, 0, UINT64_MAX, status, attrs, attrs_sz);
+}
+
+int64_t
+client :: search_partial(const char* space,
+                         const hyperdex_client_attribute_check* chks, size_t chks_sz,
+                         const char** attrnames, size_t attrnames_sz,
+                         hyperdex_client_returncode* status,
+                         const hyperdex_client_attribute** attrs, size_t* attrs_sz)
+{
+    return perform_search(space, chks, chks_sz, true, attrnames, attrnames_sz,
+                          UINT64_MAX, status, attrs, attrs_sz);
+}
+
+int64_t
+client :: search_limit(const char* space,
+                       const hyperdex_client_attribute_check* chks, size_t chks_sz,
+                       uint64_t limit,
+                       hyperdex_client_returncode* status,
+                       const hyperdex_client_attribute** attrs, size_t* attrs_sz)
+{
+    return perform_search(space, chks, chks_sz, false, NULL, 0, limit, status, attrs, attrs_sz);
 }
 
 int64_t
@@ -188,39 +504,40 @@ client :: sorted_search(const char* space,
                         hyperdex_client_returncode* status,
                         const hyperdex_client_attribute** attrs, size_t* attrs_sz)
 {
-    SEARCH_BOILERPLATE
-    uint16_t sort_by_num = sc->lookup_attr(sort_by);
-
-    if (sort_by_num == sc->attrs_sz)
-    {
-        ERROR(UNKNOWNATTR) << "\"" << e::strescape(sort_by)
-                           << "\" is not an attribute of space \""
-                           << e::strescape(space) << "\"";
-        return -1 - chks_sz;
-    }
-
-    datatype_info* di = datatype_info::lookup(sc->attrs[sort_by_num].type);
+    return perform_sorted_search(space, chks, chks_sz, sort_by, limit, maximize,
+                                 false, NULL, 0, NULL, 0,
+                                 status, attrs, attrs_sz, NULL, NULL);
+}
 
-    if (!di->comparable())
-    {
-        ERROR(WRONGTYPE) << "cannot sort by attribute \""
-                         << e::strescape(sort_by)
-                         << "\": it is not comparable";
-        return -1 - chks_sz;
-    }
+int64_t
+client :: sorted_search_partial(const char* space,
+                                const hyperdex_client_attribute_check* chks, size_t chks_sz,
+                                const char* sort_by,
+                                uint64_t limit,
+                                bool maximize,
+                                const char** attrnames, size_t attrnames_sz,
+                                hyperdex_client_returncode* status,
+                                const hyperdex_client_attribute** attrs, size_t* attrs_sz)
+{
+    return perform_sorted_search(space, chks, chks_sz, sort_by, limit, maximize,
+                                 true, attrnames, attrnames_sz, NULL, 0,
+                                 status, attrs, attrs_sz, NULL, NULL);
+}
 
-    int64_t client_id = m_next_client_id++;
-    e::intrusive_ptr<pending_aggregation> op;
-    op = new pending_sorted_search(this, client_id, maximize, limit, sort_by_num, di, status, attrs, attrs_sz);
-    int8_t max = maximize ? 1 : 0;
-    size_t sz = HYPERDEX_CLIENT_HEADER_SIZE_REQ
-              + pack_size(checks)
-              + sizeof(limit)
-              + sizeof(sort_by_num)
-              + sizeof(max);
-    std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
-    msg->pack_at(HYPERDEX_CLIENT_HEADER_SIZE_REQ) << checks << limit << sort_by_num << max;
-    return perform_aggregation(servers, op, REQ_SORTED_SEARCH, msg, status);
+int64_t
+client :: sorted_search_page(const char* space,
+                             const hyperdex_client_attribute_check* chks, size_t chks_sz,
+                             const char* sort_by,
+                             uint64_t limit,
+                             bool maximize,
+                             const char* cursor, size_t cursor_sz,
+                             hyperdex_client_returncode* status,
+                             const hyperdex_client_attribute** attrs, size_t* attrs_sz,
+                             const char** next_cursor, size_t* next_cursor_sz)
+{
+    return perform_sorted_search(space, chks, chks_sz, sort_by, limit, maximize,
+                                 false, NULL, 0, cursor, cursor_sz,
+                                 status, attrs, attrs_sz, next_cursor, next_cursor_sz);
 }
 
 int64_t
@@ -333,6 +650,12 @@ client :: perform_funcall(const hyperdex_client_keyop_info* opinfo,
     return send_keyop(space, key, REQ_ATOMIC, msg, op, status);
 }
 
+void
+client :: set_read_from_replicas(bool enable)
+{
+    m_read_from_replicas = enable;
+}
+
 int64_t
 client :: loop(int timeout, hyperdex_client_returncode* status)
 {
@@ -737,6 +1060,222 @@ client :: prepare_searchop(const schema& sc,
     return 0;
 }
 
+bool
+client :: prepare_projection(const char* space, const schema& sc, bool partial,
+                             const char** attrnames, size_t attrnames_sz,
+                             hyperdex_client_returncode* status,
+                             std::vector<uint16_t>* attrnums)
+{
+    attrnums->clear();
+
+    if (!partial)
+    {
+        for (uint16_t i = 1; i < sc.attrs_sz; ++i)
+        {
+            attrnums->push_back(i);
+        }
+
+        return true;
+    }
+
+    for (size_t i = 0; i < attrnames_sz; ++i)
+    {
+        uint16_t attrnum = sc.lookup_attr(attrnames[i]);
+
+        if (attrnum == sc.attrs_sz)
+        {
+            ERROR(UNKNOWNATTR) << "\"" << e::strescape(attrnames[i])
+                               << "\" is not an attribute of space \""
+                               << e::strescape(space) << "\"";
+            return false;
+        }
+
+        if (attrnum == 0)
+        {
+            ERROR(DONTUSEKEY) << "attribute \"" << e::strescape(attrnames[i])
+                              << "\" is the key and cannot be projected";
+            return false;
+        }
+
+        if (std::find(attrnums->begin(), attrnums->end(), attrnum) != attrnums->end())
+        {
+            ERROR(DUPEATTR) << "attribute \"" << e::strescape(attrnames[i])
+                            << "\" is named more than once";
+            return false;
+        }
+
+        attrnums->push_back(attrnum);
+    }
+
+    return true;
+}
+
+int64_t
+client :: perform_search(const char* space,
+                         const hyperdex_client_attribute_check* chks, size_t chks_sz,
+                         bool partial, const char** attrnames, size_t attrnames_sz,
+                         uint64_t limit,
+                         hyperdex_client_returncode* status,
+                         const hyperdex_client_attribute** attrs, size_t* attrs_sz)
+{
+    SEARCH_BOILERPLATE
+    std::vector<uint16_t> attrnums;
+
+    if (!prepare_projection(space, *sc, partial, attrnames, attrnames_sz, status, &attrnums))
+    {
+        return -1 - chks_sz;
+    }
+
+    int64_t client_id = m_next_client_id++;
+    e::intrusive_ptr<pending_aggregation> op;
+    op = new pending_search(this, client_id, attrnums, limit, status, attrs, attrs_sz);
+    // a limited search asks each server for its share of the limit first,
+    // and for more only while the client has too few objects
+    bool limited = limit != UINT64_MAX;
+    uint64_t batch = limit;
+
+    if (limited && !servers.empty())
+    {
+        batch = limit / servers.size() + (limit % servers.size() ? 1 : 0);
+    }
+
+    size_t sz = HYPERDEX_CLIENT_HEADER_SIZE_REQ
+              + sizeof(uint64_t)
+              + pack_size(checks)
+              + sizeof(uint32_t) + sizeof(uint16_t) * attrnums.size()
+              + (limited ? sizeof(limit) + sizeof(batch) : 0);
+    std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
+    e::buffer::packer pa = msg->pack_at(HYPERDEX_CLIENT_HEADER_SIZE_REQ);
+    pa = pa << client_id << checks << attrnums;
+
+    if (limited)
+    {
+        pa = pa << limit << batch;
+    }
+
+    return perform_aggregation(servers, op, REQ_SEARCH_START, msg, status);
+}
+
+int64_t
+client :: perform_sorted_search(const char* space,
+                                const hyperdex_client_attribute_check* chks, size_t chks_sz,
+                                const char* sort_by,
+                                uint64_t limit,
+                                bool maximize,
+                                bool partial, const char** attrnames, size_t attrnames_sz,
+                                const char* cursor, size_t cursor_sz,
+                                hyperdex_client_returncode* status,
+                                const hyperdex_client_attribute** attrs, size_t* attrs_sz,
+                                const char** next_cursor, size_t* next_cursor_sz)
+{
+    SEARCH_BOILERPLATE
+    uint16_t sort_by_num = sc->lookup_attr(sort_by);
+
+    if (sort_by_num == sc->attrs_sz)
+    {
+        ERROR(UNKNOWNATTR) << "\"" << e::strescape(sort_by)
+                           << "\" is not an attribute of space \""
+                           << e::strescape(space) << "\"";
+        return -1 - chks_sz;
+    }
+
+    datatype_info* di = datatype_info::lookup(sc->attrs[sort_by_num].type);
+
+    if (!di->comparable())
+    {
+        ERROR(WRONGTYPE) << "cannot sort by attribute \""
+                         << e::strescape(sort_by)
+                         << "\": it is not comparable";
+        return -1 - chks_sz;
+    }
+
+    datatype_info* key_di = datatype_info::lookup(sc->attrs[0].type);
+    // a cursor resumes the search after the object it names; it must come
+    // from a search in the same order, and an empty cursor starts at the top
+    e::slice after_value;
+    e::slice after_key;
+    bool has_cursor = cursor && cursor_sz > 0;
+
+    if (has_cursor)
+    {
+        uint16_t cursor_sort_by;
+        bool cursor_maximize;
+
+        if (!decode_cursor(cursor, cursor_sz, &cursor_sort_by, &cursor_maximize, &after_value, &after_key) ||
+            cursor_sort_by != sort_by_num || cursor_maximize != maximize ||
+            !di->validate(after_value) || !key_di->validate(after_key))
+        {
+            ERROR(WRONGTYPE) << "cursor is corrupt or comes from a search "
+                             << "with a different sort order";
+            return -1 - chks_sz;
+        }
+    }
+
+    std::vector<uint16_t> attrnums;
+
+    if (!prepare_projection(space, *sc, partial, attrnames, attrnames_sz, status, &attrnums))
+    {
+        return -1 - chks_sz;
+    }
+
+    // the servers always send the sort attribute so that their results can be
+    // merged here; it is stripped before returning if it was not requested
+    size_t returned = attrnums.size();
+    uint16_t sort_by_idx = 0;
+
+    if (sort_by_num > 0)
+    {
+        std::vector<uint16_t>::iterator it;
+        it = std::find(attrnums.begin(), attrnums.end(), sort_by_num);
+
+        if (it == attrnums.end())
+        {
+            attrnums.push_back(sort_by_num);
+            it = attrnums.end() - 1;
+        }
+
+        sort_by_idx = it - attrnums.begin() + 1;
+    }
+
+    int64_t client_id = m_next_client_id++;
+    e::intrusive_ptr<pending_aggregation> op;
+    op = new pending_sorted_search(this, client_id, maximize, limit,
+                                   sort_by_num, sort_by_idx, di, key_di,
+                                   attrnums, returned, status, attrs, attrs_sz,
+                                   next_cursor, next_cursor_sz);
+    // each server streams its results in sort order; the first batches
+    // together cover the limit, and the servers send more only while their
+    // objects can still displace the client's k-th best
+    uint64_t batch = limit;
+
+    if (!servers.empty())
+    {
+        batch = limit / servers.size() + (limit % servers.size() ? 1 : 0);
+    }
+
+    int8_t flags = (maximize ? 0x1 : 0) | 0x2 | (has_cursor ? 0x4 : 0);
+    size_t sz = HYPERDEX_CLIENT_HEADER_SIZE_REQ
+              + pack_size(checks)
+              + sizeof(limit)
+              + sizeof(sort_by_num)
+              + sizeof(flags)
+              + sizeof(uint32_t) + sizeof(uint16_t) * attrnums.size()
+              + sizeof(uint64_t)
+              + sizeof(batch)
+              + (has_cursor ? pack_size(after_value) + pack_size(after_key) : 0);
+    std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
+    e::buffer::packer pa = msg->pack_at(HYPERDEX_CLIENT_HEADER_SIZE_REQ);
+    pa = pa << checks << limit << sort_by_num << flags << attrnums
+            << static_cast<uint64_t>(client_id) << batch;
+
+    if (has_cursor)
+    {
+        pa = pa << after_value << after_key;
+    }
+
+    return perform_aggregation(servers, op, REQ_SORTED_SEARCH, msg, status);
+}
+
 int64_t
 client :: perform_aggregation(const std::vector<virtual_server_id>& servers,
                               e::intrusive_ptr<pending_aggregation> _op,
@@ -838,8 +1377,13 @@ client :: send(network_msgtype mt,
     switch (rc)
     {
         case BUSYBEE_SUCCESS:
-            op->handle_sent_to(id, to);
-            m_pending_ops.insert(std::make_pair(nonce, pending_server_pair(id, to, op)));
+            // without an op, the message expects no reply
+            if (op)
+            {
+                op->handle_sent_to(id, to);
+                m_pending_ops.insert(std::make_pair(nonce, pending_server_pair(id, to, op)));
+            }
+
             return true;
         case BUSYBEE_DISRUPTED:
             handle_disruption(id);
@@ -867,7 +1411,42 @@ client :: send_keyop(const char* space,
                      hyperdex_client_returncode* status)
 {
     virtual_server_id vsi = m_coord.config()->point_leader(space, key);
+    return send_keyop(vsi, space, key, mt, msg, op, status);
+}
+
+int64_t
+client :: send_readop(const char* space,
+                      const e::slice& key,
+                      network_msgtype mt,
+                      std::auto_ptr<e::buffer> msg,
+                      e::intrusive_ptr<pending> op,
+                      hyperdex_client_returncode* status)
+{
+    virtual_server_id vsi;
+
+    if (m_read_from_replicas)
+    {
+        // spread reads round-robin over the chain; the replicas keep them
+        // consistent with the point leader
+        vsi = m_coord.config()->point_replica(space, key, m_next_replica++);
+    }
+    else
+    {
+        vsi = m_coord.config()->point_leader(space, key);
+    }
+
+    return send_keyop(vsi, space, key, mt, msg, op, status);
+}
 
+int64_t
+client :: send_keyop(const virtual_server_id& vsi,
+                     const char* space,
+                     const e::slice& key,
+                     network_msgtype mt,
+                     std::auto_ptr<e::buffer> msg,
+                     e::intrusive_ptr<pending> op,
+                     hyperdex_client_returncode* status)
+{
     if (vsi == virtual_server_id())
     {
         ERROR(OFFLINE) << "all servers for key \""
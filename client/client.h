@@ -62,10 +62,33 @@ class client
         int64_t get(const char* space, const char* key, size_t key_sz,
                     hyperdex_client_returncode* status,
                     const hyperdex_client_attribute** attrs, size_t* attrs_sz);
+        int64_t get_partial(const char* space, const char* key, size_t key_sz,
+                            const char** attrnames, size_t attrnames_sz,
+                            hyperdex_client_returncode* status,
+                            const hyperdex_client_attribute** attrs, size_t* attrs_sz);
+        int64_t get_many(const char* space,
+                         const char** keys, const size_t* keys_sz, size_t keys_num,
+                         hyperdex_client_returncode* status,
+                         const hyperdex_client_attribute** attrs, size_t* attrs_sz);
+        int64_t put_many(const char* space,
+                         const char** keys, const size_t* keys_sz, size_t keys_num,
+                         const hyperdex_client_attribute* attrs, const size_t* attrs_per_key,
+                         hyperdex_client_returncode* status,
+                         hyperdex_client_returncode* statuses);
         int64_t search(const char* space,
                        const hyperdex_client_attribute_check* checks, size_t checks_sz,
                        hyperdex_client_returncode* status,
                        const hyperdex_client_attribute** attrs, size_t* attrs_sz);
+        int64_t search_partial(const char* space,
+                               const hyperdex_client_attribute_check* checks, size_t checks_sz,
+                               const char** attrnames, size_t attrnames_sz,
+                               hyperdex_client_returncode* status,
+                               const hyperdex_client_attribute** attrs, size_t* attrs_sz);
+        int64_t search_limit(const char* space,
+                             const hyperdex_client_attribute_check* checks, size_t checks_sz,
+                             uint64_t limit,
+                             hyperdex_client_returncode* status,
+                             const hyperdex_client_attribute** attrs, size_t* attrs_sz);
         int64_t search_describe(const char* space,
                                 const hyperdex_client_attribute_check* checks, size_t checks_sz,
                                 hyperdex_client_returncode* status, const char** description);
@@ -76,6 +99,23 @@ class client
                               bool maximize,
                               hyperdex_client_returncode* status,
                               const hyperdex_client_attribute** attrs, size_t* attrs_sz);
+        int64_t sorted_search_partial(const char* space,
+                                      const hyperdex_client_attribute_check* checks, size_t checks_sz,
+                                      const char* sort_by,
+                                      uint64_t limit,
+                                      bool maximize,
+                                      const char** attrnames, size_t attrnames_sz,
+                                      hyperdex_client_returncode* status,
+                                      const hyperdex_client_attribute** attrs, size_t* attrs_sz);
+        int64_t sorted_search_page(const char* space,
+                                   const hyperdex_client_attribute_check* checks, size_t checks_sz,
+                                   const char* sort_by,
+                                   uint64_t limit,
+                                   bool maximize,
+                                   const char* cursor, size_t cursor_sz,
+                                   hyperdex_client_returncode* status,
+                                   const hyperdex_client_attribute** attrs, size_t* attrs_sz,
+                                   const char** next_cursor, size_t* next_cursor_sz);
         int64_t group_del(const char* space,
                           const hyperdex_client_attribute_check* checks, size_t checks_sz,
                           hyperdex_client_returncode* status);
@@ -89,6 +129,9 @@ class client
                                 const hyperdex_client_attribute* attrs, size_t attrs_sz,
                                 const hyperdex_client_map_attribute* mapattrs, size_t mapattrs_sz,
                                 hyperdex_client_returncode* status);
+        // send gets to any replica of the key's region, instead of only
+        // to its point leader
+        void set_read_from_replicas(bool enable);
         // looping/polling
         int64_t loop(int timeout, hyperdex_client_returncode* status);
         int poll();
@@ -117,6 +160,7 @@ class client
         typedef std::map<uint64_t, pending_server_pair> pending_map_t;
         typedef std::list<pending_server_pair> pending_queue_t;
         friend class pending_get;
+        friend class pending_get_many;
         friend class pending_search;
         friend class pending_sorted_search;
 
@@ -141,6 +185,28 @@ class client
                                 hyperdex_client_returncode* status,
                                 std::vector<attribute_check>* checks,
                                 std::vector<virtual_server_id>* servers);
+        // resolve "attrnames" to attribute numbers; if "partial" is false,
+        // select every attribute except the key
+        bool prepare_projection(const char* space, const schema& sc, bool partial,
+                                const char** attrnames, size_t attrnames_sz,
+                                hyperdex_client_returncode* status,
+                                std::vector<uint16_t>* attrnums);
+        int64_t perform_search(const char* space,
+                               const hyperdex_client_attribute_check* checks, size_t checks_sz,
+                               bool partial, const char** attrnames, size_t attrnames_sz,
+                               uint64_t limit,
+                               hyperdex_client_returncode* status,
+                               const hyperdex_client_attribute** attrs, size_t* attrs_sz);
+        int64_t perform_sorted_search(const char* space,
+                                      const hyperdex_client_attribute_check* checks, size_t checks_sz,
+                                      const char* sort_by,
+                                      uint64_t limit,
+                                      bool maximize,
+                                      bool partial, const char** attrnames, size_t attrnames_sz,
+                                      const char* cursor, size_t cursor_sz,
+                                      hyperdex_client_returncode* status,
+                                      const hyperdex_client_attribute** attrs, size_t* attrs_sz,
+                                      const char** next_cursor, size_t* next_cursor_sz);
         int64_t perform_aggregation(const std::vector<virtual_server_id>& servers,
                                     e::intrusive_ptr<pending_aggregation> op,
                                     network_msgtype mt,
@@ -159,6 +225,20 @@ class client
                            std::auto_ptr<e::buffer> msg,
                            e::intrusive_ptr<pending> op,
                            hyperdex_client_returncode* status);
+        // like send_keyop, but may pick any replica of the key's region
+        int64_t send_readop(const char* space,
+                            const e::slice& key,
+                            network_msgtype mt,
+                            std::auto_ptr<e::buffer> msg,
+                            e::intrusive_ptr<pending> op,
+                            hyperdex_client_returncode* status);
+        int64_t send_keyop(const virtual_server_id& vsi,
+                           const char* space,
+                           const e::slice& key,
+                           network_msgtype mt,
+                           std::auto_ptr<e::buffer> msg,
+                           e::intrusive_ptr<pending> op,
+                           hyperdex_client_returncode* status);
         void handle_disruption(const server_id& si);
 
     private:
@@ -172,6 +252,8 @@ class client
         e::intrusive_ptr<pending> m_yielding;
         e::intrusive_ptr<pending> m_yielded;
         e::error m_last_error;
+        bool m_read_from_replicas;
+        uint64_t m_next_replica;
 };
 
 END_HYPERDEX_NAMESPACE
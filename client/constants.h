@@ -42,4 +42,10 @@
                                       + sizeof(uint64_t) /*vidt*/ \
                                       + sizeof(uint64_t) /*nonce*/)
 
+// get_many sends at most this many keys to a server in one request
+#define HYPERDEX_CLIENT_GET_MANY_BATCH 256
+// put_many sends roughly this many keys to a server in one request; repeated
+// keys are never split across requests
+#define HYPERDEX_CLIENT_PUT_MANY_BATCH 256
+
 #endif // hyperdex_client_constants_h_
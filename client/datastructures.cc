@@ -315,6 +315,20 @@ hyperdex_ds_allocate_map_attribute(struct hyperdex_ds_arena* arena, size_t sz)
     return reinterpret_cast<struct hyperdex_client_map_attribute*>(arena->allocate(bytes));
 }
 
+HYPERDEX_API const char**
+hyperdex_ds_allocate_string_array(struct hyperdex_ds_arena* arena, size_t sz)
+{
+    size_t bytes = sizeof(const char*) * sz;
+    return reinterpret_cast<const char**>(arena->allocate(bytes));
+}
+
+HYPERDEX_API size_t*
+hyperdex_ds_allocate_size_array(struct hyperdex_ds_arena* arena, size_t sz)
+{
+    size_t bytes = sizeof(size_t) * sz;
+    return reinterpret_cast<size_t*>(arena->allocate(bytes));
+}
+
 //////////////////////////// pack/unpack ints/floats ///////////////////////////
 
 HYPERDEX_API void
@@ -39,6 +39,22 @@ pending_get :: pending_get(uint64_t id,
                            size_t* attrs_sz)
     : pending(id, status)
     , m_state(INITIALIZED)
+    , m_partial(false)
+    , m_attrnums()
+    , m_attrs(attrs)
+    , m_attrs_sz(attrs_sz)
+{
+}
+
+pending_get :: pending_get(uint64_t id,
+                           const std::vector<uint16_t>& attrnums,
+                           hyperdex_client_returncode* status,
+                           const hyperdex_client_attribute** attrs,
+                           size_t* attrs_sz)
+    : pending(id, status)
+    , m_state(INITIALIZED)
+    , m_partial(true)
+    , m_attrnums(attrnums)
     , m_attrs(attrs)
     , m_attrs_sz(attrs_sz)
 {
@@ -96,7 +112,7 @@ pending_get :: handle_message(client* cl,
     *status = HYPERDEX_CLIENT_SUCCESS;
     *err = e::error();
 
-    if (mt != RESP_GET)
+    if (mt != (m_partial ? RESP_GET_PARTIAL : RESP_GET))
     {
         PENDING_ERROR(SERVERERROR) << "server " << vsi << " responded to GET with " << mt;
         return true;
@@ -172,11 +188,25 @@ pending_get :: handle_message(client* cl,
 
     hyperdex_client_returncode op_status;
     e::error op_error;
+    bool converted;
+
+    if (m_partial)
+    {
+        converted = value_to_attributes(*cl->m_coord.config(),
+                                        cl->m_coord.config()->get_region_id(vsi),
+                                        NULL, 0, value, m_attrnums,
+                                        &op_status, &op_error,
+                                        m_attrs, m_attrs_sz);
+    }
+    else
+    {
+        converted = value_to_attributes(*cl->m_coord.config(),
+                                        cl->m_coord.config()->get_region_id(vsi),
+                                        NULL, 0, value, &op_status, &op_error,
+                                        m_attrs, m_attrs_sz);
+    }
 
-    if (!value_to_attributes(*cl->m_coord.config(),
-                             cl->m_coord.config()->get_region_id(vsi),
-                             NULL, 0, value, &op_status, &op_error,
-                             m_attrs, m_attrs_sz))
+    if (!converted)
     {
         set_status(op_status);
         set_error(op_error);
@@ -28,6 +28,9 @@
 #ifndef hyperdex_client_pending_get_h_
 #define hyperdex_client_pending_get_h_
 
+// STL
+#include <vector>
+
 // HyperDex
 #include "namespace.h"
 #include "client/pending.h"
@@ -40,6 +43,11 @@ class pending_get : public pending
         pending_get(uint64_t client_visible_id,
                     hyperdex_client_returncode* status,
                     const hyperdex_client_attribute** attrs, size_t* attrs_sz);
+        // a get that retrieves only the attributes in "attrnums"
+        pending_get(uint64_t client_visible_id,
+                    const std::vector<uint16_t>& attrnums,
+                    hyperdex_client_returncode* status,
+                    const hyperdex_client_attribute** attrs, size_t* attrs_sz);
         virtual ~pending_get() throw ();
 
     // return to client
@@ -69,6 +77,8 @@ class pending_get : public pending
 
     private:
         enum { INITIALIZED, SENT, RECV, YIELDED } m_state;
+        const bool m_partial;
+        const std::vector<uint16_t> m_attrnums;
         const hyperdex_client_attribute** m_attrs;
         size_t* m_attrs_sz;
 };
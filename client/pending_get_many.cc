@@ -0,0 +1,331 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+// HyperDex
+#include "common/network_returncode.h"
+#include "client/client.h"
+#include "client/constants.h"
+#include "client/pending_get_many.h"
+#include "client/util.h"
+
+using hyperdex::pending_get_many;
+
+pending_get_many :: pending_get_many(client* cl,
+                                     uint64_t id,
+                                     hyperdex_client_returncode* status,
+                                     const hyperdex_client_attribute** attrs, size_t* attrs_sz)
+    : pending_aggregation(id, status)
+    , m_cl(cl)
+    , m_attrs(attrs)
+    , m_attrs_sz(attrs_sz)
+    , m_done(false)
+    , m_next_batch(0)
+    , m_batches()
+    , m_results()
+{
+    *m_attrs = NULL;
+    *m_attrs_sz = 0;
+}
+
+pending_get_many :: ~pending_get_many() throw ()
+{
+}
+
+uint64_t
+pending_get_many :: add_batch(const region_id& ri,
+                              const virtual_server_id& vsi,
+                              const std::vector<e::slice>& keys)
+{
+    uint64_t id = m_next_batch++;
+    batch& b(m_batches[id]);
+    b.ri = ri;
+    b.vsi = vsi;
+    b.keys.reserve(keys.size());
+
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        b.keys.push_back(std::string(reinterpret_cast<const char*>(keys[i].data()), keys[i].size()));
+    }
+
+    return id;
+}
+
+bool
+pending_get_many :: can_yield()
+{
+    return !m_results.empty() || (this->aggregation_done() && !m_done);
+}
+
+bool
+pending_get_many :: yield(hyperdex_client_returncode* status, e::error* err)
+{
+    *status = HYPERDEX_CLIENT_SUCCESS;
+    *err = e::error();
+
+    if (!m_results.empty())
+    {
+        const item& it(m_results.front());
+        hyperdex_client_returncode op_status;
+        e::error op_error;
+        bool converted;
+
+        // every result starts with the key so the application can tell which
+        // key it answers; keys that were not found carry only the key
+        if (it.status == HYPERDEX_CLIENT_SUCCESS)
+        {
+            converted = value_to_attributes(*m_cl->m_coord.config(), it.ri,
+                                            it.key.data(), it.key.size(), it.value,
+                                            &op_status, &op_error, m_attrs, m_attrs_sz);
+        }
+        else
+        {
+            converted = value_to_attributes(*m_cl->m_coord.config(), it.ri,
+                                            it.key.data(), it.key.size(),
+                                            std::vector<e::slice>(), std::vector<uint16_t>(),
+                                            &op_status, &op_error, m_attrs, m_attrs_sz);
+        }
+
+        if (!converted)
+        {
+            set_status(op_status);
+            set_error(op_error);
+        }
+        else if (it.status == HYPERDEX_CLIENT_SUCCESS ||
+                 it.status == HYPERDEX_CLIENT_NOTFOUND)
+        {
+            set_status(it.status);
+            set_error(e::error());
+        }
+        else if (it.status == HYPERDEX_CLIENT_RECONFIGURE)
+        {
+            PENDING_ERROR(RECONFIGURE) << "reconfiguration affecting the server "
+                                       << "responsible for this key";
+        }
+        else
+        {
+            PENDING_ERROR(SERVERERROR) << "server could not retrieve this key;"
+                                       << " check its log for details";
+        }
+
+        m_results.pop_front();
+        return true;
+    }
+
+    if (this->aggregation_done())
+    {
+        m_done = true;
+        set_status(HYPERDEX_CLIENT_SEARCHDONE);
+        set_error(e::error());
+    }
+
+    return true;
+}
+
+void
+pending_get_many :: handle_failure(const server_id& si,
+                                   const virtual_server_id& vsi)
+{
+    batch* b = outstanding_batch(vsi);
+
+    if (b)
+    {
+        fail_batch(b, HYPERDEX_CLIENT_RECONFIGURE);
+    }
+
+    return pending_aggregation::handle_failure(si, vsi);
+}
+
+bool
+pending_get_many :: handle_message(client* cl,
+                                   const server_id& si,
+                                   const virtual_server_id& vsi,
+                                   network_msgtype mt,
+                                   std::auto_ptr<e::buffer> msg,
+                                   e::unpacker up,
+                                   hyperdex_client_returncode* status,
+                                   e::error* err)
+{
+    bool handled = pending_aggregation::handle_message(cl, si, vsi, mt, std::auto_ptr<e::buffer>(), up, status, err);
+    assert(handled);
+
+    *status = HYPERDEX_CLIENT_SUCCESS;
+    *err = e::error();
+    uint64_t batch_id = 0;
+    uint64_t num_items = 0;
+    up = up >> batch_id;
+    std::map<uint64_t, batch>::iterator bit = m_batches.end();
+
+    if (mt == RESP_GET_MANY && !up.error())
+    {
+        bit = m_batches.find(batch_id);
+    }
+
+    // a response that names none of the batches sent to this server could
+    // answer any of them, so none of them can be trusted
+    if (bit == m_batches.end() || bit->second.vsi != vsi)
+    {
+        for (std::map<uint64_t, batch>::iterator it = m_batches.begin();
+                it != m_batches.end(); ++it)
+        {
+            if (!it->second.done && it->second.vsi == vsi)
+            {
+                fail_batch(&it->second, HYPERDEX_CLIENT_SERVERERROR);
+            }
+        }
+
+        return true;
+    }
+
+    batch* b = &bit->second;
+    up = up >> num_items;
+
+    if (b->done)
+    {
+        return true;
+    }
+
+    if (up.error() || num_items != b->keys.size())
+    {
+        fail_batch(b, HYPERDEX_CLIENT_SERVERERROR);
+        return true;
+    }
+
+    e::compat::shared_ptr<e::buffer> backing(msg.release());
+
+    for (uint64_t i = 0; i < num_items; ++i)
+    {
+        uint16_t response;
+        std::vector<e::slice> value;
+        up = up >> response >> value;
+        hyperdex_client_returncode st;
+
+        if (up.error())
+        {
+            st = HYPERDEX_CLIENT_SERVERERROR;
+            value.clear();
+        }
+        else if (static_cast<network_returncode>(response) == NET_SUCCESS)
+        {
+            st = HYPERDEX_CLIENT_SUCCESS;
+        }
+        else if (static_cast<network_returncode>(response) == NET_NOTFOUND)
+        {
+            st = HYPERDEX_CLIENT_NOTFOUND;
+        }
+        else
+        {
+            st = HYPERDEX_CLIENT_SERVERERROR;
+        }
+
+        m_results.push_back(item(b->ri, e::slice(b->keys[i]), st, value, backing));
+    }
+
+    b->done = true;
+    return true;
+}
+
+pending_get_many::batch*
+pending_get_many :: outstanding_batch(const virtual_server_id& vsi)
+{
+    for (std::map<uint64_t, batch>::iterator it = m_batches.begin();
+            it != m_batches.end(); ++it)
+    {
+        if (!it->second.done && it->second.vsi == vsi)
+        {
+            return &it->second;
+        }
+    }
+
+    return NULL;
+}
+
+void
+pending_get_many :: fail_batch(batch* b, hyperdex_client_returncode st)
+{
+    for (size_t i = 0; i < b->keys.size(); ++i)
+    {
+        m_results.push_back(item(b->ri, e::slice(b->keys[i]), st,
+                                 std::vector<e::slice>(),
+                                 e::compat::shared_ptr<e::buffer>()));
+    }
+
+    b->done = true;
+}
+
+pending_get_many :: batch :: batch()
+    : ri()
+    , vsi()
+    , keys()
+    , done(false)
+{
+}
+
+pending_get_many :: batch :: ~batch() throw ()
+{
+}
+
+pending_get_many :: item :: item(const region_id& _ri,
+                                 const e::slice& _key,
+                                 hyperdex_client_returncode _status,
+                                 const std::vector<e::slice>& _value,
+                                 e::compat::shared_ptr<e::buffer> _backing)
+    : ri(_ri)
+    , key(_key)
+    , status(_status)
+    , value(_value)
+    , backing(_backing)
+{
+}
+
+pending_get_many :: item :: item(const item& other)
+    : ri(other.ri)
+    , key(other.key)
+    , status(other.status)
+    , value(other.value)
+    , backing(other.backing)
+{
+}
+
+pending_get_many :: item :: ~item() throw ()
+{
+}
+
+pending_get_many::item&
+pending_get_many :: item :: operator = (const item& other)
+{
+    if (this != &other)
+    {
+        ri = other.ri;
+        key = other.key;
+        status = other.status;
+        value = other.value;
+        backing = other.backing;
+    }
+
+    return *this;
+}
@@ -0,0 +1,147 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef hyperdex_client_pending_get_many_h_
+#define hyperdex_client_pending_get_many_h_
+
+// STL
+#include <list>
+#include <map>
+#include <string>
+
+// e
+#include <e/compat.h>
+
+// HyperDex
+#include "namespace.h"
+#include "client/pending_aggregation.h"
+
+BEGIN_HYPERDEX_NAMESPACE
+
+class pending_get_many : public pending_aggregation
+{
+    public:
+        pending_get_many(client* cl,
+                         uint64_t client_visible_id,
+                         hyperdex_client_returncode* status,
+                         const hyperdex_client_attribute** attrs, size_t* attrs_sz);
+        virtual ~pending_get_many() throw ();
+
+    public:
+        // remember a batch of keys about to be sent to "vsi"; the returned id
+        // is echoed back by the server
+        uint64_t add_batch(const region_id& ri,
+                           const virtual_server_id& vsi,
+                           const std::vector<e::slice>& keys);
+
+    // return to client
+    public:
+        virtual bool can_yield();
+        virtual bool yield(hyperdex_client_returncode* status, e::error* error);
+
+    // events
+    public:
+        virtual void handle_failure(const server_id& si,
+                                    const virtual_server_id& vsi);
+        virtual bool handle_message(client*,
+                                    const server_id& si,
+                                    const virtual_server_id& vsi,
+                                    network_msgtype mt,
+                                    std::auto_ptr<e::buffer> msg,
+                                    e::unpacker up,
+                                    hyperdex_client_returncode* status,
+                                    e::error* error);
+
+    public:
+        class batch;
+        class item;
+
+    private:
+        friend class e::intrusive_ptr<pending_get_many>;
+
+    // noncopyable
+    private:
+        pending_get_many(const pending_get_many& other);
+        pending_get_many& operator = (const pending_get_many& rhs);
+
+    private:
+        // the oldest unanswered batch sent to "vsi", or NULL
+        batch* outstanding_batch(const virtual_server_id& vsi);
+        // answer every key of the batch with "st"
+        void fail_batch(batch* b, hyperdex_client_returncode st);
+
+    private:
+        client* m_cl;
+        const hyperdex_client_attribute** m_attrs;
+        size_t* m_attrs_sz;
+        bool m_done;
+        uint64_t m_next_batch;
+        std::map<uint64_t, batch> m_batches;
+        // one result per key, waiting to be returned to the application
+        std::list<item> m_results;
+};
+
+class pending_get_many :: batch
+{
+    public:
+        batch();
+        ~batch() throw ();
+
+    public:
+        region_id ri;
+        virtual_server_id vsi;
+        // owns the memory behind the keys of this batch's items
+        std::vector<std::string> keys;
+        bool done;
+};
+
+class pending_get_many :: item
+{
+    public:
+        item(const region_id& ri,
+             const e::slice& key,
+             hyperdex_client_returncode status,
+             const std::vector<e::slice>& value,
+             e::compat::shared_ptr<e::buffer> backing);
+        item(const item&);
+        ~item() throw ();
+
+    public:
+        item& operator = (const item&);
+
+    public:
+        region_id ri;
+        e::slice key;
+        hyperdex_client_returncode status;
+        std::vector<e::slice> value;
+        e::compat::shared_ptr<e::buffer> backing;
+};
+
+END_HYPERDEX_NAMESPACE
+
+#endif // hyperdex_client_pending_get_many_h_
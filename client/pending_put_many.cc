@@ -0,0 +1,234 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+// HyperDex
+#include "common/network_returncode.h"
+#include "client/constants.h"
+#include "client/pending_put_many.h"
+#include "client/util.h"
+
+using hyperdex::pending_put_many;
+
+pending_put_many :: pending_put_many(uint64_t id,
+                                     hyperdex_client_returncode* status,
+                                     hyperdex_client_returncode* statuses,
+                                     size_t statuses_sz)
+    : pending_aggregation(id, status)
+    , m_statuses(statuses)
+    , m_statuses_sz(statuses_sz)
+    , m_yielded(false)
+    , m_next_batch(0)
+    , m_batches()
+{
+    for (size_t i = 0; i < m_statuses_sz; ++i)
+    {
+        m_statuses[i] = HYPERDEX_CLIENT_GARBAGE;
+    }
+}
+
+pending_put_many :: ~pending_put_many() throw ()
+{
+}
+
+uint64_t
+pending_put_many :: add_batch(const virtual_server_id& vsi,
+                              const std::vector<size_t>& indices)
+{
+    uint64_t id = m_next_batch++;
+    batch& b(m_batches[id]);
+    b.vsi = vsi;
+    b.indices = indices;
+    return id;
+}
+
+bool
+pending_put_many :: can_yield()
+{
+    return this->aggregation_done() && !m_yielded;
+}
+
+bool
+pending_put_many :: yield(hyperdex_client_returncode* status, e::error* err)
+{
+    *status = HYPERDEX_CLIENT_SUCCESS;
+    *err = e::error();
+    assert(this->can_yield());
+    m_yielded = true;
+
+    for (size_t i = 0; i < m_statuses_sz; ++i)
+    {
+        switch (m_statuses[i])
+        {
+            case HYPERDEX_CLIENT_SUCCESS:
+                continue;
+            case HYPERDEX_CLIENT_RECONFIGURE:
+                PENDING_ERROR(RECONFIGURE) << "reconfiguration affecting the server "
+                                           << "responsible for key " << i;
+                return true;
+            case HYPERDEX_CLIENT_OVERFLOW:
+                PENDING_ERROR(OVERFLOW) << "key " << i << " would cause a number overflow";
+                return true;
+            case HYPERDEX_CLIENT_READONLY:
+                PENDING_ERROR(READONLY) << "cluster is in read-only mode";
+                return true;
+            default:
+                set_status(m_statuses[i]);
+                set_error(e::error());
+                return true;
+        }
+    }
+
+    set_status(HYPERDEX_CLIENT_SUCCESS);
+    set_error(e::error());
+    return true;
+}
+
+void
+pending_put_many :: handle_failure(const server_id& si,
+                                   const virtual_server_id& vsi)
+{
+    batch* b = outstanding_batch(vsi);
+
+    if (b)
+    {
+        fail_batch(b, HYPERDEX_CLIENT_RECONFIGURE);
+    }
+
+    return pending_aggregation::handle_failure(si, vsi);
+}
+
+bool
+pending_put_many :: handle_message(client* cl,
+                                   const server_id& si,
+                                   const virtual_server_id& vsi,
+                                   network_msgtype mt,
+                                   std::auto_ptr<e::buffer>,
+                                   e::unpacker up,
+                                   hyperdex_client_returncode* status,
+                                   e::error* err)
+{
+    bool handled = pending_aggregation::handle_message(cl, si, vsi, mt, std::auto_ptr<e::buffer>(), up, status, err);
+    assert(handled);
+
+    *status = HYPERDEX_CLIENT_SUCCESS;
+    *err = e::error();
+    uint64_t batch_id = 0;
+    std::vector<uint16_t> responses;
+    up = up >> batch_id >> responses;
+    std::map<uint64_t, batch>::iterator bit = m_batches.find(batch_id);
+
+    if (mt != RESP_ATOMIC_MANY || up.error() ||
+        bit == m_batches.end() || bit->second.done ||
+        bit->second.vsi != vsi || responses.size() != bit->second.indices.size())
+    {
+        batch* b = outstanding_batch(vsi);
+
+        if (b)
+        {
+            fail_batch(b, HYPERDEX_CLIENT_SERVERERROR);
+        }
+
+        return true;
+    }
+
+    batch* b = &bit->second;
+
+    for (size_t i = 0; i < responses.size(); ++i)
+    {
+        hyperdex_client_returncode st;
+
+        switch (static_cast<network_returncode>(responses[i]))
+        {
+            case NET_SUCCESS:
+                st = HYPERDEX_CLIENT_SUCCESS;
+                break;
+            case NET_NOTFOUND:
+                st = HYPERDEX_CLIENT_NOTFOUND;
+                break;
+            case NET_CMPFAIL:
+                st = HYPERDEX_CLIENT_CMPFAIL;
+                break;
+            case NET_NOTUS:
+                st = HYPERDEX_CLIENT_RECONFIGURE;
+                break;
+            case NET_OVERFLOW:
+                st = HYPERDEX_CLIENT_OVERFLOW;
+                break;
+            case NET_READONLY:
+                st = HYPERDEX_CLIENT_READONLY;
+                break;
+            case NET_BADDIMSPEC:
+            case NET_SERVERERROR:
+            default:
+                st = HYPERDEX_CLIENT_SERVERERROR;
+                break;
+        }
+
+        m_statuses[b->indices[i]] = st;
+    }
+
+    b->done = true;
+    return true;
+}
+
+pending_put_many::batch*
+pending_put_many :: outstanding_batch(const virtual_server_id& vsi)
+{
+    for (std::map<uint64_t, batch>::iterator it = m_batches.begin();
+            it != m_batches.end(); ++it)
+    {
+        if (!it->second.done && it->second.vsi == vsi)
+        {
+            return &it->second;
+        }
+    }
+
+    return NULL;
+}
+
+void
+pending_put_many :: fail_batch(batch* b, hyperdex_client_returncode st)
+{
+    for (size_t i = 0; i < b->indices.size(); ++i)
+    {
+        m_statuses[b->indices[i]] = st;
+    }
+
+    b->done = true;
+}
+
+pending_put_many :: batch :: batch()
+    : vsi()
+    , indices()
+    , done(false)
+{
+}
+
+pending_put_many :: batch :: ~batch() throw ()
+{
+}
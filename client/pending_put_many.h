@@ -0,0 +1,115 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef hyperdex_client_pending_put_many_h_
+#define hyperdex_client_pending_put_many_h_
+
+// STL
+#include <map>
+#include <vector>
+
+// HyperDex
+#include "namespace.h"
+#include "client/pending_aggregation.h"
+
+BEGIN_HYPERDEX_NAMESPACE
+
+class pending_put_many : public pending_aggregation
+{
+    public:
+        pending_put_many(uint64_t client_visible_id,
+                         hyperdex_client_returncode* status,
+                         hyperdex_client_returncode* statuses,
+                         size_t statuses_sz);
+        virtual ~pending_put_many() throw ();
+
+    public:
+        // remember that the keys at "indices" are about to be sent to "vsi";
+        // the returned id is echoed back by the server
+        uint64_t add_batch(const virtual_server_id& vsi,
+                           const std::vector<size_t>& indices);
+
+    // return to client
+    public:
+        virtual bool can_yield();
+        virtual bool yield(hyperdex_client_returncode* status, e::error* error);
+
+    // events
+    public:
+        virtual void handle_failure(const server_id& si,
+                                    const virtual_server_id& vsi);
+        virtual bool handle_message(client*,
+                                    const server_id& si,
+                                    const virtual_server_id& vsi,
+                                    network_msgtype mt,
+                                    std::auto_ptr<e::buffer> msg,
+                                    e::unpacker up,
+                                    hyperdex_client_returncode* status,
+                                    e::error* error);
+
+    public:
+        class batch;
+
+    private:
+        friend class e::intrusive_ptr<pending_put_many>;
+
+    // noncopyable
+    private:
+        pending_put_many(const pending_put_many& other);
+        pending_put_many& operator = (const pending_put_many& rhs);
+
+    private:
+        // the oldest unanswered batch sent to "vsi", or NULL
+        batch* outstanding_batch(const virtual_server_id& vsi);
+        // answer every key of the batch with "st"
+        void fail_batch(batch* b, hyperdex_client_returncode st);
+
+    private:
+        hyperdex_client_returncode* m_statuses;
+        size_t m_statuses_sz;
+        bool m_yielded;
+        uint64_t m_next_batch;
+        std::map<uint64_t, batch> m_batches;
+};
+
+class pending_put_many :: batch
+{
+    public:
+        batch();
+        ~batch() throw ();
+
+    public:
+        virtual_server_id vsi;
+        // positions of this batch's keys within the caller's arrays
+        std::vector<size_t> indices;
+        bool done;
+};
+
+END_HYPERDEX_NAMESPACE
+
+#endif // hyperdex_client_pending_put_many_h_
@@ -33,14 +33,22 @@
 
 using hyperdex::pending_search;
 
-pending_search :: pending_search(uint64_t id,
+pending_search :: pending_search(client* cl,
+                                 uint64_t id,
+                                 const std::vector<uint16_t>& attrnums,
+                                 uint64_t limit,
                                  hyperdex_client_returncode* status,
                                  const hyperdex_client_attribute** attrs, size_t* attrs_sz)
     : pending_aggregation(id, status)
+    , m_cl(cl)
+    , m_attrnums(attrnums)
     , m_attrs(attrs)
     , m_attrs_sz(attrs_sz)
     , m_yield(false)
     , m_done(false)
+    , m_limit(limit)
+    , m_received(0)
+    , m_results()
 {
     *m_attrs = NULL;
     *m_attrs_sz = 0;
@@ -53,7 +61,7 @@ pending_search :: ~pending_search() throw ()
 bool
 pending_search :: can_yield()
 {
-    return m_yield;
+    return m_yield || !m_results.empty() || (this->aggregation_done() && !m_done);
 }
 
 bool
@@ -61,16 +69,42 @@ pending_search :: yield(hyperdex_client_returncode* status, e::error* err)
 {
     *status = HYPERDEX_CLIENT_SUCCESS;
     *err = e::error();
-    m_yield = false;
 
-    if (this->aggregation_done() && !m_done)
+    // an error was recorded by handle_*; report it before anything else
+    if (m_yield)
     {
-        m_yield = true;
-        m_done = true;
+        m_yield = false;
+        return true;
+    }
+
+    if (!m_results.empty())
+    {
+        const item& it(m_results.front());
+        hyperdex_client_returncode op_status;
+        e::error op_error;
+
+        if (!value_to_attributes(*m_cl->m_coord.config(), it.ri,
+                                 it.key.data(), it.key.size(), it.value,
+                                 m_attrnums, &op_status, &op_error, m_attrs, m_attrs_sz))
+        {
+            set_status(op_status);
+            set_error(op_error);
+        }
+        else
+        {
+            set_status(HYPERDEX_CLIENT_SUCCESS);
+            set_error(e::error());
+        }
+
+        m_results.pop_front();
+        return true;
     }
-    else if (m_done)
+
+    if (this->aggregation_done())
     {
+        m_done = true;
         set_status(HYPERDEX_CLIENT_SEARCHDONE);
+        set_error(e::error());
     }
 
     return true;
@@ -102,26 +136,25 @@ pending_search :: handle_message(client* cl,
     *status = HYPERDEX_CLIENT_SUCCESS;
     *err = e::error();
 
+    // the last batch ends the search, so RESP_SEARCH_DONE means the server
+    // no longer has it (its lease ran out or it was evicted)
     if (mt == RESP_SEARCH_DONE)
     {
-        if (this->aggregation_done())
-        {
-            m_yield = true;
-            m_done = true;
-        }
-
+        PENDING_ERROR(SERVERERROR) << "server " << vsi << " dropped the search "
+                                   << "before it completed";
+        m_yield = true;
         return true;
     }
-    else if (mt != RESP_SEARCH_ITEM)
+    else if (mt != RESP_SEARCH_BATCH)
     {
         PENDING_ERROR(SERVERERROR) << "server " << vsi << " responded to SEARCH with " << mt;
         m_yield = true;
         return true;
     }
 
-    e::slice key;
-    std::vector<e::slice> value;
-    up = up >> key >> value;
+    uint8_t flags = 0;
+    uint64_t num_items = 0;
+    up = up >> flags >> num_items;
 
     if (up.error())
     {
@@ -133,20 +166,54 @@ pending_search :: handle_message(client* cl,
         return true;
     }
 
-    hyperdex_client_returncode op_status;
-    e::error op_error;
+    // the server drops the search after sending its last batch
+    bool last = flags & 1;
+    region_id ri(cl->m_coord.config()->get_region_id(vsi));
+    e::compat::shared_ptr<e::buffer> backing(msg.release());
 
-    if (!value_to_attributes(*cl->m_coord.config(),
-                             cl->m_coord.config()->get_region_id(vsi),
-                             key.data(), key.size(), value,
-                             &op_status, &op_error, m_attrs, m_attrs_sz))
+    for (uint64_t i = 0; i < num_items; ++i)
+    {
+        e::slice key;
+        std::vector<e::slice> value;
+        up = up >> key >> value;
+
+        if (up.error())
+        {
+            PENDING_ERROR(SERVERERROR) << "communication error: server "
+                                       << vsi << " sent corrupt message="
+                                       << backing->as_slice().hex()
+                                       << " in response to a SEARCH";
+            m_yield = true;
+            return true;
+        }
+
+        // servers that had a request in flight when the limit was reached
+        // may send more than the client wants
+        if (m_received < m_limit)
+        {
+            m_results.push_back(item(ri, key, value, backing));
+            ++m_received;
+        }
+    }
+
+    if (last)
     {
-        set_status(op_status);
-        set_error(op_error);
-        m_yield = true;
         return true;
     }
 
+    // the server is holding a snapshot for the rest of its objects, so tell
+    // it to let go rather than leaving it for the lease to reclaim
+    if (m_received >= m_limit)
+    {
+        std::auto_ptr<e::buffer> smsg(e::buffer::create(HYPERDEX_CLIENT_HEADER_SIZE_REQ + sizeof(uint64_t)));
+        smsg->pack_at(HYPERDEX_CLIENT_HEADER_SIZE_REQ) << static_cast<uint64_t>(client_visible_id());
+        hyperdex_client_returncode stop_status;
+        cl->send(REQ_SEARCH_STOP, vsi, cl->m_next_server_nonce++, smsg, NULL, &stop_status);
+        return true;
+    }
+
+    // ask for the next batch right away so that it is in flight while the
+    // application consumes this one
     std::auto_ptr<e::buffer> smsg(e::buffer::create(HYPERDEX_CLIENT_HEADER_SIZE_REQ + sizeof(uint64_t)));
     smsg->pack_at(HYPERDEX_CLIENT_HEADER_SIZE_REQ) << static_cast<uint64_t>(client_visible_id());
 
@@ -157,8 +224,42 @@ pending_search :: handle_message(client* cl,
         return true;
     }
 
-    set_status(HYPERDEX_CLIENT_SUCCESS);
-    set_error(e::error());
-    m_yield = true;
     return true;
 }
+
+pending_search :: item :: item(const region_id& _ri,
+                               const e::slice& _key,
+                               const std::vector<e::slice>& _value,
+                               e::compat::shared_ptr<e::buffer> _backing)
+    : ri(_ri)
+    , key(_key)
+    , value(_value)
+    , backing(_backing)
+{
+}
+
+pending_search :: item :: item(const item& other)
+    : ri(other.ri)
+    , key(other.key)
+    , value(other.value)
+    , backing(other.backing)
+{
+}
+
+pending_search :: item :: ~item() throw ()
+{
+}
+
+pending_search::item&
+pending_search :: item :: operator = (const item& other)
+{
+    if (this != &other)
+    {
+        ri = other.ri;
+        key = other.key;
+        value = other.value;
+        backing = other.backing;
+    }
+
+    return *this;
+}
@@ -28,6 +28,12 @@
 #ifndef hyperdex_client_pending_search_h_
 #define hyperdex_client_pending_search_h_
 
+// STL
+#include <list>
+
+// e
+#include <e/compat.h>
+
 // HyperDex
 #include "namespace.h"
 #include "client/pending_aggregation.h"
@@ -37,7 +43,10 @@ BEGIN_HYPERDEX_NAMESPACE
 class pending_search : public pending_aggregation
 {
     public:
-        pending_search(uint64_t client_visible_id,
+        pending_search(client* cl,
+                       uint64_t client_visible_id,
+                       const std::vector<uint16_t>& attrnums,
+                       uint64_t limit,
                        hyperdex_client_returncode* status,
                        const hyperdex_client_attribute** attrs, size_t* attrs_sz);
         virtual ~pending_search() throw ();
@@ -60,16 +69,48 @@ class pending_search : public pending_aggregation
                                     hyperdex_client_returncode* status,
                                     e::error* error);
 
+    public:
+        class item;
+
     // noncopyable
     private:
         pending_search(const pending_search& other);
         pending_search& operator = (const pending_search& rhs);
 
     private:
+        client* m_cl;
+        // the attributes the servers send for each object, in order
+        const std::vector<uint16_t> m_attrnums;
         const hyperdex_client_attribute** m_attrs;
         size_t* m_attrs_sz;
         bool m_yield;
         bool m_done;
+        // the most objects to return, and the number received so far; once
+        // there are enough, each server's search is stopped as it replies
+        const uint64_t m_limit;
+        uint64_t m_received;
+        // objects received in a batch but not yet returned to the application
+        std::list<item> m_results;
+};
+
+class pending_search :: item
+{
+    public:
+        item(const region_id& ri,
+             const e::slice& key,
+             const std::vector<e::slice>& value,
+             e::compat::shared_ptr<e::buffer> backing);
+        item(const item&);
+        ~item() throw ();
+
+    public:
+        item& operator = (const item&);
+
+    public:
+        region_id ri;
+        e::slice key;
+        std::vector<e::slice> value;
+        e::compat::shared_ptr<e::buffer> backing;
 };
 
 END_HYPERDEX_NAMESPACE
@@ -29,7 +29,9 @@
 #include <algorithm>
 
 // HyperDex
+#include "common/serialization.h"
 #include "client/client.h"
+#include "client/constants.h"
 #include "client/pending_sorted_search.h"
 #include "client/util.h"
 
@@ -40,21 +42,33 @@ pending_sorted_search :: pending_sorted_search(client* cl,
                                                uint64_t id,
                                                bool maximize,
                                                uint64_t limit,
+                                               uint16_t sort_by_num,
                                                uint16_t sort_by_idx,
                                                datatype_info* sort_by_di,
+                                               datatype_info* key_di,
+                                               const std::vector<uint16_t>& attrnums,
+                                               size_t returned,
                                                hyperdex_client_returncode* status,
                                                const hyperdex_client_attribute** attrs,
-                                               size_t* attrs_sz)
+                                               size_t* attrs_sz,
+                                               const char** next_cursor,
+                                               size_t* next_cursor_sz)
     : pending_aggregation(id, status)
     , m_cl(cl)
     , m_yield(false)
     , m_ri()
     , m_maximize(maximize)
     , m_limit(limit)
+    , m_sort_by_num(sort_by_num)
     , m_sort_by_idx(sort_by_idx)
     , m_sort_by_di(sort_by_di)
+    , m_key_di(key_di)
+    , m_attrnums(attrnums.begin(), attrnums.begin() + returned)
     , m_attrs(attrs)
     , m_attrs_sz(attrs_sz)
+    , m_next_cursor(next_cursor)
+    , m_next_cursor_sz(next_cursor_sz)
+    , m_cursor()
     , m_results()
     , m_results_idx()
 {
@@ -91,9 +105,19 @@ pending_sorted_search :: yield(hyperdex_client_returncode* status, e::error* err
     const e::slice& key(m_results[m_results_idx].key);
     const std::vector<e::slice>& value(m_results[m_results_idx].value);
     ++m_results_idx;
+    std::vector<e::slice> returned(value.begin(), value.begin() + std::min(m_attrnums.size(), value.size()));
+
+    // the cursor lets the application ask for the objects after this one
+    if (m_next_cursor && m_sort_by_idx <= value.size())
+    {
+        const e::slice& sort_value(m_sort_by_idx == 0 ? key : value[m_sort_by_idx - 1]);
+        encode_cursor(m_sort_by_num, m_maximize, sort_value, key, &m_cursor);
+        *m_next_cursor = m_cursor.data();
+        *m_next_cursor_sz = m_cursor.size();
+    }
 
     if (!value_to_attributes(*m_cl->m_coord.config(), m_ri, key.data(), key.size(),
-                             value, &op_status, &op_error, m_attrs, m_attrs_sz))
+                             returned, m_attrnums, &op_status, &op_error, m_attrs, m_attrs_sz))
     {
         set_status(op_status);
         set_error(op_error);
@@ -135,7 +159,8 @@ class sorted_search_comparator
     public:
         sorted_search_comparator(bool maximize,
                                  uint16_t sort_by_idx,
-                                 datatype_info* sort_by_di);
+                                 datatype_info* sort_by_di,
+                                 datatype_info* key_di);
 
     public:
         bool operator () (const pending_sorted_search::item& lhs,
@@ -145,16 +170,19 @@ class sorted_search_comparator
         bool m_maximize;
         uint16_t m_sort_by_idx;
         datatype_info* m_sort_by_di;
+        datatype_info* m_key_di;
 };
 
 } // namespace
 
 sorted_search_comparator :: sorted_search_comparator(bool maximize,
                                                      uint16_t sort_by_idx,
-                                                     datatype_info* sort_by_di)
+                                                     datatype_info* sort_by_di,
+                                                     datatype_info* key_di)
     : m_maximize(maximize)
     , m_sort_by_idx(sort_by_idx)
     , m_sort_by_di(sort_by_di)
+    , m_key_di(key_di)
 {
 }
 
@@ -183,7 +211,15 @@ sorted_search_comparator :: operator () (const pending_sorted_search::item& lhs,
         rhs_attr = rhs.value[m_sort_by_idx - 1];
     }
 
+    // ties break on the key so that the order is total, as the servers'
+    // is; otherwise a cursor could not say where one page ends
     int cmp = m_sort_by_di->compare(lhs_attr, rhs_attr);
+
+    if (cmp == 0 && m_sort_by_idx != 0)
+    {
+        cmp = m_key_di->compare(lhs.key, rhs.key);
+    }
+
     return m_maximize ? (cmp > 0) : (cmp < 0);
 }
 
@@ -203,14 +239,31 @@ pending_sorted_search :: handle_message(client* cl,
     *status = HYPERDEX_CLIENT_SUCCESS;
     *err = e::error();
 
-    if (mt != RESP_SORTED_SEARCH)
+    // the last batch ends the search, so RESP_SEARCH_DONE means the server
+    // no longer has it (its lease ran out or it was evicted)
+    if (mt == RESP_SEARCH_DONE)
+    {
+        PENDING_ERROR(SERVERERROR) << "server " << vsi << " dropped the sorted search "
+                                   << "before it completed";
+        m_yield = true;
+        return true;
+    }
+    else if (mt != RESP_SEARCH_BATCH && mt != RESP_SORTED_SEARCH)
     {
         PENDING_ERROR(SERVERERROR) << "server " << vsi << " responded to SORTED_SEARCH with " << mt;
         m_yield = true;
         return true;
     }
 
+    // servers that do not stream send all of their results at once
+    uint8_t flags = 1;
     uint64_t num_results = 0;
+
+    if (mt == RESP_SEARCH_BATCH)
+    {
+        up = up >> flags;
+    }
+
     up = up >> num_results;
 
     if (up.error())
@@ -223,7 +276,8 @@ pending_sorted_search :: handle_message(client* cl,
         return true;
     }
 
-    sorted_search_comparator ssc(m_maximize, m_sort_by_idx, m_sort_by_di);
+    bool last = flags & 1;
+    sorted_search_comparator ssc(m_maximize, m_sort_by_idx, m_sort_by_di, m_key_di);
     e::compat::shared_ptr<e::buffer> backing(msg.release());
 
     for (uint64_t i = 0; i < num_results; ++i)
@@ -236,7 +290,7 @@ pending_sorted_search :: handle_message(client* cl,
         {
             PENDING_ERROR(SERVERERROR) << "communication error: server "
                                        << vsi << " sent corrupt message="
-                                       << msg->as_slice().hex()
+                                       << backing->as_slice().hex()
                                        << " in response to a SORTED_SEARCH";
             m_yield = true;
             return true;
@@ -252,6 +306,13 @@ pending_sorted_search :: handle_message(client* cl,
         }
     }
 
+    if (!last && !send_next(cl, vsi, status))
+    {
+        PENDING_ERROR(RECONFIGURE) << "could not send SEARCH_NEXT to " << vsi;
+        m_yield = true;
+        return true;
+    }
+
     m_yield = this->aggregation_done();
     set_status(HYPERDEX_CLIENT_SUCCESS);
     set_error(e::error());
@@ -264,6 +325,37 @@ pending_sorted_search :: handle_message(client* cl,
     return true;
 }
 
+bool
+pending_sorted_search :: send_next(client* cl,
+                                   const virtual_server_id& vsi,
+                                   hyperdex_client_returncode* status)
+{
+    // once there are limit results, the worst of them is the bound a server's
+    // next object must beat; the server stops at the first that does not
+    bool bounded = m_limit > 0 && m_results.size() >= m_limit;
+    e::slice bound;
+
+    if (bounded)
+    {
+        const item& kth(m_results.front());
+        bound = m_sort_by_idx == 0 ? kth.key : kth.value[m_sort_by_idx - 1];
+    }
+
+    size_t sz = HYPERDEX_CLIENT_HEADER_SIZE_REQ
+              + sizeof(uint64_t)
+              + (bounded ? pack_size(bound) : 0);
+    std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
+    e::buffer::packer pa = msg->pack_at(HYPERDEX_CLIENT_HEADER_SIZE_REQ);
+    pa = pa << static_cast<uint64_t>(client_visible_id());
+
+    if (bounded)
+    {
+        pa = pa << bound;
+    }
+
+    return cl->send(REQ_SEARCH_NEXT, vsi, cl->m_next_server_nonce++, msg, this, status);
+}
+
 pending_sorted_search :: item :: item(const e::slice& _key,
                                       const std::vector<e::slice>& _value,
                                       e::compat::shared_ptr<e::buffer> _backing)
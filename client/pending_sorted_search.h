@@ -28,6 +28,9 @@
 #ifndef hyperdex_client_pending_sorted_search_h_
 #define hyperdex_client_pending_sorted_search_h_
 
+// STL
+#include <string>
+
 // e
 #include <e/compat.h>
 
@@ -45,11 +48,17 @@ class pending_sorted_search : public pending_aggregation
                               uint64_t id,
                               bool maximize,
                               uint64_t limit,
+                              uint16_t sort_by_num,
                               uint16_t sort_by_idx,
                               datatype_info* sort_by_di,
+                              datatype_info* key_di,
+                              const std::vector<uint16_t>& attrnums,
+                              size_t returned,
                               hyperdex_client_returncode* status,
                               const hyperdex_client_attribute** attrs,
-                              size_t* attrs_sz);
+                              size_t* attrs_sz,
+                              const char** next_cursor,
+                              size_t* next_cursor_sz);
         virtual ~pending_sorted_search() throw ();
 
     // return to client
@@ -75,6 +84,12 @@ class pending_sorted_search : public pending_aggregation
     public:
         class item;
 
+    private:
+        // ask the server for its next batch, passing it the current bound
+        bool send_next(client* cl,
+                       const virtual_server_id& vsi,
+                       hyperdex_client_returncode* status);
+
     // noncopyable
     private:
         pending_sorted_search(const pending_sorted_search& other);
@@ -86,10 +101,21 @@ class pending_sorted_search : public pending_aggregation
         region_id m_ri;
         bool m_maximize;
         const uint64_t m_limit;
+        const uint16_t m_sort_by_num;
         const uint16_t m_sort_by_idx;
         datatype_info* m_sort_by_di;
+        datatype_info* m_key_di;
+        // the attributes returned to the application; the servers send these
+        // first, followed by the sort attribute if it is not among them
+        const std::vector<uint16_t> m_attrnums;
         const hyperdex_client_attribute** m_attrs;
         size_t* m_attrs_sz;
+        // where to put the cursor for each object returned, if anywhere
+        const char** m_next_cursor;
+        size_t* m_next_cursor_sz;
+        std::string m_cursor;
+        // a heap of the best results so far, worst first, until all servers
+        // finish and it is sorted for the application
         std::vector<item> m_results;
         size_t m_results_idx;
 };
@@ -0,0 +1,105 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+// C
+#include <stdint.h>
+
+// STL
+#include <string>
+
+// HyperDex
+#include "test/th.h"
+#include "client/util.h"
+
+namespace
+{
+
+// encode, decode, and check that every field comes back unchanged
+void
+round_trip(uint16_t sort_by, bool maximize,
+           const std::string& value, const std::string& key)
+{
+    std::string cursor;
+    hyperdex::encode_cursor(sort_by, maximize, e::slice(value), e::slice(key), &cursor);
+    uint16_t s = 0;
+    bool m = !maximize;
+    e::slice v;
+    e::slice k;
+    ASSERT_TRUE(hyperdex::decode_cursor(cursor.data(), cursor.size(), &s, &m, &v, &k));
+    ASSERT_EQ(s, sort_by);
+    ASSERT_EQ(m, maximize);
+    ASSERT_EQ(v.str(), value);
+    ASSERT_EQ(k.str(), key);
+    // the decoded slices refer to the cursor itself
+    ASSERT_TRUE(v.cdata() >= cursor.data() && v.cdata() + v.size() <= cursor.data() + cursor.size());
+    ASSERT_TRUE(k.cdata() >= cursor.data() && k.cdata() + k.size() <= cursor.data() + cursor.size());
+}
+
+bool
+decodes(const std::string& cursor)
+{
+    uint16_t s;
+    bool m;
+    e::slice v;
+    e::slice k;
+    return hyperdex::decode_cursor(cursor.data(), cursor.size(), &s, &m, &v, &k);
+}
+
+} // namespace
+
+TEST(ClientCursor, RoundTrip)
+{
+    round_trip(1, false, "value", "key");
+    round_trip(1, true, "value", "key");
+    round_trip(0, false, "", "key");
+    round_trip(UINT16_MAX, true, "value", "");
+    round_trip(2, false, "", "");
+    round_trip(3, true, std::string("\x00\x01\xff", 3), std::string("k\x00y", 3));
+    round_trip(4, false, std::string(1024, 'v'), std::string(512, 'k'));
+}
+
+TEST(ClientCursor, RejectsMalformed)
+{
+    std::string cursor;
+    hyperdex::encode_cursor(7, true, e::slice("value"), e::slice("key"), &cursor);
+    ASSERT_TRUE(decodes(cursor));
+    ASSERT_FALSE(decodes(""));
+
+    // every truncation is rejected, as is anything trailing
+    for (size_t i = 0; i < cursor.size(); ++i)
+    {
+        ASSERT_FALSE(decodes(cursor.substr(0, i)));
+    }
+
+    ASSERT_FALSE(decodes(cursor + "x"));
+
+    // the direction is a single flag
+    std::string bad(cursor);
+    bad[sizeof(uint16_t)] = 2;
+    ASSERT_FALSE(decodes(bad));
+}
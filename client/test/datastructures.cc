@@ -99,6 +99,23 @@ TEST(ClientDataStructures, AllocateMapAttribute)
     hyperdex_ds_arena_destroy(a);
 }
 
+TEST(ClientDataStructures, AllocateArrays)
+{
+    hyperdex_ds_arena* a = hyperdex_ds_arena_create();
+    const char** strs = hyperdex_ds_allocate_string_array(a, 10);
+    size_t* sizes = hyperdex_ds_allocate_size_array(a, 10);
+    ASSERT_TRUE(strs != NULL);
+    ASSERT_TRUE(sizes != NULL);
+
+    for (size_t i = 0; i < 10; ++i)
+    {
+        strs[i] = "FOOBAR";
+        sizes[i] = 6;
+    }
+
+    hyperdex_ds_arena_destroy(a);
+}
+
 TEST(ClientDataStructures, PackInt)
 {
     char buf[sizeof(int64_t)];
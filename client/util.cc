@@ -26,6 +26,7 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 // e
+#include <e/buffer.h>
 #include <e/endian.h>
 #include <e/guard.h>
 
@@ -38,37 +39,34 @@
     op_error->set_loc(__FILE__, __LINE__); \
     op_error->set_msg()
 
-bool
-hyperdex :: value_to_attributes(const configuration& config,
-                                const region_id& rid,
-                                const uint8_t* key,
-                                size_t key_sz,
-                                const std::vector<e::slice>& value,
-                                hyperdex_client_returncode* op_status,
-                                e::error* op_error,
-                                const hyperdex_client_attribute** attrs,
-                                size_t* attrs_sz)
+namespace
 {
-    const schema* sc = config.get_schema(rid);
-
-    if (value.size() + 1 != sc->attrs_sz)
-    {
-        UTIL_ERROR(SERVERERROR) << "received object with " << value.size()
-                                << " attributes instead of "
-                                << sc->attrs_sz - 1 << " attributes";
-        return false;
-    }
 
-    size_t sz = sizeof(hyperdex_client_attribute) * sc->attrs_sz + key_sz
+// Pack the key and the attributes "attrnums[i]" = "value[i]" into a single
+// malloc'd array of hyperdex_client_attribute.  A NULL "attrnums" means that
+// "value" holds every attribute of the schema.
+bool
+pack_attributes(const hyperdex::schema* sc,
+                const uint8_t* key,
+                size_t key_sz,
+                const std::vector<e::slice>& value,
+                const std::vector<uint16_t>* attrnums,
+                hyperdex_client_returncode* op_status,
+                e::error* op_error,
+                const hyperdex_client_attribute** attrs,
+                size_t* attrs_sz)
+{
+    size_t sz = sizeof(hyperdex_client_attribute) * (value.size() + 1) + key_sz
               + strlen(sc->attrs[0].name) + 1;
 
     for (size_t i = 0; i < value.size(); ++i)
     {
-        sz += strlen(sc->attrs[i + 1].name) + 1 + value[i].size();
+        uint16_t attr = attrnums ? (*attrnums)[i] : i + 1;
+        sz += strlen(sc->attrs[attr].name) + 1 + value[i].size();
     }
 
     std::vector<hyperdex_client_attribute> ha;
-    ha.reserve(sc->attrs_sz);
+    ha.reserve(value.size() + 1);
     char* ret = static_cast<char*>(malloc(sz));
 
     if (!ret)
@@ -97,19 +95,24 @@ hyperdex :: value_to_attributes(const configuration& config,
 
     for (size_t i = 0; i < value.size(); ++i)
     {
+        uint16_t attr = attrnums ? (*attrnums)[i] : i + 1;
         ha.push_back(hyperdex_client_attribute());
-        size_t attr_sz = strlen(sc->attrs[i + 1].name) + 1;
+        size_t attr_sz = strlen(sc->attrs[attr].name) + 1;
         ha.back().attr = data;
-        memmove(data, sc->attrs[i + 1].name, attr_sz);
+        memmove(data, sc->attrs[attr].name, attr_sz);
         data += attr_sz;
         ha.back().value = data;
         memmove(data, value[i].data(), value[i].size());
         data += value[i].size();
         ha.back().value_sz = value[i].size();
-        ha.back().datatype = sc->attrs[i + 1].type;
+        ha.back().datatype = sc->attrs[attr].type;
+    }
+
+    if (!ha.empty())
+    {
+        memmove(ret, &ha.front(), sizeof(hyperdex_client_attribute) * ha.size());
     }
 
-    memmove(ret, &ha.front(), sizeof(hyperdex_client_attribute) * ha.size());
     *op_status = HYPERDEX_CLIENT_SUCCESS;
     *op_error = e::error();
     *attrs = reinterpret_cast<hyperdex_client_attribute*>(ret);
@@ -117,3 +120,88 @@ hyperdex :: value_to_attributes(const configuration& config,
     g.dismiss();
     return true;
 }
+
+} // namespace
+
+bool
+hyperdex :: value_to_attributes(const configuration& config,
+                                const region_id& rid,
+                                const uint8_t* key,
+                                size_t key_sz,
+                                const std::vector<e::slice>& value,
+                                hyperdex_client_returncode* op_status,
+                                e::error* op_error,
+                                const hyperdex_client_attribute** attrs,
+                                size_t* attrs_sz)
+{
+    const schema* sc = config.get_schema(rid);
+
+    if (value.size() + 1 != sc->attrs_sz)
+    {
+        UTIL_ERROR(SERVERERROR) << "received object with " << value.size()
+                                << " attributes instead of "
+                                << sc->attrs_sz - 1 << " attributes";
+        return false;
+    }
+
+    return pack_attributes(sc, key, key_sz, value, NULL,
+                           op_status, op_error, attrs, attrs_sz);
+}
+
+bool
+hyperdex :: value_to_attributes(const configuration& config,
+                                const region_id& rid,
+                                const uint8_t* key,
+                                size_t key_sz,
+                                const std::vector<e::slice>& value,
+                                const std::vector<uint16_t>& attrnums,
+                                hyperdex_client_returncode* op_status,
+                                e::error* op_error,
+                                const hyperdex_client_attribute** attrs,
+                                size_t* attrs_sz)
+{
+    const schema* sc = config.get_schema(rid);
+
+    if (value.size() != attrnums.size())
+    {
+        UTIL_ERROR(SERVERERROR) << "received object with " << value.size()
+                                << " attributes instead of the "
+                                << attrnums.size() << " requested attributes";
+        return false;
+    }
+
+    if (!sc->valid_projection(attrnums))
+    {
+        UTIL_ERROR(RECONFIGURE) << "the space changed while the operation was outstanding";
+        return false;
+    }
+
+    return pack_attributes(sc, key, key_sz, value, &attrnums,
+                           op_status, op_error, attrs, attrs_sz);
+}
+
+void
+hyperdex :: encode_cursor(uint16_t sort_by, bool maximize,
+                          const e::slice& value, const e::slice& key,
+                          std::string* cursor)
+{
+    uint8_t max = maximize ? 1 : 0;
+    size_t sz = sizeof(sort_by) + sizeof(max)
+              + sizeof(uint32_t) + value.size()
+              + sizeof(uint32_t) + key.size();
+    std::auto_ptr<e::buffer> buf(e::buffer::create(sz));
+    buf->pack_at(0) << sort_by << max << value << key;
+    cursor->assign(reinterpret_cast<const char*>(buf->data()), buf->size());
+}
+
+bool
+hyperdex :: decode_cursor(const char* cursor, size_t cursor_sz,
+                          uint16_t* sort_by, bool* maximize,
+                          e::slice* value, e::slice* key)
+{
+    uint8_t max = 0;
+    e::unpacker up(e::slice(cursor, cursor_sz));
+    up = up >> *sort_by >> max >> *value >> *key;
+    *maximize = max != 0;
+    return !up.error() && up.remain() == 0 && max <= 1;
+}
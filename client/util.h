@@ -28,6 +28,9 @@
 #ifndef hyperdex_client_util_h_
 #define hyperdex_client_util_h_
 
+// STL
+#include <string>
+
 // e
 #include <e/error.h>
 
@@ -51,6 +54,31 @@ value_to_attributes(const configuration& config,
                     e::error* op_error,
                     const hyperdex_client_attribute** attrs,
                     size_t* attrs_sz);
+// As above, but "value" holds only the attributes numbered in "attrnums", in
+// that order.
+bool
+value_to_attributes(const configuration& config,
+                    const region_id& rid,
+                    const uint8_t* key,
+                    size_t key_sz,
+                    const std::vector<e::slice>& value,
+                    const std::vector<uint16_t>& attrnums,
+                    hyperdex_client_returncode* op_status,
+                    e::error* op_error,
+                    const hyperdex_client_attribute** attrs,
+                    size_t* attrs_sz);
+
+// A cursor names the position of an object in a sorted search: the attribute
+// sorted by, the direction, and the object's sort value and key.  The
+// decoded slices point into "cursor".
+void
+encode_cursor(uint16_t sort_by, bool maximize,
+              const e::slice& value, const e::slice& key,
+              std::string* cursor);
+bool
+decode_cursor(const char* cursor, size_t cursor_sz,
+              uint16_t* sort_by, bool* maximize,
+              e::slice* value, e::slice* key);
 
 END_HYPERDEX_NAMESPACE
 
@@ -33,6 +33,7 @@
 #include <sstream>
 
 // HyperDex
+#include "cityhash/city.h"
 #include "common/configuration.h"
 #include "common/configuration_flags.h"
 #include "common/hash.h"
@@ -40,6 +41,7 @@
 #include "common/serialization.h"
 
 using hyperdex::configuration;
+using hyperdex::region;
 using hyperdex::region_id;
 using hyperdex::schema;
 using hyperdex::server;
@@ -64,6 +66,9 @@ configuration :: configuration()
     , m_tails_by_region()
     , m_next_by_virtual()
     , m_point_leaders_by_virtual()
+    , m_spaces_by_name()
+    , m_spaces_by_region()
+    , m_key_regions_by_space()
     , m_spaces()
     , m_transfers()
 {
@@ -86,6 +91,9 @@ configuration :: configuration(const configuration& other)
     , m_tails_by_region(other.m_tails_by_region)
     , m_next_by_virtual(other.m_next_by_virtual)
     , m_point_leaders_by_virtual(other.m_point_leaders_by_virtual)
+    , m_spaces_by_name()
+    , m_spaces_by_region()
+    , m_key_regions_by_space()
     , m_spaces(other.m_spaces)
     , m_transfers(other.m_transfers)
 {
@@ -203,15 +211,8 @@ configuration :: get_server_id(const virtual_server_id& id) const
 const schema*
 configuration :: get_schema(const char* sname) const
 {
-    for (size_t s = 0; s < m_spaces.size(); ++s)
-    {
-        if (strcmp(sname, m_spaces[s].name) == 0)
-        {
-            return &m_spaces[s].sc;
-        }
-    }
-
-    return NULL;
+    size_t s = space_index(sname);
+    return s < m_spaces.size() ? &m_spaces[s].sc : NULL;
 }
 
 const schema*
@@ -424,73 +425,43 @@ configuration :: is_point_leader(const virtual_server_id& e) const
 virtual_server_id
 configuration :: point_leader(const char* sname, const e::slice& key) const
 {
-    for (size_t s = 0; s < m_spaces.size(); ++s)
-    {
-        if (strcmp(sname, m_spaces[s].name) != 0)
-        {
-            continue;
-        }
+    size_t s = space_index(sname);
 
-        uint64_t h;
-        hash(m_spaces[s].sc, key, &h);
+    if (s >= m_spaces.size())
+    {
+        return virtual_server_id();
+    }
 
-        for (size_t pl = 0; pl < m_spaces[s].subspaces[0].regions.size(); ++pl)
-        {
-            if (m_spaces[s].subspaces[0].regions[pl].lower_coord[0] <= h &&
-                h <= m_spaces[s].subspaces[0].regions[pl].upper_coord[0])
-            {
-                if (m_spaces[s].subspaces[0].regions[pl].replicas.empty())
-                {
-                    return virtual_server_id();
-                }
+    const region& r(key_region(s, key));
+    return r.replicas.empty() ? virtual_server_id() : r.replicas[0].vsi;
+}
 
-                return m_spaces[s].subspaces[0].regions[pl].replicas[0].vsi;
-            }
-        }
+virtual_server_id
+configuration :: point_replica(const char* sname, const e::slice& key, uint64_t n) const
+{
+    size_t s = space_index(sname);
 
-        abort();
+    if (s >= m_spaces.size())
+    {
+        return virtual_server_id();
     }
 
-    return virtual_server_id();
+    const region& r(key_region(s, key));
+    return r.replicas.empty() ? virtual_server_id() : r.replicas[n % r.replicas.size()].vsi;
 }
 
 virtual_server_id
 configuration :: point_leader(const region_id& rid, const e::slice& key) const
 {
-    for (size_t s = 0; s < m_spaces.size(); ++s)
-    {
-        for (size_t ss = 0; ss < m_spaces[s].subspaces.size(); ++ss)
-        {
-            for (size_t r = 0; r < m_spaces[s].subspaces[ss].regions.size(); ++r)
-            {
-                if (m_spaces[s].subspaces[ss].regions[r].id != rid)
-                {
-                    continue;
-                }
-
-                uint64_t h;
-                hash(m_spaces[s].sc, key, &h);
-
-                for (size_t pl = 0; pl < m_spaces[s].subspaces[0].regions.size(); ++pl)
-                {
-                    if (m_spaces[s].subspaces[0].regions[pl].lower_coord[0] <= h &&
-                        h <= m_spaces[s].subspaces[0].regions[pl].upper_coord[0])
-                    {
-                        if (m_spaces[s].subspaces[0].regions[pl].replicas.empty())
-                        {
-                            return virtual_server_id();
-                        }
-
-                        return m_spaces[s].subspaces[0].regions[pl].replicas[0].vsi;
-                    }
-                }
+    size_t s = space_index(rid);
 
-                abort();
-            }
-        }
+    if (s >= m_spaces.size())
+    {
+        return virtual_server_id();
     }
 
-    return virtual_server_id();
+    const region& r(key_region(s, key));
+    return r.replicas.empty() ? virtual_server_id() : r.replicas[0].vsi;
 }
 
 bool
@@ -658,16 +629,8 @@ configuration :: lookup_search(const char* space_name,
                                const std::vector<attribute_check>& chks,
                                std::vector<virtual_server_id>* servers) const
 {
-    const space* s = NULL;
-
-    for (size_t i = 0; i < m_spaces.size(); ++i)
-    {
-        if (strcmp(space_name, m_spaces[i].name) == 0)
-        {
-            s = &m_spaces[i];
-            break;
-        }
-    }
+    size_t idx = space_index(space_name);
+    const space* s = idx < m_spaces.size() ? &m_spaces[idx] : NULL;
 
     if (!s)
     {
@@ -935,10 +898,15 @@ configuration :: refill_cache()
     m_tails_by_region.clear();
     m_next_by_virtual.clear();
     m_point_leaders_by_virtual.clear();
+    m_spaces_by_name.clear();
+    m_spaces_by_region.clear();
+    m_key_regions_by_space.clear();
+    m_key_regions_by_space.resize(m_spaces.size());
 
     for (size_t w = 0; w < m_spaces.size(); ++w)
     {
         space& s(m_spaces[w]);
+        m_spaces_by_name.push_back(std::make_pair(CityHash64(s.name, strlen(s.name)), w));
 
         for (size_t x = 0; x < s.subspaces.size(); ++x)
         {
@@ -962,6 +930,12 @@ configuration :: refill_cache()
                 m_schemas_by_region.push_back(std::make_pair(r.id.get(), &s.sc));
                 m_subspaces_by_region.push_back(std::make_pair(r.id.get(), &ss));
                 m_subspace_ids_by_region.push_back(std::make_pair(r.id.get(), ss.id.get()));
+                m_spaces_by_region.push_back(std::make_pair(r.id.get(), w));
+
+                if (x == 0 && !r.upper_coord.empty())
+                {
+                    m_key_regions_by_space[w].push_back(std::make_pair(r.upper_coord[0], &r));
+                }
 
                 if (r.replicas.empty())
                 {
@@ -1014,6 +988,69 @@ configuration :: refill_cache()
     std::sort(m_tails_by_region.begin(), m_tails_by_region.end());
     std::sort(m_next_by_virtual.begin(), m_next_by_virtual.end());
     std::sort(m_point_leaders_by_virtual.begin(), m_point_leaders_by_virtual.end());
+    std::sort(m_spaces_by_name.begin(), m_spaces_by_name.end());
+    std::sort(m_spaces_by_region.begin(), m_spaces_by_region.end());
+
+    for (size_t i = 0; i < m_key_regions_by_space.size(); ++i)
+    {
+        std::sort(m_key_regions_by_space[i].begin(), m_key_regions_by_space[i].end());
+    }
+}
+
+size_t
+configuration :: space_index(const char* sname) const
+{
+    uint64_t h = CityHash64(sname, strlen(sname));
+    std::vector<pair_uint64_t>::const_iterator it;
+    it = std::lower_bound(m_spaces_by_name.begin(),
+                          m_spaces_by_name.end(),
+                          pair_uint64_t(h, 0));
+
+    for (; it != m_spaces_by_name.end() && it->first == h; ++it)
+    {
+        if (strcmp(sname, m_spaces[it->second].name) == 0)
+        {
+            return it->second;
+        }
+    }
+
+    return m_spaces.size();
+}
+
+size_t
+configuration :: space_index(const region_id& ri) const
+{
+    std::vector<pair_uint64_t>::const_iterator it;
+    it = std::lower_bound(m_spaces_by_region.begin(),
+                          m_spaces_by_region.end(),
+                          pair_uint64_t(ri.get(), 0));
+
+    if (it != m_spaces_by_region.end() && it->first == ri.get())
+    {
+        return it->second;
+    }
+
+    return m_spaces.size();
+}
+
+const region&
+configuration :: key_region(size_t s, const e::slice& key) const
+{
+    uint64_t h;
+    hash(m_spaces[s].sc, key, &h);
+    // the regions of the key subspace partition the hash space, so the
+    // first region whose upper bound is not below "h" holds the key
+    const std::vector<uint64_region_t>& regions(m_key_regions_by_space[s]);
+    std::vector<uint64_region_t>::const_iterator it;
+    it = std::lower_bound(regions.begin(), regions.end(),
+                          uint64_region_t(h, NULL));
+
+    if (it == regions.end() || it->second->lower_coord[0] > h)
+    {
+        abort();
+    }
+
+    return *it->second;
 }
 
 e::unpacker
@@ -88,6 +88,9 @@ class configuration
         void key_regions(const server_id& s, std::vector<region_id>* servers) const;
         bool is_point_leader(const virtual_server_id& e) const;
         virtual_server_id point_leader(const char* space, const e::slice& key) const;
+        // one of the replicas in the point leader's region; "n" picks which,
+        // modulo the length of the chain
+        virtual_server_id point_replica(const char* space, const e::slice& key, uint64_t n) const;
         // point leader for this key in the same space as ri
         virtual_server_id point_leader(const region_id& ri, const e::slice& key) const;
         // lhs and rhs are in adjacent subspaces such that lhs sends CHAIN_PUT
@@ -127,6 +130,12 @@ class configuration
 
     private:
         void refill_cache();
+        // index in m_spaces of the named space, or m_spaces.size()
+        size_t space_index(const char* space) const;
+        // index in m_spaces of the space holding "ri", or m_spaces.size()
+        size_t space_index(const region_id& ri) const;
+        // the region of the key subspace of m_spaces[s] that holds "key"
+        const region& key_region(size_t s, const e::slice& key) const;
         friend size_t pack_size(const configuration&);
         friend e::buffer::packer operator << (e::buffer::packer, const configuration& s);
         friend e::unpacker operator >> (e::unpacker, configuration& s);
@@ -136,6 +145,7 @@ class configuration
         typedef std::pair<uint64_t, schema*> uint64_schema_t;
         typedef std::pair<uint64_t, subspace*> uint64_subspace_t;
         typedef std::pair<uint64_t, po6::net::location> uint64_location_t;
+        typedef std::pair<uint64_t, region*> uint64_region_t;
 
     private:
         uint64_t m_cluster;
@@ -153,6 +163,12 @@ class configuration
         std::vector<pair_uint64_t> m_tails_by_region;
         std::vector<pair_uint64_t> m_next_by_virtual;
         std::vector<uint64_t> m_point_leaders_by_virtual;
+        // (CityHash64 of name, index in m_spaces)
+        std::vector<pair_uint64_t> m_spaces_by_name;
+        // (region, index in m_spaces)
+        std::vector<pair_uint64_t> m_spaces_by_region;
+        // for each space, its key subspace's regions keyed by upper_coord[0]
+        std::vector<std::vector<uint64_region_t> > m_key_regions_by_space;
         std::vector<space> m_spaces;
         std::vector<transfer> m_transfers;
 };
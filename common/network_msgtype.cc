@@ -36,13 +36,19 @@ hyperdex :: operator << (std::ostream& lhs, const network_msgtype& rhs)
     {
         STRINGIFY(REQ_GET);
         STRINGIFY(RESP_GET);
+        STRINGIFY(REQ_GET_PARTIAL);
+        STRINGIFY(RESP_GET_PARTIAL);
+        STRINGIFY(REQ_GET_MANY);
+        STRINGIFY(RESP_GET_MANY);
         STRINGIFY(REQ_ATOMIC);
         STRINGIFY(RESP_ATOMIC);
+        STRINGIFY(REQ_ATOMIC_MANY);
+        STRINGIFY(RESP_ATOMIC_MANY);
         STRINGIFY(REQ_SEARCH_START);
         STRINGIFY(REQ_SEARCH_NEXT);
         STRINGIFY(REQ_SEARCH_STOP);
-        STRINGIFY(RESP_SEARCH_ITEM);
         STRINGIFY(RESP_SEARCH_DONE);
+        STRINGIFY(RESP_SEARCH_BATCH);
         STRINGIFY(REQ_SORTED_SEARCH);
         STRINGIFY(RESP_SORTED_SEARCH);
         STRINGIFY(REQ_GROUP_DEL);
@@ -55,12 +61,19 @@ hyperdex :: operator << (std::ostream& lhs, const network_msgtype& rhs)
         STRINGIFY(CHAIN_SUBSPACE);
         STRINGIFY(CHAIN_ACK);
         STRINGIFY(CHAIN_GC);
+        STRINGIFY(CHAIN_BATCH);
+        STRINGIFY(CHAIN_READ);
+        STRINGIFY(CHAIN_READ_RESP);
         STRINGIFY(XFER_OP);
         STRINGIFY(XFER_ACK);
         STRINGIFY(XFER_HS);
         STRINGIFY(XFER_HSA);
         STRINGIFY(XFER_HA);
         STRINGIFY(XFER_HW);
+        STRINGIFY(XFER_CHUNK);
+        STRINGIFY(XFER_TREE);
+        STRINGIFY(XFER_DIFF);
+        STRINGIFY(THROTTLE);
         STRINGIFY(BACKUP);
         STRINGIFY(PERF_COUNTERS);
         STRINGIFY(CONFIGMISMATCH);
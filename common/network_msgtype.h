@@ -40,15 +40,21 @@ enum network_msgtype
 {
     REQ_GET         = 8,
     RESP_GET        = 9,
+    REQ_GET_PARTIAL     = 10,
+    RESP_GET_PARTIAL    = 11,
+    REQ_GET_MANY        = 12,
+    RESP_GET_MANY       = 13,
 
     REQ_ATOMIC      = 16,
     RESP_ATOMIC     = 17,
+    REQ_ATOMIC_MANY     = 18,
+    RESP_ATOMIC_MANY    = 19,
 
     REQ_SEARCH_START    = 32,
     REQ_SEARCH_NEXT     = 33,
     REQ_SEARCH_STOP     = 34,
-    RESP_SEARCH_ITEM    = 35,
     RESP_SEARCH_DONE    = 36,
+    RESP_SEARCH_BATCH   = 37,
 
     REQ_SORTED_SEARCH   = 40,
     RESP_SORTED_SEARCH  = 41,
@@ -66,6 +72,9 @@ enum network_msgtype
     CHAIN_SUBSPACE  = 65,
     CHAIN_ACK       = 66,
     CHAIN_GC        = 67,
+    CHAIN_BATCH     = 68, // several CHAIN_OP/SUBSPACE/ACK for one destination
+    CHAIN_READ      = 69, // a replica asks the tail for the committed value
+    CHAIN_READ_RESP = 70,
 
     XFER_OP  = 80,
     XFER_ACK = 81,
@@ -73,7 +82,11 @@ enum network_msgtype
     XFER_HSA = 83, // handshake syn-ack
     XFER_HA  = 84, // handshake ack
     XFER_HW  = 85, // wiped
+    XFER_CHUNK = 86, // raw entries from a region dump, for bulk migration
+    XFER_TREE = 87, // leaves of the receiver's region_tree
+    XFER_DIFF = 88, // leaves where the receiver's copy differs
 
+    THROTTLE = 125,
     BACKUP = 126,
     PERF_COUNTERS = 127,
 
@@ -26,6 +26,7 @@
 // POSSIBILITY OF SUCH DAMAGE.
 
 // C
+#include <cassert>
 #include <cstring>
 
 // HyperDex
@@ -52,3 +53,31 @@ schema :: lookup_attr(const char* name) const
 
     return attrs_sz;
 }
+
+bool
+schema :: valid_projection(const std::vector<uint16_t>& attrnums) const
+{
+    for (size_t i = 0; i < attrnums.size(); ++i)
+    {
+        if (attrnums[i] == 0 || attrnums[i] >= attrs_sz)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void
+schema :: project(const std::vector<e::slice>& value,
+                  const std::vector<uint16_t>& attrnums,
+                  std::vector<e::slice>* projected) const
+{
+    assert(value.size() + 1 == attrs_sz);
+    projected->resize(attrnums.size());
+
+    for (size_t i = 0; i < attrnums.size(); ++i)
+    {
+        (*projected)[i] = value[attrnums[i] - 1];
+    }
+}
@@ -31,6 +31,12 @@
 // C
 #include <stdint.h>
 
+// STL
+#include <vector>
+
+// e
+#include <e/slice.h>
+
 // HyperDex
 #include "namespace.h"
 #include "common/attribute.h"
@@ -44,6 +50,12 @@ class schema
 
     public:
         uint16_t lookup_attr(const char* name) const;
+        // true if every entry of "attrnums" is a non-key attribute
+        bool valid_projection(const std::vector<uint16_t>& attrnums) const;
+        // select attributes "attrnums" (in that order) from a full value
+        void project(const std::vector<e::slice>& value,
+                     const std::vector<uint16_t>& attrnums,
+                     std::vector<e::slice>* projected) const;
 
     public:
         uint16_t attrs_sz;
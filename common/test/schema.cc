@@ -0,0 +1,88 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// HyperDex
+#include "test/th.h"
+#include "common/attribute.h"
+#include "common/schema.h"
+
+using hyperdex::attribute;
+using hyperdex::schema;
+
+namespace
+{
+
+const attribute attrs[] = {attribute("k", HYPERDATATYPE_STRING),
+                           attribute("a", HYPERDATATYPE_STRING),
+                           attribute("b", HYPERDATATYPE_INT64),
+                           attribute("c", HYPERDATATYPE_STRING)};
+
+schema
+make_schema()
+{
+    schema sc;
+    sc.attrs_sz = 4;
+    sc.attrs = attrs;
+    return sc;
+}
+
+} // namespace
+
+TEST(Schema, ValidProjection)
+{
+    schema sc(make_schema());
+    std::vector<uint16_t> attrnums;
+    ASSERT_TRUE(sc.valid_projection(attrnums));
+    attrnums.push_back(3);
+    attrnums.push_back(1);
+    ASSERT_TRUE(sc.valid_projection(attrnums));
+    attrnums.push_back(0);
+    ASSERT_FALSE(sc.valid_projection(attrnums));
+    attrnums.back() = 4;
+    ASSERT_FALSE(sc.valid_projection(attrnums));
+}
+
+TEST(Schema, Project)
+{
+    schema sc(make_schema());
+    std::vector<e::slice> value;
+    value.push_back(e::slice("A", 1));
+    value.push_back(e::slice("BB", 2));
+    value.push_back(e::slice("CCC", 3));
+    std::vector<uint16_t> attrnums;
+    std::vector<e::slice> projected;
+
+    sc.project(value, attrnums, &projected);
+    ASSERT_EQ(0U, projected.size());
+
+    attrnums.push_back(3);
+    attrnums.push_back(1);
+    sc.project(value, attrnums, &projected);
+    ASSERT_EQ(2U, projected.size());
+    ASSERT_TRUE(projected[0] == value[2]);
+    ASSERT_TRUE(projected[1] == value[0]);
+}
@@ -25,20 +25,27 @@
 // ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
 // POSSIBILITY OF SUCH DAMAGE.
 
+#define __STDC_LIMIT_MACROS
+
 // POSIX
 #include <dirent.h>
+#include <fcntl.h>
 #include <signal.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
 // STL
+#include <algorithm>
 #include <sstream>
 
 // Google Log
 #include <glog/logging.h>
 #include <glog/raw_logging.h>
 
+// po6
+#include <po6/io/fd.h>
+
 // e
 #include <e/endian.h>
 #include <e/strescape.h>
@@ -48,6 +55,7 @@
 #include "common/coordinator_returncode.h"
 #include "common/serialization.h"
 #include "daemon/daemon.h"
+#include "daemon/replication_manager_batch.h"
 
 #ifdef __APPLE__
 #include <mach/mach.h>
@@ -110,9 +118,13 @@ daemon :: daemon()
     , m_repl(this)
     , m_stm(this)
     , m_sm(this)
+    , m_pool(this)
+    , m_xfer_throttle()
+    , m_wipe_throttle()
     , m_config()
     , m_perf_req_get()
     , m_perf_req_atomic()
+    , m_perf_req_atomic_many()
     , m_perf_req_search_start()
     , m_perf_req_search_next()
     , m_perf_req_search_stop()
@@ -124,19 +136,32 @@ daemon :: daemon()
     , m_perf_chain_subspace()
     , m_perf_chain_ack()
     , m_perf_chain_gc()
+    , m_perf_chain_batch()
+    , m_perf_chain_read()
     , m_perf_xfer_handshake_syn()
     , m_perf_xfer_handshake_synack()
     , m_perf_xfer_handshake_ack()
     , m_perf_xfer_handshake_wiped()
     , m_perf_xfer_op()
     , m_perf_xfer_ack()
+    , m_perf_xfer_chunk()
+    , m_perf_xfer_tree()
+    , m_perf_xfer_diff()
     , m_perf_backup()
     , m_perf_perf_counters()
+    , m_perf_throttle()
     , m_block_stat_path()
     , m_stat_collector(make_thread_wrapper(&daemon::collect_stats, this))
     , m_protect_stats()
     , m_stats_start(0)
     , m_stats()
+    , m_backup_thread(make_thread_wrapper(&daemon::run_backups, this))
+    , m_protect_backups()
+    , m_wakeup_backups(&m_protect_backups)
+    , m_backup_checkpoint(0)
+    , m_backups()
+    , m_backup_snapshots()
+    , m_backup_shutdown(false)
 {
 }
 
@@ -180,7 +205,12 @@ daemon :: run(bool daemonize,
               po6::net::location bind_to,
               bool set_coordinator,
               po6::net::hostname coordinator,
-              unsigned threads)
+              unsigned threads,
+              uint64_t object_cache_size,
+              const search_manager::parameters& search_params,
+              const storage_pool::parameters& storage_params,
+              uint64_t transfer_rate,
+              uint64_t wipe_rate)
 {
     if (!install_signal_handler(SIGHUP, exit_on_signal))
     {
@@ -274,8 +304,12 @@ daemon :: run(bool daemonize,
     po6::net::hostname saved_coordinator;
     LOG(INFO) << "initializing local storage";
     m_data_dir = data.get();
+    m_data.set_object_cache_size(object_cache_size);
+    m_xfer_throttle.set_rate(transfer_rate);
+    m_wipe_throttle.set_rate(wipe_rate);
 
-    if (!m_data.initialize(data, &saved, &saved_us, &saved_bind_to, &saved_coordinator))
+    if (!m_data.initialize(data, &saved, &saved_us, &saved_bind_to, &saved_coordinator) ||
+        !reconcile_restored_regions())
     {
         return EXIT_FAILURE;
     }
@@ -337,7 +371,8 @@ daemon :: run(bool daemonize,
     m_comm.setup(bind_to, threads);
     m_repl.setup();
     m_stm.setup();
-    m_sm.setup();
+    m_sm.setup(search_params);
+    m_pool.setup(storage_params);
 
     for (size_t i = 0; i < threads; ++i)
     {
@@ -348,6 +383,7 @@ daemon :: run(bool daemonize,
     }
 
     m_stat_collector.start();
+    m_backup_thread.start();
     alarm(ALARM_INTERVAL);
     bool cluster_jump = false;
     bool requested_exit = false;
@@ -363,6 +399,8 @@ daemon :: run(bool daemonize,
             s_alarm = false;
             alarm(ALARM_INTERVAL);
             m_repl.trip_periodic();
+            m_sm.expire_idle();
+            m_data.refresh_stats();
         }
 
         if (s_debug)
@@ -403,6 +441,7 @@ daemon :: run(bool daemonize,
         {
             checkpoint_stable = m_coord.checkpoint_stable();
             m_repl.end_checkpoint(checkpoint_stable);
+            end_backup_checkpoint(checkpoint_stable);
         }
 
         if (m_config.version() > 0 &&
@@ -410,6 +449,7 @@ daemon :: run(bool daemonize,
         {
             checkpoint_gc = m_coord.checkpoint_gc();
             m_data.set_checkpoint_lower_gc(checkpoint_gc);
+            gc_backup_checkpoints(checkpoint_gc);
         }
 
         if (!m_coord.maintain_link())
@@ -446,12 +486,14 @@ daemon :: run(bool daemonize,
         m_repl.pause();
         m_data.pause();
         m_comm.pause();
+        m_pool.pause();
         m_comm.reconfigure(old_config, new_config, m_us);
         m_data.reconfigure(old_config, new_config, m_us);
         m_repl.reconfigure(old_config, new_config, m_us);
         m_stm.reconfigure(old_config, new_config, m_us);
         m_sm.reconfigure(old_config, new_config, m_us);
         m_config = new_config;
+        m_pool.unpause();
         m_comm.unpause();
         m_data.unpause();
         m_repl.unpause();
@@ -491,6 +533,15 @@ daemon :: run(bool daemonize,
         m_threads[i]->join();
     }
 
+    {
+        po6::threads::mutex::hold hold(&m_protect_backups);
+        m_backup_shutdown = true;
+        m_wakeup_backups.broadcast();
+    }
+
+    m_backup_thread.join();
+    m_backup_snapshots.clear();
+    m_pool.teardown();
     m_sm.teardown();
     m_stm.teardown();
     m_repl.teardown();
@@ -500,6 +551,56 @@ daemon :: run(bool daemonize,
     return EXIT_SUCCESS;
 }
 
+// Which storage_pool queue handles "type".  Messages that do not touch the
+// datalayer are cheap enough to process on the network thread.
+static bool
+storage_work_class(hyperdex::network_msgtype type,
+                   hyperdex::storage_pool::work_class* wc)
+{
+    using namespace hyperdex;
+
+    switch (type)
+    {
+        case REQ_GET:
+        case REQ_GET_PARTIAL:
+        case REQ_GET_MANY:
+        case CHAIN_READ:
+            *wc = storage_pool::POINT_READ;
+            return true;
+        case REQ_ATOMIC:
+        case REQ_ATOMIC_MANY:
+        case CHAIN_OP:
+        case CHAIN_SUBSPACE:
+        case CHAIN_ACK:
+        case CHAIN_BATCH:
+            *wc = storage_pool::WRITE;
+            return true;
+        case REQ_SEARCH_START:
+        case REQ_SEARCH_NEXT:
+        case REQ_SEARCH_STOP:
+        case REQ_SORTED_SEARCH:
+        case REQ_GROUP_DEL:
+        case REQ_COUNT:
+        case REQ_SEARCH_DESCRIBE:
+            *wc = storage_pool::SCAN;
+            return true;
+        case XFER_HS:
+        case XFER_HSA:
+        case XFER_HA:
+        case XFER_HW:
+        case XFER_OP:
+        case XFER_ACK:
+        case XFER_CHUNK:
+        case XFER_TREE:
+        case XFER_DIFF:
+        case BACKUP:
+            *wc = storage_pool::TRANSFER;
+            return true;
+        default:
+            return false;
+    }
+}
+
 void
 daemon :: loop(size_t thread)
 {
@@ -549,111 +650,173 @@ daemon :: loop(size_t thread)
     {
         assert(from != server_id());
         assert(vto != virtual_server_id());
+        storage_pool::work_class wc;
 
-        switch (type)
+        if (storage_work_class(type, &wc))
         {
-            case REQ_GET:
-                process_req_get(from, vfrom, vto, msg, up);
-                m_perf_req_get.tap();
-                break;
-            case REQ_ATOMIC:
-                process_req_atomic(from, vfrom, vto, msg, up);
-                m_perf_req_atomic.tap();
-                break;
-            case REQ_SEARCH_START:
-                process_req_search_start(from, vfrom, vto, msg, up);
-                m_perf_req_search_start.tap();
-                break;
-            case REQ_SEARCH_NEXT:
-                process_req_search_next(from, vfrom, vto, msg, up);
-                m_perf_req_search_next.tap();
-                break;
-            case REQ_SEARCH_STOP:
-                process_req_search_stop(from, vfrom, vto, msg, up);
-                m_perf_req_search_stop.tap();
-                break;
-            case REQ_SORTED_SEARCH:
-                process_req_sorted_search(from, vfrom, vto, msg, up);
-                m_perf_req_sorted_search.tap();
-                break;
-            case REQ_GROUP_DEL:
-                process_req_group_del(from, vfrom, vto, msg, up);
-                m_perf_req_group_del.tap();
-                break;
-            case REQ_COUNT:
-                process_req_count(from, vfrom, vto, msg, up);
-                m_perf_req_count.tap();
-                break;
-            case REQ_SEARCH_DESCRIBE:
-                process_req_search_describe(from, vfrom, vto, msg, up);
-                m_perf_req_search_describe.tap();
-                break;
-            case CHAIN_OP:
-                process_chain_op(from, vfrom, vto, msg, up);
-                m_perf_chain_op.tap();
-                break;
-            case CHAIN_SUBSPACE:
-                process_chain_subspace(from, vfrom, vto, msg, up);
-                m_perf_chain_subspace.tap();
-                break;
-            case CHAIN_ACK:
-                process_chain_ack(from, vfrom, vto, msg, up);
-                m_perf_chain_ack.tap();
-                break;
-            case CHAIN_GC:
-                process_chain_gc(from, vfrom, vto, msg, up);
-                m_perf_chain_gc.tap();
-                break;
-            case XFER_HS:
-                process_xfer_handshake_syn(from, vfrom, vto, msg, up);
-                m_perf_xfer_handshake_syn.tap();
-                break;
-            case XFER_HSA:
-                process_xfer_handshake_synack(from, vfrom, vto, msg, up);
-                m_perf_xfer_handshake_synack.tap();
-                break;
-            case XFER_HA:
-                process_xfer_handshake_ack(from, vfrom, vto, msg, up);
-                m_perf_xfer_handshake_ack.tap();
-                break;
-            case XFER_HW:
-                process_xfer_handshake_wiped(from, vfrom, vto, msg, up);
-                m_perf_xfer_handshake_wiped.tap();
-                break;
-            case XFER_OP:
-                process_xfer_op(from, vfrom, vto, msg, up);
-                m_perf_xfer_op.tap();
-                break;
-            case XFER_ACK:
-                process_xfer_ack(from, vfrom, vto, msg, up);
-                m_perf_xfer_ack.tap();
-                break;
-            case BACKUP:
-                process_backup(from, vfrom, vto, msg, up);
-                m_perf_backup.tap();
-            case PERF_COUNTERS:
-                process_perf_counters(from, vfrom, vto, msg, up);
-                m_perf_perf_counters.tap();
-                break;
-            case RESP_GET:
-            case RESP_ATOMIC:
-            case RESP_SEARCH_ITEM:
-            case RESP_SEARCH_DONE:
-            case RESP_SORTED_SEARCH:
-            case RESP_GROUP_DEL:
-            case RESP_COUNT:
-            case RESP_SEARCH_DESCRIBE:
-            case CONFIGMISMATCH:
-            case PACKET_NOP:
-            default:
-                LOG(INFO) << "received " << type << " message which servers do not process";
-                break;
+            m_pool.enqueue(wc, from, vfrom, vto, type, msg, up);
+        }
+        else
+        {
+            process_message(from, vfrom, vto, type, msg, up);
         }
     }
 
     LOG(INFO) << "network thread shutting down";
 }
 
+void
+daemon :: process_message(server_id from,
+                          virtual_server_id vfrom,
+                          virtual_server_id vto,
+                          network_msgtype type,
+                          std::auto_ptr<e::buffer> msg,
+                          e::unpacker up)
+{
+    switch (type)
+    {
+        case REQ_GET:
+            process_req_get(from, vfrom, vto, msg, up);
+            m_perf_req_get.tap();
+            break;
+        case REQ_GET_PARTIAL:
+            process_req_get_partial(from, vfrom, vto, msg, up);
+            m_perf_req_get.tap();
+            break;
+        case REQ_GET_MANY:
+            process_req_get_many(from, vfrom, vto, msg, up);
+            m_perf_req_get.tap();
+            break;
+        case REQ_ATOMIC:
+            process_req_atomic(from, vfrom, vto, msg, up);
+            m_perf_req_atomic.tap();
+            break;
+        case REQ_ATOMIC_MANY:
+            process_req_atomic_many(from, vfrom, vto, msg, up);
+            m_perf_req_atomic_many.tap();
+            break;
+        case REQ_SEARCH_START:
+            process_req_search_start(from, vfrom, vto, msg, up);
+            m_perf_req_search_start.tap();
+            break;
+        case REQ_SEARCH_NEXT:
+            process_req_search_next(from, vfrom, vto, msg, up);
+            m_perf_req_search_next.tap();
+            break;
+        case REQ_SEARCH_STOP:
+            process_req_search_stop(from, vfrom, vto, msg, up);
+            m_perf_req_search_stop.tap();
+            break;
+        case REQ_SORTED_SEARCH:
+            process_req_sorted_search(from, vfrom, vto, msg, up);
+            m_perf_req_sorted_search.tap();
+            break;
+        case REQ_GROUP_DEL:
+            process_req_group_del(from, vfrom, vto, msg, up);
+            m_perf_req_group_del.tap();
+            break;
+        case REQ_COUNT:
+            process_req_count(from, vfrom, vto, msg, up);
+            m_perf_req_count.tap();
+            break;
+        case REQ_SEARCH_DESCRIBE:
+            process_req_search_describe(from, vfrom, vto, msg, up);
+            m_perf_req_search_describe.tap();
+            break;
+        case CHAIN_OP:
+            process_chain_op(from, vfrom, vto, msg, up, NULL);
+            m_perf_chain_op.tap();
+            break;
+        case CHAIN_SUBSPACE:
+            process_chain_subspace(from, vfrom, vto, msg, up, NULL);
+            m_perf_chain_subspace.tap();
+            break;
+        case CHAIN_ACK:
+            process_chain_ack(from, vfrom, vto, msg, up, NULL);
+            m_perf_chain_ack.tap();
+            break;
+        case CHAIN_GC:
+            process_chain_gc(from, vfrom, vto, msg, up);
+            m_perf_chain_gc.tap();
+            break;
+        case CHAIN_BATCH:
+            process_chain_batch(from, vfrom, vto, msg, up);
+            m_perf_chain_batch.tap();
+            break;
+        case CHAIN_READ:
+            process_chain_read(from, vfrom, vto, msg, up);
+            m_perf_chain_read.tap();
+            break;
+        case CHAIN_READ_RESP:
+            process_chain_read_resp(from, vfrom, vto, msg, up);
+            break;
+        case XFER_HS:
+            process_xfer_handshake_syn(from, vfrom, vto, msg, up);
+            m_perf_xfer_handshake_syn.tap();
+            break;
+        case XFER_HSA:
+            process_xfer_handshake_synack(from, vfrom, vto, msg, up);
+            m_perf_xfer_handshake_synack.tap();
+            break;
+        case XFER_HA:
+            process_xfer_handshake_ack(from, vfrom, vto, msg, up);
+            m_perf_xfer_handshake_ack.tap();
+            break;
+        case XFER_HW:
+            process_xfer_handshake_wiped(from, vfrom, vto, msg, up);
+            m_perf_xfer_handshake_wiped.tap();
+            break;
+        case XFER_OP:
+            process_xfer_op(from, vfrom, vto, msg, up);
+            m_perf_xfer_op.tap();
+            break;
+        case XFER_ACK:
+            process_xfer_ack(from, vfrom, vto, msg, up);
+            m_perf_xfer_ack.tap();
+            break;
+        case XFER_CHUNK:
+            process_xfer_chunk(from, vfrom, vto, msg, up);
+            m_perf_xfer_chunk.tap();
+            break;
+        case XFER_TREE:
+            process_xfer_tree(from, vfrom, vto, msg, up);
+            m_perf_xfer_tree.tap();
+            break;
+        case XFER_DIFF:
+            process_xfer_diff(from, vfrom, vto, msg, up);
+            m_perf_xfer_diff.tap();
+            break;
+        case BACKUP:
+            process_backup(from, vfrom, vto, msg, up);
+            m_perf_backup.tap();
+            break;
+        case PERF_COUNTERS:
+            process_perf_counters(from, vfrom, vto, msg, up);
+            m_perf_perf_counters.tap();
+            break;
+        case THROTTLE:
+            process_throttle(from, vfrom, vto, msg, up);
+            m_perf_throttle.tap();
+            break;
+        case RESP_GET:
+        case RESP_GET_PARTIAL:
+        case RESP_GET_MANY:
+        case RESP_ATOMIC:
+        case RESP_ATOMIC_MANY:
+        case RESP_SEARCH_DONE:
+        case RESP_SEARCH_BATCH:
+        case RESP_SORTED_SEARCH:
+        case RESP_GROUP_DEL:
+        case RESP_COUNT:
+        case RESP_SEARCH_DESCRIBE:
+        case CONFIGMISMATCH:
+        case PACKET_NOP:
+        default:
+            LOG(INFO) << "received " << type << " message which servers do not process";
+            break;
+    }
+}
+
 void
 daemon :: process_req_get(server_id from,
                           virtual_server_id,
@@ -670,6 +833,13 @@ daemon :: process_req_get(server_id from,
         return;
     }
 
+    const std::vector<uint16_t> attrnums;
+
+    if (m_repl.client_read(from, vto, nonce, REQ_GET, key, attrnums))
+    {
+        return;
+    }
+
     std::vector<e::slice> value;
     uint64_t version;
     datalayer::reference ref;
@@ -693,14 +863,163 @@ daemon :: process_req_get(server_id from,
             break;
     }
 
+    send_get_response(from, vto, nonce, REQ_GET, attrnums, result, value);
+}
+
+void
+daemon :: process_req_get_partial(server_id from,
+                                  virtual_server_id,
+                                  virtual_server_id vto,
+                                  std::auto_ptr<e::buffer> msg,
+                                  e::unpacker up)
+{
+    uint64_t nonce;
+    e::slice key;
+    std::vector<uint16_t> attrnums;
+
+    if ((up >> nonce >> key >> attrnums).error())
+    {
+        LOG(WARNING) << "unpack of REQ_GET_PARTIAL failed; here's some hex:  " << msg->hex();
+        return;
+    }
+
+    region_id ri(m_config.get_region_id(vto));
+    const schema* sc = m_config.get_schema(ri);
+    assert(sc);
+    std::vector<e::slice> value;
+    uint64_t version;
+    datalayer::reference ref;
+    network_returncode result;
+
+    if (!sc->valid_projection(attrnums))
+    {
+        LOG(WARNING) << "REQ_GET_PARTIAL names attributes that are not in the space";
+        result = NET_BADDIMSPEC;
+    }
+    else if (m_repl.client_read(from, vto, nonce, REQ_GET_PARTIAL, key, attrnums))
+    {
+        return;
+    }
+    else
+    {
+        switch (m_data.get(ri, key, &value, &version, &ref))
+        {
+            case datalayer::SUCCESS:
+                result = NET_SUCCESS;
+                break;
+            case datalayer::NOT_FOUND:
+                result = NET_NOTFOUND;
+                break;
+            case datalayer::BAD_ENCODING:
+            case datalayer::CORRUPTION:
+            case datalayer::IO_ERROR:
+            case datalayer::LEVELDB_ERROR:
+            default:
+                LOG(ERROR) << "GET returned unacceptable error code.";
+                result = NET_SERVERERROR;
+                break;
+        }
+    }
+
+    send_get_response(from, vto, nonce, REQ_GET_PARTIAL, attrnums, result, value);
+}
+
+void
+daemon :: send_get_response(const server_id& client,
+                            const virtual_server_id& us,
+                            uint64_t nonce,
+                            network_msgtype mt,
+                            const std::vector<uint16_t>& attrnums,
+                            network_returncode result,
+                            const std::vector<e::slice>& value)
+{
+    std::vector<e::slice> projected;
+    const std::vector<e::slice>* resp = &value;
+
+    if (mt == REQ_GET_PARTIAL)
+    {
+        if (result == NET_SUCCESS)
+        {
+            const schema* sc = m_config.get_schema(m_config.get_region_id(us));
+            assert(sc);
+            sc->project(value, attrnums, &projected);
+        }
+
+        resp = &projected;
+    }
+
     size_t sz = HYPERDEX_HEADER_SIZE_VC
               + sizeof(uint64_t)
               + sizeof(uint16_t)
-              + pack_size(value);
+              + pack_size(*resp);
+    std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
+    e::buffer::packer pa = msg->pack_at(HYPERDEX_HEADER_SIZE_VC);
+    pa = pa << nonce << static_cast<uint16_t>(result) << *resp;
+    m_comm.send_client(us, client, mt == REQ_GET_PARTIAL ? RESP_GET_PARTIAL : RESP_GET, msg);
+}
+
+void
+daemon :: process_req_get_many(server_id from,
+                               virtual_server_id,
+                               virtual_server_id vto,
+                               std::auto_ptr<e::buffer> msg,
+                               e::unpacker up)
+{
+    uint64_t nonce;
+    uint64_t batch_id;
+    std::vector<e::slice> keys;
+
+    if ((up >> nonce >> batch_id >> keys).error())
+    {
+        LOG(WARNING) << "unpack of REQ_GET_MANY failed; here's some hex:  " << msg->hex();
+        return;
+    }
+
+    std::vector<datalayer::returncode> rcs;
+    std::vector<std::vector<e::slice> > values;
+    std::vector<uint64_t> versions;
+    std::vector<datalayer::reference> refs;
+    m_data.get_many(m_config.get_region_id(vto), keys, &rcs, &values, &versions, &refs);
+    std::vector<uint16_t> results(keys.size());
+    size_t sz = HYPERDEX_HEADER_SIZE_VC
+              + sizeof(uint64_t)
+              + sizeof(uint64_t)
+              + sizeof(uint64_t);
+
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        switch (rcs[i])
+        {
+            case datalayer::SUCCESS:
+                results[i] = static_cast<uint16_t>(NET_SUCCESS);
+                break;
+            case datalayer::NOT_FOUND:
+                results[i] = static_cast<uint16_t>(NET_NOTFOUND);
+                break;
+            case datalayer::BAD_ENCODING:
+            case datalayer::CORRUPTION:
+            case datalayer::IO_ERROR:
+            case datalayer::LEVELDB_ERROR:
+            default:
+                LOG(ERROR) << "GET_MANY returned unacceptable error code.";
+                results[i] = static_cast<uint16_t>(NET_SERVERERROR);
+                values[i].clear();
+                break;
+        }
+
+        sz += sizeof(uint16_t) + pack_size(values[i]);
+    }
+
     msg.reset(e::buffer::create(sz));
     e::buffer::packer pa = msg->pack_at(HYPERDEX_HEADER_SIZE_VC);
-    pa = pa << nonce << static_cast<uint16_t>(result) << value;
-    m_comm.send_client(vto, from, RESP_GET, msg);
+    pa = pa << nonce << batch_id << static_cast<uint64_t>(keys.size());
+
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        pa = pa << results[i] << values[i];
+    }
+
+    m_comm.send_client(vto, from, RESP_GET_MANY, msg);
 }
 
 void
@@ -729,6 +1048,39 @@ daemon :: process_req_atomic(server_id from,
     m_repl.client_atomic(from, vto, nonce, erase, fail_if_not_found, fail_if_found, key, checks, funcs);
 }
 
+void
+daemon :: process_req_atomic_many(server_id from,
+                                  virtual_server_id,
+                                  virtual_server_id vto,
+                                  std::auto_ptr<e::buffer> msg,
+                                  e::unpacker up)
+{
+    uint64_t nonce;
+    uint64_t batch_id;
+    uint32_t count;
+    up = up >> nonce >> batch_id >> count;
+    std::vector<replication_manager::atomic_op> ops;
+
+    while (!up.error() && ops.size() < count)
+    {
+        ops.push_back(replication_manager::atomic_op());
+        replication_manager::atomic_op* op = &ops.back();
+        uint8_t flags;
+        up = up >> op->key >> flags >> op->checks >> op->funcs;
+        op->erase = !(flags & 128);
+        op->fail_if_not_found = flags & 1;
+        op->fail_if_found = flags & 2;
+    }
+
+    if (up.error())
+    {
+        LOG(WARNING) << "unpack of REQ_ATOMIC_MANY failed; here's some hex:  " << msg->hex();
+        return;
+    }
+
+    m_repl.client_atomic_many(from, vto, nonce, batch_id, &ops);
+}
+
 void
 daemon :: process_req_search_start(server_id from,
                                    virtual_server_id,
@@ -739,14 +1091,26 @@ daemon :: process_req_search_start(server_id from,
     uint64_t nonce;
     uint64_t search_id;
     std::vector<attribute_check> checks;
+    std::vector<uint16_t> attrnums;
+
+    if ((up >> nonce >> search_id >> checks >> attrnums).error())
+    {
+        LOG(WARNING) << "unpack of REQ_SEARCH_START failed; here's some hex:  " << msg->hex();
+        return;
+    }
 
-    if ((up >> nonce >> search_id >> checks).error())
+    // a limited search follows with the most objects the client wants from
+    // this region, and how many to send at a time
+    uint64_t limit = UINT64_MAX;
+    uint64_t batch = 0;
+
+    if (up.remain() > 0 && (up >> limit >> batch).error())
     {
         LOG(WARNING) << "unpack of REQ_SEARCH_START failed; here's some hex:  " << msg->hex();
         return;
     }
 
-    m_sm.start(from, vto, msg, nonce, search_id, &checks);
+    m_sm.start(from, vto, msg, nonce, search_id, &checks, limit, batch, &attrnums);
 }
 
 void
@@ -765,7 +1129,22 @@ daemon :: process_req_search_next(server_id from,
         return;
     }
 
-    m_sm.next(from, vto, nonce, search_id);
+    // a sorted search may follow with the client's current k-th best value
+    e::slice bound;
+
+    if (up.remain() == 0)
+    {
+        m_sm.next(from, vto, nonce, search_id, NULL);
+        return;
+    }
+
+    if ((up >> bound).error())
+    {
+        LOG(WARNING) << "unpack of REQ_SEARCH_NEXT failed; here's some hex:  " << msg->hex();
+        return;
+    }
+
+    m_sm.next(from, vto, nonce, search_id, &bound);
 }
 
 void
@@ -799,14 +1178,38 @@ daemon :: process_req_sorted_search(server_id from,
     uint64_t limit;
     uint16_t sort_by;
     uint8_t flags;
+    std::vector<uint16_t> attrnums;
 
-    if ((up >> nonce >> checks >> limit >> sort_by >> flags).error())
+    if ((up >> nonce >> checks >> limit >> sort_by >> flags >> attrnums).error())
     {
         LOG(WARNING) << "unpack of REQ_SORTED_SEARCH failed; here's some hex:  " << msg->hex();
         return;
     }
 
-    m_sm.sorted_search(from, vto, nonce, &checks, limit, sort_by, flags & 0x1);
+    // streamed searches name a session and a batch size, and then continue
+    // with REQ_SEARCH_NEXT like any other search; they may also carry a
+    // cursor (the sort value and key of the object to start after)
+    if (flags & 0x2)
+    {
+        uint64_t search_id;
+        uint64_t batch;
+        e::slice after_value;
+        e::slice after_key;
+
+        if ((up >> search_id >> batch).error() ||
+            ((flags & 0x4) && (up >> after_value >> after_key).error()))
+        {
+            LOG(WARNING) << "unpack of REQ_SORTED_SEARCH failed; here's some hex:  " << msg->hex();
+            return;
+        }
+
+        bool cursor = flags & 0x4;
+        m_sm.sorted_start(from, vto, msg, nonce, search_id, &checks, limit, sort_by, flags & 0x1, batch,
+                          cursor ? &after_value : NULL, cursor ? &after_key : NULL, &attrnums);
+        return;
+    }
+
+    m_sm.sorted_search(from, vto, nonce, &checks, limit, sort_by, flags & 0x1, &attrnums);
 }
 
 void
@@ -872,7 +1275,8 @@ daemon :: process_chain_op(server_id,
                            virtual_server_id vfrom,
                            virtual_server_id vto,
                            std::auto_ptr<e::buffer> msg,
-                           e::unpacker up)
+                           e::unpacker up,
+                           replication_manager::batch* b)
 {
     uint8_t flags;
     uint64_t reg_id;
@@ -889,8 +1293,9 @@ daemon :: process_chain_op(server_id,
 
     bool fresh = flags & 1;
     bool has_value = flags & 2;
+    bool blind = flags & 4;
     bool retransmission = flags & 128;
-    m_repl.chain_op(vfrom, vto, retransmission, region_id(reg_id), seq_id, version, fresh, has_value, msg, key, value);
+    m_repl.chain_op(vfrom, vto, retransmission, region_id(reg_id), seq_id, version, fresh, blind, has_value, msg, key, value, b);
 }
 
 void
@@ -898,7 +1303,8 @@ daemon :: process_chain_subspace(server_id,
                                  virtual_server_id vfrom,
                                  virtual_server_id vto,
                                  std::auto_ptr<e::buffer> msg,
-                                 e::unpacker up)
+                                 e::unpacker up,
+                                 replication_manager::batch* b)
 {
     uint8_t flags;
     uint64_t reg_id;
@@ -915,7 +1321,7 @@ daemon :: process_chain_subspace(server_id,
     }
 
     bool retransmission = flags & 128;
-    m_repl.chain_subspace(vfrom, vto, retransmission, region_id(reg_id), seq_id, version, msg, key, value, hashes);
+    m_repl.chain_subspace(vfrom, vto, retransmission, region_id(reg_id), seq_id, version, msg, key, value, hashes, b);
 }
 
 void
@@ -938,63 +1344,196 @@ daemon :: process_chain_gc(server_id,
 }
 
 void
-daemon :: process_chain_ack(server_id,
-                            virtual_server_id vfrom,
-                            virtual_server_id vto,
-                            std::auto_ptr<e::buffer> msg,
-                            e::unpacker up)
+daemon :: process_chain_read(server_id,
+                             virtual_server_id vfrom,
+                             virtual_server_id vto,
+                             std::auto_ptr<e::buffer> msg,
+                             e::unpacker up)
 {
-    uint8_t flags;
-    uint64_t reg_id;
-    uint64_t seq_id;
-    uint64_t version;
+    uint64_t read_id;
     e::slice key;
 
-    if ((up >> flags >> reg_id >> seq_id >> version >> key).error())
+    if ((up >> read_id >> key).error())
     {
-        LOG(WARNING) << "unpack of CHAIN_ACK failed; here's some hex:  " << msg->hex();
+        LOG(WARNING) << "unpack of CHAIN_READ failed; here's some hex:  " << msg->hex();
         return;
     }
 
-    bool retransmission = flags & 128;
-    m_repl.chain_ack(vfrom, vto, retransmission, region_id(reg_id), seq_id, version, key);
+    m_repl.chain_read(vfrom, vto, read_id, key);
 }
 
 void
-daemon :: process_xfer_handshake_syn(server_id,
-                                     virtual_server_id vfrom,
-                                     virtual_server_id,
-                                     std::auto_ptr<e::buffer> msg,
-                                     e::unpacker up)
+daemon :: process_chain_read_resp(server_id,
+                                  virtual_server_id vfrom,
+                                  virtual_server_id vto,
+                                  std::auto_ptr<e::buffer> msg,
+                                  e::unpacker up)
 {
-    transfer_id xid;
+    uint64_t read_id;
+    uint16_t result;
+    std::vector<e::slice> value;
 
-    if ((up >> xid).error())
+    if ((up >> read_id >> result >> value).error())
     {
-        LOG(WARNING) << "unpack of XFER_HS failed; here's some hex:  " << msg->hex();
+        LOG(WARNING) << "unpack of CHAIN_READ_RESP failed; here's some hex:  " << msg->hex();
         return;
     }
 
-    m_stm.handshake_syn(vfrom, xid);
+    m_repl.chain_read_resp(vfrom, vto, read_id, static_cast<network_returncode>(result), value);
 }
 
 void
-daemon :: process_xfer_handshake_synack(server_id from,
-                                        virtual_server_id,
-                                        virtual_server_id to,
-                                        std::auto_ptr<e::buffer> msg,
-                                        e::unpacker up)
+daemon :: process_chain_ack(server_id,
+                            virtual_server_id vfrom,
+                            virtual_server_id vto,
+                            std::auto_ptr<e::buffer> msg,
+                            e::unpacker up,
+                            replication_manager::batch* b)
 {
-    transfer_id xid;
-    uint64_t timestamp;
+    uint8_t flags;
+    uint64_t reg_id;
+    uint64_t seq_id;
+    uint64_t version;
+    e::slice key;
 
-    if ((up >> xid >> timestamp).error())
+    if ((up >> flags >> reg_id >> seq_id >> version >> key).error())
     {
-        LOG(WARNING) << "unpack of XFER_HSA failed; here's some hex:  " << msg->hex();
+        LOG(WARNING) << "unpack of CHAIN_ACK failed; here's some hex:  " << msg->hex();
         return;
     }
 
-    m_stm.handshake_synack(from, to, xid, timestamp);
+    bool retransmission = flags & 128;
+    m_repl.chain_ack(vfrom, vto, retransmission, region_id(reg_id), seq_id, version, key, b);
+}
+
+namespace
+{
+
+// one message carried within a CHAIN_BATCH
+class batched_message
+{
+    public:
+        batched_message() : type(), body(), key() {}
+
+    public:
+        bool operator < (const batched_message& rhs) const
+        { return key < rhs.key; }
+
+    public:
+        uint8_t type;
+        e::slice body;
+        e::slice key;
+};
+
+} // namespace
+
+void
+daemon :: process_chain_batch(server_id from,
+                              virtual_server_id vfrom,
+                              virtual_server_id vto,
+                              std::auto_ptr<e::buffer> msg,
+                              e::unpacker up)
+{
+    uint32_t count;
+    up = up >> count;
+    std::vector<batched_message> msgs;
+
+    while (!up.error() && msgs.size() < count)
+    {
+        msgs.push_back(batched_message());
+        batched_message* bm = &msgs.back();
+        up = up >> bm->type >> bm->body;
+
+        // CHAIN_OP, CHAIN_SUBSPACE and CHAIN_ACK share this prefix
+        uint8_t flags;
+        uint64_t reg_id;
+        uint64_t seq_id;
+        uint64_t version;
+
+        if (!up.error() &&
+            (e::unpacker(bm->body) >> flags >> reg_id >> seq_id >> version >> bm->key).error())
+        {
+            up = up.as_error();
+        }
+    }
+
+    if (up.error())
+    {
+        LOG(WARNING) << "unpack of CHAIN_BATCH failed; here's some hex:  " << msg->hex();
+        return;
+    }
+
+    // the replication manager locks the key states in this (stable) order
+    std::stable_sort(msgs.begin(), msgs.end());
+    replication_manager::batch b;
+
+    for (size_t i = 0; i < msgs.size(); ++i)
+    {
+        std::auto_ptr<e::buffer> sub(e::buffer::create(HYPERDEX_HEADER_SIZE_VV + msgs[i].body.size()));
+        sub->pack_at(HYPERDEX_HEADER_SIZE_VV).copy(msgs[i].body);
+        e::unpacker sup = sub->unpack_from(HYPERDEX_HEADER_SIZE_VV);
+
+        switch (static_cast<network_msgtype>(msgs[i].type))
+        {
+            case CHAIN_OP:
+                process_chain_op(from, vfrom, vto, sub, sup, &b);
+                m_perf_chain_op.tap();
+                break;
+            case CHAIN_SUBSPACE:
+                process_chain_subspace(from, vfrom, vto, sub, sup, &b);
+                m_perf_chain_subspace.tap();
+                break;
+            case CHAIN_ACK:
+                process_chain_ack(from, vfrom, vto, sub, sup, &b);
+                m_perf_chain_ack.tap();
+                break;
+            default:
+                LOG(WARNING) << "dropping " << static_cast<network_msgtype>(msgs[i].type)
+                             << " which cannot be part of a CHAIN_BATCH";
+                break;
+        }
+    }
+
+    m_repl.commit(&b);
+}
+
+void
+daemon :: process_xfer_handshake_syn(server_id,
+                                     virtual_server_id vfrom,
+                                     virtual_server_id,
+                                     std::auto_ptr<e::buffer> msg,
+                                     e::unpacker up)
+{
+    transfer_id xid;
+
+    if ((up >> xid).error())
+    {
+        LOG(WARNING) << "unpack of XFER_HS failed; here's some hex:  " << msg->hex();
+        return;
+    }
+
+    m_stm.handshake_syn(vfrom, xid);
+}
+
+void
+daemon :: process_xfer_handshake_synack(server_id from,
+                                        virtual_server_id,
+                                        virtual_server_id to,
+                                        std::auto_ptr<e::buffer> msg,
+                                        e::unpacker up)
+{
+    transfer_id xid;
+    uint64_t timestamp;
+    uint8_t flags;
+
+    if ((up >> xid >> timestamp >> flags).error())
+    {
+        LOG(WARNING) << "unpack of XFER_HSA failed; here's some hex:  " << msg->hex();
+        return;
+    }
+
+    bool has_objects = flags & 0x1;
+    m_stm.handshake_synack(from, to, xid, timestamp, has_objects);
 }
 
 void
@@ -1014,7 +1553,8 @@ daemon :: process_xfer_handshake_ack(server_id,
     }
 
     bool wipe = flags & 0x1;
-    m_stm.handshake_ack(vfrom, xid, wipe);
+    bool repair = flags & 0x2;
+    m_stm.handshake_ack(vfrom, xid, wipe, repair);
 }
 
 void
@@ -1042,21 +1582,16 @@ daemon :: process_xfer_op(server_id,
                           std::auto_ptr<e::buffer> msg,
                           e::unpacker up)
 {
-    uint8_t flags;
     uint64_t xid;
-    uint64_t seq_no;
-    uint64_t version;
-    e::slice key;
-    std::vector<e::slice> value;
+    uint32_t count;
 
-    if ((up >> flags >> xid >> seq_no >> version >> key >> value).error())
+    if ((up >> xid >> count).error())
     {
         LOG(WARNING) << "unpack of XFER_OP failed; here's some hex:  " << msg->hex();
         return;
     }
 
-    bool has_value = flags & 1;
-    m_stm.xfer_op(vfrom, transfer_id(xid), seq_no, has_value, version, msg, key, value);
+    m_stm.xfer_op(vfrom, transfer_id(xid), count, msg, up);
 }
 
 void
@@ -1076,7 +1611,78 @@ daemon :: process_xfer_ack(server_id from,
         return;
     }
 
-    m_stm.xfer_ack(from, vto, transfer_id(xid), seq_no);
+    if ((flags & 2))
+    {
+        m_stm.xfer_chunk_reject(from, vto, transfer_id(xid), seq_no);
+    }
+    else if ((flags & 1))
+    {
+        m_stm.xfer_chunk_ack(from, vto, transfer_id(xid), seq_no);
+    }
+    else
+    {
+        m_stm.xfer_ack(from, vto, transfer_id(xid), seq_no);
+    }
+}
+
+void
+daemon :: process_xfer_chunk(server_id,
+                             virtual_server_id vfrom,
+                             virtual_server_id,
+                             std::auto_ptr<e::buffer> msg,
+                             e::unpacker up)
+{
+    uint64_t xid;
+    uint64_t chunk_no;
+    uint64_t checksum;
+    uint32_t count;
+    e::slice payload;
+
+    if ((up >> xid >> chunk_no >> checksum >> count >> payload).error())
+    {
+        LOG(WARNING) << "unpack of XFER_CHUNK failed; here's some hex:  " << msg->hex();
+        return;
+    }
+
+    m_stm.xfer_chunk(vfrom, transfer_id(xid), chunk_no, checksum, count, msg, payload);
+}
+
+void
+daemon :: process_xfer_tree(server_id from,
+                            virtual_server_id,
+                            virtual_server_id vto,
+                            std::auto_ptr<e::buffer> msg,
+                            e::unpacker up)
+{
+    uint64_t xid;
+    std::vector<uint64_t> leaves;
+
+    if ((up >> xid >> leaves).error())
+    {
+        LOG(WARNING) << "unpack of XFER_TREE failed; here's some hex:  " << msg->hex();
+        return;
+    }
+
+    m_stm.xfer_tree(from, vto, transfer_id(xid), leaves);
+}
+
+void
+daemon :: process_xfer_diff(server_id,
+                            virtual_server_id vfrom,
+                            virtual_server_id,
+                            std::auto_ptr<e::buffer> msg,
+                            e::unpacker up)
+{
+    uint64_t xid;
+    std::vector<uint32_t> leaves;
+
+    if ((up >> xid >> leaves).error())
+    {
+        LOG(WARNING) << "unpack of XFER_DIFF failed; here's some hex:  " << msg->hex();
+        return;
+    }
+
+    m_stm.xfer_diff(vfrom, transfer_id(xid), leaves);
 }
 
 void
@@ -1088,8 +1694,9 @@ daemon :: process_backup(server_id from,
 {
     uint64_t nonce;
     e::slice _name;
+    up = up >> nonce >> _name;
 
-    if ((up >> nonce >> _name).error() ||
+    if (up.error() ||
         strnlen(reinterpret_cast<const char*>(_name.data()), _name.size()) == _name.size())
     {
         LOG(WARNING) << "unpack of BACKUP failed; here's some hex:  " << msg->hex();
@@ -1097,34 +1704,296 @@ daemon :: process_backup(server_id from,
     }
 
     std::string name(reinterpret_cast<const char*>(_name.data()));
+
+    uint64_t checkpoint = 0;
+
+    // a request without a checkpoint gets whatever is on disk when its turn
+    // comes; zero asks for the first checkpoint to begin after this request
+    if (up.remain() > 0)
+    {
+        if ((up >> checkpoint).error())
+        {
+            LOG(WARNING) << "unpack of BACKUP failed; here's some hex:  " << msg->hex();
+            return;
+        }
+
+        if (checkpoint == 0)
+        {
+            checkpoint = m_coord.checkpoint() + 1;
+        }
+    }
+
+    po6::threads::mutex::hold hold(&m_protect_backups);
+
+    if (checkpoint > 0 && m_backup_checkpoint < checkpoint)
+    {
+        LOG(INFO) << "backup \"" << e::strescape(name) << "\" will be taken "
+                  << "once checkpoint " << checkpoint << " is stable";
+    }
+
+    m_backups.push_back(pending_backup(from, vto, nonce, name, checkpoint));
+    m_wakeup_backups.broadcast();
+}
+
+// Called from the main loop once "checkpoint_stable" is stable, so every
+// replica has committed each write issued before it, and the configuration
+// cannot change while the positions are read.
+void
+daemon :: end_backup_checkpoint(uint64_t checkpoint_stable)
+{
+    backup_snapshot bs;
+    bs.snap = m_data.make_snapshot();
+    std::vector<region_id> regions;
+    m_config.mapped_regions(m_us, &regions);
+
+    for (size_t i = 0; i < regions.size(); ++i)
+    {
+        virtual_server_id us = m_config.get_virtual(regions[i], m_us);
+        virtual_server_id vsi = m_config.head_of_region(regions[i]);
+        unsigned position = 0;
+
+        while (vsi != us && vsi != virtual_server_id() &&
+               m_config.get_region_id(vsi) == regions[i])
+        {
+            vsi = m_config.next_in_region(vsi);
+            ++position;
+        }
+
+        bs.positions.push_back(std::make_pair(regions[i], position));
+    }
+
+    po6::threads::mutex::hold hold(&m_protect_backups);
+    m_backup_snapshots.insert(std::make_pair(checkpoint_stable, bs));
+    m_backup_checkpoint = std::max(m_backup_checkpoint, checkpoint_stable);
+    m_wakeup_backups.broadcast();
+}
+
+void
+daemon :: gc_backup_checkpoints(uint64_t checkpoint_gc)
+{
+    po6::threads::mutex::hold hold(&m_protect_backups);
+    m_backup_snapshots.erase(m_backup_snapshots.begin(),
+                             m_backup_snapshots.lower_bound(checkpoint_gc));
+}
+
+void
+daemon :: run_backups()
+{
+    LOG(INFO) << "backup thread started";
+    sigset_t ss;
+
+    if (sigfillset(&ss) < 0)
+    {
+        PLOG(ERROR) << "sigfillset";
+        return;
+    }
+
+    if (pthread_sigmask(SIG_BLOCK, &ss, NULL) < 0)
+    {
+        PLOG(ERROR) << "could not block signals";
+        return;
+    }
+
+    while (true)
+    {
+        std::list<pending_backup> ready;
+        backup_snapshot bs;
+        bool have_snap = false;
+
+        {
+            po6::threads::mutex::hold hold(&m_protect_backups);
+
+            while (!m_backup_shutdown && ready.empty())
+            {
+                for (std::list<pending_backup>::iterator it = m_backups.begin();
+                        it != m_backups.end(); ++it)
+                {
+                    if (it->checkpoint <= m_backup_checkpoint)
+                    {
+                        ready.splice(ready.begin(), m_backups, it);
+                        break;
+                    }
+                }
+
+                if (ready.empty())
+                {
+                    m_wakeup_backups.wait();
+                }
+            }
+
+            if (m_backup_shutdown)
+            {
+                break;
+            }
+
+            // the coordinator may report checkpoints stable several at a time,
+            // and any snapshot taken since the checkpoint holds all it needs
+            std::map<uint64_t, backup_snapshot>::iterator sit;
+            sit = m_backup_snapshots.lower_bound(ready.front().checkpoint);
+
+            if (sit != m_backup_snapshots.end())
+            {
+                bs = sit->second;
+                have_snap = true;
+            }
+        }
+
+        take_backup(ready.front(), have_snap ? &bs : NULL);
+    }
+
+    LOG(INFO) << "backup thread shutting down";
+}
+
+void
+daemon :: take_backup(const pending_backup& pb, const backup_snapshot* bs)
+{
+    using po6::join;
+    using po6::pathname;
+    pathname _path(join(pathname(m_data_dir),
+                        pathname(("backup-" + pb.name).c_str())).get());
     network_returncode result = NET_SUCCESS;
 
-    if (!m_data.backup(e::slice(name)))
+    if (pb.checkpoint == 0)
     {
+        if (!m_data.backup(e::slice(pb.name)))
+        {
+            result = NET_SERVERERROR;
+        }
+    }
+    else if (!bs)
+    {
+        // the checkpoint became stable before this daemon was running, or
+        // was collected before the request arrived
+        LOG(ERROR) << "cannot take backup \"" << e::strescape(pb.name) << "\" "
+                   << "because this server holds no snapshot of checkpoint "
+                   << pb.checkpoint;
         result = NET_SERVERERROR;
     }
-    else
+    else if (!m_data.backup(_path.get(), bs->snap) ||
+             !write_backup_manifest(_path.get(), pb.checkpoint, bs->positions))
+    {
+        result = NET_SERVERERROR;
+    }
+
+    if (result == NET_SUCCESS)
     {
         LOG(INFO) << "Backup succeeded and is available in the directory \"backup-"
-                  << e::strescape(name) << "\" within the data directory."
+                  << e::strescape(pb.name) << "\" within the data directory."
                   << "  Copy the complete directory to elsewhere so your backup is safe.";
     }
 
-    using po6::join;
-    using po6::pathname;
-    pathname _path(join(pathname(m_data_dir),
-                        pathname(("backup-" + name).c_str())).get());
     _path = _path.realpath();
     e::slice path(_path.get());
-
     size_t sz = HYPERDEX_HEADER_SIZE_VC
               + sizeof(uint64_t)
               + sizeof(uint16_t)
-              + pack_size(path);
-    msg.reset(e::buffer::create(sz));
+              + pack_size(path)
+              + sizeof(uint64_t);
+    std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
     e::buffer::packer pa = msg->pack_at(HYPERDEX_HEADER_SIZE_VC);
-    pa = pa << nonce << static_cast<uint16_t>(result) << path;
-    m_comm.send_client(vto, from, BACKUP, msg);
+    pa = pa << pb.nonce << static_cast<uint16_t>(result) << path << pb.checkpoint;
+    m_comm.send_client(pb.vto, pb.from, BACKUP, msg);
+}
+
+// hyperdex-restore leaves a RECONCILE file with a "region <id> <dir>" line for
+// each region where this daemon's backup was not the copy nearest the tail;
+// <dir>, within the data directory, holds the backup to take the region from.
+// Every replica of the region must start out identical, or the chain drops
+// the writes that follow, so this happens before the daemon serves anything.
+bool
+daemon :: reconcile_restored_regions()
+{
+    std::string rpath(m_data_dir + "/RECONCILE");
+    po6::io::fd fd(open(rpath.c_str(), O_RDONLY));
+
+    if (fd.get() < 0 && errno == ENOENT)
+    {
+        return true;
+    }
+    else if (fd.get() < 0)
+    {
+        PLOG(ERROR) << "could not open \"" << e::strescape(rpath) << "\"";
+        return false;
+    }
+
+    std::string contents;
+    char buf[4096];
+    ssize_t amt;
+
+    while ((amt = fd.xread(buf, sizeof(buf))) > 0)
+    {
+        contents.append(buf, amt);
+    }
+
+    if (amt < 0)
+    {
+        PLOG(ERROR) << "could not read \"" << e::strescape(rpath) << "\"";
+        return false;
+    }
+
+    std::istringstream istr(contents);
+    std::string line;
+
+    while (std::getline(istr, line))
+    {
+        std::istringstream lstr(line);
+        std::string word;
+        uint64_t ri;
+        std::string dir;
+
+        if (!(lstr >> word >> ri >> dir) || word != "region")
+        {
+            LOG(ERROR) << "could not parse \"" << e::strescape(rpath) << "\": \""
+                       << e::strescape(line) << "\"";
+            return false;
+        }
+
+        if (!m_data.adopt_region(region_id(ri), m_data_dir + "/" + dir))
+        {
+            return false;
+        }
+    }
+
+    if (unlink(rpath.c_str()) < 0)
+    {
+        PLOG(ERROR) << "could not remove \"" << e::strescape(rpath) << "\"";
+        return false;
+    }
+
+    LOG(INFO) << "reconciled the restored regions; the restore-* directories "
+              << "in the data directory may now be removed";
+    return true;
+}
+
+// The manifest names the checkpoint the backup covers.  The "snapshot" line
+// marks a backup copied from a snapshot taken once the checkpoint was stable,
+// and each "region" line gives this daemon's position in that region's chain
+// (zero is the head) when the snapshot was taken.
+bool
+daemon :: write_backup_manifest(const std::string& path, uint64_t checkpoint,
+                                const std::vector<std::pair<region_id, unsigned> >& positions)
+{
+    std::ostringstream ostr;
+    ostr << "checkpoint " << checkpoint << "\n"
+         << "snapshot\n";
+
+    for (size_t i = 0; i < positions.size(); ++i)
+    {
+        ostr << "region " << positions[i].first.get() << " " << positions[i].second << "\n";
+    }
+    std::string manifest(ostr.str());
+    std::string mpath(path + "/CHECKPOINT");
+    po6::io::fd fd(open(mpath.c_str(), O_WRONLY|O_CREAT|O_TRUNC, S_IRUSR|S_IWUSR));
+
+    if (fd.get() < 0 ||
+        fd.xwrite(manifest.data(), manifest.size()) != static_cast<ssize_t>(manifest.size()) ||
+        fsync(fd.get()) < 0)
+    {
+        PLOG(ERROR) << "could not write backup manifest \"" << e::strescape(mpath) << "\"";
+        return false;
+    }
+
+    return true;
 }
 
 void
@@ -1180,6 +2049,76 @@ daemon :: process_perf_counters(server_id from,
     m_comm.send_client(vto, from, PERF_COUNTERS, msg);
 }
 
+void
+daemon :: process_throttle(server_id from,
+                           virtual_server_id,
+                           virtual_server_id vto,
+                           std::auto_ptr<e::buffer> msg,
+                           e::unpacker up)
+{
+    uint64_t nonce;
+    uint64_t transfer_rate;
+    uint64_t wipe_rate;
+
+    if ((up >> nonce >> transfer_rate >> wipe_rate).error())
+    {
+        LOG(WARNING) << "unpack of THROTTLE failed; here's some hex:  " << msg->hex();
+        return;
+    }
+
+    // UINT64_MAX leaves a rate as it is
+    if (transfer_rate != UINT64_MAX)
+    {
+        m_xfer_throttle.set_rate(transfer_rate);
+        LOG(INFO) << "throttling state transfer to " << transfer_rate << " bytes per second";
+    }
+
+    if (wipe_rate != UINT64_MAX)
+    {
+        m_wipe_throttle.set_rate(wipe_rate);
+        LOG(INFO) << "throttling wipes to " << wipe_rate << " bytes per second";
+    }
+
+    transfer_rate = m_xfer_throttle.rate();
+    wipe_rate = m_wipe_throttle.rate();
+    size_t sz = HYPERDEX_HEADER_SIZE_VC
+              + sizeof(uint64_t)
+              + sizeof(uint16_t)
+              + sizeof(uint64_t)
+              + sizeof(uint64_t);
+    msg.reset(e::buffer::create(sz));
+    e::buffer::packer pa = msg->pack_at(HYPERDEX_HEADER_SIZE_VC);
+    pa = pa << nonce << static_cast<uint16_t>(NET_SUCCESS) << transfer_rate << wipe_rate;
+    m_comm.send_client(vto, from, THROTTLE, msg);
+}
+
+// client work waiting longer than this, or queueing deeper than this many
+// items per thread, makes transfers and wipes back off
+#define FOREGROUND_MAX_WAIT (2ULL * 1000ULL * 1000ULL)
+#define FOREGROUND_MAX_DEPTH 8
+
+bool
+daemon :: foreground_pressure()
+{
+    const storage_pool::work_class foreground[] = {storage_pool::POINT_READ,
+                                                   storage_pool::WRITE,
+                                                   storage_pool::SCAN};
+
+    for (size_t i = 0; i < sizeof(foreground) / sizeof(foreground[0]); ++i)
+    {
+        storage_pool::work_class wc = foreground[i];
+        size_t threads = std::max(m_pool.threads(wc), size_t(1));
+
+        if (m_pool.depth(wc) > FOREGROUND_MAX_DEPTH * threads ||
+            m_pool.wait(wc) > FOREGROUND_MAX_WAIT)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 #define INTERVAL 100000000ULL
 
 void
@@ -1212,6 +2151,11 @@ daemon :: collect_stats()
         ret << target;
         collect_stats_msgs(&ret);
         collect_stats_leveldb(&ret);
+        collect_stats_object_cache(&ret);
+        collect_stats_searches(&ret);
+        collect_stats_storage(&ret);
+        collect_stats_transfers(&ret);
+        collect_stats_throttles(&ret);
         collect_stats_io(&ret);
         ret << "\n";
         std::string out = ret.str();
@@ -1234,6 +2178,7 @@ daemon :: collect_stats_msgs(std::ostringstream* ret)
 {
     *ret << " msgs.req_get=" << m_perf_req_get.read();
     *ret << " msgs.req_atomic=" << m_perf_req_atomic.read();
+    *ret << " msgs.req_atomic_many=" << m_perf_req_atomic_many.read();
     *ret << " msgs.req_search_start=" << m_perf_req_search_start.read();
     *ret << " msgs.req_search_next=" << m_perf_req_search_next.read();
     *ret << " msgs.req_search_stop=" << m_perf_req_search_stop.read();
@@ -1245,9 +2190,84 @@ daemon :: collect_stats_msgs(std::ostringstream* ret)
     *ret << " msgs.chain_subspace=" << m_perf_chain_subspace.read();
     *ret << " msgs.chain_ack=" << m_perf_chain_ack.read();
     *ret << " msgs.chain_gc=" << m_perf_chain_gc.read();
+    *ret << " msgs.chain_batch=" << m_perf_chain_batch.read();
+    *ret << " msgs.chain_read=" << m_perf_chain_read.read();
     *ret << " msgs.xfer_op=" << m_perf_xfer_op.read();
     *ret << " msgs.xfer_ack=" << m_perf_xfer_ack.read();
+    *ret << " msgs.xfer_chunk=" << m_perf_xfer_chunk.read();
+    *ret << " msgs.xfer_tree=" << m_perf_xfer_tree.read();
+    *ret << " msgs.xfer_diff=" << m_perf_xfer_diff.read();
     *ret << " msgs.perf_counters=" << m_perf_perf_counters.read();
+    *ret << " msgs.throttle=" << m_perf_throttle.read();
+}
+
+void
+daemon :: collect_stats_object_cache(std::ostringstream* ret)
+{
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t bytes = 0;
+    m_data.object_cache_stats(&hits, &misses, &bytes);
+    *ret << " cache.hits=" << hits;
+    *ret << " cache.misses=" << misses;
+    *ret << " cache.size=" << bytes;
+}
+
+void
+daemon :: collect_stats_searches(std::ostringstream* ret)
+{
+    *ret << " searches.open=" << m_sm.open_searches();
+    *ret << " searches.buffer_bytes=" << m_sm.buffer_bytes();
+    *ret << " searches.region_bytes=" << m_sm.region_bytes();
+    *ret << " searches.expired=" << m_sm.expired_searches();
+    *ret << " searches.evicted=" << m_sm.evicted_searches();
+}
+
+void
+daemon :: collect_stats_storage(std::ostringstream* ret)
+{
+    for (size_t i = 0; i < storage_pool::NUM_CLASSES; ++i)
+    {
+        storage_pool::work_class wc = static_cast<storage_pool::work_class>(i);
+        const char* name = storage_pool::name(wc);
+        *ret << " storage." << name << ".threads=" << m_pool.threads(wc);
+        *ret << " storage." << name << ".depth=" << m_pool.depth(wc);
+        *ret << " storage." << name << ".max_depth=" << m_pool.max_depth(wc);
+        *ret << " storage." << name << ".wait_us=" << m_pool.wait(wc) / 1000;
+        *ret << " storage." << name << ".processed=" << m_pool.processed(wc);
+        *ret << " storage." << name << ".blocked=" << m_pool.blocked(wc);
+    }
+}
+
+void
+daemon :: collect_stats_transfers(std::ostringstream* ret)
+{
+    *ret << " xfer.objects_sent=" << m_stm.objects_sent();
+    *ret << " xfer.bytes_sent=" << m_stm.bytes_sent();
+    *ret << " xfer.objects_retransmitted=" << m_stm.objects_retransmitted();
+    *ret << " xfer.objects_received=" << m_stm.objects_received();
+    *ret << " xfer.bytes_received=" << m_stm.bytes_received();
+    *ret << " xfer.batches_written=" << m_stm.batches_written();
+    *ret << " xfer.chunks_sent=" << m_stm.chunks_sent();
+    *ret << " xfer.chunks_received=" << m_stm.chunks_received();
+    *ret << " xfer.trees_compared=" << m_stm.trees_compared();
+    *ret << " xfer.leaves_differing=" << m_stm.leaves_differing();
+}
+
+void
+daemon :: collect_stats_throttles(std::ostringstream* ret)
+{
+    throttle* throttles[] = {&m_xfer_throttle, &m_wipe_throttle};
+    const char* names[] = {"transfer", "wipe"};
+
+    for (size_t i = 0; i < 2; ++i)
+    {
+        *ret << " throttle." << names[i] << ".rate=" << throttles[i]->rate();
+        *ret << " throttle." << names[i] << ".effective_rate=" << throttles[i]->effective_rate();
+        *ret << " throttle." << names[i] << ".bytes=" << throttles[i]->bytes();
+        *ret << " throttle." << names[i] << ".throttled=" << throttles[i]->throttled();
+        *ret << " throttle." << names[i] << ".backoffs=" << throttles[i]->backoffs();
+    }
 }
 
 namespace
@@ -1269,6 +2289,11 @@ void
 daemon :: collect_stats_leveldb(std::ostringstream* ret)
 {
     *ret << " leveldb.size=" << m_data.approximate_size();
+    uint64_t dropped = 0;
+    uint64_t purging = 0;
+    m_data.drop_stats(&dropped, &purging);
+    *ret << " leveldb.regions_dropped=" << dropped;
+    *ret << " leveldb.regions_purging=" << purging;
     std::string tmp;
 
     if (m_data.get_property(e::slice("leveldb.stats"), &tmp))
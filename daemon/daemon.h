@@ -28,11 +28,20 @@
 #ifndef hyperdex_daemon_daemon_h_
 #define hyperdex_daemon_daemon_h_
 
+// STL
+#include <list>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
 // po6
 #include <po6/net/hostname.h>
 #include <po6/net/ipaddr.h>
 #include <po6/net/location.h>
 #include <po6/pathname.h>
+#include <po6/threads/cond.h>
+#include <po6/threads/mutex.h>
 #include <po6/threads/thread.h>
 
 // e
@@ -51,6 +60,8 @@
 #include "daemon/replication_manager.h"
 #include "daemon/search_manager.h"
 #include "daemon/state_transfer_manager.h"
+#include "daemon/storage_pool.h"
+#include "daemon/throttle.h"
 
 BEGIN_HYPERDEX_NAMESPACE
 
@@ -68,12 +79,21 @@ class daemon
                 po6::net::location bind_to,
                 bool set_coordinator,
                 po6::net::hostname coordinator,
-                unsigned threads);
+                unsigned threads,
+                uint64_t object_cache_size,
+                const search_manager::parameters& search_params,
+                const storage_pool::parameters& storage_params,
+                uint64_t transfer_rate,
+                uint64_t wipe_rate);
 
     private:
         void loop(size_t thread);
+        void process_message(server_id from, virtual_server_id vfrom, virtual_server_id vto, network_msgtype type, std::auto_ptr<e::buffer> msg, e::unpacker up);
         void process_req_get(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
+        void process_req_get_partial(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
+        void process_req_get_many(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
         void process_req_atomic(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
+        void process_req_atomic_many(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
         void process_req_search_start(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
         void process_req_search_next(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
         void process_req_search_stop(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
@@ -81,23 +101,87 @@ class daemon
         void process_req_group_del(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
         void process_req_count(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
         void process_req_search_describe(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
-        void process_chain_op(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
-        void process_chain_subspace(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
-        void process_chain_ack(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
+        void process_chain_op(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up, replication_manager::batch* b);
+        void process_chain_subspace(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up, replication_manager::batch* b);
+        void process_chain_ack(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up, replication_manager::batch* b);
+        void process_chain_batch(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
         void process_chain_gc(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
+        void process_chain_read(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
+        void process_chain_read_resp(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
         void process_xfer_handshake_syn(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
         void process_xfer_handshake_synack(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
         void process_xfer_handshake_ack(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
         void process_xfer_handshake_wiped(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
         void process_xfer_op(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
         void process_xfer_ack(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
+        void process_xfer_chunk(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
+        void process_xfer_tree(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
+        void process_xfer_diff(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
         void process_backup(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
         void process_perf_counters(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
+        void process_throttle(server_id from, virtual_server_id vfrom, virtual_server_id vto, std::auto_ptr<e::buffer> msg, e::unpacker up);
+
+    private:
+        // true when client work is queueing up, and transfers and wipes
+        // should back off
+        bool foreground_pressure();
+
+    private:
+        // An online backup of a checkpoint copies the snapshot this daemon
+        // took once that checkpoint was stable, when every replica of every
+        // region has committed each write issued before the checkpoint.
+        // Writes issued after it may be in one replica's backup and not
+        // another's, so the snapshot also records this daemon's position in
+        // the chain of each region it holds; restore keeps the copy nearest
+        // the tail, which holds only committed writes.  The copy runs on the
+        // backup thread so it never holds up the main loop.  A request
+        // without a checkpoint gets a LiveBackup of whatever is on disk when
+        // its turn comes.
+        struct backup_snapshot
+        {
+            backup_snapshot() : snap(), positions() {}
+            datalayer::snapshot snap;
+            std::vector<std::pair<region_id, unsigned> > positions;
+        };
+        struct pending_backup
+        {
+            pending_backup(server_id f, virtual_server_id v, uint64_t n,
+                           const std::string& nm, uint64_t c)
+                : from(f), vto(v), nonce(n), name(nm), checkpoint(c) {}
+            server_id from;
+            virtual_server_id vto;
+            uint64_t nonce;
+            std::string name;
+            uint64_t checkpoint;
+        };
+        void end_backup_checkpoint(uint64_t checkpoint_stable);
+        void gc_backup_checkpoints(uint64_t checkpoint_gc);
+        void run_backups();
+        void take_backup(const pending_backup& pb, const backup_snapshot* bs);
+        bool write_backup_manifest(const std::string& path, uint64_t checkpoint,
+                                   const std::vector<std::pair<region_id, unsigned> >& positions);
+        bool reconcile_restored_regions();
+
+    private:
+        // answer a REQ_GET (or REQ_GET_PARTIAL, projecting onto "attrnums")
+        // with "value"
+        void send_get_response(const server_id& client,
+                               const virtual_server_id& us,
+                               uint64_t nonce,
+                               network_msgtype mt,
+                               const std::vector<uint16_t>& attrnums,
+                               network_returncode result,
+                               const std::vector<e::slice>& value);
 
     private:
         void collect_stats();
         void collect_stats_msgs(std::ostringstream* ret);
         void collect_stats_leveldb(std::ostringstream* ret);
+        void collect_stats_object_cache(std::ostringstream* ret);
+        void collect_stats_searches(std::ostringstream* ret);
+        void collect_stats_storage(std::ostringstream* ret);
+        void collect_stats_transfers(std::ostringstream* ret);
+        void collect_stats_throttles(std::ostringstream* ret);
         void determine_block_stat_path(const po6::pathname& data);
         void collect_stats_io(std::ostringstream* ret);
 
@@ -108,6 +192,7 @@ class daemon
         friend class replication_manager;
         friend class search_manager;
         friend class state_transfer_manager;
+        friend class storage_pool;
 
     private:
         server_id m_us;
@@ -120,10 +205,14 @@ class daemon
         replication_manager m_repl;
         state_transfer_manager m_stm;
         search_manager m_sm;
+        storage_pool m_pool;
+        throttle m_xfer_throttle;
+        throttle m_wipe_throttle;
         configuration m_config;
         // counters
         performance_counter m_perf_req_get;
         performance_counter m_perf_req_atomic;
+        performance_counter m_perf_req_atomic_many;
         performance_counter m_perf_req_search_start;
         performance_counter m_perf_req_search_next;
         performance_counter m_perf_req_search_stop;
@@ -135,14 +224,20 @@ class daemon
         performance_counter m_perf_chain_subspace;
         performance_counter m_perf_chain_ack;
         performance_counter m_perf_chain_gc;
+        performance_counter m_perf_chain_batch;
+        performance_counter m_perf_chain_read;
         performance_counter m_perf_xfer_handshake_syn;
         performance_counter m_perf_xfer_handshake_synack;
         performance_counter m_perf_xfer_handshake_ack;
         performance_counter m_perf_xfer_handshake_wiped;
         performance_counter m_perf_xfer_op;
         performance_counter m_perf_xfer_ack;
+        performance_counter m_perf_xfer_chunk;
+        performance_counter m_perf_xfer_tree;
+        performance_counter m_perf_xfer_diff;
         performance_counter m_perf_backup;
         performance_counter m_perf_perf_counters;
+        performance_counter m_perf_throttle;
         // iostat-like stats
         std::string m_block_stat_path;
         // historical data
@@ -150,6 +245,16 @@ class daemon
         po6::threads::mutex m_protect_stats;
         uint64_t m_stats_start;
         std::list<std::pair<uint64_t, std::string> > m_stats;
+        // online backups
+        po6::threads::thread m_backup_thread;
+        po6::threads::mutex m_protect_backups;
+        po6::threads::cond m_wakeup_backups;
+        uint64_t m_backup_checkpoint;
+        std::list<pending_backup> m_backups;
+        // the snapshot taken as each checkpoint since the last one garbage
+        // collected became stable
+        std::map<uint64_t, backup_snapshot> m_backup_snapshots;
+        bool m_backup_shutdown;
 };
 
 END_HYPERDEX_NAMESPACE
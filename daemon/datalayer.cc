@@ -47,7 +47,10 @@
 #include <hyperleveldb/filter_policy.h>
 
 // e
+#include <e/atomic.h>
 #include <e/endian.h>
+#include <e/strescape.h>
+#include <e/time.h>
 
 // HyperDex
 #include "common/datatypes.h"
@@ -58,8 +61,20 @@
 #include "daemon/datalayer.h"
 #include "daemon/datalayer_encodings.h"
 #include "daemon/datalayer_iterator.h"
+#include "daemon/region_tree.h"
 
 #define STRLENOF(x)	(sizeof(x)-1)
+// deletes made by the wiper between visits to the wipe throttle
+#define WIPE_THROTTLE_STRIDE 256
+// bytes a snapshot backup buffers before writing them out
+#define BACKUP_BATCH_SIZE (4ULL * 1024ULL * 1024ULL)
+// statistics are resampled no sooner than the min age, once the region's size
+// drifts, and no later than the max age
+#define STATS_MIN_AGE (60ULL * 1000ULL * 1000ULL * 1000ULL)
+#define STATS_MAX_AGE (3600ULL * 1000ULL * 1000ULL * 1000ULL)
+// the cost of the steps a search takes, relative to reading one entry in order
+#define PLAN_COST_FETCH 4
+#define PLAN_COST_SEEK 2
 
 // ASSUME:  all keys put into leveldb have a first byte without the high bit set
 
@@ -70,18 +85,31 @@ using hyperdex::reconfigure_returncode;
 datalayer :: datalayer(daemon* d)
     : m_daemon(d)
     , m_db()
+    , m_cache()
     , m_checkpointer(make_thread_wrapper(&datalayer::checkpointer, this))
     , m_wiper(make_thread_wrapper(&datalayer::wiper, this))
+    , m_sampler(make_thread_wrapper(&datalayer::sampler, this))
     , m_protect()
     , m_wakeup_checkpointer(&m_protect)
     , m_wakeup_wiper(&m_protect)
+    , m_wakeup_sampler(&m_protect)
     , m_wakeup_reconfigurer(&m_protect)
     , m_shutdown(true)
     , m_need_pause(false)
     , m_checkpointer_paused(false)
     , m_wiper_paused(false)
+    , m_sampler_paused(false)
+    , m_sample_requested(false)
     , m_checkpoint_gc(0)
     , m_wiping()
+    , m_purging()
+    , m_dropped(0)
+    , m_protect_storage()
+    , m_storage(new storage_map())
+    , m_retired_storage()
+    , m_storage_counter(0)
+    , m_protect_stats()
+    , m_stats()
 {
     po6::threads::mutex::hold hold(&m_protect);
 }
@@ -89,6 +117,12 @@ datalayer :: datalayer(daemon* d)
 datalayer :: ~datalayer() throw ()
 {
     shutdown();
+    delete m_storage;
+
+    for (size_t i = 0; i < m_retired_storage.size(); ++i)
+    {
+        delete m_retired_storage[i];
+    }
 }
 
 bool
@@ -204,10 +238,18 @@ datalayer :: initialize(const po6::pathname& path,
         return false;
     }
 
+    if (!load_storage())
+    {
+        return false;
+    }
+
+    load_stats();
+
     {
         po6::threads::mutex::hold hold(&m_protect);
         m_checkpointer.start();
         m_wiper.start();
+        m_sampler.start();
         m_shutdown = false;
     }
 
@@ -262,23 +304,62 @@ datalayer :: unpause()
     assert(m_need_pause);
     m_wakeup_checkpointer.broadcast();
     m_wakeup_wiper.broadcast();
+    m_wakeup_sampler.broadcast();
     m_need_pause = false;
 }
 
 void
-datalayer :: reconfigure(const configuration&,
-                         const configuration&,
-                         const server_id&)
+datalayer :: reconfigure(const configuration& old_config,
+                         const configuration& new_config,
+                         const server_id& us)
 {
     {
         po6::threads::mutex::hold hold(&m_protect);
         assert(m_need_pause);
 
-        while (!m_checkpointer_paused || !m_wiper_paused)
+        while (!m_checkpointer_paused || !m_wiper_paused || !m_sampler_paused)
         {
             m_wakeup_reconfigurer.wait();
         }
     }
+
+    {
+        po6::threads::mutex::hold hold(&m_protect_storage);
+
+        for (size_t i = 0; i < m_retired_storage.size(); ++i)
+        {
+            delete m_retired_storage[i];
+        }
+
+        m_retired_storage.clear();
+    }
+
+    // A server that is not available may come back and repair its regions
+    // from what it has, so only drop regions that moved away from a healthy
+    // server or whose space was removed.
+    if (new_config.get_state(us) != server::AVAILABLE)
+    {
+        return;
+    }
+
+    std::vector<region_id> old_regions;
+    std::vector<region_id> new_regions;
+    old_config.mapped_regions(us, &old_regions);
+    old_config.transfers_in_regions(us, &old_regions);
+    new_config.mapped_regions(us, &new_regions);
+    new_config.transfers_in_regions(us, &new_regions);
+    std::sort(old_regions.begin(), old_regions.end());
+    old_regions.erase(std::unique(old_regions.begin(), old_regions.end()), old_regions.end());
+    std::sort(new_regions.begin(), new_regions.end());
+
+    for (size_t i = 0; i < old_regions.size(); ++i)
+    {
+        if (!std::binary_search(new_regions.begin(), new_regions.end(), old_regions[i]))
+        {
+            wipe_checkpoints(old_regions[i]);
+            drop_region(old_regions[i]);
+        }
+    }
 }
 
 bool
@@ -308,6 +389,93 @@ datalayer :: approximate_size()
     return ret;
 }
 
+uint64_t
+datalayer :: approximate_size(const region_id& ri)
+{
+    std::vector<char> scratch_start;
+    std::vector<char> scratch_limit;
+    leveldb::Slice start;
+    leveldb::Slice limit;
+    region_id si(storage_for(ri));
+    encode_object_region(si, &scratch_start, &start);
+    encode_object_region(si, &scratch_limit, &limit);
+    encode_bump(&scratch_limit.front(), &scratch_limit.front() + limit.size());
+    leveldb::Range r(start, limit);
+    uint64_t ret = 0;
+    m_db->GetApproximateSizes(&r, 1, &ret);
+    return ret;
+}
+
+void
+datalayer :: object_cache_stats(uint64_t* hits, uint64_t* misses, uint64_t* bytes)
+{
+    *hits = m_cache.hits();
+    *misses = m_cache.misses();
+    *bytes = m_cache.size();
+}
+
+void
+datalayer :: drop_stats(uint64_t* dropped, uint64_t* purging)
+{
+    po6::threads::mutex::hold hold(&m_protect);
+    *dropped = m_dropped;
+    *purging = m_purging.size();
+}
+
+void
+datalayer :: set_object_cache_size(uint64_t bytes)
+{
+    m_cache.set_capacity(bytes);
+}
+
+void
+datalayer :: refresh_stats()
+{
+    po6::threads::mutex::hold hold(&m_protect);
+    m_sample_requested = true;
+    m_wakeup_sampler.broadcast();
+}
+
+e::compat::shared_ptr<const hyperdex::index_stats>
+datalayer :: stats_for(const region_id& ri)
+{
+    return stats_for_storage(storage_for(ri));
+}
+
+uint64_t
+datalayer :: sampled_size(const region_id& ri)
+{
+    e::compat::shared_ptr<const index_stats> stats(stats_for(ri));
+    return stats ? stats->approximate_size : 0;
+}
+
+e::compat::shared_ptr<const hyperdex::index_stats>
+datalayer :: stats_for_storage(const region_id& si)
+{
+    po6::threads::mutex::hold hold(&m_protect_stats);
+    std::map<region_id, e::compat::shared_ptr<const index_stats> >::iterator it;
+    it = m_stats.find(si);
+    return it != m_stats.end() ? it->second : e::compat::shared_ptr<const index_stats>();
+}
+
+bool
+datalayer :: pace_background(uint64_t bytes)
+{
+    {
+        po6::threads::mutex::hold hold(&m_protect);
+
+        if (m_need_pause || m_shutdown)
+        {
+            return false;
+        }
+    }
+
+    // sampling and wiping share one budget for background I/O
+    m_daemon->m_wipe_throttle.adjust(e::time(), m_daemon->foreground_pressure());
+    m_daemon->m_wipe_throttle.acquire(bytes);
+    return true;
+}
+
 datalayer::returncode
 datalayer :: get(const region_id& ri,
                  const e::slice& key,
@@ -320,7 +488,19 @@ datalayer :: get(const region_id& ri,
 
     // create the encoded key
     leveldb::Slice lkey;
-    encode_key(ri, sc.attrs[0].type, key, &scratch, &lkey);
+    encode_key(storage_for(ri), sc.attrs[0].type, key, &scratch, &lkey);
+    e::slice ckey(lkey.data(), lkey.size());
+    e::intrusive_ptr<object_cache::entry> ent;
+
+    if (m_cache.lookup(ckey, &ent))
+    {
+        *value = ent->value;
+        *version = ent->version;
+        ref->m_cached = ent;
+        return SUCCESS;
+    }
+
+    uint64_t generation = m_cache.generation(ckey);
 
     // perform the read
     leveldb::ReadOptions opts;
@@ -328,7 +508,25 @@ datalayer :: get(const region_id& ri,
     opts.verify_checksums = true;
     leveldb::Status st = m_db->Get(opts, lkey, &ref->m_backing);
 
-    if (st.ok())
+    if (st.ok() && m_cache.enabled())
+    {
+        ent = new object_cache::entry(ckey);
+        ent->backing.swap(ref->m_backing);
+        e::slice v(ent->backing.data(), ent->backing.size());
+        returncode rc = decode_value(v, &ent->value, &ent->version);
+
+        if (rc != SUCCESS)
+        {
+            return rc;
+        }
+
+        m_cache.insert(generation, ent);
+        *value = ent->value;
+        *version = ent->version;
+        ref->m_cached = ent;
+        return SUCCESS;
+    }
+    else if (st.ok())
     {
         e::slice v(ref->m_backing.data(), ref->m_backing.size());
         return decode_value(v, value, version);
@@ -343,6 +541,121 @@ datalayer :: get(const region_id& ri,
     }
 }
 
+namespace
+{
+
+class encoded_key_less
+{
+    public:
+        encoded_key_less(const std::vector<leveldb::Slice>* lkeys) : m_lkeys(lkeys) {}
+
+    public:
+        bool operator () (size_t lhs, size_t rhs) const
+        { return (*m_lkeys)[lhs].compare((*m_lkeys)[rhs]) < 0; }
+
+    private:
+        const std::vector<leveldb::Slice>* m_lkeys;
+};
+
+} // namespace
+
+void
+datalayer :: get_many(const region_id& ri,
+                      const std::vector<e::slice>& keys,
+                      std::vector<returncode>* rcs,
+                      std::vector<std::vector<e::slice> >* values,
+                      std::vector<uint64_t>* versions,
+                      std::vector<reference>* refs)
+{
+    const schema& sc(*m_daemon->m_config.get_schema(ri));
+    std::vector<std::vector<char> > scratch(keys.size());
+    std::vector<leveldb::Slice> lkeys(keys.size());
+    std::vector<uint64_t> generations(keys.size());
+    std::vector<size_t> misses;
+    rcs->assign(keys.size(), NOT_FOUND);
+    values->clear();
+    values->resize(keys.size());
+    versions->assign(keys.size(), 0);
+    refs->clear();
+    refs->resize(keys.size());
+    region_id si(storage_for(ri));
+
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        encode_key(si, sc.attrs[0].type, keys[i], &scratch[i], &lkeys[i]);
+        e::slice ckey(lkeys[i].data(), lkeys[i].size());
+        e::intrusive_ptr<object_cache::entry> ent;
+
+        if (m_cache.lookup(ckey, &ent))
+        {
+            (*rcs)[i] = SUCCESS;
+            (*values)[i] = ent->value;
+            (*versions)[i] = ent->version;
+            (*refs)[i].m_cached = ent;
+            continue;
+        }
+
+        generations[i] = m_cache.generation(ckey);
+        misses.push_back(i);
+    }
+
+    if (misses.empty())
+    {
+        return;
+    }
+
+    // visit the misses in key order so that one iterator walks forward
+    // through the region instead of starting a fresh lookup for each key
+    std::sort(misses.begin(), misses.end(), encoded_key_less(&lkeys));
+    leveldb::ReadOptions opts;
+    opts.fill_cache = true;
+    opts.verify_checksums = true;
+    std::auto_ptr<leveldb::Iterator> it(m_db->NewIterator(opts));
+
+    for (size_t m = 0; m < misses.size(); ++m)
+    {
+        size_t i = misses[m];
+        reference* ref = &(*refs)[i];
+        it->Seek(lkeys[i]);
+
+        if (!it->status().ok())
+        {
+            (*rcs)[i] = handle_error(it->status());
+            continue;
+        }
+
+        if (!it->Valid() || it->key().compare(lkeys[i]) != 0)
+        {
+            (*rcs)[i] = NOT_FOUND;
+            continue;
+        }
+
+        ref->m_backing.assign(it->value().data(), it->value().size());
+
+        if (m_cache.enabled())
+        {
+            e::intrusive_ptr<object_cache::entry> ent;
+            ent = new object_cache::entry(e::slice(lkeys[i].data(), lkeys[i].size()));
+            ent->backing.swap(ref->m_backing);
+            e::slice v(ent->backing.data(), ent->backing.size());
+            (*rcs)[i] = decode_value(v, &ent->value, &ent->version);
+
+            if ((*rcs)[i] == SUCCESS)
+            {
+                m_cache.insert(generations[i], ent);
+                (*values)[i] = ent->value;
+                (*versions)[i] = ent->version;
+                ref->m_cached = ent;
+            }
+        }
+        else
+        {
+            e::slice v(ref->m_backing.data(), ref->m_backing.size());
+            (*rcs)[i] = decode_value(v, &(*values)[i], &(*versions)[i]);
+        }
+    }
+}
+
 datalayer::returncode
 datalayer :: del(const region_id& ri,
                  const region_id& reg_id,
@@ -350,196 +663,293 @@ datalayer :: del(const region_id& ri,
                  const e::slice& key,
                  const std::vector<e::slice>& old_value)
 {
-    leveldb::WriteBatch updates;
+    write_batch wb;
+    del(ri, reg_id, seq_id, key, old_value, &wb);
+    return write(&wb);
+}
+
+datalayer::returncode
+datalayer :: put(const region_id& ri,
+                 const region_id& reg_id,
+                 uint64_t seq_id,
+                 const e::slice& key,
+                 const std::vector<e::slice>& new_value,
+                 uint64_t version)
+{
+    write_batch wb;
+    put(ri, reg_id, seq_id, key, new_value, version, &wb);
+    return write(&wb);
+}
+
+datalayer::returncode
+datalayer :: overput(const region_id& ri,
+                     const region_id& reg_id,
+                     uint64_t seq_id,
+                     const e::slice& key,
+                     const std::vector<e::slice>& old_value,
+                     const std::vector<e::slice>& new_value,
+                     uint64_t version)
+{
+    write_batch wb;
+    overput(ri, reg_id, seq_id, key, old_value, new_value, version, &wb);
+    return write(&wb);
+}
+
+void
+datalayer :: del(const region_id& ri,
+                 const region_id& reg_id,
+                 uint64_t seq_id,
+                 const e::slice& key,
+                 const std::vector<e::slice>& old_value,
+                 write_batch* wb)
+{
     const schema& sc(*m_daemon->m_config.get_schema(ri));
     std::vector<char> scratch;
+    region_id si(storage_for(ri));
 
     // create the encoded key
     leveldb::Slice lkey;
-    encode_key(ri, sc.attrs[0].type, key, &scratch, &lkey);
+    encode_key(si, sc.attrs[0].type, key, &scratch, &lkey);
 
     // delete the actual object
-    updates.Delete(lkey);
+    wb->m_updates.Delete(lkey);
+    wb->m_keys.push_back(std::string(lkey.data(), lkey.size()));
 
     // delete the index entries
     const subspace& sub(*m_daemon->m_config.get_subspace(ri));
-    create_index_changes(sc, sub, ri, key, &old_value, NULL, &updates);
+    create_index_changes(sc, sub, si, key, &old_value, NULL, &wb->m_updates);
 
     // Mark acked as part of this batch write
     if (seq_id != 0)
     {
-        char abacking[ACKED_BUF_SIZE];
-        seq_id = UINT64_MAX - seq_id;
-        encode_acked(ri, reg_id, seq_id, abacking);
-        leveldb::Slice akey(abacking, ACKED_BUF_SIZE);
-        leveldb::Slice aval("", 0);
-        updates.Put(akey, aval);
-    }
-
-    // Perform the write
-    leveldb::WriteOptions opts;
-    opts.sync = false;
-    leveldb::Status st = m_db->Write(opts, &updates);
-
-    if (st.ok())
-    {
-        return SUCCESS;
-    }
-    else if (st.IsNotFound())
-    {
-        return NOT_FOUND;
-    }
-    else
-    {
-        return handle_error(st);
+        mark_acked(ri, reg_id, seq_id, wb);
     }
 }
 
-datalayer::returncode
+void
 datalayer :: put(const region_id& ri,
                  const region_id& reg_id,
                  uint64_t seq_id,
                  const e::slice& key,
                  const std::vector<e::slice>& new_value,
-                 uint64_t version)
+                 uint64_t version,
+                 write_batch* wb)
 {
-    leveldb::WriteBatch updates;
     const schema& sc(*m_daemon->m_config.get_schema(ri));
     std::vector<char> scratch1;
     std::vector<char> scratch2;
+    region_id si(storage_for(ri));
 
     // create the encoded key
     leveldb::Slice lkey;
-    encode_key(ri, sc.attrs[0].type, key, &scratch1, &lkey);
+    encode_key(si, sc.attrs[0].type, key, &scratch1, &lkey);
 
     // create the encoded value
     leveldb::Slice lval;
     encode_value(new_value, version, &scratch2, &lval);
 
     // put the actual object
-    updates.Put(lkey, lval);
+    wb->m_updates.Put(lkey, lval);
+    wb->m_keys.push_back(std::string(lkey.data(), lkey.size()));
 
     // put the index entries
     const subspace& sub(*m_daemon->m_config.get_subspace(ri));
-    create_index_changes(sc, sub, ri, key, NULL, &new_value, &updates);
+    create_index_changes(sc, sub, si, key, NULL, &new_value, &wb->m_updates);
 
     // Mark acked as part of this batch write
     if (seq_id != 0)
     {
-        char abacking[ACKED_BUF_SIZE];
-        seq_id = UINT64_MAX - seq_id;
-        encode_acked(ri, reg_id, seq_id, abacking);
-        leveldb::Slice akey(abacking, ACKED_BUF_SIZE);
-        leveldb::Slice aval("", 0);
-        updates.Put(akey, aval);
-    }
-
-    // Perform the write
-    leveldb::WriteOptions opts;
-    opts.sync = false;
-    leveldb::Status st = m_db->Write(opts, &updates);
-
-    if (st.ok())
-    {
-        return SUCCESS;
-    }
-    else
-    {
-        return handle_error(st);
+        mark_acked(ri, reg_id, seq_id, wb);
     }
 }
 
-datalayer::returncode
+void
 datalayer :: overput(const region_id& ri,
                      const region_id& reg_id,
                      uint64_t seq_id,
                      const e::slice& key,
                      const std::vector<e::slice>& old_value,
                      const std::vector<e::slice>& new_value,
-                     uint64_t version)
+                     uint64_t version,
+                     write_batch* wb)
 {
-    leveldb::WriteBatch updates;
     const schema& sc(*m_daemon->m_config.get_schema(ri));
     std::vector<char> scratch1;
     std::vector<char> scratch2;
+    region_id si(storage_for(ri));
 
     // create the encoded key
     leveldb::Slice lkey;
-    encode_key(ri, sc.attrs[0].type, key, &scratch1, &lkey);
+    encode_key(si, sc.attrs[0].type, key, &scratch1, &lkey);
 
     // create the encoded value
     leveldb::Slice lval;
     encode_value(new_value, version, &scratch2, &lval);
 
     // put the actual object
-    updates.Put(lkey, lval);
+    wb->m_updates.Put(lkey, lval);
+    wb->m_keys.push_back(std::string(lkey.data(), lkey.size()));
 
     // put the index entries
     const subspace& sub(*m_daemon->m_config.get_subspace(ri));
-    create_index_changes(sc, sub, ri, key, &old_value, &new_value, &updates);
+    create_index_changes(sc, sub, si, key, &old_value, &new_value, &wb->m_updates);
 
     // Mark acked as part of this batch write
     if (seq_id != 0)
     {
-        char abacking[ACKED_BUF_SIZE];
-        seq_id = UINT64_MAX - seq_id;
-        encode_acked(ri, reg_id, seq_id, abacking);
-        leveldb::Slice akey(abacking, ACKED_BUF_SIZE);
-        leveldb::Slice aval("", 0);
-        updates.Put(akey, aval);
+        mark_acked(ri, reg_id, seq_id, wb);
     }
+}
+
+void
+datalayer :: mark_acked(const region_id& ri,
+                        const region_id& reg_id,
+                        uint64_t seq_id,
+                        write_batch* wb)
+{
+    char abacking[ACKED_BUF_SIZE];
+    seq_id = UINT64_MAX - seq_id;
+    encode_acked(ri, reg_id, seq_id, abacking);
+    leveldb::Slice akey(abacking, ACKED_BUF_SIZE);
+    leveldb::Slice aval("", 0);
+    wb->m_updates.Put(akey, aval);
+    ++wb->m_acked;
+}
 
-    // Perform the write
+datalayer::returncode
+datalayer :: write(write_batch* wb)
+{
     leveldb::WriteOptions opts;
     opts.sync = false;
-    leveldb::Status st = m_db->Write(opts, &updates);
+    leveldb::Status st = m_db->Write(opts, &wb->m_updates);
+
+    for (size_t i = 0; i < wb->m_keys.size(); ++i)
+    {
+        m_cache.invalidate(e::slice(wb->m_keys[i].data(), wb->m_keys[i].size()));
+    }
+
+    wb->m_updates.Clear();
+    wb->m_keys.clear();
+    wb->m_acked = 0;
 
     if (st.ok())
     {
         return SUCCESS;
     }
+    else if (st.IsNotFound())
+    {
+        return NOT_FOUND;
+    }
     else
     {
         return handle_error(st);
     }
 }
 
-datalayer::returncode
-datalayer :: uncertain_del(const region_id& ri,
-                           const e::slice& key)
+namespace
 {
-    const schema& sc(*m_daemon->m_config.get_schema(ri));
-    std::vector<char> scratch;
-
-    // create the encoded key
-    leveldb::Slice lkey;
-    encode_key(ri, sc.attrs[0].type, key, &scratch, &lkey);
-
-    // perform the read
-    std::string ref;
-    leveldb::ReadOptions opts;
-    opts.fill_cache = true;
-    opts.verify_checksums = true;
-    leveldb::Status st = m_db->Get(opts, lkey, &ref);
 
-    if (st.ok())
+// True if writing an object in the subspace changes any index entries, and
+// so the old value must be known to remove the stale ones
+bool
+has_index_entries(const hyperdex::subspace& sub)
+{
+    if (!sub.indices.empty())
     {
-        std::vector<e::slice> old_value;
-        uint64_t old_version;
-        returncode rc = decode_value(e::slice(ref.data(), ref.size()),
-                                     &old_value, &old_version);
+        return true;
+    }
 
-        if (rc != SUCCESS)
+    for (size_t i = 0; i < sub.attrs.size(); ++i)
+    {
+        if (sub.attrs[i] != 0)
         {
-            return rc;
+            return true;
         }
+    }
 
-        if (old_value.size() + 1 != sc.attrs_sz)
-        {
-            return BAD_ENCODING;
-        }
+    return false;
+}
+
+} // namespace
+
+datalayer::returncode
+datalayer :: uncertain_del(const region_id& ri,
+                           const e::slice& key)
+{
+    write_batch wb;
+    returncode rc = uncertain_del(ri, key, &wb);
+
+    if (rc != SUCCESS || wb.empty())
+    {
+        return rc;
+    }
+
+    return write(&wb);
+}
+
+datalayer::returncode
+datalayer :: uncertain_put(const region_id& ri,
+                           const e::slice& key,
+                           const std::vector<e::slice>& new_value,
+                           uint64_t version)
+{
+    write_batch wb;
+    returncode rc = uncertain_put(ri, key, new_value, version, &wb);
+
+    if (rc != SUCCESS)
+    {
+        return rc;
+    }
+
+    return write(&wb);
+}
+
+datalayer::returncode
+datalayer :: uncertain_del(const region_id& ri,
+                           const e::slice& key,
+                           write_batch* wb)
+{
+    const schema& sc(*m_daemon->m_config.get_schema(ri));
+    std::vector<char> scratch;
 
-        return del(ri, region_id(), 0, key, old_value);
+    // create the encoded key
+    leveldb::Slice lkey;
+    encode_key(storage_for(ri), sc.attrs[0].type, key, &scratch, &lkey);
+
+    // without index entries to clean up, there is no need to read
+    if (!has_index_entries(*m_daemon->m_config.get_subspace(ri)))
+    {
+        wb->m_updates.Delete(lkey);
+        wb->m_keys.push_back(std::string(lkey.data(), lkey.size()));
+        return SUCCESS;
+    }
+
+    // perform the read
+    std::string ref;
+    leveldb::ReadOptions opts;
+    opts.fill_cache = true;
+    opts.verify_checksums = true;
+    leveldb::Status st = m_db->Get(opts, lkey, &ref);
+
+    if (st.ok())
+    {
+        std::vector<e::slice> old_value;
+        uint64_t old_version;
+        returncode rc = decode_value(e::slice(ref.data(), ref.size()),
+                                     &old_value, &old_version);
+
+        if (rc != SUCCESS)
+        {
+            return rc;
+        }
+
+        if (old_value.size() + 1 != sc.attrs_sz)
+        {
+            return BAD_ENCODING;
+        }
+
+        del(ri, region_id(), 0, key, old_value, wb);
+        return SUCCESS;
     }
     else if (st.IsNotFound())
     {
@@ -555,14 +965,22 @@ datalayer::returncode
 datalayer :: uncertain_put(const region_id& ri,
                            const e::slice& key,
                            const std::vector<e::slice>& new_value,
-                           uint64_t version)
+                           uint64_t version,
+                           write_batch* wb)
 {
+    // without index entries to clean up, the object may be overwritten blind
+    if (!has_index_entries(*m_daemon->m_config.get_subspace(ri)))
+    {
+        put(ri, region_id(), 0, key, new_value, version, wb);
+        return SUCCESS;
+    }
+
     const schema& sc(*m_daemon->m_config.get_schema(ri));
     std::vector<char> scratch;
 
     // create the encoded key
     leveldb::Slice lkey;
-    encode_key(ri, sc.attrs[0].type, key, &scratch, &lkey);
+    encode_key(storage_for(ri), sc.attrs[0].type, key, &scratch, &lkey);
 
     // perform the read
     std::string ref;
@@ -588,11 +1006,13 @@ datalayer :: uncertain_put(const region_id& ri,
             return BAD_ENCODING;
         }
 
-        return overput(ri, region_id(), 0, key, old_value, new_value, version);
+        overput(ri, region_id(), 0, key, old_value, new_value, version, wb);
+        return SUCCESS;
     }
     else if (st.IsNotFound())
     {
-        return put(ri, region_id(), 0, key, new_value, version);
+        put(ri, region_id(), 0, key, new_value, version, wb);
+        return SUCCESS;
     }
     else
     {
@@ -788,11 +1208,6 @@ datalayer :: make_region_iterator(snapshot snap,
                                   returncode* error)
 {
     *error = datalayer::SUCCESS;
-    const size_t backing_sz = sizeof(uint8_t) + sizeof(uint64_t);
-    char backing[backing_sz];
-    char* ptr = backing;
-    ptr = e::pack8be('o', ptr);
-    ptr = e::pack64be(ri.get(), ptr);
 
     leveldb::ReadOptions opts;
     opts.fill_cache = true;
@@ -801,10 +1216,10 @@ datalayer :: make_region_iterator(snapshot snap,
     leveldb_iterator_ptr iter;
     iter.reset(snap, m_db->NewIterator(opts));
     const schema& sc(*m_daemon->m_config.get_schema(ri));
-    return new region_iterator(iter, ri, index_info::lookup(sc.attrs[0].type));
+    return new region_iterator(iter, storage_for(ri), index_info::lookup(sc.attrs[0].type));
 }
 
-datalayer::iterator*
+datalayer::search_iterator*
 datalayer :: make_search_iterator(snapshot snap,
                                   const region_id& ri,
                                   const std::vector<attribute_check>& checks,
@@ -818,6 +1233,12 @@ datalayer :: make_search_iterator(snapshot snap,
     range_searches(checks, &ranges);
     index_info* ki = index_info::lookup(sc.attrs[0].type);
     const subspace& sub(*m_daemon->m_config.get_subspace(ri));
+    region_id si(storage_for(ri));
+    // with statistics, plan from an estimate of the entries each iterator
+    // visits; without, fall back to asking LevelDB for the size of each range
+    e::compat::shared_ptr<const index_stats> stats(stats_for_storage(si));
+    bool planned = stats && stats->objects > 0;
+    std::vector<uint64_t> estimates;
 
     // for each range query, construct an iterator
     for (size_t i = 0; i < ranges.size(); ++i)
@@ -825,7 +1246,7 @@ datalayer :: make_search_iterator(snapshot snap,
         if (ranges[i].invalid)
         {
             if (ostr) *ostr << "encountered invalid range; returning no results\n";
-            return new dummy_iterator();
+            return new search_iterator(this, ri, new dummy_iterator(), ostr, &checks);
         }
 
         assert(ranges[i].attr < sc.attrs_sz);
@@ -845,11 +1266,15 @@ datalayer :: make_search_iterator(snapshot snap,
 
         if (ii)
         {
-            e::intrusive_ptr<index_iterator> it = ii->iterator_from_range(snap, ri, ranges[i], ki);
+            e::intrusive_ptr<index_iterator> it = ii->iterator_from_range(snap, si, ranges[i], ki);
 
             if (it)
             {
+                uint64_t est = 0;
+                planned = planned && ranges[i].attr < stats->attrs.size() &&
+                          ii->estimate_range(stats->attrs[ranges[i].attr], ranges[i], &est);
                 iterators.push_back(it);
+                estimates.push_back(est);
             }
         }
     }
@@ -873,16 +1298,20 @@ datalayer :: make_search_iterator(snapshot snap,
 
         if (ii)
         {
-            e::intrusive_ptr<index_iterator> it = ii->iterator_from_check(snap, ri, checks[i], ki);
+            e::intrusive_ptr<index_iterator> it = ii->iterator_from_check(snap, si, checks[i], ki);
 
             if (it)
             {
+                uint64_t est = 0;
+                planned = planned && checks[i].attr < stats->attrs.size() &&
+                          ii->estimate_check(stats->attrs[checks[i].attr], checks[i], &est);
                 iterators.push_back(it);
+                estimates.push_back(est);
             }
         }
     }
 
-    // figure out the cost of accessing all objects
+    // accessing all objects reads each in place
     e::intrusive_ptr<index_iterator> full_scan;
     range scan;
     scan.attr = 0;
@@ -890,58 +1319,247 @@ datalayer :: make_search_iterator(snapshot snap,
     scan.has_start = false;
     scan.has_end = false;
     scan.invalid = false;
-    full_scan = ki->iterator_from_range(snap, ri, scan, ki);
-    if (ostr) *ostr << " accessing all objects has cost " << full_scan->cost(m_db.get()) << "\n";
+    full_scan = ki->iterator_from_range(snap, si, scan, ki);
+    e::intrusive_ptr<index_iterator> best;
+    uint64_t est_candidates = 0;
+    uint64_t est_matches = 0;
 
-    // figure out the cost of each iterator
-    // we do this here and not below so that iterators can cache the size and we
-    // don't ping-pong between HyperDex and LevelDB.
-    for (size_t i = 0; i < iterators.size(); ++i)
+    if (planned)
     {
-        uint64_t iterator_cost = iterators[i]->cost(m_db.get());
-        if (ostr) *ostr << " iterator " << *iterators[i] << " has cost " << iterator_cost << "\n";
-    }
+        const double objects = stats->objects;
+        uint64_t best_cost = stats->objects;
+        best = full_scan;
+        est_candidates = stats->objects;
+
+        if (ostr) *ostr << " using statistics of " << stats->objects << " objects taken "
+                        << (e::time() - stats->taken) / 1000000000ULL << "s ago\n"
+                        << " accessing all objects has estimated cost " << best_cost << "\n";
+
+        // an unsorted iterator is used alone, fetching each object it names
+        std::vector<std::pair<uint64_t, size_t> > sorted;
+
+        for (size_t i = 0; i < iterators.size(); ++i)
+        {
+            if (ostr) *ostr << " iterator " << *iterators[i] << " has an estimated "
+                            << estimates[i] << " entries\n";
+
+            if (iterators[i]->sorted())
+            {
+                sorted.push_back(std::make_pair(estimates[i], i));
+                continue;
+            }
+
+            uint64_t cost = estimates[i] + (iterators[i]->has_value() ? 0 : estimates[i] * PLAN_COST_FETCH);
+            if (ostr) *ostr << " using it alone has estimated cost " << cost << "\n";
+
+            if (cost < best_cost)
+            {
+                best = iterators[i];
+                best_cost = cost;
+                est_candidates = estimates[i];
+            }
+        }
+
+        // sorted iterators intersect, most selective first: the search walks
+        // the first, seeks each of the others once per key that survived the
+        // ones before it (or reads it through, if that is cheaper), and then
+        // fetches the keys that survive them all, assuming the checks are
+        // independent of one another
+        std::sort(sorted.begin(), sorted.end());
+        bool fetch = !sorted.empty() && !iterators[sorted[0].second]->has_value();
+        double walked = 0;
+        double survivors = 0;
+        size_t best_sorted = 0;
+
+        for (size_t i = 0; i < sorted.size(); ++i)
+        {
+            double est = sorted[i].first;
+
+            if (i == 0)
+            {
+                walked = est;
+                survivors = est;
+            }
+            else
+            {
+                walked += std::min(survivors * PLAN_COST_SEEK, est);
+                survivors *= std::min(est / objects, 1.0);
+            }
+
+            uint64_t cost = static_cast<uint64_t>(walked + (fetch ? survivors * PLAN_COST_FETCH : 0));
+            if (ostr) *ostr << " intersecting the " << i + 1 << " most selective sorted iterators"
+                            << " has estimated cost " << cost << "\n";
 
-    std::vector<e::intrusive_ptr<index_iterator> > sorted;
-    std::vector<e::intrusive_ptr<index_iterator> > unsorted;
+            if (cost < best_cost)
+            {
+                best_sorted = i + 1;
+                best_cost = cost;
+                est_candidates = static_cast<uint64_t>(survivors);
+            }
+        }
+
+        if (best_sorted == 1)
+        {
+            best = iterators[sorted[0].second];
+        }
+        else if (best_sorted > 1)
+        {
+            std::vector<e::intrusive_ptr<index_iterator> > iters;
+            std::vector<uint64_t> costs;
+
+            for (size_t i = 0; i < best_sorted; ++i)
+            {
+                iters.push_back(iterators[sorted[i].second]);
+                costs.push_back(sorted[i].first);
+            }
+
+            best = new intersect_iterator(snap, iters, costs);
+        }
+
+        double matches = objects;
+
+        for (size_t i = 0; i < iterators.size(); ++i)
+        {
+            matches *= std::min(estimates[i] / objects, 1.0);
+        }
 
-    for (size_t i = 0; i < iterators.size(); ++i)
+        est_matches = static_cast<uint64_t>(matches);
+    }
+    else
     {
-        if (iterators[i]->sorted())
+        // figure out the cost of each iterator once; an intersection reuses
+        // the costs rather than ping-pong between HyperDex and LevelDB
+        uint64_t full_cost = full_scan->cost(m_db.get());
+        if (ostr) *ostr << " accessing all objects has cost " << full_cost << "\n";
+        std::vector<e::intrusive_ptr<index_iterator> > sorted;
+        std::vector<uint64_t> sorted_costs;
+        uint64_t sorted_cost = 0;
+        e::intrusive_ptr<index_iterator> unsorted;
+        uint64_t unsorted_cost = 0;
+
+        for (size_t i = 0; i < iterators.size(); ++i)
+        {
+            uint64_t iterator_cost = iterators[i]->cost(m_db.get());
+            if (ostr) *ostr << " iterator " << *iterators[i] << " has cost " << iterator_cost << "\n";
+
+            if (iterators[i]->sorted())
+            {
+                sorted.push_back(iterators[i]);
+                sorted_costs.push_back(iterator_cost);
+                sorted_cost += iterator_cost;
+            }
+            else if (!unsorted)
+            {
+                unsorted = iterators[i];
+                unsorted_cost = iterator_cost;
+            }
+        }
+
+        uint64_t cost = full_cost;
+
+        if (!sorted.empty())
+        {
+            best = new intersect_iterator(snap, sorted, sorted_costs);
+            cost = sorted_cost;
+        }
+        else if (unsorted)
         {
-            sorted.push_back(iterators[i]);
+            best = unsorted;
+            cost = unsorted_cost;
         }
         else
         {
-            unsorted.push_back(iterators[i]);
+            best = full_scan;
+        }
+
+        if (cost > 0 && cost * 4 > full_cost)
+        {
+            best = full_scan;
         }
     }
 
-    e::intrusive_ptr<index_iterator> best;
+    assert(best);
+    if (ostr) *ostr << " choosing to use " << *best << "\n";
+    search_iterator* ret = new search_iterator(this, ri, best, ostr, &checks);
 
-    if (!best && !sorted.empty())
+    if (planned)
     {
-        best = new intersect_iterator(snap, sorted);
+        if (ostr) *ostr << " estimating " << est_candidates << " candidates and "
+                        << est_matches << " matches\n";
+        ret->set_estimate(est_candidates, est_matches);
     }
-    else if (!best && !unsorted.empty())
+
+    return ret;
+}
+
+datalayer::search_iterator*
+datalayer :: make_sorted_iterator(snapshot snap,
+                                  const region_id& ri,
+                                  const std::vector<attribute_check>& checks,
+                                  uint16_t sort_by,
+                                  bool maximize,
+                                  const e::slice* after_value,
+                                  const e::slice* after_key,
+                                  std::ostringstream* ostr)
+{
+    const schema& sc(*m_daemon->m_config.get_schema(ri));
+    const subspace& sub(*m_daemon->m_config.get_subspace(ri));
+
+    // the key is always in order; other attributes need an index
+    if (sort_by >= sc.attrs_sz ||
+        (sort_by != 0 && !sub.indexed(sort_by)))
     {
-        best = unsorted[0];
+        return NULL;
     }
-    else
+
+    index_info* ii = index_info::lookup(sc.attrs[sort_by].type);
+    index_info* ki = index_info::lookup(sc.attrs[0].type);
+
+    if (!ii || !ki)
     {
-        best = full_scan;
+        return NULL;
     }
 
-    assert(best);
-    uint64_t cost = best->cost(m_db.get());
+    // narrow the walk to the range the checks place on sort_by; the search
+    // iterator applies every check, including the others
+    std::vector<range> ranges;
+    range_searches(checks, &ranges);
+    range r;
+    r.attr = sort_by;
+    r.type = sc.attrs[sort_by].type;
+    r.has_start = false;
+    r.has_end = false;
+    r.invalid = false;
 
-    if (cost > 0 && cost * 4 > full_scan->cost(m_db.get()))
+    for (size_t i = 0; i < ranges.size(); ++i)
     {
-        best = full_scan;
+        if (ranges[i].invalid)
+        {
+            if (ostr) *ostr << "encountered invalid range; returning no results\n";
+            return new search_iterator(this, ri, new dummy_iterator(), ostr, &checks);
+        }
+
+        if (ranges[i].attr == sort_by)
+        {
+            r = ranges[i];
+        }
     }
 
-    if (ostr) *ostr << " choosing to use " << *best << "\n";
-    return new search_iterator(this, ri, best, ostr, &checks);
+    e::intrusive_ptr<index_iterator> it;
+    it = ii->iterator_in_order(snap, storage_for(ri), r, ki, maximize);
+
+    if (!it)
+    {
+        return NULL;
+    }
+
+    if (after_key)
+    {
+        it->seek_after(after_value ? *after_value : *after_key, *after_key);
+    }
+
+    if (ostr) *ostr << " walking attr " << sort_by << " in order using " << *it << "\n";
+    return new search_iterator(this, ri, it, ostr, &checks);
 }
 
 bool
@@ -971,97 +1589,239 @@ datalayer :: backup(const e::slice& _name)
     }
 }
 
-datalayer::returncode
-datalayer :: get_from_iterator(const region_id& ri,
-                               iterator* iter,
-                               e::slice* key,
-                               std::vector<e::slice>* value,
-                               uint64_t* version,
-                               reference* ref)
+bool
+datalayer :: backup(const std::string& path, snapshot snap)
 {
-    const schema& sc(*m_daemon->m_config.get_schema(ri));
-    std::vector<char> scratch;
-
-    // create the encoded key
-    leveldb::Slice lkey;
-    encode_key(ri, sc.attrs[0].type, iter->key(), &scratch, &lkey);
-
-    // perform the read
-    leveldb::ReadOptions opts;
-    opts.fill_cache = true;
-    opts.verify_checksums = true;
-    opts.snapshot = iter->snap().get();
-    leveldb::Status st = m_db->Get(opts, lkey, &ref->m_backing);
+    leveldb::Options opts;
+    opts.write_buffer_size = 16ULL * 1024ULL * 1024ULL;
+    opts.create_if_missing = true;
+    opts.error_if_exists = true;
+    opts.manual_garbage_collection = true;
+    std::auto_ptr<const leveldb::FilterPolicy> bloom(leveldb::NewBloomFilterPolicy(10));
+    opts.filter_policy = bloom.get();
+    leveldb::DB* tmp_db;
+    leveldb::Status st = leveldb::DB::Open(opts, path, &tmp_db);
 
-    if (st.ok())
-    {
-        ref->m_backing += std::string(reinterpret_cast<const char*>(iter->key().data()), iter->key().size());
-        *key = e::slice(ref->m_backing.data()
-                        + ref->m_backing.size()
-                        - iter->key().size(),
-                        iter->key().size());
-        e::slice v(ref->m_backing.data(), ref->m_backing.size() - iter->key().size());
-        return decode_value(v, value, version);
-    }
-    else if (st.IsNotFound())
-    {
-        return NOT_FOUND;
-    }
-    else
+    if (!st.ok())
     {
-        return handle_error(st);
+        LOG(ERROR) << "could not create the backup in \"" << e::strescape(path)
+                   << "\": " << st.ToString();
+        return false;
     }
-}
 
-datalayer::returncode
-datalayer :: create_checkpoint(const region_timestamp& rt)
-{
-    po6::threads::mutex::hold hold(&m_protect);
+    std::auto_ptr<leveldb::DB> db(tmp_db);
+    leveldb::ReadOptions ropts;
+    ropts.fill_cache = false;
+    ropts.verify_checksums = true;
+    ropts.snapshot = snap.get();
+    std::auto_ptr<leveldb::Iterator> it(snap.db()->NewIterator(ropts));
+    leveldb::WriteOptions wopts;
+    wopts.sync = false;
+    leveldb::WriteBatch updates;
+    uint64_t bytes = 0;
 
-    for (wipe_list_t::iterator it = m_wiping.begin(); it != m_wiping.end(); ++it)
+    for (it->SeekToFirst(); st.ok() && it->Valid(); it->Next())
     {
-        if (it->second == rt.rid)
+        e::slice key(it->key().data(), it->key().size());
+        region_id ri;
+        uint64_t checkpoint;
+
+        if (decode_checkpoint(key, &ri, &checkpoint) == SUCCESS)
         {
-            return SUCCESS;
+            continue;
+        }
+
+        updates.Put(it->key(), it->value());
+        bytes += it->key().size() + it->value().size();
+
+        // a backup is background I/O, and shares the wiper's budget
+        if (bytes >= BACKUP_BATCH_SIZE)
+        {
+            m_daemon->m_wipe_throttle.adjust(e::time(), m_daemon->foreground_pressure());
+            m_daemon->m_wipe_throttle.acquire(bytes);
+            st = db->Write(wopts, &updates);
+            updates.Clear();
+            bytes = 0;
         }
     }
 
-    char cbacking[CHECKPOINT_BUF_SIZE + 1024];
-    encode_checkpoint(rt.rid, rt.checkpoint, cbacking);
-    leveldb::WriteOptions opts;
-    opts.sync = false;
-    leveldb::Slice ckey(cbacking, CHECKPOINT_BUF_SIZE);
-    leveldb::Slice val(rt.local_timestamp);
-    leveldb::Status st = m_db->Put(opts, ckey, val);
+    if (st.ok())
+    {
+        st = it->status();
+    }
 
-    if (!st.ok())
+    if (st.ok())
     {
-        return handle_error(st);
+        m_daemon->m_wipe_throttle.charge(bytes);
+        wopts.sync = true;
+        st = db->Write(wopts, &updates);
     }
 
-    return SUCCESS;
-}
+    if (!st.ok())
+    {
+        LOG(ERROR) << "could not copy the snapshot into the backup in \""
+                   << e::strescape(path) << "\": " << st.ToString();
+        return false;
+    }
 
-void
-datalayer :: set_checkpoint_lower_gc(uint64_t checkpoint_gc)
-{
-    po6::threads::mutex::hold hold(&m_protect);
-    m_checkpoint_gc = std::max(checkpoint_gc, m_checkpoint_gc);
-    m_wakeup_checkpointer.signal();
+    return true;
 }
 
-void
-datalayer :: largest_checkpoint_for(const region_id& ri, uint64_t* checkpoint)
+bool
+datalayer :: adopt_region(const region_id& ri, const std::string& path)
 {
-    po6::threads::mutex::hold hold(&m_protect);
+    leveldb::Options opts;
+    opts.create_if_missing = false;
+    std::auto_ptr<const leveldb::FilterPolicy> bloom(leveldb::NewBloomFilterPolicy(10));
+    opts.filter_policy = bloom.get();
+    leveldb::DB* tmp_db;
+    leveldb::Status st = leveldb::DB::Open(opts, path, &tmp_db);
 
-    for (wipe_list_t::iterator it = m_wiping.begin(); it != m_wiping.end(); ++it)
+    if (!st.ok())
     {
-        if (it->second == ri)
-        {
-            *checkpoint = 0;
-            return;
-        }
+        LOG(ERROR) << "could not open the copy of " << ri << " in \""
+                   << e::strescape(path) << "\": " << st.ToString();
+        return false;
+    }
+
+    std::auto_ptr<leveldb::DB> src(tmp_db);
+    leveldb::ReadOptions ropts;
+    ropts.fill_cache = false;
+    ropts.verify_checksums = true;
+
+    // the copy may keep the region under a storage id of its own
+    region_id src_si(ri);
+    char rbacking[STORAGE_BUF_SIZE];
+    encode_storage('r', ri, rbacking);
+    std::string sbacking;
+    st = src->Get(ropts, leveldb::Slice(rbacking, STORAGE_BUF_SIZE), &sbacking);
+
+    if (st.ok() && sbacking.size() == sizeof(uint64_t))
+    {
+        uint64_t si;
+        e::unpack64be(sbacking.data(), &si);
+        src_si = region_id(si);
+    }
+    else if (!st.IsNotFound())
+    {
+        LOG(ERROR) << "could not read the storage id of " << ri << " in \""
+                   << e::strescape(path) << "\": " << st.ToString();
+        return false;
+    }
+
+    // our own copy goes to the wiper and the region starts out empty
+    if (!drop_region(ri))
+    {
+        return false;
+    }
+
+    region_id si(storage_for(ri));
+    leveldb::WriteOptions wopts;
+    wopts.sync = false;
+    leveldb::WriteBatch updates;
+    uint64_t bytes = 0;
+    uint64_t objects = 0;
+    const uint8_t cs[] = {'i', 'o'};
+    st = leveldb::Status::OK();
+
+    for (size_t i = 0; st.ok() && i < sizeof(cs); ++i)
+    {
+        char pbacking[STORAGE_BUF_SIZE];
+        encode_storage(cs[i], src_si, pbacking);
+        leveldb::Slice prefix(pbacking, STORAGE_BUF_SIZE);
+        std::auto_ptr<leveldb::Iterator> it(src->NewIterator(ropts));
+        std::string key;
+
+        for (it->Seek(prefix); st.ok() && it->Valid() && it->key().starts_with(prefix); it->Next())
+        {
+            // same entry, under the storage id the region has here
+            key.assign(it->key().data(), it->key().size());
+            encode_storage(cs[i], si, &key[0]);
+            updates.Put(key, it->value());
+            bytes += it->key().size() + it->value().size();
+            objects += cs[i] == 'o' ? 1 : 0;
+
+            if (bytes >= BACKUP_BATCH_SIZE)
+            {
+                st = m_db->Write(wopts, &updates);
+                updates.Clear();
+                bytes = 0;
+            }
+        }
+
+        if (st.ok())
+        {
+            st = it->status();
+        }
+    }
+
+    if (st.ok())
+    {
+        wopts.sync = true;
+        st = m_db->Write(wopts, &updates);
+    }
+
+    if (!st.ok())
+    {
+        LOG(ERROR) << "could not copy " << ri << " from \""
+                   << e::strescape(path) << "\": " << st.ToString();
+        return false;
+    }
+
+    LOG(INFO) << "replaced our copy of " << ri << " with the " << objects
+              << " objects in \"" << e::strescape(path) << "\"";
+    return true;
+}
+
+datalayer::returncode
+datalayer :: create_checkpoint(const region_timestamp& rt)
+{
+    po6::threads::mutex::hold hold(&m_protect);
+
+    for (wipe_list_t::iterator it = m_wiping.begin(); it != m_wiping.end(); ++it)
+    {
+        if (it->second == rt.rid)
+        {
+            return SUCCESS;
+        }
+    }
+
+    char cbacking[CHECKPOINT_BUF_SIZE + 1024];
+    encode_checkpoint(rt.rid, rt.checkpoint, cbacking);
+    leveldb::WriteOptions opts;
+    opts.sync = false;
+    leveldb::Slice ckey(cbacking, CHECKPOINT_BUF_SIZE);
+    leveldb::Slice val(rt.local_timestamp);
+    leveldb::Status st = m_db->Put(opts, ckey, val);
+
+    if (!st.ok())
+    {
+        return handle_error(st);
+    }
+
+    return SUCCESS;
+}
+
+void
+datalayer :: set_checkpoint_lower_gc(uint64_t checkpoint_gc)
+{
+    po6::threads::mutex::hold hold(&m_protect);
+    m_checkpoint_gc = std::max(checkpoint_gc, m_checkpoint_gc);
+    m_wakeup_checkpointer.signal();
+}
+
+void
+datalayer :: largest_checkpoint_for(const region_id& ri, uint64_t* checkpoint)
+{
+    po6::threads::mutex::hold hold(&m_protect);
+
+    for (wipe_list_t::iterator it = m_wiping.begin(); it != m_wiping.end(); ++it)
+    {
+        if (it->second == ri)
+        {
+            *checkpoint = 0;
+            return;
+        }
     }
 
     leveldb::ReadOptions opts;
@@ -1159,7 +1919,228 @@ datalayer :: replay_region_from_checkpoint(const region_id& ri,
 
     leveldb_replay_iterator_ptr ptr(m_db, iter);
     const schema& sc(*m_daemon->m_config.get_schema(ri));
-    return new replay_iterator(ri, ptr, index_info::lookup(sc.attrs[0].type));
+    return new replay_iterator(storage_for(ri), ptr, index_info::lookup(sc.attrs[0].type));
+}
+
+datalayer::replay_iterator*
+datalayer :: replay_region_from_now(const region_id& ri)
+{
+    // Take the timestamp before any snapshot so that no write falls between
+    // the two.  Writes made in between are in both, and replaying them over
+    // the snapshot is harmless.
+    std::string timestamp;
+    m_db->GetReplayTimestamp(&timestamp);
+    leveldb::ReplayIterator* iter;
+    leveldb::Status st = m_db->GetReplayIterator(timestamp, &iter);
+
+    if (!st.ok())
+    {
+        LOG(ERROR) << "LevelDB corruption: invalid timestamp";
+        abort();
+    }
+
+    leveldb_replay_iterator_ptr ptr(m_db, iter);
+    const schema& sc(*m_daemon->m_config.get_schema(ri));
+    return new replay_iterator(storage_for(ri), ptr, index_info::lookup(sc.attrs[0].type));
+}
+
+datalayer::dump_iterator*
+datalayer :: dump_region(const region_id& ri,
+                         replay_iterator** changes)
+{
+    *changes = replay_region_from_now(ri);
+    snapshot snap(make_snapshot());
+    leveldb::ReadOptions opts;
+    opts.fill_cache = false;
+    opts.verify_checksums = true;
+    opts.snapshot = snap.get();
+    leveldb_iterator_ptr it;
+    it.reset(snap, m_db->NewIterator(opts));
+    return new dump_iterator(ri, storage_for(ri), it);
+}
+
+bool
+datalayer :: ingest(const region_id& ri,
+                    const e::slice& key,
+                    const e::slice& value,
+                    uint64_t* version,
+                    write_batch* wb)
+{
+    *version = 0;
+
+    const size_t prefix_sz = sizeof(uint8_t) + sizeof(uint64_t);
+
+    if (key.size() < prefix_sz ||
+        (key.data()[0] != 'i' && key.data()[0] != 'o'))
+    {
+        return false;
+    }
+
+    uint64_t rid;
+    e::unpack64be(key.data() + sizeof(uint8_t), &rid);
+
+    if (rid != ri.get())
+    {
+        return false;
+    }
+
+    // dumps name the region itself; file the entry under its storage id
+    std::string skey(key.cdata(), key.size());
+    e::pack64be(storage_for(ri).get(), &skey[sizeof(uint8_t)]);
+    leveldb::Slice lval(value.cdata(), value.size());
+    wb->m_updates.Put(skey, lval);
+
+    if (key.data()[0] == 'o')
+    {
+        wb->m_keys.push_back(skey);
+
+        // an object's value leads with its version
+        if (value.size() >= sizeof(uint64_t))
+        {
+            e::unpack64be(value.data(), version);
+        }
+    }
+
+    return true;
+}
+
+bool
+datalayer :: has_objects(const region_id& ri)
+{
+    std::vector<char> scratch;
+    leveldb::Slice prefix;
+    encode_object_region(storage_for(ri), &scratch, &prefix);
+    leveldb::ReadOptions opts;
+    opts.fill_cache = false;
+    std::auto_ptr<leveldb::Iterator> it(m_db->NewIterator(opts));
+    it->Seek(prefix);
+    return it->Valid() && it->key().starts_with(prefix);
+}
+
+datalayer::returncode
+datalayer :: hash_region(snapshot snap,
+                         const region_id& ri,
+                         region_tree* tree)
+{
+    std::vector<char> scratch;
+    leveldb::Slice prefix;
+    encode_object_region(storage_for(ri), &scratch, &prefix);
+    leveldb::ReadOptions opts;
+    opts.fill_cache = false;
+    opts.verify_checksums = true;
+    opts.snapshot = snap.get();
+    std::auto_ptr<leveldb::Iterator> it(m_db->NewIterator(opts));
+    tree->clear();
+
+    for (it->Seek(prefix); it->Valid() && it->key().starts_with(prefix); it->Next())
+    {
+        e::slice key(it->key().data() + prefix.size(), it->key().size() - prefix.size());
+        std::vector<e::slice> value;
+        uint64_t version = 0;
+
+        if (decode_value(e::slice(it->value().data(), it->value().size()),
+                         &value, &version) != SUCCESS)
+        {
+            // hash it anyway; the leaf will differ and be repaired
+            LOG(WARNING) << "could not decode an object in " << ri << " while hashing it";
+        }
+
+        tree->add(key, version);
+    }
+
+    if (!it->status().ok())
+    {
+        return handle_error(it->status());
+    }
+
+    return SUCCESS;
+}
+
+datalayer::returncode
+datalayer :: wipe_region_leaves(const region_id& ri,
+                                const std::vector<bool>& leaves)
+{
+    wipe_checkpoints(ri);
+    const schema& sc(*m_daemon->m_config.get_schema(ri));
+    index_info* di = index_info::lookup(sc.attrs[0].type);
+    std::vector<char> scratch;
+    leveldb::Slice prefix;
+    encode_object_region(storage_for(ri), &scratch, &prefix);
+
+    // iterate a snapshot so the deletes don't disturb the iteration
+    snapshot snap(make_snapshot());
+    leveldb::ReadOptions opts;
+    opts.fill_cache = false;
+    opts.verify_checksums = true;
+    opts.snapshot = snap.get();
+    std::auto_ptr<leveldb::Iterator> it(m_db->NewIterator(opts));
+    write_batch wb;
+    std::vector<char> decoded;
+    size_t batched = 0;
+
+    for (it->Seek(prefix); it->Valid() && it->key().starts_with(prefix); it->Next())
+    {
+        e::slice ekey(it->key().data() + prefix.size(), it->key().size() - prefix.size());
+
+        if (!leaves[region_tree::leaf_for(ekey)])
+        {
+            continue;
+        }
+
+        std::vector<e::slice> old_value;
+        uint64_t old_version;
+
+        if (decode_value(e::slice(it->value().data(), it->value().size()),
+                         &old_value, &old_version) != SUCCESS ||
+            old_value.size() + 1 != sc.attrs_sz)
+        {
+            LOG(WARNING) << "removing an undecodable object from " << ri
+                         << "; its index entries may remain";
+            wb.m_updates.Delete(it->key());
+            wb.m_keys.push_back(it->key().ToString());
+        }
+        else
+        {
+            size_t sz = di->decoded_size(ekey);
+            decoded.resize(std::max(sz, size_t(1)));
+            di->decode(ekey, &decoded.front());
+            del(ri, region_id(), 0, e::slice(&decoded.front(), sz), old_value, &wb);
+        }
+
+        if (++batched >= 4096)
+        {
+            returncode rc = write(&wb);
+
+            if (rc != SUCCESS)
+            {
+                return rc;
+            }
+
+            batched = 0;
+        }
+    }
+
+    if (!it->status().ok())
+    {
+        return handle_error(it->status());
+    }
+
+    return batched > 0 ? write(&wb) : SUCCESS;
+}
+
+datalayer::leaf_iterator*
+datalayer :: make_leaf_iterator(snapshot snap,
+                                const region_id& ri,
+                                const std::vector<bool>& leaves)
+{
+    leveldb::ReadOptions opts;
+    opts.fill_cache = false;
+    opts.verify_checksums = true;
+    opts.snapshot = snap.get();
+    leveldb_iterator_ptr iter;
+    iter.reset(snap, m_db->NewIterator(opts));
+    const schema& sc(*m_daemon->m_config.get_schema(ri));
+    return new leaf_iterator(storage_for(ri), iter, index_info::lookup(sc.attrs[0].type), leaves);
 }
 
 void
@@ -1318,11 +2299,12 @@ datalayer :: wiper()
     {
         transfer_id xid;
         region_id rid;
+        region_id purge;
 
         {
             po6::threads::mutex::hold hold(&m_protect);
 
-            while ((m_wiping.empty() && !m_shutdown) || m_need_pause)
+            while ((m_wiping.empty() && m_purging.empty() && !m_shutdown) || m_need_pause)
             {
                 m_wiper_paused = true;
 
@@ -1345,23 +2327,188 @@ datalayer :: wiper()
                 xid = m_wiping.front().first;
                 rid = m_wiping.front().second;
             }
+            else
+            {
+                purge = m_purging.front();
+            }
         }
 
-        assert(rid != region_id());
-        wipe_checkpoints(rid);
+        // Wipes go first because a transfer waits on each.  Should the drop
+        // fail, fall back to deleting the region's keys one by one.
+        if (rid != region_id())
+        {
+            wipe_checkpoints(rid);
 
-        if (wipe_some_indices(rid) &&
-            wipe_some_objects(rid))
+            if (drop_region(rid) ||
+                (wipe_some_indices(rid) && wipe_some_objects(rid)))
+            {
+                m_daemon->m_stm.report_wiped(xid);
+                po6::threads::mutex::hold hold(&m_protect);
+                m_wiping.pop_front();
+            }
+        }
+        else if (purge_some(purge))
         {
-            m_daemon->m_stm.report_wiped(xid);
             po6::threads::mutex::hold hold(&m_protect);
-            m_wiping.pop_front();
+            m_purging.pop_front();
         }
     }
 
     LOG(INFO) << "wiping thread shutting down";
 }
 
+void
+datalayer :: sampler()
+{
+    LOG(INFO) << "statistics thread started";
+    sigset_t ss;
+
+    if (sigfillset(&ss) < 0)
+    {
+        PLOG(ERROR) << "sigfillset";
+        return;
+    }
+
+    if (pthread_sigmask(SIG_BLOCK, &ss, NULL) < 0)
+    {
+        PLOG(ERROR) << "could not block signals";
+        return;
+    }
+
+    while (true)
+    {
+        {
+            po6::threads::mutex::hold hold(&m_protect);
+
+            while ((!m_sample_requested && !m_shutdown) || m_need_pause)
+            {
+                m_sampler_paused = true;
+
+                if (m_need_pause)
+                {
+                    m_wakeup_reconfigurer.signal();
+                }
+
+                m_wakeup_sampler.wait();
+                m_sampler_paused = false;
+            }
+
+            if (m_shutdown)
+            {
+                break;
+            }
+
+            m_sample_requested = false;
+        }
+
+        // the configuration only changes while this thread is paused
+        std::vector<region_id> regions;
+        m_daemon->m_config.mapped_regions(m_daemon->m_us, &regions);
+
+        for (size_t i = 0; i < regions.size(); ++i)
+        {
+            {
+                po6::threads::mutex::hold hold(&m_protect);
+
+                if (m_need_pause || m_shutdown)
+                {
+                    break;
+                }
+            }
+
+            region_id si(storage_for(regions[i]));
+            uint64_t size = approximate_size(regions[i]);
+            uint64_t now = e::time();
+            e::compat::shared_ptr<const index_stats> old(stats_for_storage(si));
+
+            // resample when the region has grown or shrunk by a quarter
+            if (old && now - old->taken < STATS_MAX_AGE)
+            {
+                uint64_t diff = size > old->approximate_size
+                              ? size - old->approximate_size
+                              : old->approximate_size - size;
+
+                if (now - old->taken < STATS_MIN_AGE ||
+                    diff * 4 <= old->approximate_size)
+                {
+                    continue;
+                }
+            }
+
+            e::compat::shared_ptr<index_stats> stats(new index_stats());
+
+            // cut short by a pause or shutdown, or unreadable; the next
+            // request tries again
+            if (!sample_region(regions[i], si, size, stats.get()))
+            {
+                continue;
+            }
+
+            char sbacking[STORAGE_BUF_SIZE];
+            encode_storage('s', si, sbacking);
+            std::string v(stats->serialize());
+            leveldb::Status st = m_db->Put(leveldb::WriteOptions(),
+                                           leveldb::Slice(sbacking, STORAGE_BUF_SIZE),
+                                           leveldb::Slice(v.data(), v.size()));
+
+            if (!st.ok())
+            {
+                LOG(ERROR) << "could not save the statistics of " << regions[i] << ": " << st.ToString();
+            }
+
+            po6::threads::mutex::hold hold(&m_protect_stats);
+            m_stats[si] = stats;
+        }
+    }
+
+    LOG(INFO) << "statistics thread shutting down";
+}
+
+bool
+datalayer :: sample_region(const region_id& ri,
+                           const region_id& si,
+                           uint64_t size,
+                           index_stats* stats)
+{
+    const schema& sc(*m_daemon->m_config.get_schema(ri));
+    const subspace& sub(*m_daemon->m_config.get_subspace(ri));
+    index_info* ki = index_info::lookup(sc.attrs[0].type);
+
+    if (!ki)
+    {
+        return false;
+    }
+
+    snapshot snap(make_snapshot());
+    stats->approximate_size = size;
+    stats->taken = e::time();
+    stats->attrs.resize(sc.attrs_sz);
+
+    if (!ki->collect_stats(this, snap, si, 0, ki, &stats->attrs[0]))
+    {
+        return false;
+    }
+
+    stats->objects = stats->attrs[0].entries;
+
+    for (uint16_t attr = 1; attr < sc.attrs_sz; ++attr)
+    {
+        index_info* ii = index_info::lookup(sc.attrs[attr].type);
+
+        if (!sub.indexed(attr) || !ii)
+        {
+            continue;
+        }
+
+        if (!ii->collect_stats(this, snap, si, attr, ki, &stats->attrs[attr]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 void
 datalayer :: wipe_checkpoints(const region_id& ri)
 {
@@ -1391,13 +2538,19 @@ datalayer :: wipe_checkpoints(const region_id& ri)
 bool
 datalayer :: wipe_some_indices(const region_id& ri)
 {
-    return wipe_some_common('i', ri);
+    return wipe_some_common('i', storage_for(ri));
 }
 
 bool
 datalayer :: wipe_some_objects(const region_id& ri)
 {
-    return wipe_some_common('o', ri);
+    region_id si(storage_for(ri));
+    bool done = wipe_some_common('o', si);
+    std::vector<char> scratch;
+    leveldb::Slice prefix;
+    encode_object_region(si, &scratch, &prefix);
+    m_cache.invalidate_prefix(e::slice(prefix.data(), prefix.size()));
+    return done;
 }
 
 bool
@@ -1410,21 +2563,266 @@ datalayer :: wipe_some_common(uint8_t c, const region_id& ri)
     e::pack64be(ri.get(), backing + sizeof(uint8_t));
     leveldb::Slice prefix(backing, sizeof(uint8_t) + sizeof(uint64_t));
     it->Seek(prefix);
+    uint64_t bytes = 0;
 
     for (uint64_t i = 0; i < 65536 && it->Valid(); ++i)
     {
         if (!it->key().starts_with(prefix))
         {
+            m_daemon->m_wipe_throttle.charge(bytes);
             return true;
         }
 
+        // pace the deletes, counting what they read as well as the
+        // tombstones they write; a pause or shutdown stops the wipe here
+        // and the wiper picks it up again afterwards
+        if (i % WIPE_THROTTLE_STRIDE == 0 && i > 0)
+        {
+            if (!pace_background(bytes))
+            {
+                return false;
+            }
+
+            bytes = 0;
+        }
+
+        bytes += it->key().size() * 2 + it->value().size();
         m_db->Delete(leveldb::WriteOptions(), it->key());
         it->Next();
     }
 
+    m_daemon->m_wipe_throttle.charge(bytes);
     return false;
 }
 
+bool
+datalayer :: load_storage()
+{
+    leveldb::ReadOptions opts;
+    opts.fill_cache = false;
+    opts.verify_checksums = true;
+    std::auto_ptr<leveldb::Iterator> it(m_db->NewIterator(opts));
+    po6::threads::mutex::hold hold(&m_protect_storage);
+    std::auto_ptr<storage_map> storage(new storage_map(*m_storage));
+
+    // storage ids whose purge was cut short
+    for (it->Seek(leveldb::Slice("p", 1)); it->Valid(); it->Next())
+    {
+        region_id si;
+
+        if (decode_storage(e::slice(it->key().data(), it->key().size()), 'p', &si) != SUCCESS)
+        {
+            break;
+        }
+
+        m_purging.push_back(si);
+        m_storage_counter = std::max(m_storage_counter, uint64_t(si.get() & ~STORAGE_ID_BIT));
+    }
+
+    // regions stored under an id other than their own
+    for (it->Seek(leveldb::Slice("r", 1)); it->Valid(); it->Next())
+    {
+        region_id ri;
+
+        if (decode_storage(e::slice(it->key().data(), it->key().size()), 'r', &ri) != SUCCESS)
+        {
+            break;
+        }
+
+        if (it->value().size() != sizeof(uint64_t))
+        {
+            LOG(ERROR) << "could not restore from LevelDB because the storage "
+                       << "id of " << ri << " is corrupt";
+            return false;
+        }
+
+        uint64_t si;
+        e::unpack64be(it->value().data(), &si);
+        (*storage)[ri] = region_id(si);
+        m_storage_counter = std::max(m_storage_counter, uint64_t(si & ~STORAGE_ID_BIT));
+    }
+
+    if (!it->status().ok())
+    {
+        LOG(ERROR) << "could not read region storage ids from LevelDB: " << it->status().ToString();
+        return false;
+    }
+
+    publish_storage(storage.release());
+    return true;
+}
+
+void
+datalayer :: load_stats()
+{
+    leveldb::ReadOptions opts;
+    opts.fill_cache = false;
+    opts.verify_checksums = true;
+    std::auto_ptr<leveldb::Iterator> it(m_db->NewIterator(opts));
+    leveldb::Slice prefix("s", 1);
+
+    for (it->Seek(prefix); it->Valid() && it->key().starts_with(prefix); it->Next())
+    {
+        region_id si;
+
+        // the "state" key shares the prefix
+        if (decode_storage(e::slice(it->key().data(), it->key().size()), 's', &si) != SUCCESS)
+        {
+            continue;
+        }
+
+        bool live = !(si.get() & STORAGE_ID_BIT);
+        const storage_map* storage = e::atomic::load_ptr_acquire(&m_storage);
+
+        if (live)
+        {
+            live = storage->find(si) == storage->end();
+        }
+        else
+        {
+            for (storage_map::const_iterator s = storage->begin();
+                    s != storage->end(); ++s)
+            {
+                live = live || s->second == si;
+            }
+        }
+
+        // statistics are only a hint to the planner, so those that cannot be
+        // read or that outlived their storage are simply dropped
+        e::compat::shared_ptr<index_stats> stats(new index_stats());
+
+        if (!live || !stats->parse(e::slice(it->value().data(), it->value().size())))
+        {
+            m_db->Delete(leveldb::WriteOptions(), it->key());
+            continue;
+        }
+
+        po6::threads::mutex::hold hold(&m_protect_stats);
+        m_stats[si] = stats;
+    }
+
+    if (!it->status().ok())
+    {
+        LOG(WARNING) << "could not read search statistics from LevelDB: " << it->status().ToString();
+    }
+}
+
+hyperdex::region_id
+datalayer :: storage_for(const region_id& ri)
+{
+    const storage_map* storage = e::atomic::load_ptr_acquire(&m_storage);
+    storage_map::const_iterator it = storage->find(ri);
+    return it != storage->end() ? it->second : ri;
+}
+
+bool
+datalayer :: drop_region(const region_id& ri)
+{
+    region_id old_si;
+    region_id new_si;
+
+    {
+        po6::threads::mutex::hold hold(&m_protect_storage);
+        storage_map::const_iterator it = m_storage->find(ri);
+        old_si = it != m_storage->end() ? it->second : ri;
+        new_si = region_id(STORAGE_ID_BIT | ++m_storage_counter);
+    }
+
+    // point the region at the new id and remember the old one in the same
+    // write so that a crash neither loses the purge nor revives the data
+    char rbacking[STORAGE_BUF_SIZE];
+    char vbacking[sizeof(uint64_t)];
+    char pbacking[STORAGE_BUF_SIZE];
+    encode_storage('r', ri, rbacking);
+    e::pack64be(new_si.get(), vbacking);
+    encode_storage('p', old_si, pbacking);
+    leveldb::WriteBatch updates;
+    updates.Put(leveldb::Slice(rbacking, STORAGE_BUF_SIZE),
+                leveldb::Slice(vbacking, sizeof(uint64_t)));
+    updates.Put(leveldb::Slice(pbacking, STORAGE_BUF_SIZE), leveldb::Slice("", 0));
+    leveldb::WriteOptions wopts;
+    wopts.sync = true;
+    leveldb::Status st = m_db->Write(wopts, &updates);
+
+    if (!st.ok())
+    {
+        LOG(ERROR) << "could not drop " << ri << ": " << st.ToString();
+        return false;
+    }
+
+    {
+        po6::threads::mutex::hold hold(&m_protect_storage);
+        std::auto_ptr<storage_map> storage(new storage_map(*m_storage));
+        (*storage)[ri] = new_si;
+        publish_storage(storage.release());
+    }
+
+    po6::threads::mutex::hold hold(&m_protect);
+    m_purging.push_back(old_si);
+    ++m_dropped;
+    m_wakeup_wiper.broadcast();
+    LOG(INFO) << "dropped " << ri << "; its old data will be purged in the background";
+    return true;
+}
+
+void
+datalayer :: publish_storage(storage_map* storage)
+{
+    m_retired_storage.push_back(m_storage);
+    e::atomic::store_ptr_release(&m_storage, const_cast<const storage_map*>(storage));
+}
+
+bool
+datalayer :: purge_some(const region_id& si)
+{
+    if (!wipe_some_common('i', si) ||
+        !wipe_some_common('o', si))
+    {
+        return false;
+    }
+
+    std::vector<char> scratch;
+    leveldb::Slice prefix;
+    encode_object_region(si, &scratch, &prefix);
+    m_cache.invalidate_prefix(e::slice(prefix.data(), prefix.size()));
+
+    // the range now holds nothing but tombstones; compact it so the space
+    // goes back to the filesystem now rather than whenever LevelDB gets to it
+    const uint8_t cs[] = {'i', 'o'};
+
+    for (size_t i = 0; i < sizeof(cs); ++i)
+    {
+        char start[STORAGE_BUF_SIZE];
+        char limit[STORAGE_BUF_SIZE];
+        encode_storage(cs[i], si, start);
+        encode_storage(cs[i], region_id(si.get() + 1), limit);
+        leveldb::Slice s(start, STORAGE_BUF_SIZE);
+        leveldb::Slice l(limit, STORAGE_BUF_SIZE);
+        m_db->CompactRange(&s, &l);
+    }
+
+    char sbacking[STORAGE_BUF_SIZE];
+    char pbacking[STORAGE_BUF_SIZE];
+    encode_storage('s', si, sbacking);
+    encode_storage('p', si, pbacking);
+    leveldb::WriteBatch updates;
+    updates.Delete(leveldb::Slice(sbacking, STORAGE_BUF_SIZE));
+    updates.Delete(leveldb::Slice(pbacking, STORAGE_BUF_SIZE));
+    leveldb::Status st = m_db->Write(leveldb::WriteOptions(), &updates);
+
+    {
+        po6::threads::mutex::hold hold(&m_protect_stats);
+        m_stats.erase(si);
+    }
+
+    if (!st.ok())
+    {
+        LOG(ERROR) << "could not finish purging storage " << si << ": " << st.ToString();
+    }
+
+    return true;
+}
+
 void
 datalayer :: shutdown()
 {
@@ -1434,6 +2832,7 @@ datalayer :: shutdown()
         po6::threads::mutex::hold hold(&m_protect);
         m_wakeup_checkpointer.broadcast();
         m_wakeup_wiper.broadcast();
+        m_wakeup_sampler.broadcast();
         is_shutdown = m_shutdown;
         m_shutdown = true;
     }
@@ -1442,6 +2841,7 @@ datalayer :: shutdown()
     {
         m_checkpointer.join();
         m_wiper.join();
+        m_sampler.join();
     }
 }
 
@@ -1468,6 +2868,7 @@ datalayer :: handle_error(leveldb::Status st)
 
 datalayer :: reference :: reference()
     : m_backing()
+    , m_cached()
 {
 }
 
@@ -1479,6 +2880,18 @@ void
 datalayer :: reference :: swap(reference* ref)
 {
     m_backing.swap(ref->m_backing);
+    std::swap(m_cached, ref->m_cached);
+}
+
+datalayer :: write_batch :: write_batch()
+    : m_updates()
+    , m_keys()
+    , m_acked(0)
+{
+}
+
+datalayer :: write_batch :: ~write_batch() throw ()
+{
 }
 
 std::ostream&
@@ -30,6 +30,7 @@
 
 // STL
 #include <list>
+#include <map>
 #include <set>
 #include <sstream>
 #include <string>
@@ -37,6 +38,10 @@
 
 // LevelDB
 #include <hyperleveldb/db.h>
+#include <hyperleveldb/write_batch.h>
+
+// e
+#include <e/compat.h>
 
 // po6
 #include <po6/net/hostname.h>
@@ -53,12 +58,15 @@
 #include "common/datatypes.h"
 #include "common/ids.h"
 #include "common/schema.h"
+#include "daemon/index_stats.h"
 #include "daemon/leveldb.h"
+#include "daemon/object_cache.h"
 #include "daemon/reconfigure_returncode.h"
 #include "daemon/region_timestamp.h"
 
 BEGIN_HYPERDEX_NAMESPACE
 class daemon;
+class region_tree;
 
 class datalayer
 {
@@ -73,8 +81,11 @@ class datalayer
             LEVELDB_ERROR
         };
         class reference;
+        class write_batch;
         class iterator;
         class replay_iterator;
+        class dump_iterator;
+        class leaf_iterator;
         class dummy_iterator;
         class region_iterator;
         class search_iterator;
@@ -109,6 +120,23 @@ class datalayer
                           std::string* value);
         std::string get_timestamp();
         uint64_t approximate_size();
+        uint64_t approximate_size(const region_id& ri);
+        void object_cache_stats(uint64_t* hits, uint64_t* misses, uint64_t* bytes);
+        void drop_stats(uint64_t* dropped, uint64_t* purging);
+        // the object cache stays disabled unless this is called with bytes > 0
+        void set_object_cache_size(uint64_t bytes);
+        // search planning: statistics are sampled in the background, and
+        // this wakes the sampler to refresh those that are stale
+        void refresh_stats();
+        // the statistics of "ri", or NULL if it has not been sampled
+        e::compat::shared_ptr<const index_stats> stats_for(const region_id& ri);
+        // approximate_size(ri) as of its statistics, without asking LevelDB;
+        // zero until the region is first sampled
+        uint64_t sampled_size(const region_id& ri);
+        // called as the sampler walks an index or the wiper deletes keys;
+        // charges the bytes to the background I/O budget and returns false
+        // if the work must stop for a reconfiguration or shutdown
+        bool pace_background(uint64_t bytes);
 
     public:
         // retrieve the current value of a key
@@ -117,6 +145,15 @@ class datalayer
                        std::vector<e::slice>* value,
                        uint64_t* version,
                        reference* ref);
+        // retrieve the current values of many keys in one region with a
+        // single ordered pass over the store; the outputs are resized to
+        // match "keys" and hold the result for keys[i] at index i
+        void get_many(const region_id& ri,
+                      const std::vector<e::slice>& keys,
+                      std::vector<returncode>* rcs,
+                      std::vector<std::vector<e::slice> >* values,
+                      std::vector<uint64_t>* versions,
+                      std::vector<reference>* refs);
         // put, overput, or delete a key where the existing value is known
         returncode del(const region_id& ri,
                        const region_id& reg_id,
@@ -136,6 +173,35 @@ class datalayer
                            const std::vector<e::slice>& old_value,
                            const std::vector<e::slice>& new_value,
                            uint64_t version);
+        // the same as above, except that the changes are appended to "wb" and
+        // applied by a later call to "write"; the changes to many keys may be
+        // accumulated and applied atomically with a single write to LevelDB
+        void del(const region_id& ri,
+                 const region_id& reg_id,
+                 uint64_t seq_id,
+                 const e::slice& key,
+                 const std::vector<e::slice>& old_value,
+                 write_batch* wb);
+        void put(const region_id& ri,
+                 const region_id& reg_id,
+                 uint64_t seq_id,
+                 const e::slice& key,
+                 const std::vector<e::slice>& new_value,
+                 uint64_t version,
+                 write_batch* wb);
+        void overput(const region_id& ri,
+                     const region_id& reg_id,
+                     uint64_t seq_id,
+                     const e::slice& key,
+                     const std::vector<e::slice>& old_value,
+                     const std::vector<e::slice>& new_value,
+                     uint64_t version,
+                     write_batch* wb);
+        void mark_acked(const region_id& ri,
+                        const region_id& reg_id,
+                        uint64_t seq_id,
+                        write_batch* wb);
+        returncode write(write_batch* wb);
         // put or delete where the previous value is unknown
         returncode uncertain_del(const region_id& ri,
                                  const e::slice& key);
@@ -143,6 +209,17 @@ class datalayer
                                  const e::slice& key,
                                  const std::vector<e::slice>& new_value,
                                  uint64_t version);
+        // the same as above, except that the changes are appended to "wb";
+        // the old value is read from disk only when index entries depend on
+        // it, so a batch must not hold two changes to the same key
+        returncode uncertain_del(const region_id& ri,
+                                 const e::slice& key,
+                                 write_batch* wb);
+        returncode uncertain_put(const region_id& ri,
+                                 const e::slice& key,
+                                 const std::vector<e::slice>& new_value,
+                                 uint64_t version,
+                                 write_batch* wb);
         // state from retransmitted messages
         // XXX errors are absorbed here; short of crashing we can only log
         bool check_acked(const region_id& ri,
@@ -162,19 +239,33 @@ class datalayer
         iterator* make_region_iterator(snapshot snap,
                                        const region_id& ri,
                                        returncode* error);
-        iterator* make_search_iterator(snapshot snap,
-                                       const region_id& ri,
-                                       const std::vector<attribute_check>& checks,
-                                       std::ostringstream* ostr);
+        search_iterator* make_search_iterator(snapshot snap,
+                                              const region_id& ri,
+                                              const std::vector<attribute_check>& checks,
+                                              std::ostringstream* ostr);
+        // the objects that pass checks in the order of attribute sort_by
+        // (descending if maximize), or NULL if no index yields that order;
+        // if after_key is not NULL, start after the object with that key and
+        // sort value
+        search_iterator* make_sorted_iterator(snapshot snap,
+                                              const region_id& ri,
+                                              const std::vector<attribute_check>& checks,
+                                              uint16_t sort_by,
+                                              bool maximize,
+                                              const e::slice* after_value,
+                                              const e::slice* after_key,
+                                              std::ostringstream* ostr);
         // backups
         bool backup(const e::slice& name);
-        // get the object pointed to by the iterator
-        returncode get_from_iterator(const region_id& ri,
-                                     iterator* iter,
-                                     e::slice* key,
-                                     std::vector<e::slice>* value,
-                                     uint64_t* version,
-                                     reference* ref);
+        // copy what "snap" sees into a new LevelDB instance at "path", so the
+        // backup holds exactly the state the snapshot was taken at.  The
+        // checkpoints are left behind; their timestamps name positions in
+        // this instance's history, not the copy's.
+        bool backup(const std::string& path, snapshot snap);
+        // replace this instance's copy of "ri" with the one in the backup
+        // at "path", which restore put here so that every replica of the
+        // region starts out identical
+        bool adopt_region(const region_id& ri, const std::string& path);
         // checkpointing
         returncode create_checkpoint(const region_timestamp& rt);
         void set_checkpoint_lower_gc(uint64_t checkpoint_gc);
@@ -183,6 +274,33 @@ class datalayer
                           const region_id& ri);
         replay_iterator* replay_region_from_checkpoint(const region_id& ri,
                                                        uint64_t checkpoint, bool* wipe);
+        // every write to "ri" from now on; take snapshots after calling this
+        replay_iterator* replay_region_from_now(const region_id& ri);
+        // bulk migration: a sorted dump of the raw index entries and objects
+        // of "ri" from a snapshot, and in "changes" every write after it
+        dump_iterator* dump_region(const region_id& ri,
+                                   replay_iterator** changes);
+        // append one raw entry from a dump of "ri" to "wb"; returns false if
+        // the entry does not belong to "ri".  "version" is set to the
+        // object's version, or to zero for an index entry.
+        bool ingest(const region_id& ri,
+                    const e::slice& key,
+                    const e::slice& value,
+                    uint64_t* version,
+                    write_batch* wb);
+        // anti-entropy: compare region_trees and move only what differs
+        bool has_objects(const region_id& ri);
+        returncode hash_region(snapshot snap,
+                               const region_id& ri,
+                               region_tree* tree);
+        // remove the objects of "ri" that fall in the marked leaves, with
+        // their index entries, along with the region's checkpoints
+        returncode wipe_region_leaves(const region_id& ri,
+                                      const std::vector<bool>& leaves);
+        // the objects of "ri" in "snap" that fall in the marked leaves
+        leaf_iterator* make_leaf_iterator(snapshot snap,
+                                          const region_id& ri,
+                                          const std::vector<bool>& leaves);
         // used on startup
         bool only_key_is_hyperdex_key();
 
@@ -190,13 +308,35 @@ class datalayer
         datalayer(const datalayer&);
         datalayer& operator = (const datalayer&);
 
+    private:
+        typedef std::map<region_id, region_id> storage_map;
+
     private:
         void checkpointer();
         void wiper();
+        void sampler();
+        e::compat::shared_ptr<const index_stats> stats_for_storage(const region_id& si);
+        bool sample_region(const region_id& ri,
+                           const region_id& si,
+                           uint64_t size,
+                           index_stats* stats);
+        // statistics are kept under 's' by storage id, and are dropped with
+        // the storage they describe
+        void load_stats();
         void wipe_checkpoints(const region_id& rid);
         bool wipe_some_indices(const region_id& rid);
         bool wipe_some_objects(const region_id& rid);
         bool wipe_some_common(uint8_t c, const region_id& rid);
+        // Each region's objects and index entries are keyed under a storage
+        // id, which is the region's own id until the region is first dropped.
+        // Dropping a region points it at a fresh storage id with one write;
+        // the wiper then purges the keys under the old one in the background.
+        bool load_storage();
+        region_id storage_for(const region_id& ri);
+        bool drop_region(const region_id& ri);
+        // caller must hold m_protect_storage
+        void publish_storage(storage_map* storage);
+        bool purge_some(const region_id& si);
         void shutdown();
         returncode handle_error(leveldb::Status st);
         void collect_lower_checkpoints(uint64_t checkpoint_gc);
@@ -204,19 +344,38 @@ class datalayer
     private:
         daemon* m_daemon;
         leveldb_db_ptr m_db;
+        object_cache m_cache;
         po6::threads::thread m_checkpointer;
         po6::threads::thread m_wiper;
+        po6::threads::thread m_sampler;
         po6::threads::mutex m_protect;
         po6::threads::cond m_wakeup_checkpointer;
         po6::threads::cond m_wakeup_wiper;
+        po6::threads::cond m_wakeup_sampler;
         po6::threads::cond m_wakeup_reconfigurer;
         bool m_shutdown;
         bool m_need_pause;
         bool m_checkpointer_paused;
         bool m_wiper_paused;
+        bool m_sampler_paused;
+        bool m_sample_requested;
         uint64_t m_checkpoint_gc;
         typedef std::list<std::pair<transfer_id, region_id> > wipe_list_t;
         wipe_list_t m_wiping;
+        // storage ids of dropped regions that still hold keys
+        std::list<region_id> m_purging;
+        uint64_t m_dropped;
+        po6::threads::mutex m_protect_storage;
+        // regions whose storage id is not their own.  Readers load the map
+        // without locking; writers publish a modified copy under
+        // m_protect_storage, and the maps it replaces are freed on
+        // reconfigure, when no other thread can be reading them.
+        const storage_map* m_storage;
+        std::vector<const storage_map*> m_retired_storage;
+        uint64_t m_storage_counter;
+        po6::threads::mutex m_protect_stats;
+        // by storage id
+        std::map<region_id, e::compat::shared_ptr<const index_stats> > m_stats;
 };
 
 class datalayer::reference
@@ -233,6 +392,32 @@ class datalayer::reference
 
     private:
         std::string m_backing;
+        // set instead of m_backing when the object came from the cache
+        e::intrusive_ptr<object_cache::entry> m_cached;
+};
+
+class datalayer::write_batch
+{
+    public:
+        write_batch();
+        ~write_batch() throw ();
+
+    public:
+        bool empty() const { return m_keys.empty() && m_acked == 0; }
+
+    private:
+        friend class datalayer;
+
+    private:
+        leveldb::WriteBatch m_updates;
+        // encoded keys of the objects changed by m_updates; their cache
+        // entries are invalidated once the write is applied
+        std::vector<std::string> m_keys;
+        size_t m_acked;
+
+    private:
+        write_batch(const write_batch&);
+        write_batch& operator = (const write_batch&);
 };
 
 std::ostream&
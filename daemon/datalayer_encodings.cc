@@ -265,6 +265,35 @@ hyperdex :: decode_checkpoint(const e::slice& in,
     return t == 'c' ? datalayer::SUCCESS : datalayer::BAD_ENCODING;
 }
 
+void
+hyperdex :: encode_storage(uint8_t c,
+                           const region_id& ri,
+                           char* out)
+{
+    char* ptr = out;
+    ptr = e::pack8be(c, ptr);
+    ptr = e::pack64be(ri.get(), ptr);
+}
+
+datalayer::returncode
+hyperdex :: decode_storage(const e::slice& in,
+                           uint8_t c,
+                           region_id* ri)
+{
+    if (in.size() != STORAGE_BUF_SIZE)
+    {
+        return datalayer::BAD_ENCODING;
+    }
+
+    const uint8_t* ptr = in.data();
+    uint8_t t;
+    uint64_t _ri;
+    ptr = e::unpack8be(ptr, &t);
+    ptr = e::unpack64be(ptr, &_ri);
+    *ri = region_id(_ri);
+    return t == c ? datalayer::SUCCESS : datalayer::BAD_ENCODING;
+}
+
 void
 hyperdex :: create_index_changes(const schema& sc,
                                  const subspace& sub,
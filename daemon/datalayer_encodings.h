@@ -95,6 +95,21 @@ decode_checkpoint(const e::slice& in,
                   region_id* ri,
                   uint64_t* checkpoint);
 
+// region storage: 'r' maps a region to the storage id its objects and index
+// entries are keyed under, 'p' marks a storage id awaiting its purge, and 's'
+// holds the search statistics of a storage id; storage ids other than a
+// region's own have the high bit set
+#define STORAGE_BUF_SIZE (sizeof(uint8_t) + sizeof(uint64_t))
+#define STORAGE_ID_BIT (1ULL << 63)
+void
+encode_storage(uint8_t c,
+               const region_id& ri,
+               char* out);
+datalayer::returncode
+decode_storage(const e::slice& in,
+               uint8_t c,
+               region_id* ri);
+
 void
 create_index_changes(const schema& sc,
                      const subspace& sub,
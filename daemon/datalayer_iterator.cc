@@ -34,6 +34,7 @@
 #include "daemon/daemon.h"
 #include "daemon/datalayer_encodings.h"
 #include "daemon/datalayer_iterator.h"
+#include "daemon/region_tree.h"
 
 using hyperdex::datalayer;
 using hyperdex::leveldb_snapshot_ptr;
@@ -164,10 +165,167 @@ datalayer :: replay_iterator :: status()
     return m_iter->status();
 }
 
+////////////////////////////// class dump_iterator /////////////////////////////
+
+datalayer :: dump_iterator :: dump_iterator(const region_id& ri,
+                                            const region_id& si,
+                                            leveldb_iterator_ptr iter)
+    : m_ri(ri)
+    , m_si(si)
+    , m_iter(iter)
+    , m_key()
+{
+    seek('i');
+}
+
+datalayer :: dump_iterator :: ~dump_iterator() throw ()
+{
+}
+
+bool
+datalayer :: dump_iterator :: valid()
+{
+    leveldb::Slice prefix(m_prefix, sizeof(m_prefix));
+
+    if (m_iter->Valid() && m_iter->key().starts_with(prefix))
+    {
+        return true;
+    }
+
+    // the index entries are done; move on to the objects
+    if (m_prefix[0] == 'i' && m_iter->status().ok())
+    {
+        seek('o');
+        return m_iter->Valid() && m_iter->key().starts_with(prefix);
+    }
+
+    return false;
+}
+
+void
+datalayer :: dump_iterator :: next()
+{
+    m_iter->Next();
+}
+
+e::slice
+datalayer :: dump_iterator :: key()
+{
+    // name the region rather than where it is stored locally
+    leveldb::Slice k = m_iter->key();
+    m_key.assign(k.data(), k.data() + k.size());
+    e::pack64be(m_ri.get(), &m_key[sizeof(uint8_t)]);
+    return e::slice(&m_key.front(), m_key.size());
+}
+
+e::slice
+datalayer :: dump_iterator :: value()
+{
+    leveldb::Slice v = m_iter->value();
+    return e::slice(v.data(), v.size());
+}
+
+leveldb::Status
+datalayer :: dump_iterator :: status()
+{
+    return m_iter->status();
+}
+
+void
+datalayer :: dump_iterator :: seek(uint8_t c)
+{
+    char* ptr = m_prefix;
+    ptr = e::pack8be(c, ptr);
+    ptr = e::pack64be(m_si.get(), ptr);
+    m_iter->Seek(leveldb::Slice(m_prefix, sizeof(m_prefix)));
+}
+
+////////////////////////////// class leaf_iterator /////////////////////////////
+
+datalayer :: leaf_iterator :: leaf_iterator(const region_id& ri,
+                                            leveldb_iterator_ptr iter,
+                                            index_info* di,
+                                            const std::vector<bool>& leaves)
+    : m_ri(ri)
+    , m_iter(iter)
+    , m_di(di)
+    , m_leaves(leaves)
+    , m_decoded()
+{
+    char* ptr = m_prefix;
+    ptr = e::pack8be('o', ptr);
+    ptr = e::pack64be(m_ri.get(), ptr);
+    m_iter->Seek(leveldb::Slice(m_prefix, sizeof(m_prefix)));
+}
+
+datalayer :: leaf_iterator :: ~leaf_iterator() throw ()
+{
+}
+
+bool
+datalayer :: leaf_iterator :: valid()
+{
+    leveldb::Slice prefix(m_prefix, sizeof(m_prefix));
+
+    while (m_iter->Valid() && m_iter->key().starts_with(prefix))
+    {
+        leveldb::Slice k = m_iter->key();
+        e::slice ekey(k.data() + prefix.size(), k.size() - prefix.size());
+
+        if (m_leaves[region_tree::leaf_for(ekey)])
+        {
+            return true;
+        }
+
+        m_iter->Next();
+    }
+
+    return false;
+}
+
+void
+datalayer :: leaf_iterator :: next()
+{
+    m_iter->Next();
+}
+
+e::slice
+datalayer :: leaf_iterator :: key()
+{
+    const size_t sz = sizeof(m_prefix);
+    leveldb::Slice _k = m_iter->key();
+    e::slice k = e::slice(_k.data() + sz, _k.size() - sz);
+    size_t decoded_sz = m_di->decoded_size(k);
+
+    if (m_decoded.size() < decoded_sz)
+    {
+        m_decoded.resize(decoded_sz);
+    }
+
+    m_di->decode(k, &m_decoded.front());
+    return e::slice(&m_decoded.front(), decoded_sz);
+}
+
+datalayer::returncode
+datalayer :: leaf_iterator :: unpack_value(std::vector<e::slice>* value,
+                                           uint64_t* version,
+                                           reference* ref)
+{
+    ref->m_backing.assign(m_iter->value().data(), m_iter->value().size());
+    e::slice v(ref->m_backing.data(), ref->m_backing.size());
+    return decode_value(v, value, version);
+}
+
+leveldb::Status
+datalayer :: leaf_iterator :: status()
+{
+    return m_iter->status();
+}
+
 ///////////////////////////// class dummy_iterator /////////////////////////////
 
 datalayer :: dummy_iterator :: dummy_iterator()
-    : iterator(leveldb_snapshot_ptr())
+    : index_iterator(leveldb_snapshot_ptr())
 {
 }
 
@@ -200,6 +358,35 @@ datalayer :: dummy_iterator :: describe(std::ostream& out) const
     return out << "dummy_iterator()";
 }
 
+e::slice
+datalayer :: dummy_iterator :: internal_key()
+{
+    return e::slice();
+}
+
+bool
+datalayer :: dummy_iterator :: sorted()
+{
+    return true;
+}
+
+void
+datalayer :: dummy_iterator :: seek(const e::slice&)
+{
+}
+
+bool
+datalayer :: dummy_iterator :: has_value()
+{
+    return false;
+}
+
+e::slice
+datalayer :: dummy_iterator :: value()
+{
+    return e::slice();
+}
+
 datalayer :: dummy_iterator :: ~dummy_iterator() throw ()
 {
 }
@@ -312,22 +499,30 @@ datalayer :: index_iterator :: ~index_iterator() throw ()
 {
 }
 
+void
+datalayer :: index_iterator :: seek_after(const e::slice&, const e::slice&)
+{
+    abort();
+}
+
 //////////////////////////// class intersect_iterator ////////////////////////////
 
 datalayer :: intersect_iterator :: intersect_iterator(leveldb_snapshot_ptr s,
-                                                      const std::vector<e::intrusive_ptr<index_iterator> >& iterators)
+                                                      const std::vector<e::intrusive_ptr<index_iterator> >& iterators,
+                                                      const std::vector<uint64_t>& costs)
     : index_iterator(s)
     , m_iters()
     , m_cost(0)
     , m_invalid(false)
 {
     assert(!iterators.empty());
-    std::vector<std::pair<uint64_t, e::intrusive_ptr<index_iterator> > > iters;
+    assert(iterators.size() == costs.size());
+    std::vector<std::pair<uint64_t, size_t> > iters;
 
     for (size_t i = 0; i < iterators.size(); ++i)
     {
         assert(iterators[i]->sorted());
-        iters.push_back(std::make_pair(iterators[i]->cost(s.db()), iterators[i]));
+        iters.push_back(std::make_pair(costs[i], i));
     }
 
     std::sort(iters.begin(), iters.end());
@@ -336,7 +531,7 @@ datalayer :: intersect_iterator :: intersect_iterator(leveldb_snapshot_ptr s,
     for (size_t i = 0; i < iters.size(); ++i)
     {
         m_cost += iters[i].first;
-        m_iters[i] = iters[i].second;
+        m_iters[i] = iterators[iters[i].second];
     }
 
     for (size_t i = 0; i < m_iters.size(); ++i)
@@ -446,6 +641,18 @@ datalayer :: intersect_iterator :: seek(const e::slice& k)
     return m_iters[0]->seek(k);
 }
 
+bool
+datalayer :: intersect_iterator :: has_value()
+{
+    return m_iters[0]->has_value();
+}
+
+e::slice
+datalayer :: intersect_iterator :: value()
+{
+    return m_iters[0]->value();
+}
+
 ///////////////////////////// class search_iterator ////////////////////////////
 
 datalayer :: search_iterator :: search_iterator(datalayer* dl,
@@ -456,11 +663,20 @@ datalayer :: search_iterator :: search_iterator(datalayer* dl,
     : iterator(iter->snap())
     , m_dl(dl)
     , m_ri(ri)
+    , m_si(dl->storage_for(ri))
     , m_iter(iter)
     , m_error(SUCCESS)
     , m_ostr(ostr)
     , m_num_gets(0)
+    , m_num_scanned(0)
+    , m_num_matched(0)
+    , m_estimated(false)
+    , m_est_candidates(0)
+    , m_est_matches(0)
     , m_checks(checks)
+    , m_have_object(false)
+    , m_backing()
+    , m_object()
 {
 }
 
@@ -482,46 +698,61 @@ datalayer :: search_iterator :: valid()
         return false;
     }
 
+    if (m_have_object)
+    {
+        return true;
+    }
+
     // Don't try to optimize by replacing m_ri with a const schema* because it
     // won't persist across reconfigurations
     const schema& sc(*m_dl->m_daemon->m_config.get_schema(m_ri));
 
     uint64_t version;
     std::vector<e::slice> value;
-    reference ref;
 
     // while the most selective iterator is valid and not past the end
     while (m_iter->valid())
     {
-        leveldb::ReadOptions opts;
-        opts.fill_cache = true;
-        opts.verify_checksums = true;
-        std::vector<char> kbacking;
-        leveldb::Slice lkey;
-        encode_key(m_ri, sc.attrs[0].type, m_iter->key(), &kbacking, &lkey);
-        leveldb::Status st = m_dl->m_db->Get(opts, lkey, &ref.m_backing);
-
-        if (st.ok())
+        // when the iterator walks the objects themselves, the value comes
+        // straight from LevelDB; otherwise, it costs a point lookup
+        if (m_iter->has_value())
         {
-            e::slice v(ref.m_backing.data(), ref.m_backing.size());
-            datalayer::returncode rc = decode_value(v, &value, &version);
-
-            if (rc != SUCCESS)
+            m_object = m_iter->value();
+            ++m_num_scanned;
+        }
+        else
+        {
+            leveldb::ReadOptions opts;
+            opts.fill_cache = true;
+            opts.verify_checksums = true;
+            opts.snapshot = snap().get();
+            std::vector<char> kbacking;
+            leveldb::Slice lkey;
+            encode_key(m_si, sc.attrs[0].type, m_iter->key(), &kbacking, &lkey);
+            leveldb::Status st = m_dl->m_db->Get(opts, lkey, &m_backing);
+
+            if (!st.ok())
             {
-                m_error = rc;
+                m_error = m_dl->handle_error(st);
                 return false;
             }
 
+            m_object = e::slice(m_backing.data(), m_backing.size());
             ++m_num_gets;
         }
-        else
+
+        datalayer::returncode rc = decode_value(m_object, &value, &version);
+
+        if (rc != SUCCESS)
         {
-            m_error = m_dl->handle_error(st);
+            m_error = rc;
             return false;
         }
 
         if (passes_attribute_checks(sc, *m_checks, m_iter->key(), value) == m_checks->size())
         {
+            ++m_num_matched;
+            m_have_object = true;
             return true;
         }
         else
@@ -530,13 +761,23 @@ datalayer :: search_iterator :: valid()
         }
     }
 
-    if (m_ostr) *m_ostr << " iterator retrieved " << m_num_gets << " objects from disk\n";
+    if (m_ostr) *m_ostr << " iterator retrieved " << m_num_gets << " objects from disk"
+                        << " and scanned " << m_num_scanned << " objects in place\n";
+
+    if (m_ostr && m_estimated)
+    {
+        *m_ostr << " checked " << m_num_gets + m_num_scanned << " candidates"
+                << " (estimated " << m_est_candidates << ") and found "
+                << m_num_matched << " matches (estimated " << m_est_matches << ")\n";
+    }
+
     return false;
 }
 
 void
 datalayer :: search_iterator :: next()
 {
+    m_have_object = false;
     m_iter->next();
 }
 
@@ -551,3 +792,27 @@ datalayer :: search_iterator :: key()
 {
     return m_iter->key();
 }
+
+void
+datalayer :: search_iterator :: set_estimate(uint64_t candidates, uint64_t matches)
+{
+    m_estimated = true;
+    m_est_candidates = candidates;
+    m_est_matches = matches;
+}
+
+datalayer::returncode
+datalayer :: search_iterator :: unpack(e::slice* key,
+                                       std::vector<e::slice>* value,
+                                       uint64_t* version,
+                                       reference* ref)
+{
+    assert(m_have_object);
+    e::slice k = m_iter->key();
+    ref->m_backing.reserve(m_object.size() + k.size());
+    ref->m_backing.assign(reinterpret_cast<const char*>(m_object.data()), m_object.size());
+    ref->m_backing.append(reinterpret_cast<const char*>(k.data()), k.size());
+    *key = e::slice(ref->m_backing.data() + m_object.size(), k.size());
+    e::slice v(ref->m_backing.data(), m_object.size());
+    return decode_value(v, value, version);
+}
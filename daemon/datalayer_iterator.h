@@ -93,20 +93,69 @@ class datalayer::replay_iterator
         replay_iterator& operator = (const replay_iterator&);
 };
 
-class datalayer::dummy_iterator : public iterator
+
+// walks the raw index entries and then the objects of one region, which is
+// the order they sort in
+class datalayer::dump_iterator
 {
     public:
-        dummy_iterator();
+        dump_iterator(const region_id& ri,
+                      const region_id& si,
+                      leveldb_iterator_ptr iter);
+        ~dump_iterator() throw ();
 
     public:
-        virtual bool valid();
-        virtual void next();
-        virtual uint64_t cost(leveldb::DB*);
-        virtual e::slice key();
-        virtual std::ostream& describe(std::ostream&) const;
+        bool valid();
+        void next();
+        e::slice key();
+        e::slice value();
+        leveldb::Status status();
 
-    protected:
-        virtual ~dummy_iterator() throw ();
+    private:
+        void seek(uint8_t c);
+
+    private:
+        region_id m_ri;
+        region_id m_si;
+        leveldb_iterator_ptr m_iter;
+        char m_prefix[sizeof(uint8_t) + sizeof(uint64_t)];
+        std::vector<char> m_key;
+
+    private:
+        dump_iterator(const dump_iterator&);
+        dump_iterator& operator = (const dump_iterator&);
+};
+
+// the objects of one region that fall in the marked leaves of a region_tree
+class datalayer::leaf_iterator
+{
+    public:
+        leaf_iterator(const region_id& ri,
+                      leveldb_iterator_ptr iter,
+                      index_info* di,
+                      const std::vector<bool>& leaves);
+        ~leaf_iterator() throw ();
+
+    public:
+        bool valid();
+        void next();
+        e::slice key();
+        returncode unpack_value(std::vector<e::slice>* value,
+                                uint64_t* version,
+                                reference* ref);
+        leveldb::Status status();
+
+    private:
+        region_id m_ri;
+        leveldb_iterator_ptr m_iter;
+        index_info* m_di;
+        std::vector<bool> m_leaves;
+        std::vector<char> m_decoded;
+        char m_prefix[sizeof(uint8_t) + sizeof(uint64_t)];
+
+    private:
+        leaf_iterator(const leaf_iterator&);
+        leaf_iterator& operator = (const leaf_iterator&);
 };
 
 class datalayer::region_iterator : public iterator
@@ -147,16 +196,50 @@ class datalayer::index_iterator : public iterator
         virtual e::slice internal_key() = 0;
         virtual bool sorted() = 0;
         virtual void seek(const e::slice& internal_key) = 0;
+        // does the iterator walk the objects themselves (so the encoded value
+        // is available without another read)?
+        virtual bool has_value() = 0;
+        // REQUIRES: valid && has_value
+        // the slice is valid until the iterator moves
+        virtual e::slice value() = 0;
+        // move to the first object after the one with this (decoded) value
+        // and key, in the order the iterator walks them; only the iterators
+        // from index_info::iterator_in_order support this
+        virtual void seek_after(const e::slice& value, const e::slice& key);
 
     protected:
         friend class e::intrusive_ptr<index_iterator>;
 };
 
+class datalayer::dummy_iterator : public index_iterator
+{
+    public:
+        dummy_iterator();
+
+    public:
+        virtual bool valid();
+        virtual void next();
+        virtual uint64_t cost(leveldb::DB*);
+        virtual e::slice key();
+        virtual std::ostream& describe(std::ostream&) const;
+        virtual e::slice internal_key();
+        virtual bool sorted();
+        virtual void seek(const e::slice& internal_key);
+        virtual bool has_value();
+        virtual e::slice value();
+
+    protected:
+        virtual ~dummy_iterator() throw ();
+};
+
 class datalayer::intersect_iterator : public index_iterator
 {
     public:
+        // costs[i] is the cost of iterators[i]; the cheapest is walked and
+        // the others are sought
         intersect_iterator(leveldb_snapshot_ptr snap,
-                           const std::vector<e::intrusive_ptr<index_iterator> >& iterators);
+                           const std::vector<e::intrusive_ptr<index_iterator> >& iterators,
+                           const std::vector<uint64_t>& costs);
         virtual ~intersect_iterator() throw ();
 
     public:
@@ -168,6 +251,8 @@ class datalayer::intersect_iterator : public index_iterator
         virtual e::slice internal_key();
         virtual bool sorted();
         virtual void seek(const e::slice& internal_key);
+        virtual bool has_value();
+        virtual e::slice value();
 
     private:
         std::vector<e::intrusive_ptr<index_iterator> > m_iters;
@@ -192,6 +277,22 @@ class datalayer::search_iterator : public iterator
         virtual e::slice key();
         virtual std::ostream& describe(std::ostream&) const;
 
+    public:
+        // REQUIRES: valid
+        // retrieve the object that valid() already read and checked; the
+        // key and value point into ref and outlive the iterator's position
+        returncode unpack(e::slice* key,
+                          std::vector<e::slice>* value,
+                          uint64_t* version,
+                          reference* ref);
+        // the planner's guess at the objects the search will check and the
+        // objects that will pass, reported next to the actual counts once
+        // the search ends
+        void set_estimate(uint64_t candidates, uint64_t matches);
+
+    private:
+        friend class e::intrusive_ptr<search_iterator>;
+
     private:
         search_iterator(const search_iterator&);
         search_iterator& operator = (const search_iterator&);
@@ -199,11 +300,22 @@ class datalayer::search_iterator : public iterator
     private:
         datalayer* m_dl;
         region_id m_ri;
+        // the storage id the objects of m_ri are keyed under
+        region_id m_si;
         e::intrusive_ptr<index_iterator> m_iter;
         returncode m_error;
         std::ostringstream* m_ostr;
         uint64_t m_num_gets;
+        uint64_t m_num_scanned;
+        uint64_t m_num_matched;
+        bool m_estimated;
+        uint64_t m_est_candidates;
+        uint64_t m_est_matches;
         const std::vector<attribute_check>* m_checks;
+        // the object at the current position, once valid() has read it
+        bool m_have_object;
+        std::string m_backing;
+        e::slice m_object;
 };
 
 inline std::ostream&
@@ -173,3 +173,37 @@ index_container :: iterator_from_check(leveldb_snapshot_ptr snap,
 
     return NULL;
 }
+
+bool
+index_container :: collect_stats(datalayer* dl,
+                                 leveldb_snapshot_ptr snap,
+                                 const region_id& ri,
+                                 uint16_t attr,
+                                 index_info* key_ii,
+                                 index_stats::attribute* stats)
+{
+    // the index holds one entry per element, keyed like a primitive index
+    return this->element_index_info()->collect_stats(dl, snap, ri, attr, key_ii, stats);
+}
+
+bool
+index_container :: estimate_check(const index_stats::attribute& stats,
+                                  const attribute_check& c,
+                                  uint64_t* entries)
+{
+    if (c.predicate == HYPERPREDICATE_CONTAINS &&
+        c.datatype == this->element_datatype_info()->datatype())
+    {
+        range r;
+        r.attr = c.attr;
+        r.type = c.datatype;
+        r.start = c.value;
+        r.end = c.value;
+        r.has_start = true;
+        r.has_end = true;
+        r.invalid = false;
+        return this->element_index_info()->estimate_range(stats, r, entries);
+    }
+
+    return false;
+}
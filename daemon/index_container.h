@@ -59,6 +59,15 @@ class index_container : public index_info
                                                                const region_id& ri,
                                                                const attribute_check& c,
                                                                index_info* key_ii);
+        virtual bool collect_stats(datalayer* dl,
+                                   leveldb_snapshot_ptr snap,
+                                   const region_id& ri,
+                                   uint16_t attr,
+                                   index_info* key_ii,
+                                   index_stats::attribute* stats);
+        virtual bool estimate_check(const index_stats::attribute& stats,
+                                    const attribute_check& c,
+                                    uint64_t* entries);
 
     private:
         virtual void extract_elements(const e::slice& container,
@@ -136,3 +136,40 @@ index_info :: iterator_from_check(leveldb_snapshot_ptr,
 {
     return NULL;
 }
+
+datalayer::index_iterator*
+index_info :: iterator_in_order(leveldb_snapshot_ptr,
+                                const region_id&,
+                                const range&,
+                                index_info*,
+                                bool)
+{
+    return NULL;
+}
+
+bool
+index_info :: collect_stats(datalayer*,
+                            leveldb_snapshot_ptr,
+                            const region_id&,
+                            uint16_t,
+                            index_info*,
+                            index_stats::attribute*)
+{
+    return false;
+}
+
+bool
+index_info :: estimate_range(const index_stats::attribute&,
+                             const range&,
+                             uint64_t*)
+{
+    return false;
+}
+
+bool
+index_info :: estimate_check(const index_stats::attribute&,
+                             const attribute_check&,
+                             uint64_t*)
+{
+    return false;
+}
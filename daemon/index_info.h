@@ -41,6 +41,7 @@
 #include "common/ids.h"
 #include "common/range.h"
 #include "daemon/datalayer.h"
+#include "daemon/index_stats.h"
 
 BEGIN_HYPERDEX_NAMESPACE
 
@@ -94,6 +95,35 @@ class index_info
                                                                const region_id& ri,
                                                                const attribute_check& c,
                                                                index_info* key_ii);
+        // return an iterator that retrieves exactly the keys in r in the
+        // order of the attribute's values (descending if reverse)
+        // if the index cannot yield that order, return NULL
+        virtual datalayer::index_iterator* iterator_in_order(leveldb_snapshot_ptr snap,
+                                                             const region_id& ri,
+                                                             const range& r,
+                                                             index_info* key_ii,
+                                                             bool reverse);
+
+    // override these if the type keeps statistics for the search planner
+    public:
+        // walk the index of attr in order and feed its values to stats,
+        // checking in with dl->pace_background as it goes
+        // return false if not indexable or the walk was cut short
+        virtual bool collect_stats(datalayer* dl,
+                                   leveldb_snapshot_ptr snap,
+                                   const region_id& ri,
+                                   uint16_t attr,
+                                   index_info* key_ii,
+                                   index_stats::attribute* stats);
+        // estimate the entries an iterator from iterator_from_range or
+        // iterator_from_check would visit
+        // return false if there is no estimate
+        virtual bool estimate_range(const index_stats::attribute& stats,
+                                    const range& r,
+                                    uint64_t* entries);
+        virtual bool estimate_check(const index_stats::attribute& stats,
+                                    const attribute_check& c,
+                                    uint64_t* entries);
 };
 
 END_HYPERDEX_NAMESPACE
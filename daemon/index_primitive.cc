@@ -33,6 +33,9 @@
 #include "daemon/datalayer_iterator.h"
 #include "daemon/index_primitive.h"
 
+// entries the statistics walk reads between visits to the sampler's pacing
+#define STATS_PACE_STRIDE 4096
+
 using hyperdex::datalayer;
 using hyperdex::index_primitive;
 
@@ -289,7 +292,8 @@ class range_iterator : public datalayer::index_iterator
                        const region_id& ri,
                        const range& r,
                        index_primitive* val_ii,
-                       index_info* key_ii);
+                       index_info* key_ii,
+                       bool reverse);
         virtual ~range_iterator() throw ();
 
     public:
@@ -301,6 +305,9 @@ class range_iterator : public datalayer::index_iterator
         virtual e::slice internal_key();
         virtual bool sorted();
         virtual void seek(const e::slice& internal_key);
+        virtual bool has_value();
+        virtual e::slice value();
+        virtual void seek_after(const e::slice& value, const e::slice& key);
 
     private:
         range_iterator(const range_iterator&);
@@ -317,6 +324,7 @@ class range_iterator : public datalayer::index_iterator
         std::vector<char> m_limit_buf;
         e::slice m_start;
         e::slice m_limit;
+        bool m_reverse;
         bool m_invalid;
 };
 
@@ -341,7 +349,8 @@ range_iterator :: range_iterator(leveldb_snapshot_ptr s,
                                  const region_id& ri,
                                  const range& r,
                                  index_primitive* val_ii,
-                                 index_info* key_ii)
+                                 index_info* key_ii,
+                                 bool reverse)
     : index_iterator(s)
     , m_iter()
     , m_ri(ri)
@@ -353,6 +362,7 @@ range_iterator :: range_iterator(leveldb_snapshot_ptr s,
     , m_limit_buf()
     , m_start()
     , m_limit()
+    , m_reverse(reverse)
     , m_invalid(false)
 {
     leveldb::ReadOptions opts;
@@ -378,7 +388,33 @@ range_iterator :: range_iterator(leveldb_snapshot_ptr s,
         convert_to_ordered_encoding(m_range.end, m_val_ii, &m_limit_buf, &m_limit);
     }
 
+    if (!m_reverse)
+    {
+        m_iter->Seek(slice);
+        return;
+    }
+
+    // position on the last entry at or before the end of the range
+    if (m_range.has_end)
+    {
+        m_val_ii->index_entry(m_ri, m_range.attr, m_range.end, &m_scratch, &slice);
+    }
+    else
+    {
+        m_val_ii->index_entry(m_ri, m_range.attr, &m_scratch, &slice);
+    }
+
+    hyperdex::encode_bump(&m_scratch.front(), &m_scratch.front() + slice.size());
     m_iter->Seek(slice);
+
+    if (m_iter->Valid())
+    {
+        m_iter->Prev();
+    }
+    else
+    {
+        m_iter->SeekToLast();
+    }
 }
 
 range_iterator :: ~range_iterator() throw ()
@@ -402,14 +438,18 @@ range_iterator :: valid()
             return false;
         }
 
-        if (m_ri < ri || m_range.attr < attr)
+        // walking backwards, the constructor started at or before the last
+        // entry for this attribute, so any other prefix is below the range
+        if (m_reverse ? (m_ri != ri || m_range.attr != attr)
+                      : (m_ri < ri || m_range.attr < attr))
         {
             m_invalid = true;
             return false;
         }
 
         // if there is a start, and the current value is less than it, advance
-        // the iterator
+        // the iterator.  Walking backwards, all subsequent values are less
+        // than it too
         if (m_range.has_start)
         {
             size_t sz = std::min(m_start.size(), iv.size());
@@ -418,6 +458,12 @@ range_iterator :: valid()
             if (cmp > 0 ||
                 (cmp == 0 && m_start.size() > iv.size()))
             {
+                if (m_reverse)
+                {
+                    m_invalid = true;
+                    return false;
+                }
+
                 m_iter->Next();
                 continue;
             }
@@ -431,15 +477,15 @@ range_iterator :: valid()
             size_t sz = std::min(m_limit.size(), iv.size());
             int cmp = memcmp(m_limit.data(), iv.data(), sz);
 
-            if (cmp < 0)
+            if (cmp < 0 && !m_reverse)
             {
                 m_invalid = true;
                 return false;
             }
 
-            if (cmp == 0 && m_limit.size() < iv.size())
+            if (cmp < 0 || (cmp == 0 && m_limit.size() < iv.size()))
             {
-                m_iter->Next();
+                next();
                 continue;
             }
         }
@@ -453,12 +499,41 @@ range_iterator :: valid()
 void
 range_iterator :: next()
 {
-    m_iter->Next();
+    if (m_reverse)
+    {
+        m_iter->Prev();
+    }
+    else
+    {
+        m_iter->Next();
+    }
 }
 
 uint64_t
 range_iterator :: cost(leveldb::DB* db)
 {
+    if (m_reverse)
+    {
+        // the entries between the start of the range and the current one
+        leveldb::Slice lower;
+
+        if (m_range.has_start)
+        {
+            m_val_ii->index_entry(m_ri, m_range.attr, m_range.start, &m_scratch, &lower);
+        }
+        else
+        {
+            m_val_ii->index_entry(m_ri, m_range.attr, &m_scratch, &lower);
+        }
+
+        leveldb::Range r;
+        r.start = lower;
+        r.limit = m_iter->key();
+        uint64_t ret;
+        db->GetApproximateSizes(&r, 1, &ret);
+        return ret;
+    }
+
     leveldb::Slice upper;
 
     if (m_range.has_end)
@@ -499,7 +574,7 @@ range_iterator :: key()
 std::ostream&
 range_iterator :: describe(std::ostream& out) const
 {
-    return out << "primitive range_iterator()";
+    return out << "primitive range_iterator(" << (m_reverse ? "reverse" : "") << ")";
 }
 
 e::slice
@@ -517,7 +592,7 @@ range_iterator :: internal_key()
 bool
 range_iterator :: sorted()
 {
-    return m_range.has_start && m_range.has_end && m_range.start == m_range.end;
+    return !m_reverse && m_range.has_start && m_range.has_end && m_range.start == m_range.end;
 }
 
 void
@@ -529,13 +604,52 @@ range_iterator :: seek(const e::slice& ik)
     m_iter->Seek(slice);
 }
 
+bool
+range_iterator :: has_value()
+{
+    return false;
+}
+
+e::slice
+range_iterator :: value()
+{
+    abort();
+}
+
+void
+range_iterator :: seek_after(const e::slice& value, const e::slice& key)
+{
+    leveldb::Slice target;
+    m_val_ii->index_entry(m_ri, m_range.attr, m_key_ii, key, value, &m_scratch, &target);
+    m_iter->Seek(target);
+    m_invalid = false;
+
+    if (!m_reverse)
+    {
+        // skip the entry itself if the object has not changed since
+        if (m_iter->Valid() && m_iter->key() == target)
+        {
+            m_iter->Next();
+        }
+    }
+    else if (m_iter->Valid())
+    {
+        m_iter->Prev();
+    }
+    else
+    {
+        m_iter->SeekToLast();
+    }
+}
+
 class key_iterator : public datalayer::index_iterator
 {
     public:
         key_iterator(leveldb_snapshot_ptr snap,
                      const region_id& ri,
                      const range& r,
-                     index_info* key_ii);
+                     index_info* key_ii,
+                     bool reverse);
         virtual ~key_iterator() throw ();
 
     public:
@@ -547,6 +661,9 @@ class key_iterator : public datalayer::index_iterator
         virtual e::slice internal_key();
         virtual bool sorted();
         virtual void seek(const e::slice& internal_key);
+        virtual bool has_value();
+        virtual e::slice value();
+        virtual void seek_after(const e::slice& value, const e::slice& key);
 
     private:
         key_iterator(const key_iterator&);
@@ -558,23 +675,30 @@ class key_iterator : public datalayer::index_iterator
         range m_range;
         index_info* m_key_ii;
         std::vector<char> m_scratch;
+        std::vector<char> m_start_buf;
         std::vector<char> m_limit_buf;
+        e::slice m_start;
         e::slice m_limit;
+        bool m_reverse;
         bool m_invalid;
 };
 
 key_iterator :: key_iterator(leveldb_snapshot_ptr s,
                              const region_id& ri,
                              const range& r,
-                             index_info* key_ii)
+                             index_info* key_ii,
+                             bool reverse)
     : index_iterator(s)
     , m_iter()
     , m_ri(ri)
     , m_range(r)
     , m_key_ii(key_ii)
     , m_scratch()
+    , m_start_buf()
     , m_limit_buf()
+    , m_start()
     , m_limit()
+    , m_reverse(reverse)
     , m_invalid(false)
 {
     assert(m_range.attr == 0);
@@ -600,7 +724,38 @@ key_iterator :: key_iterator(leveldb_snapshot_ptr s,
         convert_to_ordered_encoding(m_range.end, m_key_ii, &m_limit_buf, &m_limit);
     }
 
+    if (!m_reverse)
+    {
+        m_iter->Seek(slice);
+        return;
+    }
+
+    if (m_range.has_start)
+    {
+        convert_to_ordered_encoding(m_range.start, m_key_ii, &m_start_buf, &m_start);
+    }
+
+    // position on the last object at or before the end of the range
+    if (m_range.has_end)
+    {
+        encode_key(m_ri, m_range.type, m_range.end, &m_scratch, &slice);
+    }
+    else
+    {
+        encode_object_region(m_ri, &m_scratch, &slice);
+    }
+
+    hyperdex::encode_bump(&m_scratch.front(), &m_scratch.front() + slice.size());
     m_iter->Seek(slice);
+
+    if (m_iter->Valid())
+    {
+        m_iter->Prev();
+    }
+    else
+    {
+        m_iter->SeekToLast();
+    }
 }
 
 key_iterator :: ~key_iterator() throw ()
@@ -617,12 +772,26 @@ key_iterator :: valid()
         e::slice ik;
 
         if (!decode_key(_k, &ri, &ik) ||
-            m_ri < ri)
+            (m_reverse ? m_ri != ri : m_ri < ri))
         {
             m_invalid = true;
             return false;
         }
 
+        // walking backwards, the first key below the start ends the range
+        if (m_reverse && m_range.has_start)
+        {
+            size_t sz = std::min(m_start.size(), ik.size());
+            int cmp = memcmp(m_start.data(), ik.data(), sz);
+
+            if (cmp > 0 ||
+                (cmp == 0 && m_start.size() > ik.size()))
+            {
+                m_invalid = true;
+                return false;
+            }
+        }
+
         if (!m_range.has_end)
         {
             return true;
@@ -631,15 +800,15 @@ key_iterator :: valid()
         size_t sz = std::min(m_limit.size(), ik.size());
         int cmp = memcmp(m_limit.data(), ik.data(), sz);
 
-        if (cmp < 0)
+        if (cmp < 0 && !m_reverse)
         {
             m_invalid = true;
             return false;
         }
 
-        if (cmp == 0 && m_limit.size() < ik.size())
+        if (cmp < 0 || (cmp == 0 && m_limit.size() < ik.size()))
         {
-            m_iter->Next();
+            next();
             continue;
         }
 
@@ -652,12 +821,41 @@ key_iterator :: valid()
 void
 key_iterator :: next()
 {
-    m_iter->Next();
+    if (m_reverse)
+    {
+        m_iter->Prev();
+    }
+    else
+    {
+        m_iter->Next();
+    }
 }
 
 uint64_t
 key_iterator :: cost(leveldb::DB* db)
 {
+    if (m_reverse)
+    {
+        // the objects between the start of the range and the current one
+        leveldb::Slice lower;
+
+        if (m_range.has_start)
+        {
+            encode_key(m_ri, m_range.type, m_range.start, &m_scratch, &lower);
+        }
+        else
+        {
+            encode_object_region(m_ri, &m_scratch, &lower);
+        }
+
+        leveldb::Range r;
+        r.start = lower;
+        r.limit = m_iter->key();
+        uint64_t ret;
+        db->GetApproximateSizes(&r, 1, &ret);
+        return ret;
+    }
+
     leveldb::Slice upper;
 
     if (m_range.has_end)
@@ -698,7 +896,7 @@ key_iterator :: key()
 std::ostream&
 key_iterator :: describe(std::ostream& out) const
 {
-    return out << "key_iterator()";
+    return out << "key_iterator(" << (m_reverse ? "reverse" : "") << ")";
 }
 
 e::slice
@@ -714,17 +912,56 @@ key_iterator :: internal_key()
 bool
 key_iterator :: sorted()
 {
-    return true;
+    return !m_reverse;
 }
 
 void
 key_iterator :: seek(const e::slice& ik)
 {
+    assert(sorted());
     leveldb::Slice slice;
     encode_key(m_ri, ik, &m_scratch, &slice);
     m_iter->Seek(slice);
 }
 
+bool
+key_iterator :: has_value()
+{
+    return true;
+}
+
+e::slice
+key_iterator :: value()
+{
+    leveldb::Slice v = m_iter->value();
+    return e::slice(v.data(), v.size());
+}
+
+void
+key_iterator :: seek_after(const e::slice&, const e::slice& key)
+{
+    leveldb::Slice target;
+    encode_key(m_ri, m_range.type, key, &m_scratch, &target);
+    m_iter->Seek(target);
+    m_invalid = false;
+
+    if (!m_reverse)
+    {
+        if (m_iter->Valid() && m_iter->key() == target)
+        {
+            m_iter->Next();
+        }
+    }
+    else if (m_iter->Valid())
+    {
+        m_iter->Prev();
+    }
+    else
+    {
+        m_iter->SeekToLast();
+    }
+}
+
 } // namespace
 
 datalayer::index_iterator*
@@ -740,10 +977,132 @@ index_primitive :: iterator_from_range(leveldb_snapshot_ptr snap,
 
     if (r.attr != 0)
     {
-        return new range_iterator(snap, ri, r, this, key_ii);
+        return new range_iterator(snap, ri, r, this, key_ii, false);
+    }
+    else
+    {
+        return new key_iterator(snap, ri, r, key_ii, false);
+    }
+}
+
+datalayer::index_iterator*
+index_primitive :: iterator_in_order(leveldb_snapshot_ptr snap,
+                                     const region_id& ri,
+                                     const range& r,
+                                     index_info* key_ii,
+                                     bool reverse)
+{
+    if (r.invalid)
+    {
+        return NULL;
+    }
+
+    if (r.attr == 0)
+    {
+        return new key_iterator(snap, ri, r, key_ii, reverse);
+    }
+
+    // a variable-length value runs into the key that follows it, so only
+    // fixed-length values sort in the order of the values themselves
+    if (!this->encoding_fixed())
+    {
+        return NULL;
+    }
+
+    return new range_iterator(snap, ri, r, this, key_ii, reverse);
+}
+
+bool
+index_primitive :: collect_stats(datalayer* dl,
+                                 leveldb_snapshot_ptr snap,
+                                 const region_id& ri,
+                                 uint16_t attr,
+                                 index_info* key_ii,
+                                 index_stats::attribute* stats)
+{
+    leveldb::ReadOptions opts;
+    opts.fill_cache = false;
+    opts.verify_checksums = true;
+    opts.snapshot = snap.get();
+    leveldb_iterator_ptr iter;
+    iter.reset(snap, snap.db()->NewIterator(opts));
+    std::vector<char> scratch;
+    leveldb::Slice prefix;
+
+    // the keys are indexed by the objects themselves
+    if (attr == 0)
+    {
+        encode_object_region(ri, &scratch, &prefix);
     }
     else
     {
-        return new key_iterator(snap, ri, r, key_ii);
+        index_entry(ri, attr, &scratch, &prefix);
+    }
+
+    uint64_t bytes = 0;
+
+    for (iter->Seek(prefix); iter->Valid() && iter->key().starts_with(prefix); iter->Next())
+    {
+        region_id r;
+        uint16_t a;
+        e::slice v;
+        e::slice k;
+
+        if (attr == 0 ? !decode_key(iter->key(), &r, &v)
+                      : !decode_entry(iter->key(), this, key_ii, &r, &a, &v, &k))
+        {
+            return false;
+        }
+
+        stats->add(v);
+        bytes += iter->key().size() + iter->value().size();
+
+        if (stats->entries % STATS_PACE_STRIDE == 0)
+        {
+            if (!dl->pace_background(bytes))
+            {
+                return false;
+            }
+
+            bytes = 0;
+        }
+    }
+
+    if (!iter->status().ok() || !dl->pace_background(bytes))
+    {
+        return false;
+    }
+
+    stats->finish();
+    return true;
+}
+
+bool
+index_primitive :: estimate_range(const index_stats::attribute& stats,
+                                  const range& r,
+                                  uint64_t* entries)
+{
+    if (!stats.sampled || r.invalid)
+    {
+        return false;
     }
+
+    std::vector<char> start_buf;
+    std::vector<char> end_buf;
+    e::slice start;
+    e::slice end;
+
+    if (r.has_start)
+    {
+        convert_to_ordered_encoding(r.start, this, &start_buf, &start);
+    }
+
+    if (r.has_end)
+    {
+        convert_to_ordered_encoding(r.end, this, &end_buf, &end);
+    }
+
+    *entries = stats.estimate(r.has_start ? &start : NULL,
+                              r.has_end ? &end : NULL);
+    return true;
 }
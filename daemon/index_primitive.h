@@ -52,6 +52,20 @@ class index_primitive : public index_info
                                                                const region_id& ri,
                                                                const range& r,
                                                                index_info* key_ii);
+        virtual datalayer::index_iterator* iterator_in_order(leveldb_snapshot_ptr snap,
+                                                             const region_id& ri,
+                                                             const range& r,
+                                                             index_info* key_ii,
+                                                             bool reverse);
+        virtual bool collect_stats(datalayer* dl,
+                                   leveldb_snapshot_ptr snap,
+                                   const region_id& ri,
+                                   uint16_t attr,
+                                   index_info* key_ii,
+                                   index_stats::attribute* stats);
+        virtual bool estimate_range(const index_stats::attribute& stats,
+                                    const range& r,
+                                    uint64_t* entries);
 
     public:
         void index_entry(const region_id& ri,
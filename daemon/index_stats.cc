@@ -0,0 +1,355 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// C
+#include <assert.h>
+#include <string.h>
+
+// STL
+#include <algorithm>
+
+// e
+#include <e/endian.h>
+
+// HyperDex
+#include "daemon/index_stats.h"
+
+using hyperdex::index_stats;
+
+namespace
+{
+
+int
+compare(const e::slice& lhs, const std::string& rhs)
+{
+    size_t sz = std::min(lhs.size(), rhs.size());
+    int cmp = memcmp(lhs.data(), rhs.data(), sz);
+
+    if (cmp != 0)
+    {
+        return cmp;
+    }
+
+    if (lhs.size() < rhs.size())
+    {
+        return -1;
+    }
+
+    if (lhs.size() > rhs.size())
+    {
+        return 1;
+    }
+
+    return 0;
+}
+
+// the index of the first bound >= value, or, if "upper", > value
+size_t
+bound_for(const std::vector<std::string>& bounds, const e::slice& value, bool upper)
+{
+    size_t lo = 0;
+    size_t hi = bounds.size();
+
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        int cmp = compare(value, bounds[mid]);
+
+        if (cmp > 0 || (upper && cmp == 0))
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    return lo;
+}
+
+bool
+have(const char* ptr, const char* end, size_t sz)
+{
+    return static_cast<size_t>(end - ptr) >= sz;
+}
+
+} // namespace
+
+index_stats :: index_stats()
+    : objects(0)
+    , approximate_size(0)
+    , taken(0)
+    , attrs()
+{
+}
+
+index_stats :: ~index_stats() throw ()
+{
+}
+
+std::string
+index_stats :: serialize() const
+{
+    size_t sz = 3 * sizeof(uint64_t) + sizeof(uint16_t);
+
+    for (size_t i = 0; i < attrs.size(); ++i)
+    {
+        sz += sizeof(uint8_t) + 3 * sizeof(uint64_t) + sizeof(uint32_t);
+
+        for (size_t j = 0; j < attrs[i].bounds.size(); ++j)
+        {
+            sz += sizeof(uint32_t) + attrs[i].bounds[j].size();
+        }
+    }
+
+    std::string out(sz, '\0');
+    char* ptr = &out[0];
+    ptr = e::pack64be(objects, ptr);
+    ptr = e::pack64be(approximate_size, ptr);
+    ptr = e::pack64be(taken, ptr);
+    ptr = e::pack16be(attrs.size(), ptr);
+
+    for (size_t i = 0; i < attrs.size(); ++i)
+    {
+        const attribute& a(attrs[i]);
+        ptr = e::pack8be(a.sampled ? 1 : 0, ptr);
+        ptr = e::pack64be(a.entries, ptr);
+        ptr = e::pack64be(a.distinct, ptr);
+        ptr = e::pack64be(a.stride, ptr);
+        ptr = e::pack32be(a.bounds.size(), ptr);
+
+        for (size_t j = 0; j < a.bounds.size(); ++j)
+        {
+            ptr = e::pack32be(a.bounds[j].size(), ptr);
+            memmove(ptr, a.bounds[j].data(), a.bounds[j].size());
+            ptr += a.bounds[j].size();
+        }
+    }
+
+    assert(ptr == out.data() + out.size());
+    return out;
+}
+
+bool
+index_stats :: parse(const e::slice& s)
+{
+    const char* ptr = reinterpret_cast<const char*>(s.data());
+    const char* end = ptr + s.size();
+    uint16_t attrs_sz;
+
+    if (!have(ptr, end, 3 * sizeof(uint64_t) + sizeof(uint16_t)))
+    {
+        return false;
+    }
+
+    ptr = e::unpack64be(ptr, &objects);
+    ptr = e::unpack64be(ptr, &approximate_size);
+    ptr = e::unpack64be(ptr, &taken);
+    ptr = e::unpack16be(ptr, &attrs_sz);
+    attrs.clear();
+    attrs.resize(attrs_sz);
+
+    for (size_t i = 0; i < attrs.size(); ++i)
+    {
+        attribute& a(attrs[i]);
+        uint8_t sampled;
+        uint32_t bounds_sz;
+
+        if (!have(ptr, end, sizeof(uint8_t) + 3 * sizeof(uint64_t) + sizeof(uint32_t)))
+        {
+            return false;
+        }
+
+        ptr = e::unpack8be(ptr, &sampled);
+        ptr = e::unpack64be(ptr, &a.entries);
+        ptr = e::unpack64be(ptr, &a.distinct);
+        ptr = e::unpack64be(ptr, &a.stride);
+        ptr = e::unpack32be(ptr, &bounds_sz);
+        a.sampled = sampled != 0;
+
+        if (a.stride == 0 || bounds_sz > 2 * attribute::BUCKETS + 1 ||
+            a.distinct > a.entries)
+        {
+            return false;
+        }
+
+        for (uint32_t j = 0; j < bounds_sz; ++j)
+        {
+            uint32_t bound_sz;
+
+            if (!have(ptr, end, sizeof(uint32_t)))
+            {
+                return false;
+            }
+
+            ptr = e::unpack32be(ptr, &bound_sz);
+
+            if (!have(ptr, end, bound_sz))
+            {
+                return false;
+            }
+
+            a.bounds.push_back(std::string(ptr, bound_sz));
+            ptr += bound_sz;
+        }
+    }
+
+    return ptr == end;
+}
+
+index_stats :: attribute :: attribute()
+    : sampled(false)
+    , entries(0)
+    , distinct(0)
+    , stride(1)
+    , bounds()
+    , m_last()
+{
+}
+
+index_stats :: attribute :: ~attribute() throw ()
+{
+}
+
+void
+index_stats :: attribute :: add(const e::slice& value)
+{
+    sampled = true;
+
+    if (entries == 0 || compare(value, m_last) != 0)
+    {
+        ++distinct;
+    }
+
+    if (entries % stride == 0)
+    {
+        // a variable-length value runs into the key that follows it, so the
+        // index is only nearly in the order of the values; keep the bounds
+        // sorted regardless
+        if (bounds.empty() || compare(value, bounds.back()) >= 0)
+        {
+            bounds.push_back(std::string(reinterpret_cast<const char*>(value.data()), value.size()));
+        }
+        else
+        {
+            bounds.push_back(bounds.back());
+        }
+    }
+
+    ++entries;
+    m_last.assign(reinterpret_cast<const char*>(value.data()), value.size());
+
+    if (bounds.size() >= 2 * BUCKETS)
+    {
+        for (size_t i = 0; 2 * i < bounds.size(); ++i)
+        {
+            bounds[i].swap(bounds[2 * i]);
+        }
+
+        bounds.resize((bounds.size() + 1) / 2);
+        stride *= 2;
+    }
+}
+
+void
+index_stats :: attribute :: finish()
+{
+    sampled = true;
+
+    if (entries > 0 && (entries - 1) % stride != 0)
+    {
+        bounds.push_back(std::max(m_last, bounds.back()));
+    }
+
+    m_last.clear();
+}
+
+uint64_t
+index_stats :: attribute :: estimate(const e::slice* start, const e::slice* end) const
+{
+    if (entries == 0 || bounds.empty())
+    {
+        return 0;
+    }
+
+    // the position of the first entry in the range
+    uint64_t lo = 0;
+
+    if (start)
+    {
+        size_t idx = bound_for(bounds, *start, false);
+
+        if (idx == bounds.size())
+        {
+            return 0;
+        }
+
+        if (idx > 0)
+        {
+            // somewhere after the bound before, at or before this one
+            uint64_t gap = position(idx) - position(idx - 1);
+            lo = position(idx - 1) + (gap + 1) / 2;
+        }
+    }
+
+    // the position just past the last entry in the range
+    uint64_t hi = entries;
+
+    if (end)
+    {
+        size_t idx = bound_for(bounds, *end, true);
+
+        if (idx == 0)
+        {
+            return 0;
+        }
+
+        if (idx < bounds.size())
+        {
+            uint64_t gap = position(idx) - position(idx - 1);
+            hi = position(idx - 1) + 1 + (gap - 1) / 2;
+        }
+    }
+
+    uint64_t ret = hi > lo ? hi - lo : 0;
+
+    // a single value that falls between two bounds holds, on average, as
+    // many entries as any other value
+    if (start && end && *start == *end)
+    {
+        uint64_t per_value = (entries + distinct - 1) / std::max(distinct, uint64_t(1));
+        ret = std::max(ret, per_value);
+    }
+
+    return std::min(ret, entries);
+}
+
+uint64_t
+index_stats :: attribute :: position(size_t bound) const
+{
+    return std::min(bound * stride, entries - 1);
+}
@@ -0,0 +1,115 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+#ifndef hyperdex_daemon_index_stats_h_
+#define hyperdex_daemon_index_stats_h_
+
+// C
+#include <stdint.h>
+
+// STL
+#include <string>
+#include <vector>
+
+// e
+#include <e/slice.h>
+
+// HyperDex
+#include "namespace.h"
+
+BEGIN_HYPERDEX_NAMESPACE
+
+// Statistics about the objects and indices of one region, used to plan
+// searches without asking LevelDB for the size of every candidate range.
+// They are gathered by walking the region in the background, so they are
+// only ever approximately right.
+class index_stats
+{
+    public:
+        class attribute;
+
+    public:
+        index_stats();
+        ~index_stats() throw ();
+
+    public:
+        std::string serialize() const;
+        // returns false if "s" is not the output of "serialize"
+        bool parse(const e::slice& s);
+
+    public:
+        // the number of objects in the region
+        uint64_t objects;
+        // approximate_size() of the region when the statistics were taken
+        uint64_t approximate_size;
+        // e::time() when the statistics were taken
+        uint64_t taken;
+        // one per attribute of the schema; attribute 0 describes the keys
+        std::vector<attribute> attrs;
+};
+
+// An equi-depth histogram of the values in one index.  Values are in the
+// index's ordered encoding and are fed to "add" in the order of the index.
+// The histogram keeps at most 2 * BUCKETS bounds; whenever it fills, every
+// other bound is dropped and the distance between bounds doubles.
+class index_stats::attribute
+{
+    public:
+        static const size_t BUCKETS = 64;
+
+    public:
+        attribute();
+        ~attribute() throw ();
+
+    public:
+        void add(const e::slice& value);
+        // call once after the last "add"
+        void finish();
+        // the approximate number of index entries with a value in
+        // [start, end]; a NULL bound is open
+        uint64_t estimate(const e::slice* start, const e::slice* end) const;
+
+    public:
+        // false if the index was not walked
+        bool sampled;
+        uint64_t entries;
+        uint64_t distinct;
+        // the number of entries between consecutive bounds
+        uint64_t stride;
+        // bounds[i] is the value of entry i * stride; the last bound is the
+        // value of the last entry
+        std::vector<std::string> bounds;
+
+    private:
+        uint64_t position(size_t bound) const;
+
+    private:
+        std::string m_last;
+};
+
+END_HYPERDEX_NAMESPACE
+
+#endif // hyperdex_daemon_index_stats_h_
@@ -54,6 +54,21 @@ main(int argc, const char* argv[])
     const char* coordinator_host = "127.0.0.1";
     long coordinator_port = 1982;
     long threads = 0;
+    long object_cache_size = 0;
+    hyperdex::search_manager::parameters search_params;
+    long search_batch_items = search_params.batch_items;
+    long search_batch_bytes = search_params.batch_bytes;
+    long search_lease = search_params.lease;
+    long search_max_per_client = search_params.max_per_client;
+    long search_max_open = search_params.max_open;
+    hyperdex::storage_pool::parameters storage_params;
+    long read_threads = storage_params.threads[hyperdex::storage_pool::POINT_READ];
+    long write_threads = storage_params.threads[hyperdex::storage_pool::WRITE];
+    long scan_threads = storage_params.threads[hyperdex::storage_pool::SCAN];
+    long transfer_threads = storage_params.threads[hyperdex::storage_pool::TRANSFER];
+    long queue_limit = storage_params.limit[hyperdex::storage_pool::POINT_READ];
+    long transfer_rate = 0;
+    long wipe_rate = 0;
     bool log_immediate = false;
 
     e::argparser ap;
@@ -85,6 +100,45 @@ main(int argc, const char* argv[])
     ap.arg().name('t', "threads")
             .description("the number of threads which will handle network traffic")
             .metavar("N").as_long(&threads);
+    ap.arg().long_name("read-threads")
+            .description("the number of threads serving point reads (default: 0, which runs the work on the network threads)")
+            .metavar("N").as_long(&read_threads);
+    ap.arg().long_name("write-threads")
+            .description("the number of threads applying writes (default: 0, which runs the work on the network threads)")
+            .metavar("N").as_long(&write_threads);
+    ap.arg().long_name("scan-threads")
+            .description("the number of threads serving searches (default: 0, which runs the work on the network threads)")
+            .metavar("N").as_long(&scan_threads);
+    ap.arg().long_name("transfer-threads")
+            .description("the number of threads handling state transfer and backups (default: 0, which runs the work on the network threads)")
+            .metavar("N").as_long(&transfer_threads);
+    ap.arg().long_name("queue-limit")
+            .description("let at most N requests wait for each kind of storage thread (default: 1024)")
+            .metavar("N").as_long(&queue_limit);
+    ap.arg().long_name("transfer-rate")
+            .description("send state transfers at most N megabytes per second (default: 0, unlimited)")
+            .metavar("N").as_long(&transfer_rate);
+    ap.arg().long_name("wipe-rate")
+            .description("wipe regions at most N megabytes per second (default: 0, unlimited)")
+            .metavar("N").as_long(&wipe_rate);
+    ap.arg().long_name("object-cache")
+            .description("cache up to N megabytes of recently read objects (default: 0, disabled)")
+            .metavar("N").as_long(&object_cache_size);
+    ap.arg().long_name("search-batch-items")
+            .description("send at most N objects per search response (default: 256)")
+            .metavar("N").as_long(&search_batch_items);
+    ap.arg().long_name("search-batch-bytes")
+            .description("send at most N bytes per search response (default: 1MB)")
+            .metavar("N").as_long(&search_batch_bytes);
+    ap.arg().long_name("search-lease")
+            .description("drop searches idle for more than S seconds (default: 300)")
+            .metavar("S").as_long(&search_lease);
+    ap.arg().long_name("search-max-per-client")
+            .description("keep at most N searches open for each client (default: 64)")
+            .metavar("N").as_long(&search_max_per_client);
+    ap.arg().long_name("search-max-open")
+            .description("keep at most N searches open on this server (default: 1024)")
+            .metavar("N").as_long(&search_max_open);
     ap.arg().long_name("log-immediate")
             .description("immediately flush all log output")
             .set_true(&log_immediate).hidden();
@@ -113,6 +167,65 @@ main(int argc, const char* argv[])
         return EXIT_FAILURE;
     }
 
+    if (object_cache_size < 0)
+    {
+        std::cerr << "object-cache size cannot be negative" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (transfer_rate < 0 || wipe_rate < 0)
+    {
+        std::cerr << "transfer and wipe rates cannot be negative" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (search_batch_items <= 0 || search_batch_bytes <= 0)
+    {
+        std::cerr << "search batches must hold at least one object and one byte" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (search_lease <= 0 || search_max_per_client <= 0 || search_max_open <= 0)
+    {
+        std::cerr << "search leases and limits must be positive" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (read_threads < 0 || write_threads < 0 ||
+        scan_threads < 0 || transfer_threads < 0)
+    {
+        std::cerr << "cannot create a negative number of storage threads" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (queue_limit <= 0)
+    {
+        std::cerr << "queue-limit must be positive" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (read_threads > 512 || write_threads > 512 ||
+        scan_threads > 512 || transfer_threads > 512)
+    {
+        std::cerr << "refusing to create more than 512 storage threads of any kind" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    search_params.batch_items = search_batch_items;
+    search_params.batch_bytes = search_batch_bytes;
+    search_params.lease = search_lease;
+    search_params.max_per_client = search_max_per_client;
+    search_params.max_open = search_max_open;
+    storage_params.threads[hyperdex::storage_pool::POINT_READ] = read_threads;
+    storage_params.threads[hyperdex::storage_pool::WRITE] = write_threads;
+    storage_params.threads[hyperdex::storage_pool::SCAN] = scan_threads;
+    storage_params.threads[hyperdex::storage_pool::TRANSFER] = transfer_threads;
+
+    for (size_t i = 0; i < hyperdex::storage_pool::NUM_CLASSES; ++i)
+    {
+        storage_params.limit[i] = queue_limit;
+    }
+
     po6::net::ipaddr listen_ip;
     po6::net::location bind_to;
 
@@ -194,7 +307,10 @@ main(int argc, const char* argv[])
                      po6::pathname(log ? log : data),
                      listen, bind_to,
                      coordinator, po6::net::hostname(coordinator_host, coordinator_port),
-                     threads);
+                     threads, object_cache_size * 1024ULL * 1024ULL,
+                     search_params, storage_params,
+                     transfer_rate * 1024ULL * 1024ULL,
+                     wipe_rate * 1024ULL * 1024ULL);
     }
     catch (std::exception& e)
     {
@@ -0,0 +1,318 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// C
+#include <cassert>
+#include <cstring>
+
+// HyperDex
+#include "cityhash/city.h"
+#include "daemon/object_cache.h"
+
+#define NUM_SHARDS 16
+// each shard tracks invalidations in this many buckets of keys, so that a
+// write only discards the fills that race with it on nearby keys
+#define GENERATION_BUCKETS 1024
+
+using hyperdex::object_cache;
+
+namespace
+{
+
+struct string_hash
+{
+    size_t operator () (const std::string& s) const
+    {
+        return CityHash64(s.data(), s.size());
+    }
+};
+
+} // namespace
+
+////////////////////////////////// Cache Shard /////////////////////////////////
+
+class object_cache::shard
+{
+    public:
+        typedef std::list<e::intrusive_ptr<entry> > lru_t;
+        typedef google::dense_hash_map<std::string, lru_t::iterator, string_hash> map_t;
+
+    public:
+        shard();
+        ~shard() throw ();
+
+    public:
+        // REQUIRES:  mtx held
+        void erase(map_t::iterator it);
+
+    public:
+        po6::threads::mutex mtx;
+        // most recently used at the front
+        lru_t lru;
+        map_t map;
+        uint64_t bytes;
+        uint64_t capacity;
+        // bumped by every invalidation of a key in the bucket
+        uint64_t generations[GENERATION_BUCKETS];
+
+    private:
+        shard(const shard&);
+        shard& operator = (const shard&);
+};
+
+object_cache :: shard :: shard()
+    : mtx()
+    , lru()
+    , map()
+    , bytes(0)
+    , capacity(0)
+{
+    memset(generations, 0, sizeof(generations));
+    map.set_empty_key(std::string());
+    map.set_deleted_key(std::string(1, '\0'));
+}
+
+object_cache :: shard :: ~shard() throw ()
+{
+}
+
+void
+object_cache :: shard :: erase(map_t::iterator it)
+{
+    lru_t::iterator lit = it->second;
+    bytes -= (*lit)->footprint();
+    lru.erase(lit);
+    map.erase(it);
+}
+
+////////////////////////////////// Cache Entry /////////////////////////////////
+
+object_cache :: entry :: entry(const e::slice& k)
+    : key(reinterpret_cast<const char*>(k.data()), k.size())
+    , backing()
+    , value()
+    , version(0)
+    , m_ref(0)
+{
+}
+
+object_cache :: entry :: ~entry() throw ()
+{
+}
+
+size_t
+object_cache :: entry :: footprint() const
+{
+    return sizeof(entry)
+         + key.size()
+         + backing.size()
+         + value.size() * sizeof(e::slice);
+}
+
+///////////////////////////////// Object Cache /////////////////////////////////
+
+object_cache :: object_cache()
+    : m_capacity(0)
+    , m_shards(new shard[NUM_SHARDS])
+    , m_hits()
+    , m_misses()
+{
+}
+
+object_cache :: ~object_cache() throw ()
+{
+    delete[] m_shards;
+}
+
+void
+object_cache :: set_capacity(uint64_t bytes)
+{
+    m_capacity = bytes;
+
+    for (size_t i = 0; i < NUM_SHARDS; ++i)
+    {
+        po6::threads::mutex::hold hold(&m_shards[i].mtx);
+        m_shards[i].capacity = bytes / NUM_SHARDS;
+    }
+}
+
+bool
+object_cache :: lookup(const e::slice& key, e::intrusive_ptr<entry>* ent)
+{
+    if (!enabled())
+    {
+        return false;
+    }
+
+    size_t bucket;
+    shard* s = get_shard(key, &bucket);
+    std::string k(reinterpret_cast<const char*>(key.data()), key.size());
+    po6::threads::mutex::hold hold(&s->mtx);
+    shard::map_t::iterator it = s->map.find(k);
+
+    if (it == s->map.end())
+    {
+        m_misses.tap();
+        return false;
+    }
+
+    s->lru.splice(s->lru.begin(), s->lru, it->second);
+    *ent = *it->second;
+    m_hits.tap();
+    return true;
+}
+
+uint64_t
+object_cache :: generation(const e::slice& key)
+{
+    if (!enabled())
+    {
+        return 0;
+    }
+
+    size_t bucket;
+    shard* s = get_shard(key, &bucket);
+    po6::threads::mutex::hold hold(&s->mtx);
+    return s->generations[bucket];
+}
+
+void
+object_cache :: insert(uint64_t generation, e::intrusive_ptr<entry> ent)
+{
+    if (!enabled())
+    {
+        return;
+    }
+
+    size_t bucket;
+    shard* s = get_shard(e::slice(ent->key.data(), ent->key.size()), &bucket);
+    size_t footprint = ent->footprint();
+    po6::threads::mutex::hold hold(&s->mtx);
+
+    // a write raced with the read that produced ent, so ent may be stale
+    if (generation != s->generations[bucket] || footprint > s->capacity)
+    {
+        return;
+    }
+
+    shard::map_t::iterator it = s->map.find(ent->key);
+
+    if (it != s->map.end())
+    {
+        s->erase(it);
+    }
+
+    s->lru.push_front(ent);
+    s->map.insert(std::make_pair(ent->key, s->lru.begin()));
+    s->bytes += footprint;
+
+    while (s->bytes > s->capacity)
+    {
+        it = s->map.find(s->lru.back()->key);
+        assert(it != s->map.end());
+        s->erase(it);
+    }
+}
+
+void
+object_cache :: invalidate(const e::slice& key)
+{
+    if (!enabled())
+    {
+        return;
+    }
+
+    size_t bucket;
+    shard* s = get_shard(key, &bucket);
+    std::string k(reinterpret_cast<const char*>(key.data()), key.size());
+    po6::threads::mutex::hold hold(&s->mtx);
+    ++s->generations[bucket];
+    shard::map_t::iterator it = s->map.find(k);
+
+    if (it != s->map.end())
+    {
+        s->erase(it);
+    }
+}
+
+void
+object_cache :: invalidate_prefix(const e::slice& prefix)
+{
+    if (!enabled())
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < NUM_SHARDS; ++i)
+    {
+        shard* s = &m_shards[i];
+        po6::threads::mutex::hold hold(&s->mtx);
+
+        for (size_t b = 0; b < GENERATION_BUCKETS; ++b)
+        {
+            ++s->generations[b];
+        }
+
+        shard::lru_t::iterator lit = s->lru.begin();
+
+        while (lit != s->lru.end())
+        {
+            const std::string& k((*lit)->key);
+            ++lit;
+
+            if (k.size() >= prefix.size() &&
+                memcmp(k.data(), prefix.data(), prefix.size()) == 0)
+            {
+                shard::map_t::iterator it = s->map.find(k);
+                assert(it != s->map.end());
+                s->erase(it);
+            }
+        }
+    }
+}
+
+uint64_t
+object_cache :: size()
+{
+    uint64_t ret = 0;
+
+    for (size_t i = 0; i < NUM_SHARDS; ++i)
+    {
+        po6::threads::mutex::hold hold(&m_shards[i].mtx);
+        ret += m_shards[i].bytes;
+    }
+
+    return ret;
+}
+
+object_cache::shard*
+object_cache :: get_shard(const e::slice& key, size_t* bucket)
+{
+    uint64_t h = CityHash64(reinterpret_cast<const char*>(key.data()), key.size());
+    *bucket = (h / NUM_SHARDS) % GENERATION_BUCKETS;
+    return &m_shards[h % NUM_SHARDS];
+}
@@ -0,0 +1,139 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef hyperdex_daemon_object_cache_h_
+#define hyperdex_daemon_object_cache_h_
+
+// STL
+#include <list>
+#include <string>
+#include <vector>
+
+// Google
+#include <google/dense_hash_map>
+
+// po6
+#include <po6/threads/mutex.h>
+
+// e
+#include <e/intrusive_ptr.h>
+#include <e/slice.h>
+
+// HyperDex
+#include "namespace.h"
+#include "daemon/performance_counter.h"
+
+BEGIN_HYPERDEX_NAMESPACE
+
+// A sharded LRU cache of decoded objects, keyed by the encoded LevelDB key
+// (which already carries the region).  Entries are immutable once inserted,
+// and readers hold them by reference so that eviction never pulls memory
+// out from underneath a slice.
+//
+// Writers must call "invalidate" after their write hits LevelDB.  A reader
+// that misses calls "generation" before reading LevelDB and hands the result
+// to "insert"; the insert is dropped if an invalidation of a key that shares
+// its generation bucket raced with the read.
+class object_cache
+{
+    public:
+        class entry;
+
+    public:
+        object_cache();
+        ~object_cache() throw ();
+
+    public:
+        // 0 disables the cache; must be called before concurrent use
+        void set_capacity(uint64_t bytes);
+        bool enabled() const { return m_capacity > 0; }
+        bool lookup(const e::slice& key, e::intrusive_ptr<entry>* ent);
+        uint64_t generation(const e::slice& key);
+        void insert(uint64_t generation, e::intrusive_ptr<entry> ent);
+        void invalidate(const e::slice& key);
+        // drop every entry whose key starts with "prefix"
+        void invalidate_prefix(const e::slice& prefix);
+
+    // stats
+    public:
+        uint64_t hits() { return m_hits.read(); }
+        uint64_t misses() { return m_misses.read(); }
+        uint64_t size();
+
+    private:
+        class shard;
+
+    private:
+        // also returns the key's generation bucket within the shard
+        shard* get_shard(const e::slice& key, size_t* bucket);
+
+    private:
+        uint64_t m_capacity;
+        shard* m_shards;
+        performance_counter m_hits;
+        performance_counter m_misses;
+
+    private:
+        object_cache(const object_cache&);
+        object_cache& operator = (const object_cache&);
+};
+
+class object_cache::entry
+{
+    public:
+        entry(const e::slice& key);
+        ~entry() throw ();
+
+    public:
+        // the encoded key and value; callers swap the value into backing
+        // and then point "value" into it
+        const std::string key;
+        std::string backing;
+        std::vector<e::slice> value;
+        uint64_t version;
+
+    public:
+        size_t footprint() const;
+
+    private:
+        friend class e::intrusive_ptr<entry>;
+
+    private:
+        void inc() { __sync_add_and_fetch(&m_ref, 1); }
+        void dec() { if (__sync_sub_and_fetch(&m_ref, 1) == 0) delete this; }
+
+    private:
+        size_t m_ref;
+
+    private:
+        entry(const entry&);
+        entry& operator = (const entry&);
+};
+
+END_HYPERDEX_NAMESPACE
+
+#endif // hyperdex_daemon_object_cache_h_
@@ -0,0 +1,155 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// HyperDex
+#include "cityhash/city.h"
+#include "daemon/region_tree.h"
+
+using hyperdex::region_tree;
+
+const size_t region_tree::LEAVES;
+const size_t region_tree::FANOUT;
+
+size_t
+region_tree :: leaf_for(const e::slice& key)
+{
+    return CityHash64(key.cdata(), key.size()) % LEAVES;
+}
+
+region_tree :: region_tree()
+    : m_leaves(LEAVES, 0)
+    , m_levels()
+    , m_built(false)
+{
+}
+
+region_tree :: ~region_tree() throw ()
+{
+}
+
+void
+region_tree :: clear()
+{
+    m_leaves.assign(LEAVES, 0);
+    m_built = false;
+}
+
+void
+region_tree :: add(const e::slice& key, uint64_t version)
+{
+    m_leaves[leaf_for(key)] ^= CityHash64WithSeed(key.cdata(), key.size(), version);
+    m_built = false;
+}
+
+bool
+region_tree :: set_leaves(const std::vector<uint64_t>& leaves)
+{
+    if (leaves.size() != LEAVES)
+    {
+        return false;
+    }
+
+    m_leaves = leaves;
+    m_built = false;
+    return true;
+}
+
+uint64_t
+region_tree :: root()
+{
+    build();
+    return m_levels.back()[0];
+}
+
+void
+region_tree :: diff(region_tree* other, std::vector<bool>* leaves)
+{
+    build();
+    other->build();
+    leaves->assign(LEAVES, false);
+
+    // nodes that differ at the level being examined, starting at the root
+    std::vector<size_t> differ;
+
+    if (m_levels.back()[0] != other->m_levels.back()[0])
+    {
+        differ.push_back(0);
+    }
+
+    for (size_t level = m_levels.size(); !differ.empty() && level > 0; --level)
+    {
+        const std::vector<uint64_t>& ours(level > 1 ? m_levels[level - 2] : m_leaves);
+        const std::vector<uint64_t>& theirs(level > 1 ? other->m_levels[level - 2] : other->m_leaves);
+        std::vector<size_t> below;
+
+        for (size_t i = 0; i < differ.size(); ++i)
+        {
+            for (size_t c = differ[i] * FANOUT; c < (differ[i] + 1) * FANOUT; ++c)
+            {
+                if (ours[c] != theirs[c])
+                {
+                    below.push_back(c);
+                }
+            }
+        }
+
+        differ.swap(below);
+    }
+
+    for (size_t i = 0; i < differ.size(); ++i)
+    {
+        (*leaves)[differ[i]] = true;
+    }
+}
+
+void
+region_tree :: build()
+{
+    if (m_built)
+    {
+        return;
+    }
+
+    m_levels.clear();
+    const std::vector<uint64_t>* below = &m_leaves;
+
+    while (below->size() > 1)
+    {
+        std::vector<uint64_t> level(below->size() / FANOUT);
+
+        for (size_t i = 0; i < level.size(); ++i)
+        {
+            level[i] = CityHash64(reinterpret_cast<const char*>(&(*below)[i * FANOUT]),
+                                  FANOUT * sizeof(uint64_t));
+        }
+
+        m_levels.push_back(level);
+        below = &m_levels.back();
+    }
+
+    m_built = true;
+}
@@ -0,0 +1,86 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef hyperdex_daemon_region_tree_h_
+#define hyperdex_daemon_region_tree_h_
+
+// STL
+#include <vector>
+
+// e
+#include <e/slice.h>
+
+// HyperDex
+#include "namespace.h"
+
+BEGIN_HYPERDEX_NAMESPACE
+
+// A hash tree over the (key, version) pairs of one region's objects, used to
+// find which parts of a region differ between two servers.  Each object
+// falls into one of LEAVES buckets by the hash of its encoded key, a leaf is
+// the XOR of the hashes of its objects, and every interior node hashes its
+// FANOUT children.  Two servers holding the same objects at the same
+// versions build identical trees regardless of the order of "add".
+class region_tree
+{
+    public:
+        static const size_t LEAVES = 4096;
+        static const size_t FANOUT = 16;
+        static size_t leaf_for(const e::slice& key);
+
+    public:
+        region_tree();
+        ~region_tree() throw ();
+
+    public:
+        void clear();
+        void add(const e::slice& key, uint64_t version);
+        const std::vector<uint64_t>& leaves() const { return m_leaves; }
+        // returns false if "leaves" is not the leaf level of a tree
+        bool set_leaves(const std::vector<uint64_t>& leaves);
+        uint64_t root();
+        // the leaves where this tree and "other" differ, found by descending
+        // only into the interior nodes that differ
+        void diff(region_tree* other, std::vector<bool>* leaves);
+
+    private:
+        void build();
+
+    private:
+        std::vector<uint64_t> m_leaves;
+        // interior levels, from the level above the leaves up to the root
+        std::vector<std::vector<uint64_t> > m_levels;
+        bool m_built;
+
+    private:
+        region_tree(const region_tree&);
+        region_tree& operator = (const region_tree&);
+};
+
+END_HYPERDEX_NAMESPACE
+
+#endif // hyperdex_daemon_region_tree_h_
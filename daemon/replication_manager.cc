@@ -46,6 +46,8 @@
 #include "cityhash/city.h"
 #include "daemon/daemon.h"
 #include "daemon/replication_manager.h"
+#include "daemon/replication_manager_batch.h"
+#include "daemon/replication_manager_client_batch.h"
 #include "daemon/replication_manager_key_region.h"
 #include "daemon/replication_manager_key_state.h"
 #include "daemon/replication_manager_pending.h"
@@ -63,6 +65,7 @@ replication_manager :: replication_manager(daemon* d)
     , m_unstable_regions()
     , m_checkpoint(0)
     , m_need_check(1)
+    , m_blind_clock()
     , m_timestamps()
     , m_background_thread(make_thread_wrapper(&replication_manager::background_thread, this))
     , m_block_background_thread()
@@ -74,6 +77,9 @@ replication_manager :: replication_manager(daemon* d)
     , m_need_post_reconfigure(false)
     , m_need_periodic(false)
     , m_lower_bounds()
+    , m_protect_reads()
+    , m_next_read(1)
+    , m_reads()
 {
     m_key_states.set_empty_key(key_region(region_id(UINT64_MAX), e::slice("", 0)));
     m_key_states.set_deleted_key(key_region(region_id(UINT64_MAX - 1), e::slice("", 0)));
@@ -183,6 +189,37 @@ replication_manager :: reconfigure(const configuration&,
     m_unstable_regions.clear();
     new_config.point_leaders(m_daemon->m_us, &m_unstable_regions);
     check_is_needed();
+
+    // reads relayed through a tail that is no longer the tail may never be
+    // answered; let the client retry them against the new configuration
+    std::vector<relayed_read> orphaned;
+
+    {
+        po6::threads::mutex::hold hold(&m_protect_reads);
+        std::map<uint64_t, relayed_read>::iterator it = m_reads.begin();
+
+        while (it != m_reads.end())
+        {
+            const relayed_read& rr(it->second);
+
+            if (new_config.tail_of_region(new_config.get_region_id(rr.us)) != rr.tail)
+            {
+                orphaned.push_back(rr);
+                m_reads.erase(it++);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < orphaned.size(); ++i)
+    {
+        const relayed_read& rr(orphaned[i]);
+        m_daemon->send_get_response(rr.client, rr.us, rr.nonce, rr.mt, rr.attrnums,
+                                    NET_NOTUS, std::vector<e::slice>());
+    }
 }
 
 void
@@ -238,12 +275,98 @@ replication_manager :: client_atomic(const server_id& from,
                                      const std::vector<attribute_check>& checks,
                                      const std::vector<funcall>& funcs)
 {
-    if (m_daemon->m_config.read_only())
+    network_returncode nrc;
+
+    if (!issue_atomic(from, to, nonce, erase, fail_if_not_found, fail_if_found,
+                      key, checks, funcs, NULL, 0, NULL, &nrc))
     {
-        respond_to_client(to, from, nonce, NET_READONLY);
+        respond_to_client(to, from, nonce, nrc);
+    }
+}
+
+namespace
+{
+
+using hyperdex::replication_manager;
+
+class atomic_op_key_less
+{
+    public:
+        atomic_op_key_less(const std::vector<replication_manager::atomic_op>* ops) : m_ops(ops) {}
+        bool operator () (size_t lhs, size_t rhs) const
+        { return (*m_ops)[lhs].key < (*m_ops)[rhs].key; }
+
+    private:
+        const std::vector<replication_manager::atomic_op>* m_ops;
+};
+
+} // namespace
+
+void
+replication_manager :: client_atomic_many(const server_id& from,
+                                          const virtual_server_id& to,
+                                          uint64_t nonce,
+                                          uint64_t batch_id,
+                                          std::vector<atomic_op>* ops)
+{
+    e::intrusive_ptr<client_batch> cb;
+    cb = new client_batch(to, from, nonce, batch_id, ops->size());
+
+    if (ops->empty())
+    {
+        complete_client_batch(cb, 0, NET_SUCCESS);
         return;
     }
 
+    // Lock key states in key order, the same order any other batch locks them
+    // in.  The sort is stable so ops on the same key keep their order.
+    std::vector<size_t> order(ops->size());
+
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        order[i] = i;
+    }
+
+    std::stable_sort(order.begin(), order.end(), atomic_op_key_less(ops));
+    batch b;
+
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        const atomic_op& op((*ops)[order[i]]);
+        network_returncode nrc;
+
+        if (!issue_atomic(from, to, nonce, op.erase, op.fail_if_not_found,
+                          op.fail_if_found, op.key, op.checks, op.funcs,
+                          cb, order[i], &b, &nrc))
+        {
+            complete_client_batch(cb, order[i], nrc);
+        }
+    }
+
+    commit(&b);
+}
+
+bool
+replication_manager :: issue_atomic(const server_id& from,
+                                    const virtual_server_id& to,
+                                    uint64_t nonce,
+                                    bool erase,
+                                    bool fail_if_not_found,
+                                    bool fail_if_found,
+                                    const e::slice& key,
+                                    const std::vector<attribute_check>& checks,
+                                    const std::vector<funcall>& funcs,
+                                    e::intrusive_ptr<client_batch> cb,
+                                    size_t cb_idx,
+                                    batch* b,
+                                    network_returncode* nrc)
+{
+    if (m_daemon->m_config.read_only())
+    {
+        *nrc = NET_READONLY;
+        return false;
+    }
+
     const region_id ri(m_daemon->m_config.get_region_id(to));
     const schema& sc(*m_daemon->m_config.get_schema(ri));
 
@@ -254,46 +377,56 @@ replication_manager :: client_atomic(const server_id& from,
     {
         LOG(ERROR) << "dropping nonce=" << nonce << " from client=" << from
                    << " because the key, checks, or funcs don't validate";
-        respond_to_client(to, from, nonce, NET_BADDIMSPEC);
-        return;
+        *nrc = NET_BADDIMSPEC;
+        return false;
     }
 
     if (m_daemon->m_config.point_leader(ri, key) != to)
     {
         LOG(ERROR) << "dropping nonce=" << nonce << " from client=" << from
                    << " because it doesn't map to " << ri;
-        respond_to_client(to, from, nonce, NET_NOTUS);
-        return;
+        *nrc = NET_NOTUS;
+        return false;
+    }
+
+    // Unconditional overwrites take their version from the clock when the
+    // key is not already in flight, saving a disk read per write
+    uint64_t blind_version = 0;
+
+    if (is_blind_write(ri, sc, erase, fail_if_not_found, fail_if_found, checks, funcs))
+    {
+        blind_version = next_blind_version() - 1;
     }
 
     key_map_t::state_reference ksr;
-    key_state* ks = get_or_create_key_state(ri, key, &ksr);
-    network_returncode nrc;
+    key_state* ks = get_or_create_key_state(ri, key, blind_version, &ksr, b);
 
-    if (!ks->check_against_latest_version(sc, erase, fail_if_not_found, fail_if_found, checks, &nrc))
+    if (!ks->check_against_latest_version(sc, erase, fail_if_not_found, fail_if_found, checks, nrc))
     {
-        respond_to_client(to, from, nonce, nrc);
-        return;
+        return false;
     }
 
     uint64_t seq_id;
     bool found = m_idgen.generate_id(ri, &seq_id);
     assert(found);
+    // batched ops answer through "cb" rather than to the client directly
+    server_id client = cb ? server_id() : from;
 
     if (erase)
     {
-        ks->delete_latest(sc, ri, seq_id, from, nonce);
+        ks->delete_latest(sc, ri, seq_id, client, nonce, cb, cb_idx);
     }
     else
     {
-        if (!ks->put_from_funcs(sc, ri, seq_id, funcs, from, nonce))
+        if (!ks->put_from_funcs(sc, ri, seq_id, funcs, blind_version > 0, client, nonce, cb, cb_idx))
         {
-            respond_to_client(to, from, nonce, NET_OVERFLOW);
-            return;
+            *nrc = NET_OVERFLOW;
+            return false;
         }
     }
 
-    ks->move_operations_between_queues(this, to, ri, sc);
+    ks->move_operations_between_queues(this, to, ri, sc, b);
+    return true;
 }
 
 void
@@ -304,17 +437,19 @@ replication_manager :: chain_op(const virtual_server_id& from,
                                 uint64_t seq_id,
                                 uint64_t version,
                                 bool fresh,
+                                bool blind,
                                 bool has_value,
                                 std::auto_ptr<e::buffer> backing,
                                 const e::slice& key,
-                                const std::vector<e::slice>& value)
+                                const std::vector<e::slice>& value,
+                                batch* b)
 {
     const region_id ri(m_daemon->m_config.get_region_id(to));
     const schema& sc(*m_daemon->m_config.get_schema(ri));
 
     if (retransmission && m_daemon->m_data.check_acked(ri, reg_id, seq_id))
     {
-        send_ack(to, from, true, reg_id, seq_id, version, key);
+        send_ack(to, from, true, reg_id, seq_id, version, key, b);
         return;
     }
 
@@ -337,8 +472,11 @@ replication_manager :: chain_op(const virtual_server_id& from,
         return;
     }
 
+    // should we become the head, our blind writes must follow this version
+    // even if our clock runs behind the head that issued it
+    observe_version(version);
     key_map_t::state_reference ksr;
-    key_state* ks = get_or_create_key_state(ri, key, &ksr);
+    key_state* ks = get_or_create_key_state(ri, key, blind ? version - 1 : 0, &ksr, b);
     e::intrusive_ptr<pending> op = ks->get_version(version);
 
     if (op)
@@ -348,7 +486,7 @@ replication_manager :: chain_op(const virtual_server_id& from,
 
         if (op->acked)
         {
-            send_ack(to, from, false, reg_id, seq_id, version, key);
+            send_ack(to, from, false, reg_id, seq_id, version, key, b);
         }
 
         return;
@@ -359,8 +497,9 @@ replication_manager :: chain_op(const virtual_server_id& from,
                      has_value, value,
                      server_id(), 0,
                      m_daemon->m_config.version(), from);
+    op->blind = blind;
     ks->insert_deferred(version, op);
-    ks->move_operations_between_queues(this, to, ri, sc);
+    ks->move_operations_between_queues(this, to, ri, sc, b);
 }
 
 void
@@ -373,14 +512,15 @@ replication_manager :: chain_subspace(const virtual_server_id& from,
                                       std::auto_ptr<e::buffer> backing,
                                       const e::slice& key,
                                       const std::vector<e::slice>& value,
-                                      const std::vector<uint64_t>& hashes)
+                                      const std::vector<uint64_t>& hashes,
+                                      batch* b)
 {
     const region_id ri(m_daemon->m_config.get_region_id(to));
     const schema& sc(*m_daemon->m_config.get_schema(ri));
 
     if (retransmission && m_daemon->m_data.check_acked(ri, reg_id, seq_id))
     {
-        send_ack(to, from, true, reg_id, seq_id, version, key);
+        send_ack(to, from, true, reg_id, seq_id, version, key, b);
         return;
     }
 
@@ -399,8 +539,9 @@ replication_manager :: chain_subspace(const virtual_server_id& from,
         return;
     }
 
+    observe_version(version);
     key_map_t::state_reference ksr;
-    key_state* ks = get_or_create_key_state(ri, key, &ksr);
+    key_state* ks = get_or_create_key_state(ri, key, 0, &ksr, b);
 
     // Create a new pending object to set as pending.
     e::intrusive_ptr<pending> op = ks->get_version(version);
@@ -412,7 +553,7 @@ replication_manager :: chain_subspace(const virtual_server_id& from,
 
         if (op->acked)
         {
-            send_ack(to, from, false, reg_id, seq_id, version, key);
+            send_ack(to, from, false, reg_id, seq_id, version, key, b);
         }
 
         return;
@@ -458,7 +599,7 @@ replication_manager :: chain_subspace(const virtual_server_id& from,
     }
 
     ks->insert_deferred(version, op);
-    ks->move_operations_between_queues(this, to, ri, sc);
+    ks->move_operations_between_queues(this, to, ri, sc, b);
 }
 
 void
@@ -468,7 +609,8 @@ replication_manager :: chain_ack(const virtual_server_id& from,
                                  const region_id& reg_id,
                                  uint64_t seq_id,
                                  uint64_t version,
-                                 const e::slice& key)
+                                 const e::slice& key,
+                                 batch* b)
 {
     const region_id ri(m_daemon->m_config.get_region_id(to));
     const schema& sc(*m_daemon->m_config.get_schema(ri));
@@ -479,7 +621,7 @@ replication_manager :: chain_ack(const virtual_server_id& from,
     }
 
     key_map_t::state_reference ksr;
-    key_state* ks = get_key_state(ri, key, &ksr);
+    key_state* ks = get_key_state(ri, key, &ksr, b);
 
     if (!ks)
     {
@@ -517,37 +659,159 @@ replication_manager :: chain_ack(const virtual_server_id& from,
 
     if (!is_head && m_daemon->m_config.version() == op->recv_config_version)
     {
-        send_ack(to, op->recv, false, reg_id, seq_id, version, key);
+        send_ack(to, op->recv, false, reg_id, seq_id, version, key, b);
     }
 
-    if (!ks->persist_to_datalayer(this, ri, reg_id, seq_id, version))
+    if (!ks->persist_to_datalayer(this, ri, reg_id, seq_id, version, b))
     {
         LOG(ERROR) << "commit encountered unrecoverable error";
         return;
     }
 
     ks->clear_acked_prefix();
-    ks->move_operations_between_queues(this, to, ri, sc);
+    ks->move_operations_between_queues(this, to, ri, sc, b);
+    complete_client_op(to, op, NET_SUCCESS, b);
 
-    if (op->client != server_id())
+    for (size_t i = 0; i < op->subsumed.size(); ++i)
     {
-        respond_to_client(to, op->client, op->nonce, NET_SUCCESS);
+        complete_client_op(to, op->subsumed[i], NET_SUCCESS, b);
     }
 
     if (is_head && m_daemon->m_config.version() == op->recv_config_version)
     {
-        send_ack(to, op->recv, false, reg_id, seq_id, version, key);
+        send_ack(to, op->recv, false, reg_id, seq_id, version, key, b);
     }
 
     if (op->reg_id == ri)
     {
-        bool x;
-        x = m_idcol.collect(ri, op->seq_id);
-        assert(x);
-        check_stable(ri);
+        collect(ri, op->seq_id, b);
+    }
+
+    for (size_t i = 0; i < op->subsumed.size(); ++i)
+    {
+        if (op->subsumed[i]->reg_id == ri)
+        {
+            collect(ri, op->subsumed[i]->seq_id, b);
+        }
     }
 }
 
+namespace
+{
+
+using hyperdex::replication_manager;
+using hyperdex::virtual_server_id;
+
+class outgoing_dest_less
+{
+    public:
+        outgoing_dest_less(const std::vector<replication_manager::batch::outgoing>* msgs) : m_msgs(msgs) {}
+        bool operator () (size_t lhs, size_t rhs) const
+        {
+            const replication_manager::batch::outgoing& l((*m_msgs)[lhs]);
+            const replication_manager::batch::outgoing& r((*m_msgs)[rhs]);
+            return l.from < r.from || (l.from == r.from && l.to < r.to);
+        }
+
+    private:
+        const std::vector<replication_manager::batch::outgoing>* m_msgs;
+};
+
+} // namespace
+
+void
+replication_manager :: commit(batch* b)
+{
+    bool written = b->writes.empty() ||
+                   m_daemon->m_data.write(&b->writes) == datalayer::SUCCESS;
+
+    // The in-memory key states are ahead of the disk, exactly as when
+    // persist_to_datalayer fails for a single op.  Nothing upstream may
+    // believe these writes are durable, so hold back the acks and answer the
+    // clients with an error; the ops forwarded down the chain still go.
+    if (!written)
+    {
+        LOG(ERROR) << "commit encountered unrecoverable error; failing "
+                   << b->completions.size() << " client operations and dropping their acks";
+    }
+
+    // Send the messages, grouped by destination but otherwise in the order
+    // they were generated.
+    std::vector<size_t> order;
+
+    for (size_t i = 0; i < b->messages.size(); ++i)
+    {
+        if (written || b->messages[i].type != CHAIN_ACK)
+        {
+            order.push_back(i);
+        }
+    }
+
+    std::stable_sort(order.begin(), order.end(), outgoing_dest_less(&b->messages));
+    size_t start = 0;
+
+    while (start < order.size())
+    {
+        const batch::outgoing& first(b->messages[order[start]]);
+        size_t limit = start + 1;
+        size_t sz = HYPERDEX_HEADER_SIZE_VV + sizeof(uint32_t);
+
+        while (limit < order.size() &&
+               b->messages[order[limit]].from == first.from &&
+               b->messages[order[limit]].to == first.to)
+        {
+            ++limit;
+        }
+
+        if (limit - start == 1)
+        {
+            std::auto_ptr<e::buffer> msg(first.msg->copy());
+            m_daemon->m_comm.send_exact(first.from, first.to, first.type, msg);
+            start = limit;
+            continue;
+        }
+
+        for (size_t i = start; i < limit; ++i)
+        {
+            const batch::outgoing& o(b->messages[order[i]]);
+            sz += sizeof(uint8_t) + sizeof(uint32_t)
+                + o.msg->size() - HYPERDEX_HEADER_SIZE_VV;
+        }
+
+        std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
+        e::buffer::packer pa = msg->pack_at(HYPERDEX_HEADER_SIZE_VV);
+        pa = pa << static_cast<uint32_t>(limit - start);
+
+        for (size_t i = start; i < limit; ++i)
+        {
+            const batch::outgoing& o(b->messages[order[i]]);
+            e::slice body(o.msg->data() + HYPERDEX_HEADER_SIZE_VV,
+                          o.msg->size() - HYPERDEX_HEADER_SIZE_VV);
+            pa = pa << static_cast<uint8_t>(o.type) << body;
+        }
+
+        m_daemon->m_comm.send_exact(first.from, first.to, CHAIN_BATCH, msg);
+        start = limit;
+    }
+
+    for (size_t i = 0; i < b->completions.size(); ++i)
+    {
+        complete_client_op(b->completions[i].first, b->completions[i].second,
+                           written ? NET_SUCCESS : NET_SERVERERROR, NULL);
+    }
+
+    for (size_t i = 0; written && i < b->collections.size(); ++i)
+    {
+        collect(b->collections[i].first, b->collections[i].second, NULL);
+    }
+
+    b->messages.clear();
+    b->completions.clear();
+    b->collections.clear();
+    b->last = NULL;
+    b->refs.clear();
+}
+
 void
 replication_manager :: chain_gc(const region_id& reg_id, uint64_t seq_id)
 {
@@ -556,6 +820,140 @@ replication_manager :: chain_gc(const region_id& reg_id, uint64_t seq_id)
     m_lower_bounds.push_back(std::make_pair(reg_id, seq_id));
 }
 
+bool
+replication_manager :: client_read(const server_id& from,
+                                   const virtual_server_id& us,
+                                   uint64_t nonce,
+                                   network_msgtype mt,
+                                   const e::slice& key,
+                                   const std::vector<uint16_t>& attrnums)
+{
+    region_id ri(m_daemon->m_config.get_region_id(us));
+    virtual_server_id tail = m_daemon->m_config.tail_of_region(ri);
+
+    if (tail == us || tail == virtual_server_id())
+    {
+        return false;
+    }
+
+    {
+        key_map_t::state_reference ksr;
+        key_state* ks = get_key_state(ri, key, &ksr, NULL);
+
+        if (!ks || ks->empty())
+        {
+            return false;
+        }
+    }
+
+    uint64_t read_id;
+
+    {
+        po6::threads::mutex::hold hold(&m_protect_reads);
+        read_id = m_next_read++;
+        relayed_read& rr(m_reads[read_id]);
+        rr.client = from;
+        rr.us = us;
+        rr.tail = tail;
+        rr.nonce = nonce;
+        rr.mt = mt;
+        rr.attrnums = attrnums;
+    }
+
+    size_t sz = HYPERDEX_HEADER_SIZE_VV
+              + sizeof(uint64_t)
+              + pack_size(key);
+    std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
+    msg->pack_at(HYPERDEX_HEADER_SIZE_VV) << read_id << key;
+
+    if (!m_daemon->m_comm.send_exact(us, tail, CHAIN_READ, msg))
+    {
+        // our own copy may hold writes that never commit, so have the client
+        // retry (as a reconfiguration) rather than answering from it
+        {
+            po6::threads::mutex::hold hold(&m_protect_reads);
+            m_reads.erase(read_id);
+        }
+
+        m_daemon->send_get_response(from, us, nonce, mt, attrnums,
+                                    NET_NOTUS, std::vector<e::slice>());
+    }
+
+    return true;
+}
+
+void
+replication_manager :: chain_read(const virtual_server_id& from,
+                                  const virtual_server_id& to,
+                                  uint64_t read_id,
+                                  const e::slice& key)
+{
+    region_id ri(m_daemon->m_config.get_region_id(to));
+    std::vector<e::slice> value;
+    uint64_t version;
+    datalayer::reference ref;
+    network_returncode result;
+
+    if (m_daemon->m_config.tail_of_region(ri) != to)
+    {
+        result = NET_NOTUS;
+    }
+    else
+    {
+        switch (m_daemon->m_data.get(ri, key, &value, &version, &ref))
+        {
+            case datalayer::SUCCESS:
+                result = NET_SUCCESS;
+                break;
+            case datalayer::NOT_FOUND:
+                result = NET_NOTFOUND;
+                break;
+            case datalayer::BAD_ENCODING:
+            case datalayer::CORRUPTION:
+            case datalayer::IO_ERROR:
+            case datalayer::LEVELDB_ERROR:
+            default:
+                LOG(ERROR) << "GET returned unacceptable error code.";
+                result = NET_SERVERERROR;
+                break;
+        }
+    }
+
+    size_t sz = HYPERDEX_HEADER_SIZE_VV
+              + sizeof(uint64_t)
+              + sizeof(uint16_t)
+              + pack_size(value);
+    std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
+    msg->pack_at(HYPERDEX_HEADER_SIZE_VV) << read_id << static_cast<uint16_t>(result) << value;
+    m_daemon->m_comm.send_exact(to, from, CHAIN_READ_RESP, msg);
+}
+
+void
+replication_manager :: chain_read_resp(const virtual_server_id& from,
+                                       const virtual_server_id& to,
+                                       uint64_t read_id,
+                                       network_returncode result,
+                                       const std::vector<e::slice>& value)
+{
+    relayed_read rr;
+
+    {
+        po6::threads::mutex::hold hold(&m_protect_reads);
+        std::map<uint64_t, relayed_read>::iterator it = m_reads.find(read_id);
+
+        if (it == m_reads.end() || it->second.us != to || it->second.tail != from)
+        {
+            LOG(INFO) << "dropping CHAIN_READ_RESP for unknown read " << read_id;
+            return;
+        }
+
+        rr = it->second;
+        m_reads.erase(it);
+    }
+
+    m_daemon->send_get_response(rr.client, rr.us, rr.nonce, rr.mt, rr.attrnums, result, value);
+}
+
 void
 replication_manager :: trip_periodic()
 {
@@ -634,26 +1032,74 @@ replication_manager :: end_checkpoint(uint64_t seq)
 replication_manager::key_state*
 replication_manager :: get_key_state(const region_id& ri,
                                      const e::slice& key,
-                                     key_map_t::state_reference* ksr)
+                                     key_map_t::state_reference* ksr,
+                                     batch* b)
 {
     key_region kr(ri, key);
-    return m_key_states.get_state(kr, ksr);
+
+    if (!b)
+    {
+        return m_key_states.get_state(kr, ksr);
+    }
+
+    if (b->last && b->last->state_key() == kr)
+    {
+        return b->last;
+    }
+
+    e::compat::shared_ptr<key_map_t::state_reference> ref(new key_map_t::state_reference());
+    key_state* ks = m_key_states.get_state(kr, ref.get());
+
+    if (ks)
+    {
+        b->refs.push_back(ref);
+        b->last = ks;
+    }
+
+    return ks;
 }
 
 replication_manager::key_state*
 replication_manager :: get_or_create_key_state(const region_id& ri,
                                                const e::slice& key,
-                                               key_map_t::state_reference* ksr)
+                                               uint64_t blind_version,
+                                               key_map_t::state_reference* ksr,
+                                               batch* b)
 {
     key_region kr(ri, key);
-    key_state* ks = m_key_states.get_or_create_state(kr, ksr);
+    key_state* ks = NULL;
+
+    if (!b)
+    {
+        ks = m_key_states.get_or_create_state(kr, ksr);
+    }
+    else if (b->last && b->last->state_key() == kr)
+    {
+        ks = b->last;
+    }
+    else
+    {
+        e::compat::shared_ptr<key_map_t::state_reference> ref(new key_map_t::state_reference());
+        ks = m_key_states.get_or_create_state(kr, ref.get());
+        b->refs.push_back(ref);
+        b->last = ks;
+    }
 
     if (!ks || ks->initialized())
     {
         return ks;
     }
 
-    switch (ks->initialize(&m_daemon->m_data, ri))
+    if (blind_version > 0)
+    {
+        ks->initialize_blind(blind_version);
+        return ks;
+    }
+
+    datalayer::returncode rc = ks->initialize(&m_daemon->m_data, ri);
+    observe_version(ks->persisted_version());
+
+    switch (rc)
     {
         case datalayer::SUCCESS:
         case datalayer::NOT_FOUND:
@@ -668,12 +1114,74 @@ replication_manager :: get_or_create_key_state(const region_id& ri,
     }
 }
 
+bool
+replication_manager :: is_blind_write(const region_id& ri,
+                                      const schema& sc,
+                                      bool erase,
+                                      bool fail_if_not_found,
+                                      bool fail_if_found,
+                                      const std::vector<attribute_check>& checks,
+                                      const std::vector<funcall>& funcs)
+{
+    if (erase || fail_if_not_found || fail_if_found || !checks.empty())
+    {
+        return false;
+    }
+
+    // every secondary attribute must be set outright
+    std::vector<bool> set(sc.attrs_sz, false);
+
+    for (size_t i = 0; i < funcs.size(); ++i)
+    {
+        if (funcs[i].name != FUNC_SET || funcs[i].attr >= sc.attrs_sz)
+        {
+            return false;
+        }
+
+        set[funcs[i].attr] = true;
+    }
+
+    for (size_t i = 1; i < sc.attrs_sz; ++i)
+    {
+        if (!set[i])
+        {
+            return false;
+        }
+    }
+
+    // other subspaces need the old value to find the object's old home, and
+    // indices need it to remove stale entries
+    const configuration& config(m_daemon->m_config);
+    subspace_id ss = config.subspace_of(ri);
+
+    if (config.subspace_prev(ss) != subspace_id() ||
+        config.subspace_next(ss) != subspace_id())
+    {
+        return false;
+    }
+
+    return config.get_subspace(ri)->indices.empty();
+}
+
+uint64_t
+replication_manager :: next_blind_version()
+{
+    return m_blind_clock.next(e::time());
+}
+
+void
+replication_manager :: observe_version(uint64_t version)
+{
+    m_blind_clock.observe(version);
+}
+
 void
 replication_manager :: send_message(const virtual_server_id& us,
                                     bool retransmission,
                                     uint64_t version,
                                     const e::slice& key,
-                                    e::intrusive_ptr<pending> op)
+                                    e::intrusive_ptr<pending> op,
+                                    batch* b)
 {
     // If we've sent it somewhere, we shouldn't resend.  If the sender intends a
     // resend, they should clear "sent" first.
@@ -763,6 +1271,7 @@ replication_manager :: send_message(const virtual_server_id& us,
     {
         uint8_t flags = (op->fresh ? 1 : 0)
                       | (op->has_value ? 2 : 0)
+                      | (op->blind ? 4 : 0)
                       | (retransmission ? 128 : 0);
         size_t sz = HYPERDEX_HEADER_SIZE_VV
                   + sizeof(uint8_t)
@@ -810,6 +1319,13 @@ replication_manager :: send_message(const virtual_server_id& us,
 
     op->sent_config_version = m_daemon->m_config.version();
     op->sent = dest;
+
+    if (b)
+    {
+        b->messages.push_back(batch::outgoing(us, dest, type, e::compat::shared_ptr<e::buffer>(msg.release())));
+        return;
+    }
+
     m_daemon->m_comm.send_exact(us, dest, type, msg);
 }
 
@@ -820,7 +1336,8 @@ replication_manager :: send_ack(const virtual_server_id& us,
                                 const region_id& reg_id,
                                 uint64_t seq_id,
                                 uint64_t version,
-                                const e::slice& key)
+                                const e::slice& key,
+                                batch* b)
 {
     uint8_t flags = (retransmission ? 128 : 0);
     size_t sz = HYPERDEX_HEADER_SIZE_VV
@@ -832,6 +1349,13 @@ replication_manager :: send_ack(const virtual_server_id& us,
               + key.size();
     std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
     msg->pack_at(HYPERDEX_HEADER_SIZE_VV) << flags << reg_id.get() << seq_id << version << key;
+
+    if (b)
+    {
+        b->messages.push_back(batch::outgoing(us, to, CHAIN_ACK, e::compat::shared_ptr<e::buffer>(msg.release())));
+        return true;
+    }
+
     return m_daemon->m_comm.send_exact(us, to, CHAIN_ACK, msg);
 }
 
@@ -850,6 +1374,66 @@ replication_manager :: respond_to_client(const virtual_server_id& us,
     m_daemon->m_comm.send_client(us, client, RESP_ATOMIC, msg);
 }
 
+void
+replication_manager :: complete_client_op(const virtual_server_id& us,
+                                          e::intrusive_ptr<pending> op,
+                                          network_returncode ret,
+                                          batch* b)
+{
+    if (op->client == server_id() && !op->cbatch)
+    {
+        return;
+    }
+
+    if (b)
+    {
+        b->completions.push_back(std::make_pair(us, op));
+    }
+    else if (op->cbatch)
+    {
+        complete_client_batch(op->cbatch, op->cbatch_idx, ret);
+    }
+    else
+    {
+        respond_to_client(us, op->client, op->nonce, ret);
+    }
+}
+
+void
+replication_manager :: complete_client_batch(e::intrusive_ptr<client_batch> cb,
+                                             size_t idx,
+                                             network_returncode ret)
+{
+    if (!cb->results.empty() && !cb->complete(idx, ret))
+    {
+        return;
+    }
+
+    size_t sz = HYPERDEX_HEADER_SIZE_VC
+              + sizeof(uint64_t)
+              + sizeof(uint64_t)
+              + sizeof(uint32_t)
+              + cb->results.size() * sizeof(uint16_t);
+    std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
+    msg->pack_at(HYPERDEX_HEADER_SIZE_VC) << cb->nonce << cb->batch_id << cb->results;
+    m_daemon->m_comm.send_client(cb->us, cb->client, RESP_ATOMIC_MANY, msg);
+}
+
+void
+replication_manager :: collect(const region_id& ri, uint64_t seq_id, batch* b)
+{
+    if (b)
+    {
+        b->collections.push_back(std::make_pair(ri, seq_id));
+        return;
+    }
+
+    bool x;
+    x = m_idcol.collect(ri, seq_id);
+    assert(x);
+    check_stable(ri);
+}
+
 bool
 replication_manager :: is_check_needed()
 {
@@ -1122,7 +1706,7 @@ replication_manager :: retransmit(const std::vector<region_id>& point_leaders,
 
         const schema& sc(*m_daemon->m_config.get_schema(ri));
         ks->resend_committable(this, us);
-        ks->move_operations_between_queues(this, us, ri, sc);
+        ks->move_operations_between_queues(this, us, ri, sc, NULL);
     }
 
     m_daemon->m_comm.wake_one();
@@ -1209,3 +1793,31 @@ replication_manager :: shutdown()
         m_background_thread.join();
     }
 }
+
+replication_manager :: atomic_op :: atomic_op()
+    : erase(false)
+    , fail_if_not_found(false)
+    , fail_if_found(false)
+    , key()
+    , checks()
+    , funcs()
+{
+}
+
+replication_manager :: atomic_op :: ~atomic_op() throw ()
+{
+}
+
+replication_manager :: relayed_read :: relayed_read()
+    : client()
+    , us()
+    , tail()
+    , nonce(0)
+    , mt(REQ_GET)
+    , attrnums()
+{
+}
+
+replication_manager :: relayed_read :: ~relayed_read() throw ()
+{
+}
@@ -30,6 +30,7 @@
 
 // STL
 #include <list>
+#include <map>
 
 // po6
 #include <po6/threads/cond.h>
@@ -49,12 +50,14 @@
 #include "common/configuration.h"
 #include "common/funcall.h"
 #include "common/ids.h"
+#include "common/network_msgtype.h"
 #include "common/network_returncode.h"
 #include "daemon/identifier_collector.h"
 #include "daemon/identifier_generator.h"
 #include "daemon/reconfigure_returncode.h"
 #include "daemon/region_timestamp.h"
 #include "daemon/state_hash_table.h"
+#include "daemon/version_clock.h"
 
 BEGIN_HYPERDEX_NAMESPACE
 class daemon;
@@ -62,6 +65,10 @@ class daemon;
 // Manage replication.
 class replication_manager
 {
+    public:
+        class atomic_op; // one key operation of a batched client request
+        class batch; // chain messages and writes committed together
+
     public:
         replication_manager(daemon*);
         ~replication_manager() throw ();
@@ -90,7 +97,17 @@ class replication_manager
                            const e::slice& key,
                            const std::vector<attribute_check>& checks,
                            const std::vector<funcall>& funcs);
-        // These are called in response to messages from other hosts.
+        // Issue many independent key operations from one client request.
+        // Operations on the same key are applied in the order given, and the
+        // client gets one response carrying a result for every operation.
+        void client_atomic_many(const server_id& from,
+                                const virtual_server_id& to,
+                                uint64_t nonce,
+                                uint64_t batch_id,
+                                std::vector<atomic_op>* ops);
+        // These are called in response to messages from other hosts.  When
+        // "b" is non-NULL, the messages and writes they generate are held in
+        // "b" until it is passed to "commit".
         void chain_op(const virtual_server_id& from,
                       const virtual_server_id& to,
                       bool retransmission,
@@ -98,10 +115,12 @@ class replication_manager
                       uint64_t seq_id,
                       uint64_t new_version,
                       bool fresh,
+                      bool blind,
                       bool has_value,
                       std::auto_ptr<e::buffer> backing,
                       const e::slice& key,
-                      const std::vector<e::slice>& value);
+                      const std::vector<e::slice>& value,
+                      batch* b);
         void chain_subspace(const virtual_server_id& from,
                             const virtual_server_id& to,
                             bool retransmission,
@@ -111,15 +130,45 @@ class replication_manager
                             std::auto_ptr<e::buffer> backing,
                             const e::slice& key,
                             const std::vector<e::slice>& value,
-                            const std::vector<uint64_t>& hashes);
+                            const std::vector<uint64_t>& hashes,
+                            batch* b);
         void chain_ack(const virtual_server_id& from,
                        const virtual_server_id& to,
                        bool retransmission,
                        const region_id& reg_id,
                        uint64_t seq_id,
                        uint64_t version,
-                       const e::slice& key);
+                       const e::slice& key,
+                       batch* b);
+        // Apply the writes held in "b" with a single write to disk, then send
+        // its messages, coalescing those bound for the same virtual server
+        // into one CHAIN_BATCH.  Keys must be fed to a batch in sorted order.
+        void commit(batch* b);
         void chain_gc(const region_id& reg_id, uint64_t seq_id);
+        // Fold a version this server has seen, from the chain or from a
+        // state transfer, into the clock for blind writes.
+        void observe_version(uint64_t version);
+        // Gets may be served by any replica of the key's region.  A replica
+        // with operations in flight for the key cannot tell which of them
+        // have committed, so it relays the read through the tail of the
+        // region, which persists only committed values.  Returns false when
+        // "us" should answer from its own copy; otherwise the client gets its
+        // response from the tail or, if the tail is unreachable, a NET_NOTUS.
+        bool client_read(const server_id& from,
+                         const virtual_server_id& us,
+                         uint64_t nonce,
+                         network_msgtype mt,
+                         const e::slice& key,
+                         const std::vector<uint16_t>& attrnums);
+        void chain_read(const virtual_server_id& from,
+                        const virtual_server_id& to,
+                        uint64_t read_id,
+                        const e::slice& key);
+        void chain_read_resp(const virtual_server_id& from,
+                             const virtual_server_id& to,
+                             uint64_t read_id,
+                             network_returncode result,
+                             const std::vector<e::slice>& value);
         void trip_periodic();
         void begin_checkpoint(uint64_t seq);
         void end_checkpoint(uint64_t seq);
@@ -128,42 +177,89 @@ class replication_manager
         class pending; // state for one pending operation
         class key_region; // a tuple of (key, region)
         class key_state; // state for a single key
+        class client_batch; // results of a client_atomic_many
+        class relayed_read; // a client read waiting on the tail
         typedef state_hash_table<key_region, key_state> key_map_t;
         friend class e::compat::hash<key_region>;
+        friend class replication_manager_test;
 
     private:
         replication_manager(const replication_manager&);
         replication_manager& operator = (const replication_manager&);
 
     private:
+        // Check and issue one client operation.  Returns false and sets
+        // "nrc" if the operation fails before it is sent down the chain.
+        bool issue_atomic(const server_id& from,
+                          const virtual_server_id& to,
+                          uint64_t nonce,
+                          bool erase,
+                          bool fail_if_not_found,
+                          bool fail_if_found,
+                          const e::slice& key,
+                          const std::vector<attribute_check>& checks,
+                          const std::vector<funcall>& funcs,
+                          e::intrusive_ptr<client_batch> cb,
+                          size_t cb_idx,
+                          batch* b,
+                          network_returncode* nrc);
         // Get the state for the specified key.
         // Returns NULL if there is no key_state that's currently in use.
+        // With a batch, the state stays locked until the batch commits.
         key_state* get_key_state(const region_id& ri,
                                  const e::slice& key,
-                                 key_map_t::state_reference* ksr);
+                                 key_map_t::state_reference* ksr,
+                                 batch* b);
         // Get the state for the specified key.
         // Will retrieve the state from disk and create the key_state when
-        // necessary.
+        // necessary.  A non-zero "blind_version" skips the disk read and
+        // creates the key_state as if the object were absent at that version.
         key_state* get_or_create_key_state(const region_id& ri,
                                            const e::slice& key,
-                                           key_map_t::state_reference* ksr);
+                                           uint64_t blind_version,
+                                           key_map_t::state_reference* ksr,
+                                           batch* b);
+        // True if the write replaces every attribute unconditionally in a
+        // space where nothing else needs the object's previous value.
+        bool is_blind_write(const region_id& ri,
+                            const schema& sc,
+                            bool erase,
+                            bool fail_if_not_found,
+                            bool fail_if_found,
+                            const std::vector<attribute_check>& checks,
+                            const std::vector<funcall>& funcs);
+        // Versions for blind writes come from a clock rather than from the
+        // object on disk.  Every version seen is folded in so that the
+        // clock stays ahead of the versions in the chain.
+        uint64_t next_blind_version();
         // Send a response to the specified client.
         void send_message(const virtual_server_id& us,
                           bool retransmission,
                           uint64_t version,
                           const e::slice& key,
-                          e::intrusive_ptr<pending> op);
+                          e::intrusive_ptr<pending> op,
+                          batch* b);
         bool send_ack(const virtual_server_id& us,
                       const virtual_server_id& to,
                       bool retransmission,
                       const region_id& reg_id,
                       uint64_t seq_id,
                       uint64_t version,
-                      const e::slice& key);
+                      const e::slice& key,
+                      batch* b);
         void respond_to_client(const virtual_server_id& us,
                                const server_id& client,
                                uint64_t nonce,
                                network_returncode ret);
+        // Tell the client that issued "op" how it went
+        void complete_client_op(const virtual_server_id& us,
+                                e::intrusive_ptr<pending> op,
+                                network_returncode ret,
+                                batch* b);
+        void complete_client_batch(e::intrusive_ptr<client_batch> cb,
+                                   size_t idx,
+                                   network_returncode ret);
+        void collect(const region_id& ri, uint64_t seq_id, batch* b);
         // check stability
         bool is_check_needed();
         void check_is_needed();
@@ -191,6 +287,7 @@ class replication_manager
         std::vector<region_id> m_unstable_regions;
         uint64_t m_checkpoint;
         uint32_t m_need_check;
+        version_clock m_blind_clock;
         std::vector<region_timestamp> m_timestamps;
         po6::threads::thread m_background_thread;
         po6::threads::mutex m_block_background_thread;
@@ -202,6 +299,39 @@ class replication_manager
         bool m_need_post_reconfigure;
         bool m_need_periodic;
         std::list<std::pair<region_id, uint64_t> > m_lower_bounds;
+        po6::threads::mutex m_protect_reads;
+        uint64_t m_next_read;
+        std::map<uint64_t, relayed_read> m_reads;
+};
+
+class replication_manager::atomic_op
+{
+    public:
+        atomic_op();
+        ~atomic_op() throw ();
+
+    public:
+        bool erase;
+        bool fail_if_not_found;
+        bool fail_if_found;
+        e::slice key;
+        std::vector<attribute_check> checks;
+        std::vector<funcall> funcs;
+};
+
+class replication_manager::relayed_read
+{
+    public:
+        relayed_read();
+        ~relayed_read() throw ();
+
+    public:
+        server_id client;
+        virtual_server_id us;
+        virtual_server_id tail;
+        uint64_t nonce;
+        network_msgtype mt;
+        std::vector<uint16_t> attrnums;
 };
 
 END_HYPERDEX_NAMESPACE
@@ -0,0 +1,93 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+// HyperDex
+#include "daemon/replication_manager_batch.h"
+#include "daemon/replication_manager_key_state.h"
+#include "daemon/replication_manager_pending.h"
+
+using hyperdex::replication_manager;
+
+replication_manager :: batch :: batch()
+    : last(NULL)
+    , refs()
+    , writes()
+    , messages()
+    , completions()
+    , collections()
+{
+}
+
+replication_manager :: batch :: ~batch() throw ()
+{
+}
+
+replication_manager :: batch :: outgoing :: outgoing()
+    : from()
+    , to()
+    , type()
+    , msg()
+{
+}
+
+replication_manager :: batch :: outgoing :: outgoing(const virtual_server_id& f,
+                                                     const virtual_server_id& t,
+                                                     network_msgtype mt,
+                                                     e::compat::shared_ptr<e::buffer> m)
+    : from(f)
+    , to(t)
+    , type(mt)
+    , msg(m)
+{
+}
+
+replication_manager :: batch :: outgoing :: outgoing(const outgoing& other)
+    : from(other.from)
+    , to(other.to)
+    , type(other.type)
+    , msg(other.msg)
+{
+}
+
+replication_manager :: batch :: outgoing :: ~outgoing() throw ()
+{
+}
+
+replication_manager::batch::outgoing&
+replication_manager :: batch :: outgoing :: operator = (const outgoing& rhs)
+{
+    if (this != &rhs)
+    {
+        from = rhs.from;
+        to = rhs.to;
+        type = rhs.type;
+        msg = rhs.msg;
+    }
+
+    return *this;
+}
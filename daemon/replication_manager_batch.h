@@ -0,0 +1,94 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef hyperdex_daemon_replication_manager_batch_h_
+#define hyperdex_daemon_replication_manager_batch_h_
+
+// STL
+#include <vector>
+
+// e
+#include <e/compat.h>
+
+// HyperDex
+#include "common/network_msgtype.h"
+#include "daemon/datalayer.h"
+#include "daemon/replication_manager.h"
+
+// Everything a network thread does on behalf of a group of chain messages (or
+// one batched client request) that must wait until the group is done:  the key
+// states it touched stay locked, its writes go to disk together, and its
+// outgoing messages are sent together once those writes are applied.
+class hyperdex::replication_manager::batch
+{
+    public:
+        batch();
+        ~batch() throw ();
+
+    public:
+        class outgoing;
+
+    public:
+        // the key state most recently locked for this batch; keys are fed to
+        // a batch in sorted order, so a repeated key is always the last one
+        key_state* last;
+        std::vector<e::compat::shared_ptr<key_map_t::state_reference> > refs;
+        datalayer::write_batch writes;
+        std::vector<outgoing> messages;
+        // client operations to complete once the writes are applied
+        std::vector<std::pair<virtual_server_id, e::intrusive_ptr<pending> > > completions;
+        // (region, seq_id) pairs to collect once the writes are applied
+        std::vector<std::pair<region_id, uint64_t> > collections;
+
+    private:
+        batch(const batch&);
+        batch& operator = (const batch&);
+};
+
+class hyperdex::replication_manager::batch::outgoing
+{
+    public:
+        outgoing();
+        outgoing(const virtual_server_id& from,
+                 const virtual_server_id& to,
+                 network_msgtype type,
+                 e::compat::shared_ptr<e::buffer> msg);
+        outgoing(const outgoing& other);
+        ~outgoing() throw ();
+
+    public:
+        outgoing& operator = (const outgoing& rhs);
+
+    public:
+        virtual_server_id from;
+        virtual_server_id to;
+        network_msgtype type;
+        e::compat::shared_ptr<e::buffer> msg;
+};
+
+#endif // hyperdex_daemon_replication_manager_batch_h_
@@ -0,0 +1,59 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+// HyperDex
+#include "daemon/replication_manager_client_batch.h"
+
+using hyperdex::replication_manager;
+
+replication_manager :: client_batch :: client_batch(const virtual_server_id& _us,
+                                                    const server_id& _client,
+                                                    uint64_t _nonce,
+                                                    uint64_t _batch_id,
+                                                    size_t ops)
+    : us(_us)
+    , client(_client)
+    , nonce(_nonce)
+    , batch_id(_batch_id)
+    , results(ops, static_cast<uint16_t>(NET_SERVERERROR))
+    , m_ref(0)
+    , m_outstanding(ops)
+{
+}
+
+replication_manager :: client_batch :: ~client_batch() throw ()
+{
+}
+
+bool
+replication_manager :: client_batch :: complete(size_t idx, network_returncode ret)
+{
+    assert(idx < results.size());
+    results[idx] = static_cast<uint16_t>(ret);
+    return __sync_sub_and_fetch(&m_outstanding, 1) == 0;
+}
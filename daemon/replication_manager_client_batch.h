@@ -0,0 +1,76 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef hyperdex_daemon_replication_manager_client_batch_h_
+#define hyperdex_daemon_replication_manager_client_batch_h_
+
+// STL
+#include <vector>
+
+// HyperDex
+#include "common/ids.h"
+#include "common/network_returncode.h"
+#include "daemon/replication_manager.h"
+
+// The results of one client_atomic_many.  Operations finish in any order and
+// from any thread; whichever finishes last sends the response.
+class hyperdex::replication_manager::client_batch
+{
+    public:
+        client_batch(const virtual_server_id& us,
+                     const server_id& client,
+                     uint64_t nonce,
+                     uint64_t batch_id,
+                     size_t ops);
+        ~client_batch() throw ();
+
+    public:
+        // Record the result of the operation at "idx".  Returns true for the
+        // last operation to complete.
+        bool complete(size_t idx, network_returncode ret);
+
+    public:
+        const virtual_server_id us;
+        const server_id client;
+        const uint64_t nonce;
+        const uint64_t batch_id;
+        std::vector<uint16_t> results;
+
+    private:
+        friend class e::intrusive_ptr<client_batch>;
+        void inc() { __sync_add_and_fetch(&m_ref, 1); }
+        void dec() { if (__sync_sub_and_fetch(&m_ref, 1) == 0) delete this; }
+        size_t m_ref;
+        size_t m_outstanding;
+
+    private:
+        client_batch(const client_batch&);
+        client_batch& operator = (const client_batch&);
+};
+
+#endif // hyperdex_daemon_replication_manager_client_batch_h_
@@ -0,0 +1,81 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+// HyperDex
+#include "daemon/replication_manager_key_state.h"
+#include "daemon/replication_manager_pending.h"
+
+using hyperdex::replication_manager;
+
+bool
+replication_manager :: key_state :: coalesce_run(pending_list_t* run, bool has_old_value)
+{
+    if (run->size() < 2)
+    {
+        return false;
+    }
+
+    // Only client operations may be coalesced, and only when none follow
+    // them, because the coalesced op takes the version of the first and
+    // anything after the run would see a gap.
+    for (pending_list_t::iterator it = run->begin();
+            it != run->end(); ++it)
+    {
+        if (it->second->recv != virtual_server_id())
+        {
+            return false;
+        }
+    }
+
+    e::intrusive_ptr<pending> last = run->back().second;
+
+    // a run that creates and then deletes the object leaves nothing to send
+    if (!last->has_value && !has_old_value)
+    {
+        return false;
+    }
+
+    uint64_t version = run->front().first;
+    run->pop_back();
+
+    while (!run->empty())
+    {
+        e::intrusive_ptr<pending> op = run->front().second;
+        run->pop_front();
+        // its value will never be sent or stored
+        op->backing.reset();
+        op->value.clear();
+        last->subsumed.insert(last->subsumed.end(), op->subsumed.begin(), op->subsumed.end());
+        op->subsumed.clear();
+        last->subsumed.push_back(op);
+    }
+
+    last->fresh = last->has_value && !has_old_value;
+    run->push_back(std::make_pair(version, last));
+    return true;
+}
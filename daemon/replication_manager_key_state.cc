@@ -31,6 +31,8 @@
 // HyperDex
 #include "common/hash.h"
 #include "daemon/daemon.h"
+#include "daemon/replication_manager_batch.h"
+#include "daemon/replication_manager_client_batch.h"
 #include "daemon/replication_manager_key_region.h"
 #include "daemon/replication_manager_key_state.h"
 #include "daemon/replication_manager_pending.h"
@@ -117,6 +119,12 @@ replication_manager :: key_state :: clear()
     assert(empty());
 }
 
+uint64_t
+replication_manager :: key_state :: persisted_version() const
+{
+    return m_old_version;
+}
+
 uint64_t
 replication_manager :: key_state :: max_seq_id() const
 {
@@ -228,6 +236,15 @@ replication_manager :: key_state :: initialize(datalayer* data,
     return rc;
 }
 
+void
+replication_manager :: key_state :: initialize_blind(uint64_t old_version)
+{
+    assert(!m_initialized);
+    m_has_old_value = false;
+    m_old_version = old_version;
+    m_initialized = true;
+}
+
 bool
 replication_manager :: key_state :: check_against_latest_version(const schema& sc,
                                                                  bool erase,
@@ -247,7 +264,8 @@ replication_manager :: key_state :: check_against_latest_version(const schema& s
 void
 replication_manager :: key_state :: delete_latest(const schema& sc,
                                                   const region_id& reg_id, uint64_t seq_id,
-                                                  const server_id& client, uint64_t nonce)
+                                                  const server_id& client, uint64_t nonce,
+                                                  e::intrusive_ptr<client_batch> cb, size_t cb_idx)
 {
     assert(sc.attrs_sz > 0);
     e::intrusive_ptr<pending> op;
@@ -256,6 +274,8 @@ replication_manager :: key_state :: delete_latest(const schema& sc,
                      false, std::vector<e::slice>(sc.attrs_sz - 1),
                      client, nonce,
                      0, virtual_server_id());
+    op->cbatch = cb;
+    op->cbatch_idx = cb_idx;
 
     uint64_t new_version = 0;
 
@@ -279,7 +299,9 @@ bool
 replication_manager :: key_state :: put_from_funcs(const schema& sc,
                                                    const region_id& reg_id, uint64_t seq_id,
                                                    const std::vector<funcall>& funcs,
-                                                   const server_id& client, uint64_t nonce)
+                                                   bool blind,
+                                                   const server_id& client, uint64_t nonce,
+                                                   e::intrusive_ptr<client_batch> cb, size_t cb_idx)
 {
     bool has_old_value = false;
     uint64_t old_version = 0;
@@ -302,6 +324,9 @@ replication_manager :: key_state :: put_from_funcs(const schema& sc,
                      true, new_value,
                      client, nonce,
                      0, virtual_server_id());
+    op->blind = blind;
+    op->cbatch = cb;
+    op->cbatch_idx = cb_idx;
 
     if (funcs_passed == funcs.size())
     {
@@ -331,25 +356,29 @@ replication_manager :: key_state :: persist_to_datalayer(replication_manager* rm
                                                          const region_id& ri,
                                                          const region_id& reg_id,
                                                          uint64_t seq_id,
-                                                         uint64_t version)
+                                                         uint64_t version,
+                                                         batch* b)
 {
+    datalayer* data = &rm->m_daemon->m_data;
+
     if (m_old_version < version)
     {
         e::intrusive_ptr<pending> op = get_version(version);
         assert(op);
-        datalayer::returncode rc;
+        datalayer::write_batch local;
+        datalayer::write_batch* wb = b ? &b->writes : &local;
+        datalayer::returncode rc = datalayer::SUCCESS;
 
         // if this is a case where we are to remove the object from disk
         if (!op->has_value || (op->this_old_region != op->this_new_region && ri == op->this_old_region))
         {
             if (m_has_old_value)
             {
-                rc = rm->m_daemon->m_data.del(ri, reg_id, seq_id, m_key, m_old_value);
+                data->del(ri, reg_id, seq_id, m_key, m_old_value, wb);
             }
             else
             {
-                rm->m_daemon->m_data.mark_acked(ri, reg_id, seq_id);
-                rc = datalayer::SUCCESS;
+                data->mark_acked(ri, reg_id, seq_id, wb);
             }
         }
         // otherwise it is a case where we are to place this object on disk
@@ -357,14 +386,24 @@ replication_manager :: key_state :: persist_to_datalayer(replication_manager* rm
         {
             if (m_has_old_value)
             {
-                rc = rm->m_daemon->m_data.overput(ri, reg_id, seq_id, m_key, m_old_value, op->value, version);
+                data->overput(ri, reg_id, seq_id, m_key, m_old_value, op->value, version, wb);
             }
             else
             {
-                rc = rm->m_daemon->m_data.put(ri, reg_id, seq_id, m_key, op->value, version);
+                data->put(ri, reg_id, seq_id, m_key, op->value, version, wb);
             }
         }
 
+        for (size_t i = 0; i < op->subsumed.size(); ++i)
+        {
+            data->mark_acked(ri, op->subsumed[i]->reg_id, op->subsumed[i]->seq_id, wb);
+        }
+
+        if (!b)
+        {
+            rc = data->write(&local);
+        }
+
         switch (rc)
         {
             case datalayer::SUCCESS:
@@ -379,14 +418,19 @@ replication_manager :: key_state :: persist_to_datalayer(replication_manager* rm
                 return false;
         }
 
+        rm->observe_version(version);
         m_has_old_value = op->has_value;
         m_old_version = version;
         m_old_value = op->value;
         m_old_backing = op->backing;
     }
+    else if (b)
+    {
+        data->mark_acked(ri, reg_id, seq_id, &b->writes);
+    }
     else
     {
-        rm->m_daemon->m_data.mark_acked(ri, reg_id, seq_id);
+        data->mark_acked(ri, reg_id, seq_id);
     }
 
     return true;
@@ -423,7 +467,7 @@ replication_manager :: key_state :: resend_committable(replication_manager* rm,
 
         it->second->sent = virtual_server_id();
         it->second->sent_config_version = 0;
-        rm->send_message(us, true, it->first, m_key, it->second);
+        rm->send_message(us, true, it->first, m_key, it->second, NULL);
     }
 }
 
@@ -441,6 +485,11 @@ replication_manager :: key_state :: append_seq_ids(std::vector<std::pair<region_
             it != m_committable.end(); ++it)
     {
         seq_ids->push_back(std::make_pair(m_ri, it->second->seq_id));
+
+        for (size_t i = 0; i < it->second->subsumed.size(); ++i)
+        {
+            seq_ids->push_back(std::make_pair(m_ri, it->second->subsumed[i]->seq_id));
+        }
     }
 
     for (pending_list_t::iterator it = m_blocked.begin();
@@ -460,7 +509,8 @@ void
 replication_manager :: key_state :: move_operations_between_queues(replication_manager* rm,
                                                                    const virtual_server_id& us,
                                                                    const region_id& ri,
-                                                                   const schema& sc)
+                                                                   const schema& sc,
+                                                                   batch* b)
 {
     // Apply deferred operations
     while (!m_deferred.empty())
@@ -522,6 +572,11 @@ replication_manager :: key_state :: move_operations_between_queues(replication_m
         m_deferred.pop_front();
     }
 
+    if (m_committable.empty())
+    {
+        coalesce_blocked(rm, ri, sc);
+    }
+
     // Issue blocked operations
     while (!m_blocked.empty())
     {
@@ -535,9 +590,16 @@ replication_manager :: key_state :: move_operations_between_queues(replication_m
             break;
         }
 
+        // If the op came from a client while another is in flight, hold it
+        // back so that it can be coalesced with those that queue behind it
+        if (op->recv == virtual_server_id() && !m_committable.empty())
+        {
+            break;
+        }
+
         m_committable.push_back(m_blocked.front());
         m_blocked.pop_front();
-        rm->send_message(us, false, version, m_key, op);
+        rm->send_message(us, false, version, m_key, op, b);
     }
 }
 
@@ -636,6 +698,26 @@ replication_manager :: key_state :: check_version(const schema& sc,
     return passes_attribute_checks(sc, checks, m_key, *old_value) == checks.size();
 }
 
+void
+replication_manager :: key_state :: coalesce_blocked(replication_manager* rm,
+                                                     const region_id& ri,
+                                                     const schema& sc)
+{
+    assert(m_committable.empty());
+
+    if (!coalesce_run(&m_blocked, m_has_old_value))
+    {
+        return;
+    }
+
+    // the coalesced op now replaces everything since the value on disk
+    e::intrusive_ptr<pending> op = m_blocked.back().second;
+    hash_objects(&rm->m_daemon->m_config, ri, sc,
+                 op->has_value, op->value,
+                 m_has_old_value, m_has_old_value ? m_old_value : op->value,
+                 op);
+}
+
 void
 replication_manager :: key_state :: hash_objects(const configuration* config,
                                                  const region_id& reg,
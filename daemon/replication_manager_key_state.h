@@ -53,11 +53,29 @@ class hyperdex::replication_manager::key_state
         void clear();
         uint64_t max_seq_id() const;
         uint64_t min_seq_id() const;
+        uint64_t persisted_version() const;
         e::intrusive_ptr<pending> get_version(uint64_t version) const;
 
+    public:
+        typedef std::list<std::pair<uint64_t, e::intrusive_ptr<pending> > >
+                pending_list_t;
+        // At the point leader, a client operation that arrives while another
+        // operation on the key is in flight is held back, so at most one
+        // client write per key is in the chain at a time.  When the one in
+        // flight commits, the run of operations held back collapses into the
+        // last of them, which takes the version of the first so that the
+        // versions downstream stay contiguous.  The others become its
+        // "subsumed" operations and complete when it commits.  Returns false
+        // and leaves "run" alone when it cannot be collapsed.
+        static bool coalesce_run(pending_list_t* run, bool has_old_value);
+
     public:
         datalayer::returncode initialize(datalayer* data,
                                          const region_id& ri);
+        // Initialize without reading from disk, treating the object as
+        // absent at "old_version".  Only valid when the next operation
+        // overwrites the whole object and nothing needs its old value.
+        void initialize_blind(uint64_t old_version);
         bool check_against_latest_version(const schema& sc,
                                           bool erase,
                                           bool fail_if_not_found,
@@ -66,15 +84,20 @@ class hyperdex::replication_manager::key_state
                                           network_returncode* nrc);
         void delete_latest(const schema& sc,
                            const region_id& reg_id, uint64_t seq_id,
-                           const server_id& client, uint64_t nonce);
+                           const server_id& client, uint64_t nonce,
+                           e::intrusive_ptr<client_batch> cb, size_t cb_idx);
         bool put_from_funcs(const schema& sc,
                             const region_id& reg_id, uint64_t seq_id,
                             const std::vector<funcall>& funcs,
-                            const server_id& client, uint64_t nonce);
+                            bool blind,
+                            const server_id& client, uint64_t nonce,
+                            e::intrusive_ptr<client_batch> cb, size_t cb_idx);
         void insert_deferred(uint64_t version, e::intrusive_ptr<pending> op);
+        // with a batch, the write is added to the batch and applied when it
+        // commits
         bool persist_to_datalayer(replication_manager* rm, const region_id& ri,
                                   const region_id& reg_id, uint64_t seq_id,
-                                  uint64_t version);
+                                  uint64_t version, batch* b);
         void clear_deferred();
         void clear_acked_prefix();
         void resend_committable(replication_manager* rm,
@@ -87,12 +110,11 @@ class hyperdex::replication_manager::key_state
         void move_operations_between_queues(replication_manager* rm,
                                             const virtual_server_id& us,
                                             const region_id& ri,
-                                            const schema& sc);
+                                            const schema& sc,
+                                            batch* b);
         void debug_dump();
 
     private:
-        typedef std::list<std::pair<uint64_t, e::intrusive_ptr<pending> > >
-                pending_list_t;
         friend class e::intrusive_ptr<key_state>;
         friend class key_state_reference;
 
@@ -111,6 +133,11 @@ class hyperdex::replication_manager::key_state
                            uint64_t old_version,
                            std::vector<e::slice>* old_value,
                            network_returncode* nrc);
+        // coalesce_run on the blocked operations, rehashing the result
+        // against the value on disk
+        void coalesce_blocked(replication_manager* rm,
+                              const region_id& ri,
+                              const schema& sc);
         void hash_objects(const configuration* config,
                           const region_id& reg,
                           const schema& sc,
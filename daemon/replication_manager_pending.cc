@@ -29,6 +29,7 @@
 #include <glog/logging.h>
 
 // HyperDex
+#include "daemon/replication_manager_client_batch.h"
 #include "daemon/replication_manager_pending.h"
 
 using hyperdex::replication_manager;
@@ -52,15 +53,19 @@ replication_manager :: pending :: pending(std::auto_ptr<e::buffer> _backing,
     , sent_config_version(0)
     , sent()
     , fresh(_fresh)
+    , blind(false)
     , acked(false)
     , client(_client)
     , nonce(_nonce)
+    , cbatch()
+    , cbatch_idx(0)
     , old_hashes()
     , new_hashes()
     , this_old_region()
     , this_new_region()
     , prev_region()
     , next_region()
+    , subsumed()
     , m_ref(0)
 {
 }
@@ -77,9 +82,11 @@ replication_manager :: pending :: debug_dump()
     LOG(INFO) << "  recv: version=" << recv_config_version << " from=" << recv;
     LOG(INFO) << "  sent: version=" << sent_config_version << " to=" << sent;
     LOG(INFO) << "  fresh: " << (fresh ? "yes" : "no");
+    LOG(INFO) << "  blind: " << (blind ? "yes" : "no");
     LOG(INFO) << "  acked: " << (acked ? "yes" : "no");
     LOG(INFO) << "  prev: " << prev_region;
     LOG(INFO) << "  this_old: " << this_old_region;
     LOG(INFO) << "  this_new: " << this_new_region;
     LOG(INFO) << "  next: " << next_region;
+    LOG(INFO) << "  subsumed: " << subsumed.size();
 }
@@ -62,15 +62,24 @@ class hyperdex::replication_manager::pending
         uint64_t sent_config_version;
         virtual_server_id sent; // we sent to here
         bool fresh;
+        // a full overwrite that replicas may apply without reading the
+        // object from disk
+        bool blind;
         bool acked;
         server_id client;
         uint64_t nonce;
+        // set instead of client/nonce when the op is part of a batched request
+        e::intrusive_ptr<client_batch> cbatch;
+        size_t cbatch_idx;
         std::vector<uint64_t> old_hashes;
         std::vector<uint64_t> new_hashes;
         region_id this_old_region;
         region_id this_new_region;
         region_id prev_region;
         region_id next_region;
+        // client operations on the same key that this operation overwrote
+        // before either was sent down the chain; they commit when it does
+        std::vector<e::intrusive_ptr<pending> > subsumed;
 
     private:
         friend class e::intrusive_ptr<pending>;
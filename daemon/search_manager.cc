@@ -29,12 +29,14 @@
 
 // STL
 #include <algorithm>
+#include <list>
 #include <sstream>
 
 // Google Log
 #include <glog/logging.h>
 
 // e
+#include <e/atomic.h>
 #include <e/intrusive_ptr.h>
 #include <e/time.h>
 
@@ -105,6 +107,165 @@ search_manager :: id :: operator == (const id& rhs) const
            search_id == rhs.search_id;
 }
 
+////////////////////////////// Sorted Search Items /////////////////////////////
+
+namespace hyperdex
+{
+
+struct _sorted_search_params
+{
+    _sorted_search_params(const schema* _sc,
+                          uint16_t _sort_by,
+                          bool _maximize)
+        : sc(_sc), sort_by(_sort_by), maximize(_maximize) {}
+    ~_sorted_search_params() throw () {}
+    const schema* sc;
+    uint16_t sort_by;
+    bool maximize;
+
+    private:
+        _sorted_search_params(const _sorted_search_params&);
+        _sorted_search_params& operator = (const _sorted_search_params&);
+};
+
+struct _sorted_search_item
+{
+    _sorted_search_item(_sorted_search_params* p)
+        : params(p), key(), value(), version(), ref() {}
+    _sorted_search_item(const _sorted_search_item& other);
+    ~_sorted_search_item() throw () {}
+    _sorted_search_item& operator = (const _sorted_search_item& other);
+    _sorted_search_params* params;
+    e::slice key;
+    std::vector<e::slice> value;
+    uint64_t version;
+    datalayer::reference ref;
+};
+
+_sorted_search_item :: _sorted_search_item(const _sorted_search_item& other)
+    : params(other.params)
+    , key(other.key)
+    , value(other.value)
+    , version(other.version)
+    , ref(other.ref)
+{
+}
+
+_sorted_search_item&
+_sorted_search_item :: _sorted_search_item :: operator = (const _sorted_search_item& other)
+{
+    params = other.params;
+    key = other.key;
+    value = other.value;
+    version = other.version;
+    ref = other.ref;
+    return *this;
+}
+
+// compare by the sort attribute, and then by key so that the order is total
+// and matches the order the indices walk in
+static int
+compare_items(const _sorted_search_item& lhs, const _sorted_search_item& rhs)
+{
+    assert(lhs.params == rhs.params);
+    _sorted_search_params* params = lhs.params;
+    datatype_info* ki = datatype_info::lookup(params->sc->attrs[0].type);
+    int cmp = 0;
+
+    if (params->sort_by != 0)
+    {
+        datatype_info* di = datatype_info::lookup(params->sc->attrs[params->sort_by].type);
+        cmp = di->compare(lhs.value[params->sort_by - 1],
+                          rhs.value[params->sort_by - 1]);
+    }
+
+    if (cmp == 0)
+    {
+        cmp = ki->compare(lhs.key, rhs.key);
+    }
+
+    return cmp;
+}
+
+bool
+operator < (const _sorted_search_item& lhs, const _sorted_search_item& rhs)
+{
+    if (lhs.params->sort_by >= lhs.params->sc->attrs_sz)
+    {
+        return false;
+    }
+
+    int cmp = compare_items(lhs, rhs);
+
+    if (lhs.params->maximize)
+    {
+        return cmp < 0;
+    }
+    else
+    {
+        return cmp > 0;
+    }
+}
+
+bool
+operator > (const _sorted_search_item& lhs, const _sorted_search_item& rhs)
+{
+    if (lhs.params->sort_by >= lhs.params->sc->attrs_sz)
+    {
+        return false;
+    }
+
+    int cmp = compare_items(lhs, rhs);
+
+    if (lhs.params->maximize)
+    {
+        return cmp > 0;
+    }
+    else
+    {
+        return cmp < 0;
+    }
+}
+
+} // namespace hyperdex
+
+// keep the "limit" best objects from iter, best first; with after, only
+// objects that come after it count
+static void
+find_top_n(e::intrusive_ptr<hyperdex::datalayer::search_iterator> iter,
+           hyperdex::_sorted_search_params* params,
+           const hyperdex::_sorted_search_item* after,
+           uint64_t limit,
+           std::vector<hyperdex::_sorted_search_item>* top_n)
+{
+    using hyperdex::_sorted_search_item;
+
+    while (iter && iter->valid())
+    {
+        top_n->push_back(_sorted_search_item(params));
+        iter->unpack(&top_n->back().key, &top_n->back().value, &top_n->back().version, &top_n->back().ref);
+
+        if (after && !(*after > top_n->back()))
+        {
+            top_n->pop_back();
+            iter->next();
+            continue;
+        }
+
+        std::push_heap(top_n->begin(), top_n->end());
+
+        if (top_n->size() > limit)
+        {
+            std::pop_heap(top_n->begin(), top_n->end());
+            top_n->pop_back();
+        }
+
+        iter->next();
+    }
+
+    std::sort(top_n->begin(), top_n->end(), std::greater<_sorted_search_item>());
+}
+
 ///////////////////////////// Search Manager State /////////////////////////////
 
 class search_manager::state
@@ -112,15 +273,41 @@ class search_manager::state
     public:
         state(const region_id& region,
               std::auto_ptr<e::buffer> msg,
-              std::vector<attribute_check>* checks);
+              std::vector<attribute_check>* checks,
+              std::vector<uint16_t>* attrnums);
         ~state() throw ();
 
+    public:
+        // walk the objects of the search: from ordered when they were found
+        // up front, and from iter otherwise
+        bool valid();
+        datalayer::returncode unpack(e::slice* key,
+                                     std::vector<e::slice>* value,
+                                     std::list<datalayer::reference>* refs);
+        void next();
+
     public:
         po6::threads::mutex lock;
         const region_id region;
         const std::auto_ptr<e::buffer> backing;
         std::vector<attribute_check> checks;
-        e::intrusive_ptr<datalayer::iterator> iter;
+        // the attributes sent for each object, in order
+        std::vector<uint16_t> attrnums;
+        e::intrusive_ptr<datalayer::search_iterator> iter;
+        // e::time() of the last request; read and written atomically
+        uint64_t last_used;
+        // the bytes of the request this search holds on to
+        uint64_t buffered;
+        // set for a sorted search, which sends objects in sort order
+        bool sorted;
+        _sorted_search_params params;
+        // the search sends at most "batch" objects at a time (zero for the
+        // server's default) and "remaining" in total
+        uint64_t batch;
+        uint64_t remaining;
+        // the top objects, when no index walks the sort attribute in order
+        std::vector<_sorted_search_item> ordered;
+        size_t ordered_idx;
 
     private:
         friend class e::intrusive_ptr<state>;
@@ -135,26 +322,113 @@ class search_manager::state
 
 search_manager :: state :: state(const region_id& r,
                                  std::auto_ptr<e::buffer> msg,
-                                 std::vector<attribute_check>* c)
+                                 std::vector<attribute_check>* c,
+                                 std::vector<uint16_t>* a)
     : lock()
     , region(r)
     , backing(msg)
     , checks()
+    , attrnums()
     , iter()
+    , last_used(e::time())
+    , buffered(0)
+    , sorted(false)
+    , params(NULL, 0, false)
+    , batch(0)
+    , remaining(UINT64_MAX)
+    , ordered()
+    , ordered_idx(0)
     , m_ref(0)
 {
     checks.swap(*c);
+    attrnums.swap(*a);
 }
 
 search_manager :: state :: ~state() throw ()
 {
 }
 
+bool
+search_manager :: state :: valid()
+{
+    if (!iter)
+    {
+        return ordered_idx < ordered.size();
+    }
+
+    return iter->valid();
+}
+
+hyperdex::datalayer::returncode
+search_manager :: state :: unpack(e::slice* key,
+                                  std::vector<e::slice>* value,
+                                  std::list<datalayer::reference>* refs)
+{
+    if (!iter)
+    {
+        *key = ordered[ordered_idx].key;
+        *value = ordered[ordered_idx].value;
+        return datalayer::SUCCESS;
+    }
+
+    uint64_t version;
+    refs->push_back(datalayer::reference());
+    datalayer::returncode rc = iter->unpack(key, value, &version, &refs->back());
+
+    if (rc != datalayer::SUCCESS)
+    {
+        refs->pop_back();
+    }
+
+    return rc;
+}
+
+void
+search_manager :: state :: next()
+{
+    if (!iter)
+    {
+        ++ordered_idx;
+    }
+    else
+    {
+        iter->next();
+    }
+}
+
+//////////////////////////// Search Manager Parameters ///////////////////////////
+
+search_manager :: parameters :: parameters()
+    : batch_items(256)
+    , batch_bytes(1024 * 1024)
+    , lease(300)
+    , max_per_client(64)
+    , max_open(1024)
+{
+}
+
+search_manager :: parameters :: ~parameters() throw ()
+{
+}
+
 //////////////////////////////// Search Manager ////////////////////////////////
 
 search_manager :: search_manager(daemon* d)
     : m_daemon(d)
     , m_searches(10)
+    , m_batch_items(1)
+    , m_batch_bytes(0)
+    , m_lease(0)
+    , m_max_per_client(0)
+    , m_max_open(0)
+    , m_protect()
+    , m_open_per_client()
+    , m_open(0)
+    , m_open_per_region()
+    , m_buffer_bytes(0)
+    , m_region_bytes(0)
+    , m_perf_expired()
+    , m_perf_evicted()
 {
 }
 
@@ -163,8 +437,13 @@ search_manager :: ~search_manager() throw ()
 }
 
 bool
-search_manager :: setup()
+search_manager :: setup(const parameters& params)
 {
+    m_batch_items = std::max(params.batch_items, size_t(1));
+    m_batch_bytes = params.batch_bytes;
+    m_lease = params.lease * 1000000000ULL;
+    m_max_per_client = std::max(params.max_per_client, size_t(1));
+    m_max_open = std::max(params.max_open, size_t(1));
     return true;
 }
 
@@ -185,10 +464,26 @@ search_manager :: unpause()
 
 void
 search_manager :: reconfigure(const configuration&,
-                              const configuration&,
-                              const server_id&)
+                              const configuration& new_config,
+                              const server_id& us)
 {
-    // XXX cleanup dead or old searches
+    // searches over regions we no longer serve can never make progress
+    typedef e::lockfree_hash_map<id, e::intrusive_ptr<state>, hash> search_map_t;
+    std::vector<std::pair<id, e::intrusive_ptr<state> > > dead;
+
+    for (search_map_t::iterator it = m_searches.begin();
+            it != m_searches.end(); ++it)
+    {
+        if (new_config.get_virtual(it.key().region, us) == virtual_server_id())
+        {
+            dead.push_back(std::make_pair(it.key(), it.value()));
+        }
+    }
+
+    for (size_t i = 0; i < dead.size(); ++i)
+    {
+        drop(dead[i].first, dead[i].second);
+    }
 }
 
 void
@@ -197,10 +492,25 @@ search_manager :: start(const server_id& from,
                         std::auto_ptr<e::buffer> msg,
                         uint64_t nonce,
                         uint64_t search_id,
-                        std::vector<attribute_check>* checks)
+                        std::vector<attribute_check>* checks,
+                        uint64_t limit,
+                        uint64_t batch,
+                        std::vector<uint16_t>* attrnums)
 {
     region_id ri(m_daemon->m_config.get_region_id(to));
     id sid(ri, from, search_id);
+    const schema* sc = m_daemon->m_config.get_schema(ri);
+    assert(sc);
+
+    if (!sc->valid_projection(*attrnums))
+    {
+        LOG(WARNING) << "received request for search " << search_id << " from client "
+                     << from << " that names attributes not in the space";
+        std::auto_ptr<e::buffer> resp(e::buffer::create(HYPERDEX_HEADER_SIZE_VC + sizeof(uint64_t)));
+        resp->pack_at(HYPERDEX_HEADER_SIZE_VC) << nonce;
+        m_daemon->m_comm.send_client(to, from, RESP_SEARCH_DONE, resp);
+        return;
+    }
 
     if (m_searches.contains(sid))
     {
@@ -209,8 +519,11 @@ search_manager :: start(const server_id& from,
         return;
     }
 
-    e::intrusive_ptr<state> st = new state(ri, msg, checks);
+    make_room(from);
+    e::intrusive_ptr<state> st = new state(ri, msg, checks, attrnums);
     std::stable_sort(st->checks.begin(), st->checks.end());
+    st->batch = batch;
+    st->remaining = limit;
     datalayer::returncode rc = datalayer::SUCCESS;
     datalayer::snapshot snap = m_daemon->m_data.make_snapshot();
     st->iter = m_daemon->m_data.make_search_iterator(snap, ri, st->checks, NULL);
@@ -230,15 +543,121 @@ search_manager :: start(const server_id& from,
             abort();
     }
 
-    m_searches.insert(sid, st);
-    next(from, to, nonce, search_id);
+    st->buffered = st->backing->capacity();
+
+    track(sid, st);
+
+    if (!m_searches.insert(sid, st))
+    {
+        untrack(sid, st);
+        LOG(WARNING) << "received request for search " << search_id << " from client "
+                     << from << " but the search is already in progress";
+        return;
+    }
+
+    next(from, to, nonce, search_id, NULL);
+}
+
+void
+search_manager :: sorted_start(const server_id& from,
+                               const virtual_server_id& to,
+                               std::auto_ptr<e::buffer> msg,
+                               uint64_t nonce,
+                               uint64_t search_id,
+                               std::vector<attribute_check>* checks,
+                               uint64_t limit,
+                               uint16_t sort_by,
+                               bool maximize,
+                               uint64_t batch,
+                               const e::slice* after_value,
+                               const e::slice* after_key,
+                               std::vector<uint16_t>* attrnums)
+{
+    region_id ri(m_daemon->m_config.get_region_id(to));
+    id sid(ri, from, search_id);
+    const schema* sc = m_daemon->m_config.get_schema(ri);
+    assert(sc);
+    // a cursor must hold a valid key and sort value to compare against
+    bool valid_cursor = !after_key ||
+                        (sort_by < sc->attrs_sz &&
+                         datatype_info::lookup(sc->attrs[0].type)->validate(*after_key) &&
+                         datatype_info::lookup(sc->attrs[sort_by].type)->validate(*after_value));
+
+    if (!sc->valid_projection(*attrnums) || !valid_cursor)
+    {
+        LOG(WARNING) << "received sorted search " << search_id << " from client "
+                     << from << " that names attributes not in the space"
+                     << " or carries a corrupt cursor";
+        std::auto_ptr<e::buffer> resp(e::buffer::create(HYPERDEX_HEADER_SIZE_VC + sizeof(uint64_t)));
+        resp->pack_at(HYPERDEX_HEADER_SIZE_VC) << nonce;
+        m_daemon->m_comm.send_client(to, from, RESP_SEARCH_DONE, resp);
+        return;
+    }
+
+    if (m_searches.contains(sid))
+    {
+        LOG(WARNING) << "received sorted search " << search_id << " from client "
+                     << from << " but the search is already in progress";
+        return;
+    }
+
+    make_room(from);
+    e::intrusive_ptr<state> st = new state(ri, msg, checks, attrnums);
+    std::stable_sort(st->checks.begin(), st->checks.end());
+    st->sorted = true;
+    st->params.sc = sc;
+    st->params.sort_by = sort_by;
+    st->params.maximize = maximize;
+    st->batch = std::max(batch, uint64_t(1));
+    st->remaining = limit;
+    datalayer::snapshot snap = m_daemon->m_data.make_snapshot();
+    st->iter = m_daemon->m_data.make_sorted_iterator(snap, ri, st->checks, sort_by, maximize,
+                                                     after_value, after_key, NULL);
+
+    // without an index in sort order, the only way to know the best object is
+    // to look at all of them, so find the top objects now and send from those
+    if (!st->iter)
+    {
+        e::intrusive_ptr<datalayer::search_iterator> iter;
+        iter = m_daemon->m_data.make_search_iterator(snap, ri, st->checks, NULL);
+        std::auto_ptr<_sorted_search_item> after;
+
+        if (after_key)
+        {
+            after.reset(new _sorted_search_item(&st->params));
+            after->key = *after_key;
+            after->value.resize(sc->attrs_sz - 1);
+
+            if (sort_by > 0)
+            {
+                after->value[sort_by - 1] = *after_value;
+            }
+        }
+
+        find_top_n(iter, &st->params, after.get(), limit, &st->ordered);
+    }
+
+    st->buffered = st->backing->capacity();
+
+    track(sid, st);
+
+    if (!m_searches.insert(sid, st))
+    {
+        untrack(sid, st);
+        LOG(WARNING) << "received sorted search " << search_id << " from client "
+                     << from << " but the search is already in progress";
+        return;
+    }
+
+    next(from, to, nonce, search_id, NULL);
 }
 
 void
 search_manager :: next(const server_id& from,
                        const virtual_server_id& to,
                        uint64_t nonce,
-                       uint64_t search_id)
+                       uint64_t search_id,
+                       const e::slice* bound)
 {
     region_id ri(m_daemon->m_config.get_region_id(to));
     id sid(ri, from, search_id);
@@ -253,28 +672,102 @@ search_manager :: next(const server_id& from,
     }
 
     po6::threads::mutex::hold hold(&st->lock);
+    e::atomic::store_64_nobarrier(&st->last_used, e::time());
+    // the references own the memory behind the slices; a list never moves
+    // them, so the slices stay valid until the batch is packed
+    std::list<datalayer::reference> refs;
+    std::vector<std::pair<e::slice, std::vector<e::slice> > > items;
+    const schema* sc = m_daemon->m_config.get_schema(ri);
+    assert(sc);
+    size_t sz = HYPERDEX_HEADER_SIZE_VC
+              + sizeof(uint64_t)
+              + sizeof(uint8_t)
+              + sizeof(uint64_t);
+    // a limited search sends no more than the client can use
+    uint64_t batch = std::min(st->batch ? st->batch : m_batch_items, st->remaining);
+    datatype_info* sort_di = NULL;
+    bool pruned = false;
+
+    if (st->sorted && st->params.sort_by < sc->attrs_sz)
+    {
+        sort_di = datatype_info::lookup(sc->attrs[st->params.sort_by].type);
+    }
 
-    if (st->iter->valid())
+    // the bound comes from the client; comparing against a malformed one
+    // could read past its end, so such a bound prunes nothing
+    if (sort_di && bound && !sort_di->validate(*bound))
+    {
+        LOG(WARNING) << "received search next for " << search_id << " from client "
+                     << from << " with a corrupt bound; ignoring the bound";
+        bound = NULL;
+    }
+
+    while (items.size() < batch && st->valid())
     {
         e::slice key;
+        std::vector<e::slice> full;
         std::vector<e::slice> val;
-        uint64_t ver;
-        datalayer::reference tmp;
-        m_daemon->m_data.get_from_iterator(ri, st->iter.get(), &key, &val, &ver, &tmp);
-        size_t sz = HYPERDEX_HEADER_SIZE_VC
-                  + sizeof(uint64_t)
-                  + pack_size(key)
-                  + pack_size(val);
-        std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
-        msg->pack_at(HYPERDEX_HEADER_SIZE_VC) << nonce << key << val;
-        m_daemon->m_comm.send_client(to, from, RESP_SEARCH_ITEM, msg);
-        st->iter->next();
+        size_t refs_sz = refs.size();
+        datalayer::returncode rc = st->unpack(&key, &full, &refs);
+
+        if (rc != datalayer::SUCCESS)
+        {
+            LOG(ERROR) << "could not unpack search result for search "
+                       << search_id << ":  " << rc;
+            st->next();
+            continue;
+        }
+
+        // objects come in sort order, so once one cannot displace the
+        // client's k-th best object, none of the rest can either; objects
+        // that tie with it may still win on their keys
+        if (sort_di && bound)
+        {
+            const e::slice& attr(st->params.sort_by == 0 ? key : full[st->params.sort_by - 1]);
+            int cmp = sort_di->compare(attr, *bound);
+
+            if (st->params.maximize ? cmp < 0 : cmp > 0)
+            {
+                refs.resize(refs_sz);
+                pruned = true;
+                break;
+            }
+        }
+
+        sc->project(full, st->attrnums, &val);
+
+        size_t item_sz = pack_size(key) + pack_size(val);
+
+        // always send at least one object so that objects larger than the
+        // byte budget still make progress
+        if (!items.empty() && sz + item_sz > m_batch_bytes)
+        {
+            refs.resize(refs_sz);
+            break;
+        }
+
+        items.push_back(std::make_pair(key, val));
+        sz += item_sz;
+        st->next();
     }
-    else
+
+    st->remaining -= items.size();
+    bool done = pruned || !st->valid() || st->remaining == 0;
+    uint8_t flags = done ? 1 : 0;
+    uint64_t num_items = items.size();
+    std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
+    e::buffer::packer pa = msg->pack_at(HYPERDEX_HEADER_SIZE_VC);
+    pa = pa << nonce << flags << num_items;
+
+    for (size_t i = 0; i < items.size(); ++i)
+    {
+        pa = pa << items[i].first << items[i].second;
+    }
+
+    m_daemon->m_comm.send_client(to, from, RESP_SEARCH_BATCH, msg);
+
+    if (flags & 1)
     {
-        std::auto_ptr<e::buffer> msg(e::buffer::create(HYPERDEX_HEADER_SIZE_VC + sizeof(uint64_t)));
-        msg->pack_at(HYPERDEX_HEADER_SIZE_VC) << nonce;
-        m_daemon->m_comm.send_client(to, from, RESP_SEARCH_DONE, msg);
         stop(from, to, search_id);
     }
 }
@@ -286,134 +779,200 @@ search_manager :: stop(const server_id& from,
 {
     region_id ri(m_daemon->m_config.get_region_id(to));
     id sid(ri, from, search_id);
-    m_searches.remove(sid);
+    e::intrusive_ptr<state> st;
+
+    if (m_searches.lookup(sid, &st))
+    {
+        drop(sid, st);
+    }
 }
 
-namespace hyperdex
+void
+search_manager :: expire_idle()
 {
+    typedef e::lockfree_hash_map<id, e::intrusive_ptr<state>, hash> search_map_t;
+    const uint64_t now = e::time();
+    std::vector<std::pair<id, e::intrusive_ptr<state> > > idle;
 
-struct _sorted_search_params
-{
-    _sorted_search_params(const schema* _sc,
-                          uint16_t _sort_by,
-                          bool _maximize)
-        : sc(_sc), sort_by(_sort_by), maximize(_maximize) {}
-    ~_sorted_search_params() throw () {}
-    const schema* sc;
-    uint16_t sort_by;
-    bool maximize;
+    for (search_map_t::iterator it = m_searches.begin();
+            it != m_searches.end(); ++it)
+    {
+        e::intrusive_ptr<state> st = it.value();
+        uint64_t last_used = e::atomic::load_64_nobarrier(&st->last_used);
 
-    private:
-        _sorted_search_params(const _sorted_search_params&);
-        _sorted_search_params& operator = (const _sorted_search_params&);
-};
+        if (last_used + m_lease < now)
+        {
+            idle.push_back(std::make_pair(it.key(), st));
+        }
+    }
 
-struct _sorted_search_item
-{
-    _sorted_search_item(_sorted_search_params* p)
-        : params(p), key(), value(), version(), ref() {}
-    _sorted_search_item(const _sorted_search_item& other);
-    ~_sorted_search_item() throw () {}
-    _sorted_search_item& operator = (const _sorted_search_item& other);
-    _sorted_search_params* params;
-    e::slice key;
-    std::vector<e::slice> value;
-    uint64_t version;
-    datalayer::reference ref;
-};
+    for (size_t i = 0; i < idle.size(); ++i)
+    {
+        if (drop(idle[i].first, idle[i].second))
+        {
+            LOG(INFO) << "search " << idle[i].first.search_id
+                      << " from client " << idle[i].first.client
+                      << " expired after its lease ran out";
+            m_perf_expired.tap();
+        }
+    }
+}
 
-_sorted_search_item :: _sorted_search_item(const _sorted_search_item& other)
-    : params(other.params)
-    , key(other.key)
-    , value(other.value)
-    , version(other.version)
-    , ref(other.ref)
+uint64_t
+search_manager :: open_searches()
 {
+    po6::threads::mutex::hold hold(&m_protect);
+    return m_open;
 }
 
-_sorted_search_item&
-_sorted_search_item :: _sorted_search_item :: operator = (const _sorted_search_item& other)
+uint64_t
+search_manager :: buffer_bytes()
 {
-    params = other.params;
-    key = other.key;
-    value = other.value;
-    version = other.version;
-    ref = other.ref;
-    return *this;
+    po6::threads::mutex::hold hold(&m_protect);
+    return m_buffer_bytes;
 }
 
-bool
-operator < (const _sorted_search_item& lhs, const _sorted_search_item& rhs)
+uint64_t
+search_manager :: region_bytes()
 {
-    assert(lhs.params == rhs.params);
-    _sorted_search_params* params = lhs.params;
+    po6::threads::mutex::hold hold(&m_protect);
+    return m_region_bytes;
+}
 
-    if (params->sort_by >= params->sc->attrs_sz)
+void
+search_manager :: make_room(const server_id& client)
+{
+    while (true)
     {
-        return false;
+        bool client_full = false;
+        bool server_full = false;
+
+        {
+            po6::threads::mutex::hold hold(&m_protect);
+            std::map<server_id, size_t>::iterator it = m_open_per_client.find(client);
+            client_full = it != m_open_per_client.end() &&
+                          it->second >= m_max_per_client;
+            server_full = m_open >= m_max_open;
+        }
+
+        if (!client_full && !server_full)
+        {
+            return;
+        }
+
+        if (!evict_lru(client, !client_full))
+        {
+            return;
+        }
     }
+}
 
-    int cmp = 0;
+bool
+search_manager :: evict_lru(const server_id& client, bool any_client)
+{
+    typedef e::lockfree_hash_map<id, e::intrusive_ptr<state>, hash> search_map_t;
+    bool found = false;
+    id victim(region_id(), server_id(), 0);
+    e::intrusive_ptr<state> victim_st;
+    uint64_t victim_last_used = 0;
+
+    for (search_map_t::iterator it = m_searches.begin();
+            it != m_searches.end(); ++it)
+    {
+        if (!any_client && it.key().client != client)
+        {
+            continue;
+        }
+
+        e::intrusive_ptr<state> st = it.value();
+        uint64_t last_used = e::atomic::load_64_nobarrier(&st->last_used);
+
+        if (!found || last_used < victim_last_used)
+        {
+            found = true;
+            victim = it.key();
+            victim_st = st;
+            victim_last_used = last_used;
+        }
+    }
 
-    if (params->sort_by == 0)
+    if (!found)
     {
-        datatype_info* di = datatype_info::lookup(params->sc->attrs[0].type);
-        cmp = di->compare(lhs.key, rhs.key);
+        return false;
     }
-    else
+
+    if (drop(victim, victim_st))
     {
-        datatype_info* di = datatype_info::lookup(params->sc->attrs[params->sort_by].type);
-        cmp = di->compare(lhs.value[params->sort_by - 1],
-                          rhs.value[params->sort_by - 1]);
+        LOG(INFO) << "evicted search " << victim.search_id
+                  << " from client " << victim.client
+                  << " to stay within the limit on open searches";
+        m_perf_evicted.tap();
     }
 
-    if (params->maximize)
+    return true;
+}
+
+void
+search_manager :: track(const id& sid, const e::intrusive_ptr<state>& st)
+{
+    // sampled before taking the lock; only used if this is the region's
+    // first open search
+    uint64_t size = m_daemon->m_data.sampled_size(st->region);
+    po6::threads::mutex::hold hold(&m_protect);
+    ++m_open_per_client[sid.client];
+    ++m_open;
+    m_buffer_bytes += st->buffered;
+    std::map<region_id, std::pair<size_t, uint64_t> >::iterator it;
+    it = m_open_per_region.find(st->region);
+
+    if (it == m_open_per_region.end())
     {
-        return cmp < 0;
+        m_open_per_region.insert(std::make_pair(st->region, std::make_pair(1, size)));
+        m_region_bytes += size;
     }
     else
     {
-        return cmp > 0;
+        ++it->second.first;
     }
 }
 
 bool
-operator > (const _sorted_search_item& lhs, const _sorted_search_item& rhs)
+search_manager :: drop(const id& sid, const e::intrusive_ptr<state>& st)
 {
-    assert(lhs.params == rhs.params);
-    _sorted_search_params* params = lhs.params;
-
-    if (params->sort_by >= params->sc->attrs_sz)
+    if (!m_searches.remove(sid))
     {
         return false;
     }
 
-    int cmp = 0;
+    untrack(sid, st);
+    return true;
+}
 
-    if (params->sort_by == 0)
-    {
-        datatype_info* di = datatype_info::lookup(params->sc->attrs[0].type);
-        cmp = di->compare(lhs.key, rhs.key);
-    }
-    else
-    {
-        datatype_info* di = datatype_info::lookup(params->sc->attrs[params->sort_by].type);
-        cmp = di->compare(lhs.value[params->sort_by - 1],
-                          rhs.value[params->sort_by - 1]);
-    }
+void
+search_manager :: untrack(const id& sid, const e::intrusive_ptr<state>& st)
+{
+    po6::threads::mutex::hold hold(&m_protect);
+    std::map<server_id, size_t>::iterator it = m_open_per_client.find(sid.client);
+    assert(it != m_open_per_client.end());
 
-    if (params->maximize)
+    if (--it->second == 0)
     {
-        return cmp > 0;
+        m_open_per_client.erase(it);
     }
-    else
+
+    --m_open;
+    m_buffer_bytes -= st->buffered;
+    std::map<region_id, std::pair<size_t, uint64_t> >::iterator rit;
+    rit = m_open_per_region.find(st->region);
+    assert(rit != m_open_per_region.end());
+
+    if (--rit->second.first == 0)
     {
-        return cmp < 0;
+        m_region_bytes -= rit->second.second;
+        m_open_per_region.erase(rit);
     }
 }
 
-} // namespace hyperdex
-
 void
 search_manager :: sorted_search(const server_id& from,
                                 const virtual_server_id& to,
@@ -421,14 +980,24 @@ search_manager :: sorted_search(const server_id& from,
                                 std::vector<attribute_check>* checks,
                                 uint64_t limit,
                                 uint16_t sort_by,
-                                bool maximize)
+                                bool maximize,
+                                std::vector<uint16_t>* attrnums)
 {
     region_id ri(m_daemon->m_config.get_region_id(to));
     std::stable_sort(checks->begin(), checks->end());
     datalayer::returncode rc = datalayer::SUCCESS;
     datalayer::snapshot snap = m_daemon->m_data.make_snapshot();
-    e::intrusive_ptr<datalayer::iterator> iter;
-    iter = m_daemon->m_data.make_search_iterator(snap, ri, *checks, NULL);
+    e::intrusive_ptr<datalayer::search_iterator> iter;
+    // when an index walks sort_by in order, the first limit matches are the
+    // answer; otherwise every match goes through the heap
+    iter = m_daemon->m_data.make_sorted_iterator(snap, ri, *checks, sort_by, maximize, NULL, NULL, NULL);
+    bool in_order = true;
+
+    if (!iter)
+    {
+        in_order = false;
+        iter = m_daemon->m_data.make_search_iterator(snap, ri, *checks, NULL);
+    }
 
     switch (rc)
     {
@@ -451,26 +1020,33 @@ search_manager :: sorted_search(const server_id& from,
     std::vector<_sorted_search_item> top_n;
     top_n.reserve(limit);
 
-    while (iter->valid())
+    if (!sc->valid_projection(*attrnums))
     {
-        top_n.push_back(_sorted_search_item(&params));
-        m_daemon->m_data.get_from_iterator(ri, iter.get(), &top_n.back().key, &top_n.back().value, &top_n.back().version, &top_n.back().ref);
-        std::push_heap(top_n.begin(), top_n.end());
-
-        if (top_n.size() > limit)
-        {
-            std::pop_heap(top_n.begin(), top_n.end());
-            top_n.pop_back();
-        }
+        LOG(WARNING) << "received sorted search from client " << from
+                     << " that names attributes not in the space";
+        iter = e::intrusive_ptr<datalayer::search_iterator>();
+    }
 
+    while (in_order && iter && iter->valid() && top_n.size() < limit)
+    {
+        top_n.push_back(_sorted_search_item(&params));
+        iter->unpack(&top_n.back().key, &top_n.back().value, &top_n.back().version, &top_n.back().ref);
         iter->next();
     }
 
-    std::sort(top_n.begin(), top_n.end(), std::greater<_sorted_search_item>());
+    if (!in_order)
+    {
+        find_top_n(iter, &params, NULL, limit, &top_n);
+    }
+
     size_t sz = HYPERDEX_HEADER_SIZE_VC + sizeof(uint64_t) + sizeof(uint64_t);
 
+    // sorting needs the whole value; only the projection is sent
     for (size_t i = 0; i < top_n.size(); ++i)
     {
+        std::vector<e::slice> projected;
+        sc->project(top_n[i].value, *attrnums, &projected);
+        top_n[i].value.swap(projected);
         sz += pack_size(top_n[i].key) + pack_size(top_n[i].value);
     }
 
@@ -499,7 +1075,7 @@ search_manager :: group_keyop(const server_id& from,
     std::stable_sort(checks->begin(), checks->end());
     datalayer::returncode rc = datalayer::SUCCESS;
     datalayer::snapshot snap = m_daemon->m_data.make_snapshot();
-    e::intrusive_ptr<datalayer::iterator> iter;
+    e::intrusive_ptr<datalayer::search_iterator> iter;
     iter = m_daemon->m_data.make_search_iterator(snap, ri, *checks, NULL);
     uint64_t result = 0;
 
@@ -521,11 +1097,7 @@ search_manager :: group_keyop(const server_id& from,
 
     while (iter->valid() && result < UINT64_MAX)
     {
-        e::slice key;
-        std::vector<e::slice> val;
-        uint64_t ver;
-        datalayer::reference tmp;
-        m_daemon->m_data.get_from_iterator(ri, iter.get(), &key, &val, &ver, &tmp);
+        e::slice key = iter->key();
         size_t sz = HYPERDEX_HEADER_SIZE_SV // SV because we imitate a client
                   + sizeof(uint64_t)
                   + pack_size(key)
@@ -562,7 +1134,7 @@ search_manager :: count(const server_id& from,
     std::stable_sort(checks->begin(), checks->end());
     datalayer::returncode rc = datalayer::SUCCESS;
     datalayer::snapshot snap = m_daemon->m_data.make_snapshot();
-    e::intrusive_ptr<datalayer::iterator> iter;
+    e::intrusive_ptr<datalayer::search_iterator> iter;
     iter = m_daemon->m_data.make_search_iterator(snap, ri, *checks, NULL);
     uint64_t result = 0;
 
@@ -611,7 +1183,7 @@ search_manager :: search_describe(const server_id& from,
     datalayer::snapshot snap = m_daemon->m_data.make_snapshot();
     uint64_t t_end = e::time();
     ostr << " snapshot took " << t_end - t_start << "ns\n";
-    e::intrusive_ptr<datalayer::iterator> iter;
+    e::intrusive_ptr<datalayer::search_iterator> iter;
     t_start = e::time();
     iter = m_daemon->m_data.make_search_iterator(snap, ri, *checks, &ostr);
     t_end = e::time();
@@ -28,6 +28,12 @@
 #ifndef hyperdex_daemon_search_manager_h_
 #define hyperdex_daemon_search_manager_h_
 
+// STL
+#include <map>
+
+// po6
+#include <po6/threads/mutex.h>
+
 // e
 #include <e/intrusive_ptr.h>
 #include <e/lockfree_hash_map.h>
@@ -37,6 +43,7 @@
 #include "common/ids.h"
 #include "common/network_msgtype.h"
 #include "daemon/datalayer.h"
+#include "daemon/performance_counter.h"
 #include "daemon/reconfigure_returncode.h"
 
 BEGIN_HYPERDEX_NAMESPACE
@@ -44,12 +51,15 @@ class daemon;
 
 class search_manager
 {
+    public:
+        class parameters;
+
     public:
         search_manager(daemon*);
         ~search_manager() throw ();
 
     public:
-        bool setup();
+        bool setup(const parameters& params);
         void teardown();
         void pause();
         void unpause();
@@ -58,16 +68,40 @@ class search_manager
                          const server_id& us);
 
     public:
+        // the search sends at most limit objects, "batch" at a time, where a
+        // batch of zero uses the server's default
         void start(const server_id& from,
                    const virtual_server_id& to,
                    std::auto_ptr<e::buffer> msg,
                    uint64_t nonce,
                    uint64_t search_id,
-                   std::vector<attribute_check>* checks);
+                   std::vector<attribute_check>* checks,
+                   uint64_t limit,
+                   uint64_t batch,
+                   std::vector<uint16_t>* attrnums);
+        // like start, but the objects come in sort order, and the search
+        // sends at most limit of them, "batch" at a time; if after_key is
+        // not NULL, it starts after the object with that key and sort value
+        void sorted_start(const server_id& from,
+                          const virtual_server_id& to,
+                          std::auto_ptr<e::buffer> msg,
+                          uint64_t nonce,
+                          uint64_t search_id,
+                          std::vector<attribute_check>* checks,
+                          uint64_t limit,
+                          uint16_t sort_by,
+                          bool maximize,
+                          uint64_t batch,
+                          const e::slice* after_value,
+                          const e::slice* after_key,
+                          std::vector<uint16_t>* attrnums);
+        // for a sorted search, bound (if not NULL) is the client's current
+        // k-th best value; the search ends at the first object not better
         void next(const server_id& from,
                   const virtual_server_id& to,
                   uint64_t nonce,
-                  uint64_t search_id);
+                  uint64_t search_id,
+                  const e::slice* bound);
         void stop(const server_id& from,
                   const virtual_server_id& to,
                   uint64_t search_id);
@@ -77,7 +111,8 @@ class search_manager
                            std::vector<attribute_check>* checks,
                            uint64_t limit,
                            uint16_t sort_by,
-                           bool maximize);
+                           bool maximize,
+                           std::vector<uint16_t>* attrnums);
         void group_keyop(const server_id& from,
                          const virtual_server_id& to,
                          uint64_t nonce,
@@ -94,6 +129,21 @@ class search_manager
                              uint64_t nonce,
                              std::vector<attribute_check>* checks);
 
+    // session management
+    public:
+        // drop every search that has been idle longer than the lease
+        void expire_idle();
+        uint64_t open_searches();
+        // the request buffers held by open searches
+        uint64_t buffer_bytes();
+        // an estimate, not a measurement, of the data open searches keep
+        // from being compacted: the sampled size of every region with an
+        // open search, counted once however many searches it has, as of
+        // its first search.  Regions not yet sampled count as zero.
+        uint64_t region_bytes();
+        uint64_t expired_searches() { return m_perf_expired.read(); }
+        uint64_t evicted_searches() { return m_perf_evicted.read(); }
+
     private:
         class id;
         class state;
@@ -105,9 +155,52 @@ class search_manager
     private:
         static uint64_t hash(const id&);
 
+    private:
+        // make room for one more search from "client", evicting the least
+        // recently used searches if it is over either cap
+        void make_room(const server_id& client);
+        bool evict_lru(const server_id& client, bool any_client);
+        void track(const id& sid, const e::intrusive_ptr<state>& st);
+        void untrack(const id& sid, const e::intrusive_ptr<state>& st);
+        // returns true if this call removed the search
+        bool drop(const id& sid, const e::intrusive_ptr<state>& st);
+
     private:
         daemon* m_daemon;
         e::lockfree_hash_map<id, e::intrusive_ptr<state>, hash> m_searches;
+        size_t m_batch_items;
+        size_t m_batch_bytes;
+        uint64_t m_lease;
+        size_t m_max_per_client;
+        size_t m_max_open;
+        // accounting for searches in m_searches
+        po6::threads::mutex m_protect;
+        std::map<server_id, size_t> m_open_per_client;
+        uint64_t m_open;
+        // per region: its open searches, and its size when the first opened
+        std::map<region_id, std::pair<size_t, uint64_t> > m_open_per_region;
+        uint64_t m_buffer_bytes;
+        uint64_t m_region_bytes;
+        performance_counter m_perf_expired;
+        performance_counter m_perf_evicted;
+};
+
+class search_manager::parameters
+{
+    public:
+        parameters();
+        ~parameters() throw ();
+
+    public:
+        // each RESP_SEARCH_BATCH carries at most this many objects/bytes
+        size_t batch_items;
+        size_t batch_bytes;
+        // searches idle for longer than this many seconds are dropped
+        uint64_t lease;
+        // caps on open searches; the least recently used search is evicted
+        // to make room for a new one
+        size_t max_per_client;
+        size_t max_open;
 };
 
 END_HYPERDEX_NAMESPACE
@@ -37,11 +37,18 @@
 // po6
 #include <po6/threads/mutex.h>
 
+// e
+#include <e/array_ptr.h>
+#include <e/compat.h>
+
 // HyperDex
 #include "namespace.h"
 
 BEGIN_HYPERDEX_NAMESPACE
 
+// The table is split into independently locked stripes, chosen by the hash of
+// the key, so that threads working on different keys rarely share a mutex.
+//
 // Only one iterator may be used at a time
 
 template <typename K, typename T>
@@ -52,14 +59,16 @@ class state_hash_table
         class iterator;
 
     public:
-        state_hash_table();
+        static const size_t DEFAULT_STRIPES = 64;
+
+    public:
+        // "stripes" is rounded up to a power of two
+        state_hash_table(size_t stripes = DEFAULT_STRIPES);
         ~state_hash_table() throw ();
 
     public:
-        void set_empty_key(const K& k)
-        { m_state_map->set_empty_key(k); }
-        void set_deleted_key(const K& k)
-        { m_state_map->set_deleted_key(k); }
+        void set_empty_key(const K& k);
+        void set_deleted_key(const K& k);
 
     public:
         T* create_state(const K& key, state_reference* sr);
@@ -69,14 +78,43 @@ class state_hash_table
     private:
         typedef std::list<e::intrusive_ptr<T> > state_list_t;
         typedef google::dense_hash_map<K, typename state_list_t::iterator> state_map_t;
+        class stripe;
 
     private:
-        po6::threads::mutex m_mtx;
-        const std::auto_ptr<state_map_t> m_state_map;
-        const std::auto_ptr<state_list_t> m_state_list;
-        typename state_list_t::iterator m_itl;
-        bool m_itl_erased;
+        stripe* get_stripe(const K& key);
+
+    private:
+        size_t m_stripes_sz;
+        unsigned m_stripes_shift;
+        e::array_ptr<stripe> m_stripes;
+        po6::threads::mutex m_iter_mtx;
         bool m_iterating;
+
+    private:
+        state_hash_table(const state_hash_table&);
+        state_hash_table& operator = (const state_hash_table&);
+};
+
+template <typename K, typename T>
+class state_hash_table<K, T>::stripe
+{
+    public:
+        stripe();
+        ~stripe() throw ();
+
+    public:
+        po6::threads::mutex mtx;
+        state_map_t state_map;
+        state_list_t state_list;
+        // the iterator's position within this stripe
+        typename state_list_t::iterator itl;
+        bool itl_erased;
+        // keep neighboring stripes' mutexes off of this stripe's cache lines
+        char padding[64];
+
+    private:
+        stripe(const stripe&);
+        stripe& operator = (const stripe&);
 };
 
 template <typename K, typename T>
@@ -119,6 +157,7 @@ class state_hash_table<K, T>::iterator
         state_hash_table* m_sht;
         state_reference m_sr;
         T* m_ptr;
+        size_t m_stripe;
         bool m_primed;
         bool m_valid;
 
@@ -128,26 +167,88 @@ class state_hash_table<K, T>::iterator
 };
 
 template <typename K, typename T>
-state_hash_table<K, T> :: state_hash_table()
-    : m_mtx()
-    , m_state_map(new state_map_t())
-    , m_state_list(new state_list_t())
-    , m_itl(m_state_list->begin())
-    , m_itl_erased(false)
+state_hash_table<K, T> :: stripe :: stripe()
+    : mtx()
+    , state_map()
+    , state_list()
+    , itl(state_list.end())
+    , itl_erased(false)
+{
+}
+
+template <typename K, typename T>
+state_hash_table<K, T> :: stripe :: ~stripe() throw ()
+{
+}
+
+template <typename K, typename T>
+state_hash_table<K, T> :: state_hash_table(size_t stripes)
+    : m_stripes_sz(1)
+    , m_stripes_shift(64)
+    , m_stripes()
+    , m_iter_mtx()
     , m_iterating(false)
 {
+    while (m_stripes_sz < stripes)
+    {
+        m_stripes_sz *= 2;
+        --m_stripes_shift;
+    }
+
+    m_stripes = new stripe[m_stripes_sz];
 }
 
 template <typename K, typename T>
 state_hash_table<K, T> :: ~state_hash_table() throw ()
 {
-    po6::threads::mutex::hold hold(&m_mtx);
+    for (size_t i = 0; i < m_stripes_sz; ++i)
+    {
+        po6::threads::mutex::hold hold(&m_stripes[i].mtx);
+    }
+}
+
+template <typename K, typename T>
+void
+state_hash_table<K, T> :: set_empty_key(const K& k)
+{
+    for (size_t i = 0; i < m_stripes_sz; ++i)
+    {
+        m_stripes[i].state_map.set_empty_key(k);
+    }
+}
+
+template <typename K, typename T>
+void
+state_hash_table<K, T> :: set_deleted_key(const K& k)
+{
+    for (size_t i = 0; i < m_stripes_sz; ++i)
+    {
+        m_stripes[i].state_map.set_deleted_key(k);
+    }
+}
+
+template <typename K, typename T>
+typename state_hash_table<K, T>::stripe*
+state_hash_table<K, T> :: get_stripe(const K& key)
+{
+    if (m_stripes_sz == 1)
+    {
+        return &m_stripes[0];
+    }
+
+    // the dense_hash_map inside each stripe picks buckets with the low bits
+    // of the hash, so mix the hash and select the stripe with the high bits
+    uint64_t h = e::compat::hash<K>()(key);
+    h *= 0x9e3779b97f4a7c15ULL;
+    return &m_stripes[h >> m_stripes_shift];
 }
 
 template <typename K, typename T>
 T*
 state_hash_table<K, T> :: create_state(const K& key, state_reference* sr)
 {
+    stripe* s = get_stripe(key);
+
     while (true)
     {
         e::intrusive_ptr<T> t = new T(key);
@@ -155,10 +256,15 @@ state_hash_table<K, T> :: create_state(const K& key, state_reference* sr)
         std::pair<typename state_map_t::iterator, bool> inserted;
 
         {
-            po6::threads::mutex::hold hold(&m_mtx);
+            po6::threads::mutex::hold hold(&s->mtx);
             typename state_list_t::iterator it;
-            it = m_state_list->insert(m_state_list->end(), t);
-            inserted = m_state_map->insert(std::make_pair(t->state_key(), it));
+            it = s->state_list.insert(s->state_list.end(), t);
+            inserted = s->state_map.insert(std::make_pair(t->state_key(), it));
+
+            if (!inserted.second)
+            {
+                s->state_list.erase(it);
+            }
         }
 
         if (!inserted.second)
@@ -175,15 +281,17 @@ template <typename K, typename T>
 T*
 state_hash_table<K, T> :: get_state(const K& key, state_reference* sr)
 {
+    stripe* s = get_stripe(key);
+
     while (true)
     {
         e::intrusive_ptr<T> t;
 
         {
-            po6::threads::mutex::hold hold(&m_mtx);
-            typename state_map_t::iterator it = m_state_map->find(key);
+            po6::threads::mutex::hold hold(&s->mtx);
+            typename state_map_t::iterator it = s->state_map.find(key);
 
-            if (it == m_state_map->end())
+            if (it == s->state_map.end())
             {
                 return NULL;
             }
@@ -207,21 +315,23 @@ template <typename K, typename T>
 T*
 state_hash_table<K, T> :: get_or_create_state(const K& key, state_reference* sr)
 {
+    stripe* s = get_stripe(key);
+
     while (true)
     {
         e::intrusive_ptr<T> t;
 
         {
-            po6::threads::mutex::hold hold(&m_mtx);
-            typename state_map_t::iterator it = m_state_map->find(key);
+            po6::threads::mutex::hold hold(&s->mtx);
+            typename state_map_t::iterator it = s->state_map.find(key);
 
-            if (it == m_state_map->end())
+            if (it == s->state_map.end())
             {
                 t = new T(key);
                 typename state_list_t::iterator itl;
-                itl = m_state_list->insert(m_state_list->end(), t);
+                itl = s->state_list.insert(s->state_list.end(), t);
                 std::pair<typename state_map_t::iterator, bool> inserted;
-                inserted = m_state_map->insert(std::make_pair(t->state_key(), itl));
+                inserted = s->state_map.insert(std::make_pair(t->state_key(), itl));
                 assert(inserted.second);
             }
             else
@@ -277,10 +387,10 @@ state_hash_table<K, T> :: state_reference :: unlock()
 {
     assert(m_locked);
     // so we need to prevent a deadlock with cycle
-    // state_hash_table::m_mtx -> m_state->lock ->
+    // stripe::mtx -> m_state->lock ->
     //
     // To do this, we mark garbage on key_state, release the lock, grab
-    // replication_manager::m_key_states_lock and destroy the object.
+    // the stripe's lock and destroy the object.
     // Everyone else will spin without holding a lock on the key state.
     bool we_collect = m_state->finished() && !m_state->marked_garbage();
 
@@ -293,20 +403,21 @@ state_hash_table<K, T> :: state_reference :: unlock()
 
     if (we_collect)
     {
-        po6::threads::mutex::hold hold(&m_sht->m_mtx);
+        stripe* s = m_sht->get_stripe(m_state->state_key());
+        po6::threads::mutex::hold hold(&s->mtx);
         typename state_map_t::iterator itm;
-        itm = m_sht->m_state_map->find(m_state->state_key());
+        itm = s->state_map.find(m_state->state_key());
         typename state_list_t::iterator itl;
-        bool erase_iterator = itm->second == m_sht->m_itl;
-        itl = m_sht->m_state_list->erase(itm->second);
+        bool erase_iterator = itm->second == s->itl;
+        itl = s->state_list.erase(itm->second);
 
         if (erase_iterator)
         {
-            m_sht->m_itl = itl;
-            m_sht->m_itl_erased = true;
+            s->itl = itl;
+            s->itl_erased = true;
         }
 
-        m_sht->m_state_map->erase(itm);
+        s->state_map.erase(itm);
     }
 
     m_sht = NULL;
@@ -319,14 +430,20 @@ state_hash_table<K, T> :: iterator :: iterator(state_hash_table* sht)
     : m_sht(sht)
     , m_sr()
     , m_ptr(NULL)
+    , m_stripe(0)
     , m_primed(false)
     , m_valid(false)
 {
-    po6::threads::mutex::hold hold(&m_sht->m_mtx);
-    assert(!m_sht->m_iterating);
-    m_sht->m_iterating = true;
-    m_sht->m_itl = m_sht->m_state_list->begin();
-    m_sht->m_itl_erased = false;
+    {
+        po6::threads::mutex::hold hold(&m_sht->m_iter_mtx);
+        assert(!m_sht->m_iterating);
+        m_sht->m_iterating = true;
+    }
+
+    stripe* s = &m_sht->m_stripes[0];
+    po6::threads::mutex::hold hold(&s->mtx);
+    s->itl = s->state_list.begin();
+    s->itl_erased = false;
 }
 
 template <typename K, typename T>
@@ -337,7 +454,7 @@ state_hash_table<K, T> :: iterator :: ~iterator() throw ()
         m_sr.unlock();
     }
 
-    po6::threads::mutex::hold hold(&m_sht->m_mtx);
+    po6::threads::mutex::hold hold(&m_sht->m_iter_mtx);
     assert(m_sht->m_iterating);
     m_sht->m_iterating = false;
 }
@@ -381,31 +498,41 @@ state_hash_table<K, T> :: iterator :: prime(bool inc)
         m_ptr = NULL;
     }
 
-    while (true)
+    while (m_stripe < m_sht->m_stripes_sz)
     {
         e::intrusive_ptr<T> t;
 
         {
-            po6::threads::mutex::hold hold(&m_sht->m_mtx);
+            stripe* s = &m_sht->m_stripes[m_stripe];
+            po6::threads::mutex::hold hold(&s->mtx);
 
-            if (m_sht->m_itl == m_sht->m_state_list->end())
+            if (s->itl != s->state_list.end() && inc && !s->itl_erased)
             {
-                return;
+                ++s->itl;
             }
 
-            if (inc && !m_sht->m_itl_erased)
+            inc = false;
+            s->itl_erased = false;
+
+            if (s->itl != s->state_list.end())
             {
-                ++(m_sht->m_itl);
+                t = *s->itl;
+            }
+        }
+
+        if (!t)
+        {
+            ++m_stripe;
 
-                if (m_sht->m_itl == m_sht->m_state_list->end())
-                {
-                    return;
-                }
+            if (m_stripe < m_sht->m_stripes_sz)
+            {
+                stripe* s = &m_sht->m_stripes[m_stripe];
+                po6::threads::mutex::hold hold(&s->mtx);
+                s->itl = s->state_list.begin();
+                s->itl_erased = false;
             }
 
-            inc = false;
-            m_sht->m_itl_erased = false;
-            t = *m_sht->m_itl;
+            continue;
         }
 
         m_sr.lock(m_sht, t);
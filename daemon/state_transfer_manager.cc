@@ -27,22 +27,46 @@
 
 // POSIX
 #include <signal.h>
+#include <time.h>
 
 // STL
 #include <algorithm>
+#include <set>
 
 // Google Log
 #include <glog/logging.h>
 
+// e
+#include <e/endian.h>
+#include <e/time.h>
+
 // HyperDex
 #include "common/serialization.h"
+#include "cityhash/city.h"
 #include "daemon/daemon.h"
 #include "daemon/datalayer_iterator.h"
+#include "daemon/region_tree.h"
 #include "daemon/state_transfer_manager.h"
+#include "daemon/state_transfer_manager_chunk.h"
 #include "daemon/state_transfer_manager_pending.h"
 #include "daemon/state_transfer_manager_transfer_in_state.h"
 #include "daemon/state_transfer_manager_transfer_out_state.h"
 
+// objects and bytes packed into one XFER_OP
+#define XFER_BATCH_OBJECTS 256
+#define XFER_BATCH_BYTES (1ULL << 20)
+// objects in flight per transfer; the window starts at one batch and grows
+// with every ack, as with slow start
+#define XFER_WINDOW_MAX 16384
+// objects applied per write on the receiving end
+#define XFER_WRITE_OBJECTS 4096
+// raw entries and bytes per XFER_CHUNK, and chunks in flight per transfer
+#define XFER_CHUNK_ENTRIES 16384
+#define XFER_CHUNK_BYTES (4ULL << 20)
+#define XFER_CHUNK_WINDOW 8
+// how often the kickstarter revisits transfers that the throttle held back
+#define XFER_PACE_INTERVAL (10ULL * 1000ULL * 1000ULL)
+
 using po6::threads::make_thread_wrapper;
 using hyperdex::reconfigure_returncode;
 using hyperdex::state_transfer_manager;
@@ -57,9 +81,20 @@ state_transfer_manager :: state_transfer_manager(daemon* d)
     , m_wakeup_kickstarter(&m_block_kickstarter)
     , m_wakeup_reconfigurer(&m_block_kickstarter)
     , m_need_kickstart(false)
+    , m_throttled(0)
     , m_shutdown(true)
     , m_need_pause(false)
     , m_paused(false)
+    , m_perf_objects_sent()
+    , m_perf_bytes_sent()
+    , m_perf_objects_retransmitted()
+    , m_perf_objects_received()
+    , m_perf_bytes_received()
+    , m_perf_batches_written()
+    , m_perf_chunks_sent()
+    , m_perf_chunks_received()
+    , m_perf_trees_compared()
+    , m_perf_leaves_differing()
 {
 }
 
@@ -203,7 +238,8 @@ state_transfer_manager :: handshake_syn(const virtual_server_id& from,
 
     uint64_t timestamp = 0;
     m_daemon->m_data.largest_checkpoint_for(tis->xfer.rid, &timestamp);
-    send_handshake_synack(tis->xfer, timestamp);
+    bool has_objects = m_daemon->m_data.has_objects(tis->xfer.rid);
+    send_handshake_synack(tis->xfer, timestamp, has_objects);
     LOG(INFO) << "received handshake_syn for " << xid;
 }
 
@@ -211,7 +247,8 @@ void
 state_transfer_manager :: handshake_synack(const server_id& from,
                                            const virtual_server_id& to,
                                            const transfer_id& xid,
-                                           uint64_t timestamp)
+                                           uint64_t timestamp,
+                                           bool has_objects)
 {
     transfer_out_state* tos = get_tos(xid);
 
@@ -229,21 +266,66 @@ state_transfer_manager :: handshake_synack(const server_id& from,
         return;
     }
 
+    if (tos->handshake_syn)
+    {
+        // a duplicate; starting over would renumber what's in flight
+        return;
+    }
+
     bool wipe = false;
     std::auto_ptr<datalayer::replay_iterator> iter;
     iter.reset(m_daemon->m_data.replay_region_from_checkpoint(tos->xfer.rid, timestamp, &wipe));
+
+    // The other end holds a copy of the region too old to replay onto, but
+    // most of it is likely still right, so compare hash trees and send only
+    // the parts that differ
+    if (wipe && has_objects)
+    {
+        std::auto_ptr<datalayer::replay_iterator> changes;
+        changes.reset(m_daemon->m_data.replay_region_from_now(tos->xfer.rid));
+        datalayer::snapshot snap(m_daemon->m_data.make_snapshot());
+        std::auto_ptr<region_tree> tree(new region_tree());
+        datalayer::returncode rc = m_daemon->m_data.hash_region(snap, tos->xfer.rid, tree.get());
+
+        if (rc == datalayer::SUCCESS)
+        {
+            wipe = false;
+            tos->repair = true;
+            tos->snap = snap;
+            tos->tree = tree;
+            iter = changes;
+        }
+        else
+        {
+            LOG(ERROR) << "could not hash " << tos->xfer.rid << " for " << xid
+                       << " (" << rc << "); copying the region in full";
+        }
+    }
+
+    // The other end starts from nothing, so copy the region's entries
+    // wholesale and replay only the writes made since the copy was taken
+    if (wipe)
+    {
+        datalayer::replay_iterator* changes = NULL;
+        tos->dump.reset(m_daemon->m_data.dump_region(tos->xfer.rid, &changes));
+        iter.reset(changes);
+    }
+
     tos->handshake_syn = true;
     tos->wipe = wipe;
     tos->iter = iter;
-    send_handshake_ack(tos->xfer, tos->wipe);
+    tos->window_sz = std::max(tos->window_sz, size_t(XFER_BATCH_OBJECTS));
+    send_handshake_ack(tos->xfer, tos->wipe, tos->repair);
     transfer_more_state(tos);
-    LOG(INFO) << "received handshake_synack for " << xid << " @ " << timestamp;
+    LOG(INFO) << "received handshake_synack for " << xid << " @ " << timestamp
+              << (tos->repair ? " (and will repair the other end's copy)" : "");
 }
 
 void
 state_transfer_manager :: handshake_ack(const virtual_server_id& from,
                                         const transfer_id& xid,
-                                        bool wipe)
+                                        bool wipe,
+                                        bool repair)
 {
     transfer_in_state* tis = get_tis(xid);
 
@@ -265,7 +347,10 @@ state_transfer_manager :: handshake_ack(const virtual_server_id& from,
     {
         tis->handshake_complete = true;
         tis->wipe = wipe;
-        LOG(INFO) << "received handshake_ack for " << xid << (wipe ? " (and we must wipe our previous state)" : "");
+        tis->repair = repair;
+        LOG(INFO) << "received handshake_ack for " << xid
+                  << (wipe ? " (and we must wipe our previous state)" : "")
+                  << (repair ? " (and we must repair our previous state)" : "");
     }
 
     put_to_disk_and_send_acks(tis);
@@ -316,12 +401,9 @@ state_transfer_manager :: report_wiped(const transfer_id& xid)
 void
 state_transfer_manager :: xfer_op(const virtual_server_id& from,
                                   const transfer_id& xid,
-                                  uint64_t seq_no,
-                                  bool has_value,
-                                  uint64_t version,
+                                  uint32_t count,
                                   std::auto_ptr<e::buffer> msg,
-                                  const e::slice& key,
-                                  const std::vector<e::slice>& value)
+                                  e::unpacker up)
 {
     transfer_in_state* tis = get_tis(xid);
 
@@ -339,37 +421,73 @@ state_transfer_manager :: xfer_op(const virtual_server_id& from,
         return;
     }
 
-    if (seq_no < tis->upper_bound_acked)
+    m_perf_bytes_received.add(msg->size());
+    e::compat::shared_ptr<e::buffer> backing(msg.release());
+    bool stale = false;
+
+    for (uint32_t i = 0; i < count; ++i)
     {
-        return send_ack(tis->xfer, seq_no);
-    }
+        uint8_t flags;
+        e::intrusive_ptr<pending> op(new pending());
+        up = up >> flags >> op->seq_no >> op->version >> op->key >> op->value;
 
-    std::list<e::intrusive_ptr<pending> >::iterator where_to_put_it;
+        if (up.error())
+        {
+            LOG(WARNING) << "unpack of XFER_OP failed; here's some hex:  " << backing->hex();
+            break;
+        }
 
-    for (where_to_put_it = tis->queued.begin();
-            where_to_put_it != tis->queued.end(); ++where_to_put_it)
-    {
-        if ((*where_to_put_it)->seq_no == seq_no)
+        op->has_value = flags & 1;
+        op->msg = backing;
+        m_perf_objects_received.tap();
+
+        if (op->seq_no < tis->upper_bound_acked)
         {
-            // silently drop it
-            return;
+            stale = true;
+            continue;
         }
 
-        if ((*where_to_put_it)->seq_no > seq_no)
+        // objects usually arrive in order, so look for their place from the
+        // back of the queue
+        std::list<e::intrusive_ptr<pending> >::iterator where_to_put_it = tis->queued.end();
+
+        while (where_to_put_it != tis->queued.begin())
         {
-            break;
+            std::list<e::intrusive_ptr<pending> >::iterator prev = where_to_put_it;
+            --prev;
+
+            if ((*prev)->seq_no <= op->seq_no)
+            {
+                break;
+            }
+
+            where_to_put_it = prev;
         }
+
+        if (where_to_put_it != tis->queued.begin())
+        {
+            std::list<e::intrusive_ptr<pending> >::iterator prev = where_to_put_it;
+            --prev;
+
+            if ((*prev)->seq_no == op->seq_no)
+            {
+                // silently drop it
+                continue;
+            }
+        }
+
+        tis->queued.insert(where_to_put_it, op);
     }
 
-    e::intrusive_ptr<pending> op(new pending());
-    op->seq_no = seq_no;
-    op->has_value = has_value;
-    op->version = version;
-    op->key = key;
-    op->value = value;
-    op->msg = msg;
-    tis->queued.insert(where_to_put_it, op);
+    uint64_t upper_bound_acked = tis->upper_bound_acked;
     put_to_disk_and_send_acks(tis);
+
+    // a retransmission of what we have already written must still be acked,
+    // or the sender will keep retransmitting it
+    if (stale && upper_bound_acked == tis->upper_bound_acked)
+    {
+        send_ack(tis->xfer, tis->upper_bound_acked);
+    }
 }
 
 void
@@ -394,33 +512,286 @@ state_transfer_manager :: xfer_ack(const server_id& from,
         return;
     }
 
-    std::list<e::intrusive_ptr<pending> >::iterator it;
+    // the ack is cumulative, so it covers everything in the window before it
+    size_t acked = 0;
+
+    while (!tos->window.empty() && tos->window.front()->seq_no < seq_no)
+    {
+        tos->window.pop_front();
+        ++acked;
+    }
+
+    if (acked > 0)
+    {
+        tos->handshake_ack = true;
+        tos->window_sz = std::min(tos->window_sz + acked, size_t(XFER_WINDOW_MAX));
+    }
+
+    transfer_more_state(tos);
+}
+
+void
+state_transfer_manager :: xfer_chunk(const virtual_server_id& from,
+                                     const transfer_id& xid,
+                                     uint64_t chunk_no,
+                                     uint64_t checksum,
+                                     uint32_t count,
+                                     std::auto_ptr<e::buffer> msg,
+                                     const e::slice& payload)
+{
+    transfer_in_state* tis = get_tis(xid);
+
+    if (!tis)
+    {
+        LOG(INFO) << "dropping XFER_CHUNK for " << xid << " which we don't know about";
+        return;
+    }
+
+    po6::threads::mutex::hold hold(&tis->mtx);
 
-    for (it = tos->window.begin(); it != tos->window.end(); ++it)
+    if (tis->xfer.vsrc != from || tis->xfer.id != xid)
     {
-        if ((*it)->seq_no == seq_no)
+        LOG(INFO) << "dropping XFER_CHUNK that came from the wrong host";
+        return;
+    }
+
+    if (tis->failed)
+    {
+        return send_chunk_reject(tis->xfer, chunk_no);
+    }
+
+    if (!tis->handshake_complete || !tis->wipe || !tis->wiped)
+    {
+        LOG(INFO) << "dropping XFER_CHUNK for " << xid << " that came before we wiped";
+        return;
+    }
+
+    if (CityHash64(payload.cdata(), payload.size()) != checksum)
+    {
+        LOG(ERROR) << "dropping XFER_CHUNK " << chunk_no << " for " << xid
+                   << " because its checksum does not match";
+        return;
+    }
+
+    m_perf_chunks_received.tap();
+    m_perf_bytes_received.add(msg->size());
+
+    if (chunk_no < tis->next_chunk_no)
+    {
+        return send_chunk_ack(tis->xfer, tis->next_chunk_no);
+    }
+
+    std::list<e::intrusive_ptr<chunk> >::iterator where_to_put_it;
+
+    for (where_to_put_it = tis->chunks.begin();
+            where_to_put_it != tis->chunks.end(); ++where_to_put_it)
+    {
+        if ((*where_to_put_it)->chunk_no == chunk_no)
+        {
+            // silently drop it
+            return;
+        }
+
+        if ((*where_to_put_it)->chunk_no > chunk_no)
         {
             break;
         }
     }
 
-    if (it != tos->window.end())
+    e::intrusive_ptr<chunk> c(new chunk());
+    c->chunk_no = chunk_no;
+    c->checksum = checksum;
+    c->count = count;
+    c->payload = payload;
+    c->msg = msg;
+    tis->chunks.insert(where_to_put_it, c);
+    put_chunks_to_disk_and_send_acks(tis);
+}
+
+void
+state_transfer_manager :: xfer_chunk_ack(const server_id& from,
+                                         const virtual_server_id& to,
+                                         const transfer_id& xid,
+                                         uint64_t chunk_no)
+{
+    transfer_out_state* tos = get_tos(xid);
+
+    if (!tos)
+    {
+        LOG(INFO) << "dropping XFER_ACK for " << xid << " which we don't know about";
+        return;
+    }
+
+    po6::threads::mutex::hold hold(&tos->mtx);
+
+    if (tos->xfer.dst != from || tos->xfer.vsrc != to || tos->xfer.id != xid)
     {
-        (*it)->acked = true;
-        tos->handshake_ack = true;
+        LOG(INFO) << "dropping XFER_ACK that came from the wrong host";
+        return;
+    }
+
+    while (!tos->chunks.empty() && tos->chunks.front()->chunk_no < chunk_no)
+    {
+        tos->chunks.pop_front();
+    }
+
+    transfer_more_state(tos);
+}
+
+void
+state_transfer_manager :: xfer_chunk_reject(const server_id& from,
+                                            const virtual_server_id& to,
+                                            const transfer_id& xid,
+                                            uint64_t chunk_no)
+{
+    transfer_out_state* tos = get_tos(xid);
+
+    if (!tos)
+    {
+        LOG(INFO) << "dropping XFER_ACK for " << xid << " which we don't know about";
+        return;
+    }
+
+    po6::threads::mutex::hold hold(&tos->mtx);
+
+    if (tos->xfer.dst != from || tos->xfer.vsrc != to || tos->xfer.id != xid)
+    {
+        LOG(INFO) << "dropping XFER_ACK that came from the wrong host";
+        return;
+    }
+
+    if (tos->failed)
+    {
+        return;
+    }
+
+    // resending the chunk would only be rejected again, so stop here and
+    // leave the transfer incomplete until the next reconfiguration
+    LOG(ERROR) << "abandoning " << xid << " because the other end rejected chunk "
+               << chunk_no << " of " << tos->xfer.rid;
+    tos->failed = true;
+    tos->chunks.clear();
+    tos->dump.reset();
+}
 
-        if (tos->window_sz < 1024)
+void
+state_transfer_manager :: xfer_tree(const server_id& from,
+                                    const virtual_server_id& to,
+                                    const transfer_id& xid,
+                                    const std::vector<uint64_t>& leaves)
+{
+    transfer_out_state* tos = get_tos(xid);
+
+    if (!tos)
+    {
+        LOG(INFO) << "dropping XFER_TREE for " << xid << " which we don't know about";
+        return;
+    }
+
+    po6::threads::mutex::hold hold(&tos->mtx);
+
+    if (tos->xfer.dst != from || tos->xfer.vsrc != to || tos->xfer.id != xid)
+    {
+        LOG(INFO) << "dropping XFER_TREE that came from the wrong host";
+        return;
+    }
+
+    if (!tos->repair || tos->tree_compared)
+    {
+        // a duplicate
+        return;
+    }
+
+    region_tree theirs;
+
+    if (!theirs.set_leaves(leaves))
+    {
+        LOG(WARNING) << "dropping XFER_TREE for " << xid << " with "
+                     << leaves.size() << " leaves";
+        return;
+    }
+
+    std::vector<bool> differ;
+    tos->tree->diff(&theirs, &differ);
+
+    for (size_t i = 0; i < differ.size(); ++i)
+    {
+        if (differ[i])
         {
-            ++tos->window_sz;
+            tos->differing.push_back(i);
         }
     }
 
-    while (!tos->window.empty() && (*tos->window.begin())->acked)
+    tos->repair_iter.reset(m_daemon->m_data.make_leaf_iterator(tos->snap, tos->xfer.rid, differ));
+    tos->tree.reset();
+    tos->snap = datalayer::snapshot();
+    tos->tree_compared = true;
+    m_perf_trees_compared.tap();
+    m_perf_leaves_differing.add(tos->differing.size());
+    LOG(INFO) << "repairing " << tos->differing.size() << "/" << region_tree::LEAVES
+              << " leaves of " << tos->xfer.rid << " for " << xid;
+    transfer_more_state(tos);
+}
+
+void
+state_transfer_manager :: xfer_diff(const virtual_server_id& from,
+                                    const transfer_id& xid,
+                                    const std::vector<uint32_t>& leaves)
+{
+    transfer_in_state* tis = get_tis(xid);
+
+    if (!tis)
+    {
+        LOG(INFO) << "dropping XFER_DIFF for " << xid << " which we don't know about";
+        return;
+    }
+
+    po6::threads::mutex::hold hold(&tis->mtx);
+
+    if (tis->xfer.vsrc != from || tis->xfer.id != xid)
     {
-        tos->window.pop_front();
+        LOG(INFO) << "dropping XFER_DIFF that came from the wrong host";
+        return;
     }
 
-    transfer_more_state(tos);
+    if (!tis->handshake_complete || !tis->repair)
+    {
+        LOG(INFO) << "dropping XFER_DIFF for " << xid << " that came before the handshake";
+        return;
+    }
+
+    if (!tis->wiped)
+    {
+        std::vector<bool> differ(region_tree::LEAVES, false);
+
+        for (size_t i = 0; i < leaves.size(); ++i)
+        {
+            if (leaves[i] >= region_tree::LEAVES)
+            {
+                LOG(WARNING) << "dropping XFER_DIFF for " << xid << " with leaf " << leaves[i];
+                return;
+            }
+
+            differ[leaves[i]] = true;
+        }
+
+        datalayer::returncode rc = m_daemon->m_data.wipe_region_leaves(tis->xfer.rid, differ);
+
+        if (rc != datalayer::SUCCESS)
+        {
+            // the sender keeps sending XFER_DIFF until we ack, so try again then
+            LOG(ERROR) << "could not wipe " << leaves.size() << " leaves of "
+                       << tis->xfer.rid << " for " << xid << ": " << rc;
+            return;
+        }
+
+        tis->wiped = true;
+        tis->leaves.clear();
+        LOG(INFO) << "we've wiped " << leaves.size() << "/" << region_tree::LEAVES
+                  << " leaves of our state for " << xid;
+    }
+
+    put_to_disk_and_send_acks(tis);
 }
 
 state_transfer_manager::transfer_in_state*
@@ -454,6 +825,11 @@ state_transfer_manager :: get_tos(const transfer_id& xid)
 void
 state_transfer_manager :: transfer_more_state(transfer_out_state* tos)
 {
+    if (tos->failed)
+    {
+        return;
+    }
+
     if (!tos->handshake_syn)
     {
         send_handshake_syn(tos->xfer);
@@ -462,38 +838,125 @@ state_transfer_manager :: transfer_more_state(transfer_out_state* tos)
 
     if (!tos->handshake_ack)
     {
-        send_handshake_ack(tos->xfer, tos->wipe);
+        send_handshake_ack(tos->xfer, tos->wipe, tos->repair);
     }
 
     assert(tos->iter.get());
 
-    while (tos->window.size() < tos->window_sz && tos->iter->valid())
+    if (tos->repair && !tos->tree_compared)
+    {
+        // the other end answers the ack with its tree
+        return;
+    }
+
+    if (tos->repair && !tos->handshake_ack)
+    {
+        send_diff(tos->xfer, tos->differing);
+    }
+
+    if (transfer_more_chunks(tos))
+    {
+        return;
+    }
+
+    // objects in the window from here on have not been sent yet
+    std::list<e::intrusive_ptr<pending> >::iterator unsent = tos->window.end();
+    size_t unsent_objects = 0;
+    size_t unsent_bytes = 0;
+    const uint64_t now = e::time();
+
+    while (tos->window.size() < tos->window_sz)
     {
+        if (unsent_objects == 0 && !admit(now))
+        {
+            break;
+        }
+
+        if (tos->repair_iter.get() && !tos->repair_iter->valid())
+        {
+            if (!tos->repair_iter->status().ok())
+            {
+                // leave the iterator in place so the transfer stalls rather
+                // than going live with part of the region unrepaired
+                LOG(ERROR) << "could not repair " << tos->xfer.rid << " for "
+                           << tos->xfer.id << ": " << tos->repair_iter->status().ToString();
+                break;
+            }
+
+            tos->repair_iter.reset();
+        }
+
         e::intrusive_ptr<pending> op(new pending());
-        op->seq_no = tos->next_seq_no;
-        ++tos->next_seq_no;
-        op->kref.assign(reinterpret_cast<const char*>(tos->iter->key().data()), tos->iter->key().size());
-        op->key = e::slice(op->kref);
 
-        if (tos->iter->has_value())
+        // the objects of the leaves that differ go first, as of the snapshot
+        // the trees were built from, and then the writes made since
+        if (tos->repair_iter.get())
         {
+            op->kref.assign(reinterpret_cast<const char*>(tos->repair_iter->key().data()), tos->repair_iter->key().size());
+            op->key = e::slice(op->kref);
             op->has_value = true;
 
-            if (tos->iter->unpack_value(&op->value, &op->version, &op->vref) != datalayer::SUCCESS)
+            if (tos->repair_iter->unpack_value(&op->value, &op->version, &op->vref) != datalayer::SUCCESS)
             {
                 LOG(ERROR) << "error doing state transfer";
                 break;
             }
+
+            tos->repair_iter->next();
+        }
+        else if (tos->iter->valid())
+        {
+            op->kref.assign(reinterpret_cast<const char*>(tos->iter->key().data()), tos->iter->key().size());
+            op->key = e::slice(op->kref);
+
+            if (tos->iter->has_value())
+            {
+                op->has_value = true;
+
+                if (tos->iter->unpack_value(&op->value, &op->version, &op->vref) != datalayer::SUCCESS)
+                {
+                    LOG(ERROR) << "error doing state transfer";
+                    break;
+                }
+            }
+            else
+            {
+                op->has_value = false;
+                op->version = 0;
+            }
+
+            tos->iter->next();
         }
         else
         {
-            op->has_value = false;
-            op->version = 0;
+            break;
         }
 
+        op->seq_no = tos->next_seq_no;
+        ++tos->next_seq_no;
         tos->window.push_back(op);
-        send_object(tos->xfer, op.get());
-        tos->iter->next();
+
+        if (unsent == tos->window.end())
+        {
+            unsent = --tos->window.end();
+        }
+
+        ++unsent_objects;
+        unsent_bytes += op->key.size() + pack_size(op->value);
+
+        if (unsent_objects >= XFER_BATCH_OBJECTS ||
+            unsent_bytes >= XFER_BATCH_BYTES)
+        {
+            send_objects(tos->xfer, unsent, tos->window.end());
+            unsent = tos->window.end();
+            unsent_objects = 0;
+            unsent_bytes = 0;
+        }
+    }
+
+    if (unsent != tos->window.end())
+    {
+        send_objects(tos->xfer, unsent, tos->window.end());
     }
 
     if (!tos->handshake_ack)
@@ -501,6 +964,10 @@ state_transfer_manager :: transfer_more_state(transfer_out_state* tos)
         // pass!  we need the other end to give us some sign that it's ready,
         // otherwise we cannot consider moving forward, even if we're ready.
     }
+    else if (tos->repair_iter.get())
+    {
+        // pass!  the repair stalled on an error
+    }
     else if (tos->window.empty() && m_daemon->m_config.is_transfer_live(tos->xfer.id))
     {
         m_daemon->m_coord.transfer_complete(tos->xfer.id);
@@ -511,14 +978,143 @@ state_transfer_manager :: transfer_more_state(transfer_out_state* tos)
     }
 }
 
+bool
+state_transfer_manager :: transfer_more_chunks(transfer_out_state* tos)
+{
+    if (!tos->dump.get() && tos->chunks.empty())
+    {
+        return false;
+    }
+
+    // the other end must have wiped before it can take raw entries
+    if (!tos->handshake_ack)
+    {
+        return true;
+    }
+
+    const uint64_t now = e::time();
+
+    while (tos->dump.get() && tos->chunks.size() < XFER_CHUNK_WINDOW && admit(now))
+    {
+        if (!tos->dump->valid())
+        {
+            if (!tos->dump->status().ok())
+            {
+                // leave the dump in place so the transfer stalls rather than
+                // going live without the rest of the region
+                LOG(ERROR) << "could not dump " << tos->xfer.rid << " for "
+                           << tos->xfer.id << ": " << tos->dump->status().ToString();
+                break;
+            }
+
+            LOG(INFO) << "dumped " << tos->xfer.rid << " for " << tos->xfer.id
+                      << " in " << tos->next_chunk_no - 1 << " chunks";
+            tos->dump.reset();
+            break;
+        }
+
+        e::intrusive_ptr<chunk> c(new chunk());
+        c->chunk_no = tos->next_chunk_no;
+        ++tos->next_chunk_no;
+
+        while (tos->dump->valid() &&
+               c->count < XFER_CHUNK_ENTRIES &&
+               c->backing.size() < XFER_CHUNK_BYTES)
+        {
+            e::slice entry[2] = {tos->dump->key(), tos->dump->value()};
+
+            for (size_t i = 0; i < 2; ++i)
+            {
+                char sz[sizeof(uint32_t)];
+                e::pack32be(entry[i].size(), sz);
+                c->backing.append(sz, sizeof(uint32_t));
+                c->backing.append(entry[i].cdata(), entry[i].size());
+            }
+
+            ++c->count;
+            tos->dump->next();
+        }
+
+        c->payload = e::slice(c->backing);
+        c->checksum = CityHash64(c->backing.data(), c->backing.size());
+        tos->chunks.push_back(c);
+        send_chunk(tos->xfer, c.get());
+    }
+
+    return tos->dump.get() || !tos->chunks.empty();
+}
+
 void
 state_transfer_manager :: retransmit(transfer_out_state* tos)
 {
+    // the window goes out whole or not at all; when the throttle holds it
+    // back the kickstarter retransmits it once the throttle refills
+    if (tos->failed)
+    {
+        return;
+    }
+
+    if (!admit(e::time()))
+    {
+        tos->retransmit_pending = true;
+        return;
+    }
+
+    tos->retransmit_pending = false;
+
+    for (std::list<e::intrusive_ptr<chunk> >::iterator it = tos->chunks.begin();
+            it != tos->chunks.end(); ++it)
+    {
+        send_chunk(tos->xfer, it->get());
+    }
+
+    std::list<e::intrusive_ptr<pending> >::iterator first = tos->window.begin();
+    size_t objects = 0;
+    size_t bytes = 0;
+
     for (std::list<e::intrusive_ptr<pending> >::iterator it = tos->window.begin();
             it != tos->window.end(); ++it)
     {
-        send_object(tos->xfer, it->get());
+        ++objects;
+        bytes += (*it)->key.size() + pack_size((*it)->value);
+
+        if (objects >= XFER_BATCH_OBJECTS || bytes >= XFER_BATCH_BYTES)
+        {
+            std::list<e::intrusive_ptr<pending> >::iterator last = it;
+            ++last;
+            send_objects(tos->xfer, first, last);
+            m_perf_objects_retransmitted.add(objects);
+            first = last;
+            objects = 0;
+            bytes = 0;
+        }
     }
+
+    if (first != tos->window.end())
+    {
+        send_objects(tos->xfer, first, tos->window.end());
+        m_perf_objects_retransmitted.add(objects);
+    }
+}
+
+bool
+state_transfer_manager :: admit(uint64_t now)
+{
+    m_daemon->m_xfer_throttle.adjust(now, m_daemon->foreground_pressure());
+
+    if (m_daemon->m_xfer_throttle.admit(now))
+    {
+        return true;
+    }
+
+    // the kickstarter picks up where we left off once the throttle refills
+    if (__sync_bool_compare_and_swap(&m_throttled, 0, 1))
+    {
+        po6::threads::mutex::hold hold(&m_block_kickstarter);
+        m_wakeup_kickstarter.broadcast();
+    }
+
+    return false;
 }
 
 void
@@ -535,19 +1131,74 @@ state_transfer_manager :: put_to_disk_and_send_acks(transfer_in_state* tis)
         return;
     }
 
+    if (tis->repair && !tis->wiped)
+    {
+        // hash our copy once, and send its leaves every time the sender asks
+        // until it tells us which of them differ
+        if (tis->leaves.empty())
+        {
+            region_tree tree;
+            datalayer::returncode rc;
+            rc = m_daemon->m_data.hash_region(m_daemon->m_data.make_snapshot(), tis->xfer.rid, &tree);
+
+            if (rc != datalayer::SUCCESS)
+            {
+                LOG(ERROR) << "could not hash " << tis->xfer.rid << " for "
+                           << tis->xfer.id << ": " << rc;
+                return;
+            }
+
+            tis->leaves = tree.leaves();
+        }
+
+        send_tree(tis->xfer, tis->leaves);
+        return;
+    }
+
     if (tis->queued.empty())
     {
         send_handshake_wiped(tis->xfer);
     }
 
-    while (!tis->queued.empty() &&
-           tis->queued.front()->seq_no == tis->upper_bound_acked)
+    // apply every object that is next in sequence, many to a write, and
+    // acknowledge them all at once; objects leave the queue only once their
+    // write succeeds
+    datalayer::write_batch wb;
+    std::set<std::string> keys;
+    size_t batched = 0;
+    const uint64_t start_upper_bound_acked = tis->upper_bound_acked;
+    uint64_t upper_bound_acked = tis->upper_bound_acked;
+    uint64_t max_version = 0;
+    std::list<e::intrusive_ptr<pending> >::iterator it = tis->queued.begin();
+
+    while (it != tis->queued.end() &&
+           (*it)->seq_no == upper_bound_acked)
     {
-        e::intrusive_ptr<pending> op = tis->queued.front();
+        e::intrusive_ptr<pending> op = *it;
+        std::string key(op->key.cdata(), op->key.size());
+
+        // the old value of a key changed earlier in the batch would be read
+        // from disk without that change
+        if (keys.find(key) != keys.end() ||
+            batched >= XFER_WRITE_OBJECTS)
+        {
+            if (!apply_batch(tis, &wb))
+            {
+                // the sender retransmits what we don't ack
+                batched = 0;
+                break;
+            }
+
+            tis->queued.erase(tis->queued.begin(), it);
+            tis->upper_bound_acked = upper_bound_acked;
+            keys.clear();
+            batched = 0;
+        }
 
         if (op->has_value)
         {
-            datalayer::returncode rc = m_daemon->m_data.uncertain_put(tis->xfer.rid, op->key, op->value, op->version);
+            max_version = std::max(max_version, op->version);
+            datalayer::returncode rc = m_daemon->m_data.uncertain_put(tis->xfer.rid, op->key, op->value, op->version, &wb);
 
             switch (rc)
             {
@@ -567,7 +1218,7 @@ state_transfer_manager :: put_to_disk_and_send_acks(transfer_in_state* tis)
         }
         else
         {
-            datalayer::returncode rc = m_daemon->m_data.uncertain_del(tis->xfer.rid, op->key);
+            datalayer::returncode rc = m_daemon->m_data.uncertain_del(tis->xfer.rid, op->key, &wb);
 
             switch (rc)
             {
@@ -586,9 +1237,103 @@ state_transfer_manager :: put_to_disk_and_send_acks(transfer_in_state* tis)
             }
         }
 
-        send_ack(tis->xfer, op->seq_no);
-        tis->upper_bound_acked = std::max(tis->upper_bound_acked, op->seq_no + 1);
-        tis->queued.pop_front();
+        keys.insert(key);
+        ++batched;
+        upper_bound_acked = op->seq_no + 1;
+        ++it;
+    }
+
+    if (batched > 0 && apply_batch(tis, &wb))
+    {
+        tis->queued.erase(tis->queued.begin(), it);
+        tis->upper_bound_acked = upper_bound_acked;
+    }
+
+    m_daemon->m_repl.observe_version(max_version);
+
+    if (tis->upper_bound_acked != start_upper_bound_acked)
+    {
+        send_ack(tis->xfer, tis->upper_bound_acked);
+    }
+}
+
+void
+state_transfer_manager :: put_chunks_to_disk_and_send_acks(transfer_in_state* tis)
+{
+    const uint64_t start_next_chunk_no = tis->next_chunk_no;
+
+    while (!tis->chunks.empty() &&
+           tis->chunks.front()->chunk_no == tis->next_chunk_no)
+    {
+        e::intrusive_ptr<chunk> c = tis->chunks.front();
+        datalayer::write_batch wb;
+        e::unpacker up(c->payload);
+        bool valid = true;
+        uint64_t max_version = 0;
+
+        for (uint32_t i = 0; valid && i < c->count; ++i)
+        {
+            e::slice key;
+            e::slice value;
+            uint64_t version = 0;
+            up = up >> key >> value;
+            valid = !up.error() &&
+                    m_daemon->m_data.ingest(tis->xfer.rid, key, value, &version, &wb);
+            max_version = std::max(max_version, version);
+        }
+
+        // the sender would retransmit the chunk forever, so tell it to give
+        // up; the chunks already on disk stay until the region is wiped
+        if (!valid)
+        {
+            LOG(ERROR) << "abandoning " << tis->xfer.id << " because XFER_CHUNK "
+                       << c->chunk_no << " holds entries outside "
+                       << tis->xfer.rid;
+            tis->failed = true;
+            tis->chunks.clear();
+            send_chunk_reject(tis->xfer, c->chunk_no);
+            return;
+        }
+
+        // keep the chunk until it is on disk so a later call retries it
+        if (!apply_batch(tis, &wb))
+        {
+            break;
+        }
+
+        // we may become the head of the region, and our blind writes must
+        // then follow what the region already holds
+        m_daemon->m_repl.observe_version(max_version);
+        tis->chunks.pop_front();
+        ++tis->next_chunk_no;
+    }
+
+    if (tis->next_chunk_no != start_next_chunk_no)
+    {
+        send_chunk_ack(tis->xfer, tis->next_chunk_no);
+    }
+}
+
+bool
+state_transfer_manager :: apply_batch(transfer_in_state* tis, datalayer::write_batch* wb)
+{
+    datalayer::returncode rc = m_daemon->m_data.write(wb);
+    m_perf_batches_written.tap();
+
+    switch (rc)
+    {
+        case datalayer::SUCCESS:
+            return true;
+        case datalayer::NOT_FOUND:
+        case datalayer::BAD_ENCODING:
+        case datalayer::CORRUPTION:
+        case datalayer::IO_ERROR:
+        case datalayer::LEVELDB_ERROR:
+            LOG(ERROR) << "state transfer for " << tis->xfer.id << " could not write: " << rc;
+            return false;
+        default:
+            LOG(ERROR) << "state transfer for " << tis->xfer.id << " could not write";
+            return false;
     }
 }
 
@@ -603,20 +1348,22 @@ state_transfer_manager :: send_handshake_syn(const transfer& xfer)
 }
 
 void
-state_transfer_manager :: send_handshake_synack(const transfer& xfer, uint64_t timestamp)
+state_transfer_manager :: send_handshake_synack(const transfer& xfer, uint64_t timestamp, bool has_objects)
 {
+    uint8_t flags = has_objects ? 0x1 : 0;
     size_t sz = HYPERDEX_HEADER_SIZE_VV
               + sizeof(uint64_t)
-              + sizeof(uint64_t);
+              + sizeof(uint64_t)
+              + sizeof(uint8_t);
     std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
-    msg->pack_at(HYPERDEX_HEADER_SIZE_VV) << xfer.id << timestamp;
+    msg->pack_at(HYPERDEX_HEADER_SIZE_VV) << xfer.id << timestamp << flags;
     m_daemon->m_comm.send_exact(xfer.vdst, xfer.vsrc, XFER_HSA, msg);
 }
 
 void
-state_transfer_manager :: send_handshake_ack(const transfer& xfer, bool wipe)
+state_transfer_manager :: send_handshake_ack(const transfer& xfer, bool wipe, bool repair)
 {
-    uint8_t flags = wipe ? 0x1 : 0;
+    uint8_t flags = (wipe ? 0x1 : 0) | (repair ? 0x2 : 0);
     size_t sz = HYPERDEX_HEADER_SIZE_VV
               + sizeof(uint64_t)
               + sizeof(uint8_t);
@@ -636,20 +1383,38 @@ state_transfer_manager :: send_handshake_wiped(const transfer& xfer)
 }
 
 void
-state_transfer_manager :: send_object(const transfer& xfer,
-                                      pending* op)
+state_transfer_manager :: send_objects(const transfer& xfer,
+                                       std::list<e::intrusive_ptr<pending> >::iterator first,
+                                       std::list<e::intrusive_ptr<pending> >::iterator last)
 {
-    uint8_t flags = (op->has_value ? 1 : 0);
+    uint32_t count = 0;
     size_t sz = HYPERDEX_HEADER_SIZE_VV
-              + sizeof(uint8_t)
-              + sizeof(uint64_t)
               + sizeof(uint64_t)
-              + sizeof(uint64_t)
-              + sizeof(uint32_t) + op->key.size()
-              + pack_size(op->value);
+              + sizeof(uint32_t);
+
+    for (std::list<e::intrusive_ptr<pending> >::iterator it = first; it != last; ++it)
+    {
+        sz += sizeof(uint8_t)
+            + sizeof(uint64_t)
+            + sizeof(uint64_t)
+            + sizeof(uint32_t) + (*it)->key.size()
+            + pack_size((*it)->value);
+        ++count;
+    }
+
     std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
-    msg->pack_at(HYPERDEX_HEADER_SIZE_VV) << flags << xfer.id.get() << op->seq_no
-                                          << op->version << op->key << op->value;
+    e::buffer::packer pa = msg->pack_at(HYPERDEX_HEADER_SIZE_VV);
+    pa = pa << xfer.id.get() << count;
+
+    for (std::list<e::intrusive_ptr<pending> >::iterator it = first; it != last; ++it)
+    {
+        uint8_t flags = ((*it)->has_value ? 1 : 0);
+        pa = pa << flags << (*it)->seq_no << (*it)->version << (*it)->key << (*it)->value;
+    }
+
+    m_perf_objects_sent.add(count);
+    m_perf_bytes_sent.add(sz);
+    m_daemon->m_xfer_throttle.charge(sz);
     m_daemon->m_comm.send_exact(xfer.vsrc, xfer.vdst, XFER_OP, msg);
 }
 
@@ -666,6 +1431,74 @@ state_transfer_manager :: send_ack(const transfer& xfer, uint64_t seq_no)
     m_daemon->m_comm.send_exact(xfer.vdst, xfer.vsrc, XFER_ACK, msg);
 }
 
+void
+state_transfer_manager :: send_chunk(const transfer& xfer, chunk* c)
+{
+    size_t sz = HYPERDEX_HEADER_SIZE_VV
+              + sizeof(uint64_t)
+              + sizeof(uint64_t)
+              + sizeof(uint64_t)
+              + sizeof(uint32_t)
+              + sizeof(uint32_t) + c->payload.size();
+    std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
+    msg->pack_at(HYPERDEX_HEADER_SIZE_VV) << xfer.id.get() << c->chunk_no
+                                          << c->checksum << c->count << c->payload;
+    m_perf_chunks_sent.tap();
+    m_perf_bytes_sent.add(sz);
+    m_daemon->m_xfer_throttle.charge(sz);
+    m_daemon->m_comm.send_exact(xfer.vsrc, xfer.vdst, XFER_CHUNK, msg);
+}
+
+void
+state_transfer_manager :: send_chunk_ack(const transfer& xfer, uint64_t chunk_no)
+{
+    uint8_t flags = 1;
+    size_t sz = HYPERDEX_HEADER_SIZE_VV
+              + sizeof(uint8_t)
+              + sizeof(uint64_t)
+              + sizeof(uint64_t);
+    std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
+    msg->pack_at(HYPERDEX_HEADER_SIZE_VV) << flags << xfer.id.get() << chunk_no;
+    m_daemon->m_comm.send_exact(xfer.vdst, xfer.vsrc, XFER_ACK, msg);
+}
+
+void
+state_transfer_manager :: send_chunk_reject(const transfer& xfer, uint64_t chunk_no)
+{
+    uint8_t flags = 3;
+    size_t sz = HYPERDEX_HEADER_SIZE_VV
+              + sizeof(uint8_t)
+              + sizeof(uint64_t)
+              + sizeof(uint64_t);
+    std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
+    msg->pack_at(HYPERDEX_HEADER_SIZE_VV) << flags << xfer.id.get() << chunk_no;
+    m_daemon->m_comm.send_exact(xfer.vdst, xfer.vsrc, XFER_ACK, msg);
+}
+
+void
+state_transfer_manager :: send_tree(const transfer& xfer, const std::vector<uint64_t>& leaves)
+{
+    size_t sz = HYPERDEX_HEADER_SIZE_VV
+              + sizeof(uint64_t)
+              + sizeof(uint32_t)
+              + leaves.size() * sizeof(uint64_t);
+    std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
+    msg->pack_at(HYPERDEX_HEADER_SIZE_VV) << xfer.id << leaves;
+    m_daemon->m_comm.send_exact(xfer.vdst, xfer.vsrc, XFER_TREE, msg);
+}
+
+void
+state_transfer_manager :: send_diff(const transfer& xfer, const std::vector<uint32_t>& leaves)
+{
+    size_t sz = HYPERDEX_HEADER_SIZE_VV
+              + sizeof(uint64_t)
+              + sizeof(uint32_t)
+              + leaves.size() * sizeof(uint32_t);
+    std::auto_ptr<e::buffer> msg(e::buffer::create(sz));
+    msg->pack_at(HYPERDEX_HEADER_SIZE_VV) << xfer.id << leaves;
+    m_daemon->m_comm.send_exact(xfer.vsrc, xfer.vdst, XFER_DIFF, msg);
+}
+
 void
 state_transfer_manager :: kickstarter()
 {
@@ -686,10 +1519,14 @@ state_transfer_manager :: kickstarter()
 
     while (true)
     {
+        bool kicked = false;
+
         {
             po6::threads::mutex::hold hold(&m_block_kickstarter);
 
-            while ((!m_need_kickstart && !m_shutdown) || m_need_pause)
+            // while the throttle holds transfers back, wake up periodically
+            // to pace them
+            while ((!m_need_kickstart && !m_shutdown && !m_throttled) || m_need_pause)
             {
                 m_paused = true;
 
@@ -707,23 +1544,52 @@ state_transfer_manager :: kickstarter()
                 break;
             }
 
+            kicked = m_need_kickstart;
             m_need_kickstart = false;
         }
 
+        if (!kicked)
+        {
+            timespec ts;
+            ts.tv_sec = 0;
+            ts.tv_nsec = XFER_PACE_INTERVAL;
+            nanosleep(&ts, NULL);
+            m_daemon->m_xfer_throttle.adjust(e::time(), m_daemon->foreground_pressure());
+
+            if (m_daemon->m_xfer_throttle.delay(e::time()) > 0 ||
+                !__sync_bool_compare_and_swap(&m_throttled, 1, 0))
+            {
+                continue;
+            }
+        }
+
         size_t idx = 0;
 
         while (true)
         {
-            po6::threads::mutex::hold hold(&m_block_kickstarter);
+            e::intrusive_ptr<transfer_out_state> tos;
 
-            if (idx >= m_transfers_out.size())
             {
-                break;
+                po6::threads::mutex::hold hold(&m_block_kickstarter);
+
+                if (idx >= m_transfers_out.size())
+                {
+                    break;
+                }
+
+                tos = m_transfers_out[idx];
+            }
+
+            // admit may take m_block_kickstarter while we hold tos->mtx,
+            // so it must not be held here
+            po6::threads::mutex::hold hold(&tos->mtx);
+
+            if (kicked || tos->retransmit_pending)
+            {
+                retransmit(tos.get());
             }
 
-            po6::threads::mutex::hold hold2(&m_transfers_out[idx]->mtx);
-            retransmit(m_transfers_out[idx].get());
-            transfer_more_state(m_transfers_out[idx].get());
+            transfer_more_state(tos.get());
             ++idx;
         }
     }
@@ -29,7 +29,9 @@
 #define hyperdex_daemon_state_transfer_manager_h_
 
 // STL
+#include <list>
 #include <memory>
+#include <vector>
 
 // po6
 #include <po6/threads/cond.h>
@@ -37,11 +39,14 @@
 #include <po6/threads/thread.h>
 
 // e
+#include <e/buffer.h>
 #include <e/intrusive_ptr.h>
 
 // HyperDex
 #include "namespace.h"
 #include "common/configuration.h"
+#include "daemon/datalayer.h"
+#include "daemon/performance_counter.h"
 #include "daemon/reconfigure_returncode.h"
 
 BEGIN_HYPERDEX_NAMESPACE
@@ -69,28 +74,71 @@ class state_transfer_manager
         void handshake_synack(const server_id& from,
                               const virtual_server_id& to,
                               const transfer_id& xid,
-                              uint64_t timestamp);
+                              uint64_t timestamp,
+                              bool has_objects);
         void handshake_ack(const virtual_server_id& from,
                            const transfer_id& xid,
-                           bool wipe);
+                           bool wipe,
+                           bool repair);
         void handshake_wiped(const server_id& from,
                              const virtual_server_id& to,
                              const transfer_id& xid);
         void report_wiped(const transfer_id& xid);
+        // "up" holds "count" objects, each packed as
+        // flags, seq_no, version, key, value
         void xfer_op(const virtual_server_id& from,
                      const transfer_id& xid,
-                     uint64_t seq_no,
-                     bool has_value,
-                     uint64_t version,
+                     uint32_t count,
                      std::auto_ptr<e::buffer> msg,
-                     const e::slice& key,
-                     const std::vector<e::slice>& value);
+                     e::unpacker up);
+        // every object before "seq_no" is on disk at the other end
         void xfer_ack(const server_id& from,
                       const virtual_server_id& to,
                       const transfer_id& xid,
                       uint64_t seq_no);
+        // bulk migration of a region to a server that starts without it
+        void xfer_chunk(const virtual_server_id& from,
+                        const transfer_id& xid,
+                        uint64_t chunk_no,
+                        uint64_t checksum,
+                        uint32_t count,
+                        std::auto_ptr<e::buffer> msg,
+                        const e::slice& payload);
+        // every chunk before "chunk_no" is on disk at the other end
+        void xfer_chunk_ack(const server_id& from,
+                            const virtual_server_id& to,
+                            const transfer_id& xid,
+                            uint64_t chunk_no);
+        // the other end could not ingest chunk "chunk_no" and gave up
+        void xfer_chunk_reject(const server_id& from,
+                               const virtual_server_id& to,
+                               const transfer_id& xid,
+                               uint64_t chunk_no);
+        // repair of a region the other end already holds an old copy of:
+        // the receiver sends the leaves of its region_tree and the sender
+        // answers with the leaves that differ before sending their objects
+        void xfer_tree(const server_id& from,
+                       const virtual_server_id& to,
+                       const transfer_id& xid,
+                       const std::vector<uint64_t>& leaves);
+        void xfer_diff(const virtual_server_id& from,
+                       const transfer_id& xid,
+                       const std::vector<uint32_t>& leaves);
+
+    public:
+        uint64_t objects_sent() { return m_perf_objects_sent.read(); }
+        uint64_t bytes_sent() { return m_perf_bytes_sent.read(); }
+        uint64_t objects_retransmitted() { return m_perf_objects_retransmitted.read(); }
+        uint64_t objects_received() { return m_perf_objects_received.read(); }
+        uint64_t bytes_received() { return m_perf_bytes_received.read(); }
+        uint64_t batches_written() { return m_perf_batches_written.read(); }
+        uint64_t chunks_sent() { return m_perf_chunks_sent.read(); }
+        uint64_t chunks_received() { return m_perf_chunks_received.read(); }
+        uint64_t trees_compared() { return m_perf_trees_compared.read(); }
+        uint64_t leaves_differing() { return m_perf_leaves_differing.read(); }
 
     private:
+        class chunk;
         class pending;
         class transfer_in_state;
         class transfer_out_state;
@@ -101,17 +149,32 @@ class state_transfer_manager
         transfer_out_state* get_tos(const transfer_id& xid);
         // caller must hold mtx on tos
         void transfer_more_state(transfer_out_state* tos);
+        // caller must hold mtx on tos
+        // returns true while the bulk copy is still in progress
+        bool transfer_more_chunks(transfer_out_state* tos);
         void retransmit(transfer_out_state* tos);
+        // returns false, and remembers to come back, when the throttle says
+        // to hold off sending
+        bool admit(uint64_t now);
+        // caller must hold mtx on tis
+        void put_chunks_to_disk_and_send_acks(transfer_in_state* tis);
         // caller must hold mtx on tis
         void put_to_disk_and_send_acks(transfer_in_state* tis);
-        // caller must hold mtx on tos
-        // send the last object in tos
+        bool apply_batch(transfer_in_state* tis, datalayer::write_batch* wb);
         void send_handshake_syn(const transfer& xfer);
-        void send_handshake_synack(const transfer& xfer, uint64_t timestamp);
-        void send_handshake_ack(const transfer& xfer, bool wipe);
+        void send_handshake_synack(const transfer& xfer, uint64_t timestamp, bool has_objects);
+        void send_handshake_ack(const transfer& xfer, bool wipe, bool repair);
         void send_handshake_wiped(const transfer& xfer);
-        void send_object(const transfer& xfer, pending* op);
+        // send the objects in [first, last) as one XFER_OP
+        void send_objects(const transfer& xfer,
+                          std::list<e::intrusive_ptr<pending> >::iterator first,
+                          std::list<e::intrusive_ptr<pending> >::iterator last);
         void send_ack(const transfer& xfer, uint64_t seq_id);
+        void send_chunk(const transfer& xfer, chunk* c);
+        void send_chunk_ack(const transfer& xfer, uint64_t chunk_no);
+        void send_chunk_reject(const transfer& xfer, uint64_t chunk_no);
+        void send_tree(const transfer& xfer, const std::vector<uint64_t>& leaves);
+        void send_diff(const transfer& xfer, const std::vector<uint32_t>& leaves);
         void kickstarter();
         void shutdown();
 
@@ -128,9 +191,20 @@ class state_transfer_manager
         po6::threads::cond m_wakeup_kickstarter;
         po6::threads::cond m_wakeup_reconfigurer;
         bool m_need_kickstart;
+        uint32_t m_throttled;
         bool m_shutdown;
         bool m_need_pause;
         bool m_paused;
+        performance_counter m_perf_objects_sent;
+        performance_counter m_perf_bytes_sent;
+        performance_counter m_perf_objects_retransmitted;
+        performance_counter m_perf_objects_received;
+        performance_counter m_perf_bytes_received;
+        performance_counter m_perf_batches_written;
+        performance_counter m_perf_chunks_sent;
+        performance_counter m_perf_chunks_received;
+        performance_counter m_perf_trees_compared;
+        performance_counter m_perf_leaves_differing;
 };
 
 END_HYPERDEX_NAMESPACE
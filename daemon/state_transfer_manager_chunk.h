@@ -0,0 +1,75 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef hyperdex_daemon_state_transfer_manager_chunk_h_
+#define hyperdex_daemon_state_transfer_manager_chunk_h_
+
+// STL
+#include <string>
+
+// e
+#include <e/buffer.h>
+#include <e/intrusive_ptr.h>
+
+// HyperDex
+#include "daemon/state_transfer_manager.h"
+
+// A run of raw LevelDB entries from a region dump, shipped as one XFER_CHUNK
+// during bulk migration.  "payload" holds "count" (key, value) pairs, each
+// packed as a slice, and "checksum" is the CityHash64 of the payload.
+class hyperdex::state_transfer_manager::chunk
+{
+    public:
+        chunk();
+        ~chunk() throw ();
+
+    public:
+        uint64_t chunk_no;
+        uint64_t checksum;
+        uint32_t count;
+        e::slice payload;
+        // the sender packs the payload here
+        std::string backing;
+        // the receiver keeps the message the payload points into
+        std::auto_ptr<e::buffer> msg;
+
+    private:
+        friend class e::intrusive_ptr<chunk>;
+
+    private:
+        void inc() { ++m_ref; }
+        void dec() { --m_ref; if (m_ref == 0) delete this; }
+
+    private:
+        size_t m_ref;
+
+    private:
+        chunk(const chunk&);
+        chunk& operator = (const chunk&);
+};
+
+#endif // hyperdex_daemon_state_transfer_manager_chunk_h_
@@ -36,7 +36,6 @@ state_transfer_manager :: state_transfer_manager :: pending :: pending()
     , version(0)
     , key()
     , value()
-    , acked(false)
     , msg()
     , kref()
     , vref()
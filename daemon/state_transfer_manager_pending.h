@@ -28,6 +28,9 @@
 #ifndef hyperdex_daemon_state_transfer_manager_pending_h_
 #define hyperdex_daemon_state_transfer_manager_pending_h_
 
+// e
+#include <e/compat.h>
+
 // HyperDex
 #include "daemon/datalayer.h"
 #include "daemon/state_transfer_manager.h"
@@ -44,8 +47,8 @@ class hyperdex::state_transfer_manager::pending
         uint64_t version;
         e::slice key;
         std::vector<e::slice> value;
-        bool acked;
-        std::auto_ptr<e::buffer> msg;
+        // shared by every object that arrived in the same XFER_OP
+        e::compat::shared_ptr<e::buffer> msg;
         std::string kref;
         datalayer::reference vref;
 
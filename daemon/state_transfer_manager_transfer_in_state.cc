@@ -28,6 +28,7 @@
 // HyperDex
 #include "daemon/datalayer.h"
 #include "daemon/datalayer_iterator.h"
+#include "daemon/state_transfer_manager_chunk.h"
 #include "daemon/state_transfer_manager_pending.h"
 #include "daemon/state_transfer_manager_transfer_in_state.h"
 
@@ -38,9 +39,14 @@ state_transfer_manager :: transfer_in_state :: transfer_in_state(const transfer&
     , mtx()
     , upper_bound_acked(1)
     , queued()
+    , next_chunk_no(1)
+    , chunks()
     , handshake_complete(false)
     , wipe(false)
     , wiped(false)
+    , repair(false)
+    , leaves()
+    , failed(false)
     , m_ref(0)
 {
 }
@@ -45,9 +45,17 @@ class hyperdex::state_transfer_manager::transfer_in_state
         po6::threads::mutex mtx;
         uint64_t upper_bound_acked;
         std::list<e::intrusive_ptr<pending> > queued;
+        uint64_t next_chunk_no;
+        std::list<e::intrusive_ptr<chunk> > chunks;
         bool handshake_complete;
         bool wipe;
         bool wiped;
+        // repair in place: "wiped" is set once the leaves that differ are gone
+        bool repair;
+        std::vector<uint64_t> leaves;
+        // set when the sender sent a chunk we cannot ingest; the transfer is
+        // abandoned and every later chunk is rejected
+        bool failed;
 
     private:
         friend class e::intrusive_ptr<transfer_in_state>;
@@ -27,6 +27,7 @@
 
 // HyperDex
 #include "daemon/datalayer_iterator.h"
+#include "daemon/state_transfer_manager_chunk.h"
 #include "daemon/state_transfer_manager_pending.h"
 #include "daemon/state_transfer_manager_transfer_out_state.h"
 
@@ -39,9 +40,20 @@ state_transfer_manager :: transfer_out_state :: transfer_out_state(const transfe
     , window()
     , window_sz(1)
     , iter()
+    , dump()
+    , next_chunk_no(1)
+    , chunks()
+    , retransmit_pending(false)
     , handshake_syn(false)
     , handshake_ack(false)
     , wipe(false)
+    , repair(false)
+    , snap()
+    , tree()
+    , tree_compared(false)
+    , differing()
+    , repair_iter()
+    , failed(false)
     , m_ref(0)
 {
 }
@@ -39,6 +39,7 @@
 
 // HyperDex
 #include "daemon/datalayer.h"
+#include "daemon/region_tree.h"
 #include "daemon/state_transfer_manager.h"
 
 using hyperdex::state_transfer_manager;
@@ -56,9 +57,28 @@ class state_transfer_manager::transfer_out_state
         std::list<e::intrusive_ptr<pending> > window;
         size_t window_sz;
         std::auto_ptr<datalayer::replay_iterator> iter;
+        // set while a bulk copy is being dumped; "iter" then replays the
+        // writes made after the dump was taken
+        std::auto_ptr<datalayer::dump_iterator> dump;
+        uint64_t next_chunk_no;
+        std::list<e::intrusive_ptr<chunk> > chunks;
+        // set when the throttle held back a retransmission of the window
+        bool retransmit_pending;
         bool handshake_syn; // do we know the other end got a syn?
         bool handshake_ack; // do we know the other end got a ack?
         bool wipe;
+        // set when the other end holds an old copy of the region; "tree"
+        // hashes "snap" until the other end's tree arrives, after which
+        // "repair_iter" walks the objects of the leaves that differ and
+        // "iter" replays the writes made after "snap" was taken
+        bool repair;
+        datalayer::snapshot snap;
+        std::auto_ptr<region_tree> tree;
+        bool tree_compared;
+        std::vector<uint32_t> differing;
+        std::auto_ptr<datalayer::leaf_iterator> repair_iter;
+        // set when the other end rejected a chunk; nothing more is sent
+        bool failed;
 
     private:
         friend class e::intrusive_ptr<transfer_out_state>;
@@ -0,0 +1,422 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+// POSIX
+#include <signal.h>
+
+// STL
+#include <algorithm>
+
+// Google Log
+#include <glog/logging.h>
+
+// e
+#include <e/time.h>
+
+// HyperDex
+#include "daemon/daemon.h"
+#include "daemon/storage_pool.h"
+
+using po6::threads::make_thread_wrapper;
+using hyperdex::storage_pool;
+
+///////////////////////////////// Storage Work /////////////////////////////////
+
+class storage_pool::work
+{
+    public:
+        work(const server_id& from,
+             const virtual_server_id& vfrom,
+             const virtual_server_id& vto,
+             network_msgtype type,
+             std::auto_ptr<e::buffer> msg,
+             const e::unpacker& up);
+        ~work() throw ();
+
+    public:
+        server_id from;
+        virtual_server_id vfrom;
+        virtual_server_id vto;
+        network_msgtype type;
+        std::auto_ptr<e::buffer> msg;
+        e::unpacker up;
+        uint64_t enqueued;
+
+    private:
+        work(const work&);
+        work& operator = (const work&);
+};
+
+storage_pool :: work :: work(const server_id& f,
+                             const virtual_server_id& vf,
+                             const virtual_server_id& vt,
+                             network_msgtype t,
+                             std::auto_ptr<e::buffer> m,
+                             const e::unpacker& u)
+    : from(f)
+    , vfrom(vf)
+    , vto(vt)
+    , type(t)
+    , msg(m)
+    , up(u)
+    , enqueued(e::time())
+{
+}
+
+storage_pool :: work :: ~work() throw ()
+{
+}
+
+///////////////////////////////// Storage Queue ////////////////////////////////
+
+class storage_pool::queue
+{
+    public:
+        queue();
+        ~queue() throw ();
+
+    public:
+        po6::threads::mutex mtx;
+        po6::threads::cond avail;
+        po6::threads::cond space;
+        po6::threads::cond idle;
+        std::list<work*> items;
+        uint64_t depth;
+        uint64_t max_depth;
+        uint64_t wait;
+        size_t threads;
+        size_t limit;
+        size_t active;
+        bool shutdown;
+        performance_counter processed;
+        performance_counter blocked;
+
+    private:
+        queue(const queue&);
+        queue& operator = (const queue&);
+};
+
+storage_pool :: queue :: queue()
+    : mtx()
+    , avail(&mtx)
+    , space(&mtx)
+    , idle(&mtx)
+    , items()
+    , depth(0)
+    , max_depth(0)
+    , wait(0)
+    , threads(0)
+    , limit(0)
+    , active(0)
+    , shutdown(false)
+    , processed()
+    , blocked()
+{
+}
+
+storage_pool :: queue :: ~queue() throw ()
+{
+    for (std::list<work*>::iterator it = items.begin();
+            it != items.end(); ++it)
+    {
+        delete *it;
+    }
+}
+
+////////////////////////////// Storage Parameters //////////////////////////////
+
+storage_pool :: parameters :: parameters()
+{
+    // every class runs on the network threads unless configured otherwise
+    for (size_t i = 0; i < NUM_CLASSES; ++i)
+    {
+        threads[i] = 0;
+        limit[i] = 1024;
+    }
+}
+
+storage_pool :: parameters :: ~parameters() throw ()
+{
+}
+
+///////////////////////////////// Storage Pool /////////////////////////////////
+
+const char*
+storage_pool :: name(work_class wc)
+{
+    switch (wc)
+    {
+        case POINT_READ:
+            return "point_read";
+        case WRITE:
+            return "write";
+        case SCAN:
+            return "scan";
+        case TRANSFER:
+            return "transfer";
+        default:
+            return "unknown";
+    }
+}
+
+storage_pool :: storage_pool(daemon* d)
+    : m_daemon(d)
+    , m_threads()
+{
+    for (size_t i = 0; i < NUM_CLASSES; ++i)
+    {
+        m_queues[i] = new queue();
+    }
+}
+
+storage_pool :: ~storage_pool() throw ()
+{
+    shutdown();
+
+    for (size_t i = 0; i < NUM_CLASSES; ++i)
+    {
+        delete m_queues[i];
+    }
+}
+
+bool
+storage_pool :: setup(const parameters& params)
+{
+    for (size_t i = 0; i < NUM_CLASSES; ++i)
+    {
+        po6::threads::mutex::hold hold(&m_queues[i]->mtx);
+        m_queues[i]->threads = params.threads[i];
+        m_queues[i]->limit = std::max(params.limit[i], size_t(1));
+        m_queues[i]->shutdown = false;
+    }
+
+    for (size_t i = 0; i < NUM_CLASSES; ++i)
+    {
+        for (size_t j = 0; j < params.threads[i]; ++j)
+        {
+            using namespace po6::threads;
+            e::compat::shared_ptr<thread> t(new thread(make_thread_wrapper(&storage_pool::worker, this, i)));
+            m_threads.push_back(t);
+            t->start();
+        }
+    }
+
+    return true;
+}
+
+void
+storage_pool :: teardown()
+{
+    shutdown();
+}
+
+void
+storage_pool :: pause()
+{
+    for (size_t i = 0; i < NUM_CLASSES; ++i)
+    {
+        queue* q = m_queues[i];
+        po6::threads::mutex::hold hold(&q->mtx);
+
+        while (!q->items.empty() || q->active > 0)
+        {
+            q->idle.wait();
+        }
+    }
+}
+
+void
+storage_pool :: unpause()
+{
+}
+
+void
+storage_pool :: enqueue(work_class wc,
+                        const server_id& from,
+                        const virtual_server_id& vfrom,
+                        const virtual_server_id& vto,
+                        network_msgtype type,
+                        std::auto_ptr<e::buffer> msg,
+                        const e::unpacker& up)
+{
+    assert(wc < NUM_CLASSES);
+    queue* q = m_queues[wc];
+
+    if (q->threads == 0)
+    {
+        m_daemon->process_message(from, vfrom, vto, type, msg, up);
+        q->processed.tap();
+        return;
+    }
+
+    std::auto_ptr<work> w(new work(from, vfrom, vto, type, msg, up));
+    po6::threads::mutex::hold hold(&q->mtx);
+
+    if (q->depth >= q->limit && !q->shutdown)
+    {
+        q->blocked.tap();
+
+        while (q->depth >= q->limit && !q->shutdown)
+        {
+            q->space.wait();
+        }
+    }
+
+    q->items.push_back(w.get());
+    w.release();
+    ++q->depth;
+    q->max_depth = std::max(q->max_depth, q->depth);
+    q->avail.signal();
+}
+
+size_t
+storage_pool :: threads(work_class wc)
+{
+    po6::threads::mutex::hold hold(&m_queues[wc]->mtx);
+    return m_queues[wc]->threads;
+}
+
+uint64_t
+storage_pool :: depth(work_class wc)
+{
+    po6::threads::mutex::hold hold(&m_queues[wc]->mtx);
+    return m_queues[wc]->depth;
+}
+
+uint64_t
+storage_pool :: max_depth(work_class wc)
+{
+    // the high-water mark since the previous call
+    po6::threads::mutex::hold hold(&m_queues[wc]->mtx);
+    uint64_t ret = m_queues[wc]->max_depth;
+    m_queues[wc]->max_depth = m_queues[wc]->depth;
+    return ret;
+}
+
+uint64_t
+storage_pool :: wait(work_class wc)
+{
+    po6::threads::mutex::hold hold(&m_queues[wc]->mtx);
+    return m_queues[wc]->depth > 0 ? m_queues[wc]->wait : 0;
+}
+
+uint64_t
+storage_pool :: processed(work_class wc)
+{
+    return m_queues[wc]->processed.read();
+}
+
+uint64_t
+storage_pool :: blocked(work_class wc)
+{
+    return m_queues[wc]->blocked.read();
+}
+
+void
+storage_pool :: worker(size_t wc)
+{
+    sigset_t ss;
+
+    if (sigfillset(&ss) < 0)
+    {
+        PLOG(ERROR) << "sigfillset";
+        return;
+    }
+
+    sigdelset(&ss, SIGPROF);
+
+    if (pthread_sigmask(SIG_SETMASK, &ss, NULL) < 0)
+    {
+        PLOG(ERROR) << "could not block signals";
+        return;
+    }
+
+    queue* q = m_queues[wc];
+    LOG(INFO) << name(static_cast<work_class>(wc)) << " storage thread started";
+
+    while (true)
+    {
+        std::auto_ptr<work> w;
+
+        {
+            po6::threads::mutex::hold hold(&q->mtx);
+
+            while (q->items.empty() && !q->shutdown)
+            {
+                q->avail.wait();
+            }
+
+            if (q->shutdown)
+            {
+                break;
+            }
+
+            w.reset(q->items.front());
+            q->items.pop_front();
+            --q->depth;
+            q->space.signal();
+            q->wait = (q->wait * 7 + (e::time() - w->enqueued)) / 8;
+            ++q->active;
+        }
+
+        m_daemon->process_message(w->from, w->vfrom, w->vto, w->type, w->msg, w->up);
+        q->processed.tap();
+
+        {
+            po6::threads::mutex::hold hold(&q->mtx);
+            --q->active;
+
+            if (q->items.empty() && q->active == 0)
+            {
+                q->idle.broadcast();
+            }
+        }
+    }
+
+    LOG(INFO) << name(static_cast<work_class>(wc)) << " storage thread shutting down";
+}
+
+void
+storage_pool :: shutdown()
+{
+    for (size_t i = 0; i < NUM_CLASSES; ++i)
+    {
+        po6::threads::mutex::hold hold(&m_queues[i]->mtx);
+        m_queues[i]->shutdown = true;
+        m_queues[i]->avail.broadcast();
+        m_queues[i]->space.broadcast();
+        m_queues[i]->idle.broadcast();
+    }
+
+    for (size_t i = 0; i < m_threads.size(); ++i)
+    {
+        m_threads[i]->join();
+    }
+
+    m_threads.clear();
+}
@@ -0,0 +1,142 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#ifndef hyperdex_daemon_storage_pool_h_
+#define hyperdex_daemon_storage_pool_h_
+
+// STL
+#include <list>
+#include <memory>
+#include <vector>
+
+// po6
+#include <po6/threads/cond.h>
+#include <po6/threads/mutex.h>
+#include <po6/threads/thread.h>
+
+// e
+#include <e/buffer.h>
+#include <e/compat.h>
+
+// HyperDex
+#include "namespace.h"
+#include "common/ids.h"
+#include "common/network_msgtype.h"
+#include "daemon/performance_counter.h"
+
+BEGIN_HYPERDEX_NAMESPACE
+class daemon;
+
+// Runs storage work on its own threads so that the network threads only parse
+// and dispatch.  Each class of work has its own queue and workers, so a burst
+// of scans or state transfer cannot starve point reads or writes.
+class storage_pool
+{
+    public:
+        enum work_class
+        {
+            POINT_READ = 0,
+            WRITE      = 1,
+            SCAN       = 2,
+            TRANSFER   = 3
+        };
+        static const size_t NUM_CLASSES = 4;
+        static const char* name(work_class wc);
+        class parameters;
+
+    public:
+        storage_pool(daemon*);
+        ~storage_pool() throw ();
+
+    public:
+        bool setup(const parameters& params);
+        void teardown();
+        // wait until every queued item has been processed; the caller must
+        // first stop the network threads from enqueuing more work
+        void pause();
+        void unpause();
+
+    public:
+        // hand the message to the workers for "wc"; if "wc" has no workers,
+        // process it on the calling thread.  When the queue for "wc" is at
+        // its limit, wait for the workers to make room so that a slow disk
+        // slows the network threads instead of growing the queue.
+        void enqueue(work_class wc,
+                     const server_id& from,
+                     const virtual_server_id& vfrom,
+                     const virtual_server_id& vto,
+                     network_msgtype type,
+                     std::auto_ptr<e::buffer> msg,
+                     const e::unpacker& up);
+
+    public:
+        size_t threads(work_class wc);
+        uint64_t depth(work_class wc);
+        uint64_t max_depth(work_class wc);
+        // a moving average of how long work waits in the queue, or zero when
+        // the queue is empty
+        uint64_t wait(work_class wc);
+        uint64_t processed(work_class wc);
+        // how many times enqueue waited for room
+        uint64_t blocked(work_class wc);
+
+    private:
+        class work;
+        class queue;
+
+    private:
+        void worker(size_t wc);
+        void shutdown();
+
+    private:
+        daemon* m_daemon;
+        queue* m_queues[NUM_CLASSES];
+        std::vector<e::compat::shared_ptr<po6::threads::thread> > m_threads;
+
+    private:
+        storage_pool(const storage_pool&);
+        storage_pool& operator = (const storage_pool&);
+};
+
+class storage_pool::parameters
+{
+    public:
+        parameters();
+        ~parameters() throw ();
+
+    public:
+        // number of workers for each work_class; zero processes that class
+        // of work on the network threads
+        size_t threads[NUM_CLASSES];
+        // the most items that may wait in each queue
+        size_t limit[NUM_CLASSES];
+};
+
+END_HYPERDEX_NAMESPACE
+
+#endif // hyperdex_daemon_storage_pool_h_
@@ -0,0 +1,456 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+// C
+#include <stdlib.h>
+
+// POSIX
+#include <unistd.h>
+
+// e
+#include <e/endian.h>
+
+// HyperDex
+#include "test/th.h"
+#include "common/range.h"
+#include "daemon/datalayer_encodings.h"
+#include "daemon/datalayer_iterator.h"
+#include "daemon/index_int64.h"
+#include "daemon/index_string.h"
+
+using hyperdex::datalayer;
+using hyperdex::leveldb_db_ptr;
+using hyperdex::leveldb_snapshot_ptr;
+using hyperdex::range;
+using hyperdex::region_id;
+
+// The iterators under test only need the base classes from the datalayer;
+// defining them here keeps the rest of the daemon out of this binary.
+
+datalayer :: iterator :: iterator(leveldb_snapshot_ptr s)
+    : m_ref(0)
+    , m_snap(s)
+{
+}
+
+leveldb_snapshot_ptr
+datalayer :: iterator :: snap()
+{
+    return m_snap;
+}
+
+datalayer :: iterator :: ~iterator() throw ()
+{
+}
+
+datalayer :: index_iterator :: index_iterator(leveldb_snapshot_ptr s)
+    : iterator(s)
+{
+}
+
+datalayer :: index_iterator :: ~index_iterator() throw ()
+{
+}
+
+void
+datalayer :: index_iterator :: seek_after(const e::slice&, const e::slice&)
+{
+    abort();
+}
+
+bool
+datalayer :: pace_background(uint64_t)
+{
+    return true;
+}
+
+namespace
+{
+
+hyperdex::index_int64 int64_ii;
+hyperdex::index_string string_ii;
+
+std::string
+int64(int64_t x)
+{
+    char buf[sizeof(int64_t)];
+    e::pack64le(x, buf);
+    return std::string(buf, sizeof(int64_t));
+}
+
+// a LevelDB instance in a scratch directory that is removed afterwards
+class database
+{
+    public:
+        database();
+        ~database() throw ();
+
+    public:
+        // index "key" under an int64 "value" of attribute "attr"
+        void index(const region_id& ri, uint16_t attr,
+                   int64_t value, const char* key);
+        // store an object with a string key
+        void object(const region_id& ri, const char* key);
+        leveldb_snapshot_ptr snapshot();
+
+    private:
+        char m_dir[64];
+        leveldb_db_ptr m_db;
+
+    private:
+        database(const database&);
+        database& operator = (const database&);
+};
+
+database :: database()
+    : m_db()
+{
+    strcpy(m_dir, "/tmp/hyperdex-index-primitive-XXXXXX");
+    ASSERT_TRUE(mkdtemp(m_dir) != NULL);
+    leveldb::Options opts;
+    opts.create_if_missing = true;
+    leveldb::DB* db = NULL;
+    leveldb::Status st = leveldb::DB::Open(opts, m_dir, &db);
+    ASSERT_TRUE(st.ok());
+    m_db.reset(db);
+}
+
+database :: ~database() throw ()
+{
+    m_db.reset();
+    leveldb::DestroyDB(m_dir, leveldb::Options());
+    rmdir(m_dir);
+}
+
+void
+database :: index(const region_id& ri, uint16_t attr,
+                  int64_t value, const char* key)
+{
+    std::string v(int64(value));
+    e::slice vs(v);
+    leveldb::WriteBatch updates;
+    int64_ii.index_changes(ri, attr, &string_ii, e::slice(key), NULL, &vs, &updates);
+    ASSERT_TRUE(m_db->Write(leveldb::WriteOptions(), &updates).ok());
+}
+
+void
+database :: object(const region_id& ri, const char* key)
+{
+    std::vector<char> scratch;
+    leveldb::Slice k;
+    hyperdex::encode_key(ri, HYPERDATATYPE_STRING, e::slice(key), &scratch, &k);
+    ASSERT_TRUE(m_db->Put(leveldb::WriteOptions(), k, leveldb::Slice("value")).ok());
+}
+
+leveldb_snapshot_ptr
+database :: snapshot()
+{
+    return leveldb_snapshot_ptr(m_db, m_db->GetSnapshot());
+}
+
+// attribute 1 of region 1 holds -5, 10, 20, ... 50 under keys named after
+// their values, with entries for its neighbours on either side
+void
+populate(database* db)
+{
+    db->index(region_id(0), 1, 25, "z25");
+    db->index(region_id(1), 1, -5, "n05");
+    db->index(region_id(1), 1, 10, "a10");
+    db->index(region_id(1), 1, 20, "a20");
+    db->index(region_id(1), 1, 30, "a30");
+    db->index(region_id(1), 1, 40, "a40");
+    db->index(region_id(1), 1, 50, "a50");
+    db->index(region_id(1), 2, 0, "x00");
+    db->index(region_id(2), 1, 15, "y15");
+    db->object(region_id(0), "z");
+    db->object(region_id(1), "b");
+    db->object(region_id(1), "c");
+    db->object(region_id(1), "d");
+    db->object(region_id(1), "e");
+    db->object(region_id(1), "f");
+    db->object(region_id(2), "a");
+}
+
+// an inclusive range over attribute "attr"; NULL bounds are open
+range
+values(uint16_t attr, const std::string* start, const std::string* end)
+{
+    range r;
+    r.attr = attr;
+    r.type = attr == 0 ? HYPERDATATYPE_STRING : HYPERDATATYPE_INT64;
+    r.has_start = start != NULL;
+    r.has_end = end != NULL;
+    r.invalid = false;
+
+    if (start)
+    {
+        r.start = e::slice(*start);
+    }
+
+    if (end)
+    {
+        r.end = e::slice(*end);
+    }
+
+    return r;
+}
+
+datalayer::index_iterator*
+in_order(database* db, const region_id& ri, const range& r, bool reverse)
+{
+    hyperdex::index_info* ii = r.attr == 0 ? static_cast<hyperdex::index_info*>(&string_ii)
+                                           : static_cast<hyperdex::index_info*>(&int64_ii);
+    return ii->iterator_in_order(db->snapshot(), ri, r, &string_ii, reverse);
+}
+
+// the keys the iterator visits from where it stands, space separated
+std::string
+walk(datalayer::index_iterator* it)
+{
+    std::string keys;
+
+    for (; it->valid(); it->next())
+    {
+        if (!keys.empty())
+        {
+            keys += " ";
+        }
+
+        keys += it->key().str();
+    }
+
+    return keys;
+}
+
+std::string
+walk(database* db, const region_id& ri, const range& r, bool reverse)
+{
+    e::intrusive_ptr<datalayer::index_iterator> it(in_order(db, ri, r, reverse));
+    return walk(it.get());
+}
+
+} // namespace
+
+TEST(IndexPrimitive, RangeForward)
+{
+    database db;
+    populate(&db);
+    std::string lo(int64(20));
+    std::string hi(int64(40));
+    ASSERT_EQ(walk(&db, region_id(1), values(1, NULL, NULL), false),
+              "n05 a10 a20 a30 a40 a50");
+    ASSERT_EQ(walk(&db, region_id(1), values(1, &lo, &hi), false), "a20 a30 a40");
+    ASSERT_EQ(walk(&db, region_id(1), values(2, NULL, NULL), false), "x00");
+}
+
+TEST(IndexPrimitive, RangeReverse)
+{
+    database db;
+    populate(&db);
+    ASSERT_EQ(walk(&db, region_id(1), values(1, NULL, NULL), true),
+              "a50 a40 a30 a20 a10 n05");
+    ASSERT_EQ(walk(&db, region_id(1), values(2, NULL, NULL), true), "x00");
+    ASSERT_EQ(walk(&db, region_id(2), values(1, NULL, NULL), true), "y15");
+    ASSERT_EQ(walk(&db, region_id(0), values(1, NULL, NULL), true), "z25");
+    ASSERT_EQ(walk(&db, region_id(3), values(1, NULL, NULL), true), "");
+}
+
+TEST(IndexPrimitive, RangeReverseBounds)
+{
+    database db;
+    populate(&db);
+    std::string v0(int64(0));
+    std::string v20(int64(20));
+    std::string v35(int64(35));
+    std::string v40(int64(40));
+    std::string v50(int64(50));
+    std::string v60(int64(60));
+    // both ends are inclusive
+    ASSERT_EQ(walk(&db, region_id(1), values(1, &v20, &v40), true), "a40 a30 a20");
+    ASSERT_EQ(walk(&db, region_id(1), values(1, &v20, &v20), true), "a20");
+    ASSERT_EQ(walk(&db, region_id(1), values(1, &v50, &v50), true), "a50");
+    // bounds that fall between entries
+    ASSERT_EQ(walk(&db, region_id(1), values(1, &v0, &v35), true), "a30 a20 a10");
+    ASSERT_EQ(walk(&db, region_id(1), values(1, NULL, &v60), true),
+              "a50 a40 a30 a20 a10 n05");
+    ASSERT_EQ(walk(&db, region_id(1), values(1, &v35, NULL), true), "a50 a40");
+    // ranges that hold nothing
+    ASSERT_EQ(walk(&db, region_id(1), values(1, &v60, NULL), true), "");
+    ASSERT_EQ(walk(&db, region_id(1), values(1, NULL, &v0), true), "n05");
+    ASSERT_EQ(walk(&db, region_id(1), values(1, &v40, &v35), true), "");
+}
+
+TEST(IndexPrimitive, RangeReverseTies)
+{
+    database db;
+    populate(&db);
+    db.index(region_id(1), 1, 30, "b30");
+    db.index(region_id(1), 1, 30, "c30");
+    std::string v30(int64(30));
+    // equal values walk in the order of their keys, backwards too
+    ASSERT_EQ(walk(&db, region_id(1), values(1, &v30, &v30), false), "a30 b30 c30");
+    ASSERT_EQ(walk(&db, region_id(1), values(1, &v30, &v30), true), "c30 b30 a30");
+    ASSERT_EQ(walk(&db, region_id(1), values(1, &v30, NULL), true),
+              "a50 a40 c30 b30 a30");
+}
+
+TEST(IndexPrimitive, RangeReverseAtEndOfDatabase)
+{
+    database db;
+    db.index(region_id(1), 1, 10, "a10");
+    db.index(region_id(1), 1, 20, "a20");
+    std::string v15(int64(15));
+    // nothing sorts after the range, so the walk starts from the last entry
+    ASSERT_EQ(walk(&db, region_id(1), values(1, NULL, NULL), true), "a20 a10");
+    ASSERT_EQ(walk(&db, region_id(1), values(1, NULL, &v15), true), "a10");
+    ASSERT_EQ(walk(&db, region_id(0), values(1, NULL, NULL), true), "");
+}
+
+TEST(IndexPrimitive, KeyForward)
+{
+    database db;
+    populate(&db);
+    std::string c("c");
+    std::string e("e");
+    ASSERT_EQ(walk(&db, region_id(1), values(0, NULL, NULL), false), "b c d e f");
+    ASSERT_EQ(walk(&db, region_id(1), values(0, &c, &e), false), "c d e");
+}
+
+TEST(IndexPrimitive, KeyReverse)
+{
+    database db;
+    populate(&db);
+    ASSERT_EQ(walk(&db, region_id(1), values(0, NULL, NULL), true), "f e d c b");
+    ASSERT_EQ(walk(&db, region_id(0), values(0, NULL, NULL), true), "z");
+    // the last region in the database starts from its last object
+    ASSERT_EQ(walk(&db, region_id(2), values(0, NULL, NULL), true), "a");
+    ASSERT_EQ(walk(&db, region_id(3), values(0, NULL, NULL), true), "");
+}
+
+TEST(IndexPrimitive, KeyReverseBounds)
+{
+    database db;
+    populate(&db);
+    std::string a("a");
+    std::string c("c");
+    std::string cc("cc");
+    std::string e("e");
+    std::string z("z");
+    ASSERT_EQ(walk(&db, region_id(1), values(0, &c, &e), true), "e d c");
+    ASSERT_EQ(walk(&db, region_id(1), values(0, &c, &c), true), "c");
+    ASSERT_EQ(walk(&db, region_id(1), values(0, &a, &cc), true), "c b");
+    ASSERT_EQ(walk(&db, region_id(1), values(0, &cc, &z), true), "f e d");
+    ASSERT_EQ(walk(&db, region_id(1), values(0, NULL, &a), true), "");
+    ASSERT_EQ(walk(&db, region_id(1), values(0, &z, NULL), true), "");
+}
+
+TEST(IndexPrimitive, RangeSeekAfter)
+{
+    database db;
+    populate(&db);
+    db.index(region_id(1), 1, 30, "b30");
+    db.index(region_id(1), 1, 30, "c30");
+    std::string v25(int64(25));
+    std::string v30(int64(30));
+    std::string v60(int64(60));
+    e::intrusive_ptr<datalayer::index_iterator> it;
+    // the cursor's own entry is skipped, and equal values resume by key
+    it = in_order(&db, region_id(1), values(1, NULL, NULL), false);
+    it->seek_after(e::slice(v30), e::slice("b30"));
+    ASSERT_EQ(walk(it.get()), "c30 a40 a50");
+    it = in_order(&db, region_id(1), values(1, NULL, NULL), true);
+    it->seek_after(e::slice(v30), e::slice("b30"));
+    ASSERT_EQ(walk(it.get()), "a30 a20 a10 n05");
+    // an object that moved since the cursor was made resumes where it was
+    it = in_order(&db, region_id(1), values(1, NULL, NULL), false);
+    it->seek_after(e::slice(v25), e::slice("a25"));
+    ASSERT_EQ(walk(it.get()), "a30 b30 c30 a40 a50");
+    it = in_order(&db, region_id(1), values(1, NULL, NULL), true);
+    it->seek_after(e::slice(v25), e::slice("a25"));
+    ASSERT_EQ(walk(it.get()), "a20 a10 n05");
+    // the key orders the cursor among equal values, not its value elsewhere
+    it = in_order(&db, region_id(1), values(1, NULL, NULL), false);
+    it->seek_after(e::slice(v30), e::slice("a50"));
+    ASSERT_EQ(walk(it.get()), "b30 c30 a40 a50");
+    // resuming after the last entry, in either direction
+    it = in_order(&db, region_id(1), values(1, NULL, NULL), false);
+    it->seek_after(e::slice(v60), e::slice("a60"));
+    ASSERT_EQ(walk(it.get()), "");
+    it = in_order(&db, region_id(1), values(1, NULL, NULL), true);
+    it->seek_after(e::slice(int64(-5)), e::slice("n05"));
+    ASSERT_EQ(walk(it.get()), "");
+    // the range still bounds the walk
+    it = in_order(&db, region_id(1), values(1, &v25, &v30), true);
+    it->seek_after(e::slice(v30), e::slice("c30"));
+    ASSERT_EQ(walk(it.get()), "b30 a30");
+    it = in_order(&db, region_id(1), values(1, &v25, &v30), false);
+    it->seek_after(e::slice(v30), e::slice("a30"));
+    ASSERT_EQ(walk(it.get()), "b30 c30");
+}
+
+TEST(IndexPrimitive, RangeSeekAfterAtEndOfDatabase)
+{
+    database db;
+    db.index(region_id(1), 1, 10, "a10");
+    db.index(region_id(1), 1, 20, "a20");
+    std::string v30(int64(30));
+    e::intrusive_ptr<datalayer::index_iterator> it;
+    it = in_order(&db, region_id(1), values(1, NULL, NULL), true);
+    it->seek_after(e::slice(v30), e::slice("a30"));
+    ASSERT_EQ(walk(it.get()), "a20 a10");
+}
+
+TEST(IndexPrimitive, KeySeekAfter)
+{
+    database db;
+    populate(&db);
+    e::intrusive_ptr<datalayer::index_iterator> it;
+    it = in_order(&db, region_id(1), values(0, NULL, NULL), false);
+    it->seek_after(e::slice("c"), e::slice("c"));
+    ASSERT_EQ(walk(it.get()), "d e f");
+    it = in_order(&db, region_id(1), values(0, NULL, NULL), true);
+    it->seek_after(e::slice("c"), e::slice("c"));
+    ASSERT_EQ(walk(it.get()), "b");
+    // a deleted object resumes where it was
+    it = in_order(&db, region_id(1), values(0, NULL, NULL), false);
+    it->seek_after(e::slice("cc"), e::slice("cc"));
+    ASSERT_EQ(walk(it.get()), "d e f");
+    it = in_order(&db, region_id(1), values(0, NULL, NULL), true);
+    it->seek_after(e::slice("cc"), e::slice("cc"));
+    ASSERT_EQ(walk(it.get()), "c b");
+    // the walk stays within the region
+    it = in_order(&db, region_id(1), values(0, NULL, NULL), false);
+    it->seek_after(e::slice("f"), e::slice("f"));
+    ASSERT_EQ(walk(it.get()), "");
+    it = in_order(&db, region_id(1), values(0, NULL, NULL), true);
+    it->seek_after(e::slice("b"), e::slice("b"));
+    ASSERT_EQ(walk(it.get()), "");
+    it = in_order(&db, region_id(2), values(0, NULL, NULL), true);
+    it->seek_after(e::slice("z"), e::slice("z"));
+    ASSERT_EQ(walk(it.get()), "a");
+}
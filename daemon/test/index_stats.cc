@@ -0,0 +1,166 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+// e
+#include <e/endian.h>
+
+// HyperDex
+#include "test/th.h"
+#include "daemon/index_stats.h"
+
+using hyperdex::index_stats;
+
+namespace
+{
+
+// big-endian so that memcmp orders the values numerically
+std::string
+value(uint64_t x)
+{
+    char buf[sizeof(uint64_t)];
+    e::pack64be(x, buf);
+    return std::string(buf, sizeof(uint64_t));
+}
+
+uint64_t
+estimate(const index_stats::attribute& a, uint64_t lo, uint64_t hi)
+{
+    std::string start(value(lo));
+    std::string end(value(hi));
+    e::slice s(start);
+    e::slice t(end);
+    return a.estimate(&s, &t);
+}
+
+bool
+near(uint64_t actual, uint64_t expected, uint64_t slack)
+{
+    return actual + slack >= expected && actual <= expected + slack;
+}
+
+} // namespace
+
+TEST(IndexStats, Empty)
+{
+    index_stats::attribute a;
+    a.finish();
+    ASSERT_TRUE(a.sampled);
+    ASSERT_EQ(a.entries, 0U);
+    ASSERT_EQ(a.distinct, 0U);
+    ASSERT_EQ(a.estimate(NULL, NULL), 0U);
+    ASSERT_EQ(estimate(a, 0, 100), 0U);
+}
+
+TEST(IndexStats, Uniform)
+{
+    index_stats::attribute a;
+
+    for (uint64_t i = 0; i < 10000; ++i)
+    {
+        std::string v(value(i));
+        a.add(e::slice(v));
+    }
+
+    a.finish();
+    ASSERT_EQ(a.entries, 10000U);
+    ASSERT_EQ(a.distinct, 10000U);
+    ASSERT_TRUE(a.bounds.size() <= 2 * index_stats::attribute::BUCKETS);
+    ASSERT_TRUE(a.bounds.size() > index_stats::attribute::BUCKETS);
+    ASSERT_EQ(a.estimate(NULL, NULL), 10000U);
+    ASSERT_TRUE(near(estimate(a, 1000, 2999), 2000, a.stride));
+    ASSERT_TRUE(near(estimate(a, 0, 4999), 5000, a.stride));
+    ASSERT_TRUE(near(estimate(a, 9000, 20000), 1000, a.stride));
+    // one distinct value is one entry
+    ASSERT_EQ(estimate(a, 1234, 1234), 1U);
+    // outside of the values seen
+    ASSERT_EQ(estimate(a, 10000, 20000), 0U);
+
+    std::string v(value(5000));
+    e::slice s(v);
+    ASSERT_TRUE(near(a.estimate(&s, NULL), 5000, a.stride));
+    ASSERT_TRUE(near(a.estimate(NULL, &s), 5001, a.stride));
+}
+
+TEST(IndexStats, Skewed)
+{
+    index_stats::attribute a;
+
+    for (uint64_t i = 0; i < 4000; ++i)
+    {
+        std::string v(value(i < 3000 ? 7 : i));
+        a.add(e::slice(v));
+    }
+
+    a.finish();
+    ASSERT_EQ(a.entries, 4000U);
+    ASSERT_EQ(a.distinct, 1001U);
+    // the popular value spans many bounds
+    ASSERT_TRUE(near(estimate(a, 7, 7), 3000, a.stride));
+    // the others fall back to the average of four entries per value
+    ASSERT_EQ(estimate(a, 3500, 3500), 4U);
+    ASSERT_TRUE(near(estimate(a, 3000, 3999), 1000, a.stride));
+}
+
+TEST(IndexStats, RoundTrip)
+{
+    index_stats s;
+    s.objects = 1000;
+    s.approximate_size = 1 << 20;
+    s.taken = 42;
+    s.attrs.resize(3);
+
+    for (uint64_t i = 0; i < 1000; ++i)
+    {
+        std::string v(value(i / 3));
+        s.attrs[0].add(e::slice(v));
+    }
+
+    s.attrs[0].finish();
+    s.attrs[2].finish();
+    std::string out(s.serialize());
+
+    index_stats t;
+    ASSERT_TRUE(t.parse(e::slice(out)));
+    ASSERT_EQ(t.objects, 1000U);
+    ASSERT_EQ(t.approximate_size, 1U << 20);
+    ASSERT_EQ(t.taken, 42U);
+    ASSERT_EQ(t.attrs.size(), 3U);
+    ASSERT_TRUE(t.attrs[0].sampled);
+    ASSERT_FALSE(t.attrs[1].sampled);
+    ASSERT_TRUE(t.attrs[2].sampled);
+    ASSERT_EQ(t.attrs[0].entries, s.attrs[0].entries);
+    ASSERT_EQ(t.attrs[0].distinct, s.attrs[0].distinct);
+    ASSERT_EQ(t.attrs[0].stride, s.attrs[0].stride);
+    ASSERT_TRUE(t.attrs[0].bounds == s.attrs[0].bounds);
+    ASSERT_EQ(estimate(t.attrs[0], 100, 199), estimate(s.attrs[0], 100, 199));
+
+    // anything short of the whole encoding is rejected
+    for (size_t i = 0; i < out.size(); i += 7)
+    {
+        index_stats u;
+        ASSERT_FALSE(u.parse(e::slice(out.data(), i)));
+    }
+}
@@ -0,0 +1,148 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// C
+#include <cstdio>
+#include <cstring>
+
+// HyperDex
+#include "test/th.h"
+#include "daemon/object_cache.h"
+
+using hyperdex::object_cache;
+
+namespace
+{
+
+e::intrusive_ptr<object_cache::entry>
+make_entry(const char* key, const char* value, uint64_t version)
+{
+    e::intrusive_ptr<object_cache::entry> ent;
+    ent = new object_cache::entry(e::slice(key, strlen(key)));
+    ent->backing = value;
+    ent->value.push_back(e::slice(ent->backing.data(), ent->backing.size()));
+    ent->version = version;
+    return ent;
+}
+
+} // namespace
+
+TEST(ObjectCache, Disabled)
+{
+    object_cache oc;
+    e::intrusive_ptr<object_cache::entry> ent;
+    oc.insert(oc.generation(e::slice("key", 3)), make_entry("key", "value", 1));
+    ASSERT_FALSE(oc.lookup(e::slice("key", 3), &ent));
+    ASSERT_EQ(oc.size(), 0U);
+}
+
+TEST(ObjectCache, InsertLookupInvalidate)
+{
+    object_cache oc;
+    oc.set_capacity(1024 * 1024);
+    e::intrusive_ptr<object_cache::entry> ent;
+    ASSERT_FALSE(oc.lookup(e::slice("key", 3), &ent));
+    ASSERT_EQ(oc.misses(), 1U);
+    oc.insert(oc.generation(e::slice("key", 3)), make_entry("key", "value", 5));
+    ASSERT_TRUE(oc.lookup(e::slice("key", 3), &ent));
+    ASSERT_EQ(oc.hits(), 1U);
+    ASSERT_EQ(ent->version, 5U);
+    ASSERT_TRUE(ent->value[0] == e::slice("value", 5));
+    oc.invalidate(e::slice("key", 3));
+    ASSERT_FALSE(oc.lookup(e::slice("key", 3), &ent));
+    ASSERT_EQ(oc.size(), 0U);
+}
+
+TEST(ObjectCache, RacingWriteDropsInsert)
+{
+    object_cache oc;
+    oc.set_capacity(1024 * 1024);
+    e::intrusive_ptr<object_cache::entry> ent;
+    // a reader grabs the generation, a writer invalidates, then the
+    // reader's (now stale) object must not make it into the cache
+    uint64_t gen = oc.generation(e::slice("key", 3));
+    oc.invalidate(e::slice("key", 3));
+    oc.insert(gen, make_entry("key", "stale", 1));
+    ASSERT_FALSE(oc.lookup(e::slice("key", 3), &ent));
+}
+
+TEST(ObjectCache, WritesToOtherKeysKeepInsert)
+{
+    object_cache oc;
+    oc.set_capacity(1024 * 1024);
+    e::intrusive_ptr<object_cache::entry> ent;
+    uint64_t gen = oc.generation(e::slice("key", 3));
+    char key[32];
+
+    // a steady stream of writes elsewhere, many of them to the same shard,
+    // must not keep the reader's object out of the cache
+    for (size_t i = 0; i < 32; ++i)
+    {
+        sprintf(key, "other%lu", (unsigned long)i);
+        oc.invalidate(e::slice(key, strlen(key)));
+    }
+
+    oc.insert(gen, make_entry("key", "value", 1));
+    ASSERT_TRUE(oc.lookup(e::slice("key", 3), &ent));
+}
+
+TEST(ObjectCache, InvalidatePrefix)
+{
+    object_cache oc;
+    oc.set_capacity(1024 * 1024);
+    e::intrusive_ptr<object_cache::entry> ent;
+    oc.insert(oc.generation(e::slice("a1", 2)), make_entry("a1", "x", 1));
+    oc.insert(oc.generation(e::slice("a2", 2)), make_entry("a2", "x", 1));
+    oc.insert(oc.generation(e::slice("b1", 2)), make_entry("b1", "x", 1));
+    oc.invalidate_prefix(e::slice("a", 1));
+    ASSERT_FALSE(oc.lookup(e::slice("a1", 2), &ent));
+    ASSERT_FALSE(oc.lookup(e::slice("a2", 2), &ent));
+    ASSERT_TRUE(oc.lookup(e::slice("b1", 2), &ent));
+}
+
+TEST(ObjectCache, EvictsLeastRecentlyUsed)
+{
+    object_cache oc;
+    // one entry's worth of room in every shard
+    e::intrusive_ptr<object_cache::entry> probe = make_entry("k", "v", 1);
+    oc.set_capacity(16 * (probe->footprint() + 64));
+    e::intrusive_ptr<object_cache::entry> ent;
+    char key[32];
+
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        sprintf(key, "k%lu", (unsigned long)i);
+        oc.insert(oc.generation(e::slice(key, strlen(key))), make_entry(key, "v", i));
+    }
+
+    ASSERT_LE(oc.size(), 16 * (probe->footprint() + 64));
+    // the most recent insert is always still there
+    ASSERT_TRUE(oc.lookup(e::slice(key, strlen(key)), &ent));
+    ASSERT_EQ(ent->version, 999U);
+    // and entries that were evicted are still valid for readers holding them
+    ASSERT_TRUE(ent->value[0] == e::slice("v", 1));
+}
@@ -0,0 +1,120 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// C
+#include <cstdio>
+
+// STL
+#include <string>
+
+// HyperDex
+#include "test/th.h"
+#include "daemon/region_tree.h"
+
+using hyperdex::region_tree;
+
+namespace
+{
+
+void
+fill(region_tree* tree, size_t n, uint64_t version)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        char buf[32];
+        size_t sz = sprintf(buf, "key%lu", (unsigned long)i);
+        tree->add(e::slice(buf, sz), version);
+    }
+}
+
+size_t
+count(const std::vector<bool>& leaves)
+{
+    size_t c = 0;
+
+    for (size_t i = 0; i < leaves.size(); ++i)
+    {
+        c += leaves[i] ? 1 : 0;
+    }
+
+    return c;
+}
+
+} // namespace
+
+TEST(RegionTree, EmptyTreesMatch)
+{
+    region_tree a;
+    region_tree b;
+    std::vector<bool> leaves;
+    ASSERT_EQ(a.root(), b.root());
+    a.diff(&b, &leaves);
+    ASSERT_EQ(leaves.size(), region_tree::LEAVES);
+    ASSERT_EQ(count(leaves), 0U);
+}
+
+TEST(RegionTree, OrderDoesNotMatter)
+{
+    region_tree a;
+    region_tree b;
+    a.add(e::slice("x", 1), 1);
+    a.add(e::slice("y", 1), 2);
+    b.add(e::slice("y", 1), 2);
+    b.add(e::slice("x", 1), 1);
+    ASSERT_EQ(a.root(), b.root());
+}
+
+TEST(RegionTree, DiffFindsChangedLeaves)
+{
+    region_tree a;
+    region_tree b;
+    fill(&a, 10000, 1);
+    fill(&b, 10000, 1);
+    ASSERT_EQ(a.root(), b.root());
+
+    // a newer version of one key, and a key only one side has
+    b.add(e::slice("key17", 5), 1);
+    b.add(e::slice("key17", 5), 2);
+    b.add(e::slice("extra", 5), 1);
+    ASSERT_NE(a.root(), b.root());
+
+    std::vector<bool> leaves;
+    a.diff(&b, &leaves);
+    ASSERT_TRUE(leaves[region_tree::leaf_for(e::slice("key17", 5))]);
+    ASSERT_TRUE(leaves[region_tree::leaf_for(e::slice("extra", 5))]);
+    ASSERT_LE(count(leaves), 2U);
+}
+
+TEST(RegionTree, SetLeaves)
+{
+    region_tree a;
+    region_tree b;
+    fill(&a, 100, 3);
+    ASSERT_TRUE(b.set_leaves(a.leaves()));
+    ASSERT_EQ(a.root(), b.root());
+    ASSERT_FALSE(b.set_leaves(std::vector<uint64_t>(3)));
+}
@@ -0,0 +1,227 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+// HyperDex
+#include "test/th.h"
+#include "daemon/replication_manager_client_batch.h"
+#include "daemon/replication_manager_key_state.h"
+#include "daemon/replication_manager_pending.h"
+
+BEGIN_HYPERDEX_NAMESPACE
+
+class replication_manager_test
+{
+    public:
+        typedef replication_manager::key_state key_state;
+        typedef replication_manager::pending pending;
+        typedef replication_manager::client_batch client_batch;
+};
+
+END_HYPERDEX_NAMESPACE
+
+using hyperdex::region_id;
+using hyperdex::server_id;
+using hyperdex::virtual_server_id;
+
+typedef hyperdex::replication_manager_test::key_state key_state;
+typedef hyperdex::replication_manager_test::pending pending;
+typedef hyperdex::replication_manager_test::client_batch client_batch;
+
+namespace
+{
+
+e::intrusive_ptr<pending>
+client_op(uint64_t seq_id, bool has_value)
+{
+    std::vector<e::slice> value;
+
+    if (has_value)
+    {
+        value.push_back(e::slice("value", 5));
+    }
+
+    return new pending(std::auto_ptr<e::buffer>(),
+                       region_id(1), seq_id, false,
+                       has_value, value,
+                       server_id(42), seq_id,
+                       0, virtual_server_id());
+}
+
+e::intrusive_ptr<pending>
+chain_op(uint64_t seq_id)
+{
+    std::vector<e::slice> value(1, e::slice("value", 5));
+    return new pending(std::auto_ptr<e::buffer>(),
+                       region_id(1), seq_id, false,
+                       true, value,
+                       server_id(), 0,
+                       1, virtual_server_id(7));
+}
+
+} // namespace
+
+TEST(Coalesce, CollapsesIntoLastOp)
+{
+    e::intrusive_ptr<pending> a = client_op(1, true);
+    e::intrusive_ptr<pending> b = client_op(2, true);
+    e::intrusive_ptr<pending> c = client_op(3, true);
+    key_state::pending_list_t run;
+    run.push_back(std::make_pair(5, a));
+    run.push_back(std::make_pair(6, b));
+    run.push_back(std::make_pair(7, c));
+    ASSERT_TRUE(key_state::coalesce_run(&run, true));
+    ASSERT_EQ(run.size(), 1U);
+    ASSERT_TRUE(run.front().second == c);
+    // the value sent is the last one's, and the ops it replaced keep none
+    ASSERT_EQ(c->value.size(), 1U);
+    ASSERT_TRUE(a->value.empty());
+    ASSERT_TRUE(b->value.empty());
+    // the ops it replaced are kept, in order, to complete when it commits
+    ASSERT_EQ(c->subsumed.size(), 2U);
+    ASSERT_TRUE(c->subsumed[0] == a);
+    ASSERT_TRUE(c->subsumed[1] == b);
+}
+
+TEST(Coalesce, TakesVersionOfFirstOp)
+{
+    key_state::pending_list_t run;
+    run.push_back(std::make_pair(11, client_op(1, true)));
+    run.push_back(std::make_pair(12, client_op(2, true)));
+    run.push_back(std::make_pair(13, client_op(3, true)));
+    run.push_back(std::make_pair(14, client_op(4, true)));
+    ASSERT_TRUE(key_state::coalesce_run(&run, true));
+    ASSERT_EQ(run.size(), 1U);
+    // the value on disk is at 10, so replicas expect 11 next
+    ASSERT_EQ(run.front().first, 11U);
+}
+
+TEST(Coalesce, FreshOnlyWithoutOldValue)
+{
+    key_state::pending_list_t run;
+    run.push_back(std::make_pair(1, client_op(1, true)));
+    run.push_back(std::make_pair(2, client_op(2, true)));
+    ASSERT_TRUE(key_state::coalesce_run(&run, false));
+    ASSERT_TRUE(run.front().second->fresh);
+
+    run.clear();
+    run.push_back(std::make_pair(1, client_op(1, true)));
+    run.push_back(std::make_pair(2, client_op(2, true)));
+    ASSERT_TRUE(key_state::coalesce_run(&run, true));
+    ASSERT_FALSE(run.front().second->fresh);
+}
+
+TEST(Coalesce, DeleteReplacesRun)
+{
+    key_state::pending_list_t run;
+    run.push_back(std::make_pair(3, client_op(1, true)));
+    run.push_back(std::make_pair(4, client_op(2, false)));
+    ASSERT_TRUE(key_state::coalesce_run(&run, true));
+    ASSERT_EQ(run.size(), 1U);
+    ASSERT_EQ(run.front().first, 3U);
+    ASSERT_FALSE(run.front().second->has_value);
+    ASSERT_FALSE(run.front().second->fresh);
+}
+
+TEST(Coalesce, LeavesShortRunsAlone)
+{
+    e::intrusive_ptr<pending> a = client_op(1, true);
+    key_state::pending_list_t run;
+    ASSERT_FALSE(key_state::coalesce_run(&run, true));
+    run.push_back(std::make_pair(1, a));
+    ASSERT_FALSE(key_state::coalesce_run(&run, true));
+    ASSERT_EQ(run.size(), 1U);
+    ASSERT_TRUE(a->subsumed.empty());
+}
+
+TEST(Coalesce, LeavesChainOpsAlone)
+{
+    e::intrusive_ptr<pending> a = client_op(1, true);
+    e::intrusive_ptr<pending> b = chain_op(2);
+    key_state::pending_list_t run;
+    run.push_back(std::make_pair(1, a));
+    run.push_back(std::make_pair(2, b));
+    ASSERT_FALSE(key_state::coalesce_run(&run, true));
+    ASSERT_EQ(run.size(), 2U);
+    ASSERT_EQ(a->value.size(), 1U);
+    ASSERT_TRUE(b->subsumed.empty());
+}
+
+TEST(Coalesce, LeavesCreateThenDeleteAlone)
+{
+    key_state::pending_list_t run;
+    run.push_back(std::make_pair(1, client_op(1, true)));
+    run.push_back(std::make_pair(2, client_op(2, false)));
+    ASSERT_FALSE(key_state::coalesce_run(&run, false));
+    ASSERT_EQ(run.size(), 2U);
+}
+
+TEST(Coalesce, FlattensSubsumedOps)
+{
+    e::intrusive_ptr<pending> a = client_op(1, true);
+    e::intrusive_ptr<pending> b = client_op(2, true);
+    e::intrusive_ptr<pending> c = client_op(3, true);
+    b->subsumed.push_back(a);
+    key_state::pending_list_t run;
+    run.push_back(std::make_pair(1, b));
+    run.push_back(std::make_pair(2, c));
+    ASSERT_TRUE(key_state::coalesce_run(&run, true));
+    ASSERT_TRUE(b->subsumed.empty());
+    ASSERT_EQ(c->subsumed.size(), 2U);
+    ASSERT_TRUE(c->subsumed[0] == a);
+    ASSERT_TRUE(c->subsumed[1] == b);
+}
+
+// Completing the coalesced op and each op it subsumed, as chain_ack does,
+// answers every operation of a batched client request exactly once.
+TEST(Coalesce, SubsumedOpsCompleteTheirBatch)
+{
+    e::intrusive_ptr<client_batch> cb(new client_batch(virtual_server_id(1), server_id(42), 1, 1, 3));
+    key_state::pending_list_t run;
+
+    for (uint64_t i = 0; i < 3; ++i)
+    {
+        e::intrusive_ptr<pending> op = client_op(i + 1, true);
+        op->client = server_id();
+        op->cbatch = cb;
+        op->cbatch_idx = i;
+        run.push_back(std::make_pair(i + 1, op));
+    }
+
+    ASSERT_TRUE(key_state::coalesce_run(&run, true));
+    e::intrusive_ptr<pending> op = run.front().second;
+    ASSERT_EQ(op->cbatch_idx, 2U);
+    ASSERT_EQ(op->subsumed.size(), 2U);
+    ASSERT_FALSE(cb->complete(op->cbatch_idx, hyperdex::NET_SUCCESS));
+    ASSERT_FALSE(cb->complete(op->subsumed[0]->cbatch_idx, hyperdex::NET_SUCCESS));
+    ASSERT_TRUE(cb->complete(op->subsumed[1]->cbatch_idx, hyperdex::NET_SUCCESS));
+
+    for (size_t i = 0; i < cb->results.size(); ++i)
+    {
+        ASSERT_EQ(cb->results[i], static_cast<uint16_t>(hyperdex::NET_SUCCESS));
+    }
+}
@@ -0,0 +1,150 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// HyperDex
+#include "test/th.h"
+#include "daemon/throttle.h"
+
+using hyperdex::throttle;
+
+#define MS (1000ULL * 1000ULL)
+#define SEC (1000ULL * MS)
+
+TEST(Throttle, UnlimitedAdmitsEverything)
+{
+    throttle t;
+    ASSERT_EQ(t.effective_rate(), 0U);
+
+    for (uint64_t i = 0; i < 100; ++i)
+    {
+        ASSERT_TRUE(t.admit(SEC + i));
+        t.charge(1ULL << 30);
+    }
+
+    ASSERT_EQ(t.delay(SEC), 0U);
+    ASSERT_EQ(t.throttled(), 0U);
+    ASSERT_EQ(t.bytes(), 100ULL << 30);
+}
+
+TEST(Throttle, DebtDelaysAdmission)
+{
+    throttle t;
+    t.set_rate(1000000);
+    // the bucket starts empty of debt
+    ASSERT_TRUE(t.admit(SEC));
+    t.charge(1100000);
+    // 1MB/s with up to 100KB saved up, so 1.1MB leaves a second of debt
+    ASSERT_FALSE(t.admit(SEC));
+    ASSERT_TRUE(t.delay(SEC) > 900 * MS);
+    ASSERT_TRUE(t.delay(SEC) <= SEC + 1);
+    ASSERT_FALSE(t.admit(SEC + 500 * MS));
+    ASSERT_TRUE(t.admit(SEC + 1001 * MS));
+    ASSERT_EQ(t.throttled(), 2U);
+}
+
+TEST(Throttle, BurstIsCapped)
+{
+    throttle t;
+    t.set_rate(1000000);
+    ASSERT_TRUE(t.admit(SEC));
+    // an idle hour saves up no more than a tenth of a second
+    ASSERT_TRUE(t.admit(3600 * SEC));
+    t.charge(300000);
+    ASSERT_FALSE(t.admit(3600 * SEC));
+    ASSERT_TRUE(t.admit(3600 * SEC + 201 * MS));
+}
+
+TEST(Throttle, BacksOffUnderPressure)
+{
+    throttle t;
+    t.set_rate(64ULL << 20);
+    uint64_t now = SEC;
+    t.adjust(now, false);
+    ASSERT_EQ(t.effective_rate(), 64ULL << 20);
+
+    now += 100 * MS;
+    t.adjust(now, true);
+    ASSERT_EQ(t.effective_rate(), 32ULL << 20);
+    // too soon to adjust again
+    t.adjust(now + MS, true);
+    ASSERT_EQ(t.effective_rate(), 32ULL << 20);
+
+    for (size_t i = 0; i < 10; ++i)
+    {
+        now += 100 * MS;
+        t.adjust(now, true);
+    }
+
+    // no lower than 1/64 of the configured rate
+    ASSERT_EQ(t.effective_rate(), 1ULL << 20);
+    ASSERT_EQ(t.backoffs(), 6U);
+
+    // recovers 1/8 of the configured rate per interval
+    now += 100 * MS;
+    t.adjust(now, false);
+    ASSERT_EQ(t.effective_rate(), 9ULL << 20);
+
+    for (size_t i = 0; i < 10; ++i)
+    {
+        now += 100 * MS;
+        t.adjust(now, false);
+    }
+
+    ASSERT_EQ(t.effective_rate(), 64ULL << 20);
+}
+
+TEST(Throttle, UnlimitedBacksOffFromObservedRate)
+{
+    throttle t;
+    uint64_t now = SEC;
+    t.adjust(now, false);
+    // 8MB over 100ms is 80MB/s
+    t.charge(8ULL * 1000ULL * 1000ULL);
+    now += 100 * MS;
+    t.adjust(now, true);
+    ASSERT_EQ(t.effective_rate(), 40ULL * 1000ULL * 1000ULL);
+
+    for (size_t i = 0; i < 8; ++i)
+    {
+        now += 100 * MS;
+        t.adjust(now, false);
+    }
+
+    ASSERT_EQ(t.effective_rate(), 0U);
+}
+
+TEST(Throttle, SetRateResetsBackoff)
+{
+    throttle t;
+    t.set_rate(64ULL << 20);
+    t.adjust(SEC, false);
+    t.adjust(SEC + 100 * MS, true);
+    ASSERT_EQ(t.effective_rate(), 32ULL << 20);
+    t.set_rate(16ULL << 20);
+    ASSERT_EQ(t.rate(), 16ULL << 20);
+    ASSERT_EQ(t.effective_rate(), 16ULL << 20);
+}
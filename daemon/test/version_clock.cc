@@ -0,0 +1,111 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+// HyperDex
+#include "test/th.h"
+#include "daemon/version_clock.h"
+
+using hyperdex::version_clock;
+
+#define SEC (1000ULL * 1000ULL * 1000ULL)
+
+TEST(VersionClock, FollowsTheClock)
+{
+    version_clock vc;
+    ASSERT_EQ(vc.next(10 * SEC), 10 * SEC);
+    ASSERT_EQ(vc.next(20 * SEC), 20 * SEC);
+    ASSERT_EQ(vc.last(), 20 * SEC);
+}
+
+TEST(VersionClock, NeverRepeats)
+{
+    version_clock vc;
+    uint64_t prev = vc.next(10 * SEC);
+
+    // a clock that stands still or steps backwards still yields new versions
+    for (uint64_t i = 0; i < 100; ++i)
+    {
+        uint64_t v = vc.next(10 * SEC - i);
+        ASSERT_EQ(v, prev + 1);
+        prev = v;
+    }
+}
+
+TEST(VersionClock, ObserveOnlyMovesForward)
+{
+    version_clock vc;
+    vc.observe(50 * SEC);
+    ASSERT_EQ(vc.last(), 50 * SEC);
+    vc.observe(40 * SEC);
+    ASSERT_EQ(vc.last(), 50 * SEC);
+    ASSERT_EQ(vc.next(10 * SEC), 50 * SEC + 1);
+}
+
+// The head of a chain issues blind versions from its clock, which here runs
+// a minute ahead of the replica that takes over from it.  The replica sees
+// the old head's versions as chain ops, and once it is the head, its first
+// blind version must still be above every one of them or the other replicas
+// would drop it as out of order.
+TEST(VersionClock, FailoverToSlowerClock)
+{
+    version_clock old_head;
+    version_clock new_head;
+    uint64_t now = 100 * SEC;
+    uint64_t skew = 60 * SEC;
+    uint64_t highest = 0;
+
+    for (uint64_t i = 0; i < 10; ++i)
+    {
+        uint64_t v = old_head.next(now + skew + i);
+        ASSERT_TRUE(v > highest);
+        highest = v;
+        // the replica observes each version when the chain op arrives,
+        // before it has persisted anything
+        new_head.observe(v);
+    }
+
+    // the old head fails; the new head's clock is still a minute behind
+    uint64_t first = new_head.next(now + 10);
+    ASSERT_TRUE(first > highest);
+    ASSERT_TRUE(new_head.next(now + 11) > first);
+}
+
+// A replica that gets the region from a state transfer observes the
+// versions it receives, even those it never saw as chain ops.
+TEST(VersionClock, TransferredVersionsAreObserved)
+{
+    version_clock vc;
+    uint64_t transferred[] = {70 * SEC, 90 * SEC, 80 * SEC};
+
+    for (size_t i = 0; i < sizeof(transferred) / sizeof(transferred[0]); ++i)
+    {
+        vc.observe(transferred[i]);
+    }
+
+    ASSERT_EQ(vc.next(30 * SEC), 90 * SEC + 1);
+}
@@ -0,0 +1,227 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// POSIX
+#include <time.h>
+
+// STL
+#include <algorithm>
+
+// e
+#include <e/time.h>
+
+// HyperDex
+#include "daemon/throttle.h"
+
+// the fraction of the rate admitted is out of THROTTLE_FULL
+#define THROTTLE_FULL 1024
+#define THROTTLE_MIN_FACTOR 16
+#define THROTTLE_RECOVER 128
+#define THROTTLE_MIN_RATE (256ULL * 1024ULL)
+#define THROTTLE_MIN_BURST (64ULL * 1024ULL)
+#define THROTTLE_ADJUST_INTERVAL (100ULL * 1000ULL * 1000ULL)
+#define THROTTLE_MAX_SLEEP (100ULL * 1000ULL * 1000ULL)
+
+using hyperdex::throttle;
+
+throttle :: throttle()
+    : m_mtx()
+    , m_rate(0)
+    , m_ceiling(0)
+    , m_factor(THROTTLE_FULL)
+    , m_tokens(0)
+    , m_last_refill(0)
+    , m_last_adjust(0)
+    , m_window_bytes(0)
+    , m_perf_bytes()
+    , m_perf_throttled()
+    , m_perf_backoffs()
+{
+}
+
+throttle :: ~throttle() throw ()
+{
+}
+
+void
+throttle :: set_rate(uint64_t bytes_per_second)
+{
+    po6::threads::mutex::hold hold(&m_mtx);
+    // an explicit rate overrides any backing off
+    m_rate = bytes_per_second;
+    m_ceiling = bytes_per_second;
+    m_factor = THROTTLE_FULL;
+    m_tokens = std::min(m_tokens, 0.);
+}
+
+uint64_t
+throttle :: rate()
+{
+    po6::threads::mutex::hold hold(&m_mtx);
+    return m_rate;
+}
+
+uint64_t
+throttle :: effective_rate()
+{
+    po6::threads::mutex::hold hold(&m_mtx);
+    return effective_rate_locked();
+}
+
+bool
+throttle :: admit(uint64_t now)
+{
+    po6::threads::mutex::hold hold(&m_mtx);
+    refill(now);
+
+    if (effective_rate_locked() == 0 || m_tokens >= 0)
+    {
+        return true;
+    }
+
+    m_perf_throttled.tap();
+    return false;
+}
+
+void
+throttle :: charge(uint64_t bytes)
+{
+    po6::threads::mutex::hold hold(&m_mtx);
+    m_window_bytes += bytes;
+    m_perf_bytes.add(bytes);
+
+    if (effective_rate_locked() > 0)
+    {
+        m_tokens -= bytes;
+    }
+}
+
+uint64_t
+throttle :: delay(uint64_t now)
+{
+    po6::threads::mutex::hold hold(&m_mtx);
+    refill(now);
+    uint64_t rate = effective_rate_locked();
+
+    if (rate == 0 || m_tokens >= 0)
+    {
+        return 0;
+    }
+
+    return static_cast<uint64_t>(-m_tokens * 1e9 / rate) + 1;
+}
+
+void
+throttle :: acquire(uint64_t bytes)
+{
+    charge(bytes);
+    bool waited = false;
+
+    while (uint64_t d = delay(e::time()))
+    {
+        if (!waited)
+        {
+            m_perf_throttled.tap();
+            waited = true;
+        }
+
+        timespec ts;
+        d = std::min(d, uint64_t(THROTTLE_MAX_SLEEP));
+        ts.tv_sec = 0;
+        ts.tv_nsec = d;
+        nanosleep(&ts, NULL);
+    }
+}
+
+void
+throttle :: adjust(uint64_t now, bool pressure)
+{
+    po6::threads::mutex::hold hold(&m_mtx);
+
+    if (m_last_adjust == 0)
+    {
+        m_last_adjust = now;
+        m_window_bytes = 0;
+        return;
+    }
+
+    if (now < m_last_adjust + THROTTLE_ADJUST_INTERVAL)
+    {
+        return;
+    }
+
+    // settle the bucket at the old rate before changing it
+    refill(now);
+    uint64_t observed = m_window_bytes * 1e9 / (now - m_last_adjust);
+    m_last_adjust = now;
+    m_window_bytes = 0;
+
+    if (pressure && m_factor > THROTTLE_MIN_FACTOR)
+    {
+        if (m_factor == THROTTLE_FULL && m_rate == 0)
+        {
+            m_ceiling = std::max(observed, uint64_t(THROTTLE_MIN_RATE));
+        }
+
+        m_factor = std::max(m_factor / 2, uint64_t(THROTTLE_MIN_FACTOR));
+        m_perf_backoffs.tap();
+    }
+    else if (!pressure && m_factor < THROTTLE_FULL)
+    {
+        m_factor = std::min(m_factor + THROTTLE_RECOVER, uint64_t(THROTTLE_FULL));
+    }
+}
+
+uint64_t
+throttle :: effective_rate_locked()
+{
+    if (m_factor == THROTTLE_FULL)
+    {
+        return m_rate;
+    }
+
+    return std::max(m_ceiling * m_factor / THROTTLE_FULL, uint64_t(THROTTLE_MIN_RATE));
+}
+
+void
+throttle :: refill(uint64_t now)
+{
+    uint64_t rate = effective_rate_locked();
+
+    if (rate == 0)
+    {
+        m_tokens = 0;
+    }
+    else if (now > m_last_refill)
+    {
+        double burst = std::max(rate / 10, uint64_t(THROTTLE_MIN_BURST));
+        m_tokens += (now - m_last_refill) * (rate / 1e9);
+        m_tokens = std::min(m_tokens, burst);
+    }
+
+    m_last_refill = std::max(m_last_refill, now);
+}
@@ -0,0 +1,109 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef hyperdex_daemon_throttle_h_
+#define hyperdex_daemon_throttle_h_
+
+// C
+#include <stdint.h>
+
+// po6
+#include <po6/threads/mutex.h>
+
+// HyperDex
+#include "namespace.h"
+#include "daemon/performance_counter.h"
+
+BEGIN_HYPERDEX_NAMESPACE
+
+// A token bucket that paces background I/O, such as state transfer and
+// wiping, in bytes per second.  A rate of zero is unlimited.
+//
+// The bucket also backs off on its own.  Every "adjust" that reports
+// foreground pressure halves the rate it admits, down to 1/64 of where it
+// started; every "adjust" without pressure recovers 1/8 of it.  When the
+// configured rate is unlimited, backing off starts from the rate observed
+// just before the pressure appeared.
+//
+// Times are nanoseconds from e::time(), passed in so callers can batch
+// calls to the clock.
+class throttle
+{
+    public:
+        throttle();
+        ~throttle() throw ();
+
+    public:
+        // also resets any backing off
+        void set_rate(uint64_t bytes_per_second);
+        uint64_t rate();
+        // the rate after backing off; zero is unlimited
+        uint64_t effective_rate();
+        // true when the bucket is not in debt; a caller that is admitted
+        // may then "charge" more than the bucket holds, which delays those
+        // that come after it
+        bool admit(uint64_t now);
+        void charge(uint64_t bytes);
+        // nanoseconds until "admit" will succeed
+        uint64_t delay(uint64_t now);
+        // charge "bytes" and then sleep until "admit" would succeed
+        void acquire(uint64_t bytes);
+        // at most one adjustment is made every 100ms
+        void adjust(uint64_t now, bool pressure);
+
+    public:
+        uint64_t bytes() { return m_perf_bytes.read(); }
+        uint64_t throttled() { return m_perf_throttled.read(); }
+        uint64_t backoffs() { return m_perf_backoffs.read(); }
+
+    private:
+        // caller must hold m_mtx
+        uint64_t effective_rate_locked();
+        void refill(uint64_t now);
+
+    private:
+        po6::threads::mutex m_mtx;
+        uint64_t m_rate;
+        uint64_t m_ceiling;
+        // the fraction of the rate admitted, out of 1024
+        uint64_t m_factor;
+        double m_tokens;
+        uint64_t m_last_refill;
+        uint64_t m_last_adjust;
+        uint64_t m_window_bytes;
+        performance_counter m_perf_bytes;
+        performance_counter m_perf_throttled;
+        performance_counter m_perf_backoffs;
+
+    private:
+        throttle(const throttle&);
+        throttle& operator = (const throttle&);
+};
+
+END_HYPERDEX_NAMESPACE
+
+#endif // hyperdex_daemon_throttle_h_
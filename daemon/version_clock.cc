@@ -0,0 +1,79 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// STL
+#include <algorithm>
+
+// HyperDex
+#include "daemon/version_clock.h"
+
+using hyperdex::version_clock;
+
+version_clock :: version_clock()
+    : m_last(0)
+{
+}
+
+version_clock :: ~version_clock() throw ()
+{
+}
+
+uint64_t
+version_clock :: next(uint64_t now)
+{
+    while (true)
+    {
+        uint64_t last = m_last;
+        uint64_t next = std::max(now, last + 1);
+
+        if (__sync_bool_compare_and_swap(&m_last, last, next))
+        {
+            return next;
+        }
+    }
+}
+
+void
+version_clock :: observe(uint64_t version)
+{
+    while (true)
+    {
+        uint64_t last = m_last;
+
+        if (last >= version ||
+            __sync_bool_compare_and_swap(&m_last, last, version))
+        {
+            return;
+        }
+    }
+}
+
+uint64_t
+version_clock :: last()
+{
+    return __sync_add_and_fetch(&m_last, 0);
+}
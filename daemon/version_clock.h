@@ -0,0 +1,71 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef hyperdex_daemon_version_clock_h_
+#define hyperdex_daemon_version_clock_h_
+
+// C
+#include <stdint.h>
+
+// HyperDex
+#include "namespace.h"
+
+BEGIN_HYPERDEX_NAMESPACE
+
+// Hands out versions for blind writes, which skip reading the object they
+// overwrite.  Versions follow the local clock, but never fall behind a
+// version the server has seen from elsewhere:  after a failover the new
+// head's clock may run behind the old head's, and a version below what the
+// replicas already hold would be dropped by them as out of order.
+//
+// Times are nanoseconds from e::time(), passed in so that tests can control
+// the clock.
+class version_clock
+{
+    public:
+        version_clock();
+        ~version_clock() throw ();
+
+    public:
+        // a version above "now" and above every version handed out or
+        // observed so far
+        uint64_t next(uint64_t now);
+        // fold in a version the server has seen
+        void observe(uint64_t version);
+        uint64_t last();
+
+    private:
+        uint64_t m_last;
+
+    private:
+        version_clock(const version_clock&);
+        version_clock& operator = (const version_clock&);
+};
+
+END_HYPERDEX_NAMESPACE
+
+#endif // hyperdex_daemon_version_clock_h_
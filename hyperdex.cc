@@ -57,6 +57,8 @@ main(int argc, const char* argv[])
     cmds.push_back(e::subcommand("backup",                "Take a backup of the entire HyperDex cluster"));
     cmds.push_back(e::subcommand("backup-manager",        "Manage incremental backups of the entire HyperDex cluster"));
     cmds.push_back(e::subcommand("raw-backup",            "Take a raw backup of a single HyperDex daemon"));
+    cmds.push_back(e::subcommand("restore",               "Verify and restore a backup of the entire HyperDex cluster"));
+    cmds.push_back(e::subcommand("throttle",              "Limit the rate of state transfer and wipes on a single HyperDex daemon"));
     cmds.push_back(e::subcommand("wait-until-stable",     "Wait for the cluster to become stable on the new configuration"));
     return dispatch_to_subcommands(argc, argv,
                                    "hyperdex", "HyperDex",
@@ -167,6 +167,15 @@ hyperdex_admin_raw_backup(const char* host, uint16_t port,
                           const char* name,
                           enum hyperdex_admin_returncode* status);
 
+/* Set the rates, in bytes per second, at which one daemon sends state
+ * transfers and wipes regions.  Zero is unlimited, and UINT64_MAX leaves a
+ * rate as it is.  On success both are replaced by the daemon's rates. */
+int
+hyperdex_admin_raw_throttle(const char* host, uint16_t port,
+                            uint64_t* transfer_rate,
+                            uint64_t* wipe_rate,
+                            enum hyperdex_admin_returncode* status);
+
 const char*
 hyperdex_admin_error_message(struct hyperdex_admin* admin);
 const char*
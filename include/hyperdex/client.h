@@ -108,6 +108,11 @@ hyperdex_client_create(const char* coordinator, uint16_t port);
 void
 hyperdex_client_destroy(struct hyperdex_client* client);
 
+/* Send gets to any replica of a key's region instead of only to its point
+ * leader.  Reads stay consistent with writes.  Off by default. */
+void
+hyperdex_client_set_read_from_replicas(struct hyperdex_client* client, int enable);
+
 int64_t
 hyperdex_client_get(struct hyperdex_client* client,
                     const char* space,
@@ -115,6 +120,21 @@ hyperdex_client_get(struct hyperdex_client* client,
                     enum hyperdex_client_returncode* status,
                     const struct hyperdex_client_attribute** attrs, size_t* attrs_sz);
 
+int64_t
+hyperdex_client_get_partial(struct hyperdex_client* client,
+                            const char* space,
+                            const char* key, size_t key_sz,
+                            const char** attrnames, size_t attrnames_sz,
+                            enum hyperdex_client_returncode* status,
+                            const struct hyperdex_client_attribute** attrs, size_t* attrs_sz);
+
+int64_t
+hyperdex_client_get_many(struct hyperdex_client* client,
+                         const char* space,
+                         const char** keys, const size_t* keys_sz, size_t keys_num,
+                         enum hyperdex_client_returncode* status,
+                         const struct hyperdex_client_attribute** attrs, size_t* attrs_sz);
+
 int64_t
 hyperdex_client_put(struct hyperdex_client* client,
                     const char* space,
@@ -122,6 +142,14 @@ hyperdex_client_put(struct hyperdex_client* client,
                     const struct hyperdex_client_attribute* attrs, size_t attrs_sz,
                     enum hyperdex_client_returncode* status);
 
+int64_t
+hyperdex_client_put_many(struct hyperdex_client* client,
+                         const char* space,
+                         const char** keys, const size_t* keys_sz, size_t keys_num,
+                         const struct hyperdex_client_attribute* attrs, const size_t* attrs_per_key,
+                         enum hyperdex_client_returncode* status,
+                         enum hyperdex_client_returncode* statuses);
+
 int64_t
 hyperdex_client_cond_put(struct hyperdex_client* client,
                          const char* space,
@@ -577,6 +605,22 @@ hyperdex_client_search(struct hyperdex_client* client,
                        enum hyperdex_client_returncode* status,
                        const struct hyperdex_client_attribute** attrs, size_t* attrs_sz);
 
+int64_t
+hyperdex_client_search_partial(struct hyperdex_client* client,
+                               const char* space,
+                               const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
+                               const char** attrnames, size_t attrnames_sz,
+                               enum hyperdex_client_returncode* status,
+                               const struct hyperdex_client_attribute** attrs, size_t* attrs_sz);
+
+int64_t
+hyperdex_client_search_limit(struct hyperdex_client* client,
+                             const char* space,
+                             const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
+                             uint64_t limit,
+                             enum hyperdex_client_returncode* status,
+                             const struct hyperdex_client_attribute** attrs, size_t* attrs_sz);
+
 int64_t
 hyperdex_client_search_describe(struct hyperdex_client* client,
                                 const char* space,
@@ -594,6 +638,29 @@ hyperdex_client_sorted_search(struct hyperdex_client* client,
                               enum hyperdex_client_returncode* status,
                               const struct hyperdex_client_attribute** attrs, size_t* attrs_sz);
 
+int64_t
+hyperdex_client_sorted_search_partial(struct hyperdex_client* client,
+                                      const char* space,
+                                      const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
+                                      const char* sort_by,
+                                      uint64_t limit,
+                                      int maxmin,
+                                      const char** attrnames, size_t attrnames_sz,
+                                      enum hyperdex_client_returncode* status,
+                                      const struct hyperdex_client_attribute** attrs, size_t* attrs_sz);
+
+int64_t
+hyperdex_client_sorted_search_page(struct hyperdex_client* client,
+                                   const char* space,
+                                   const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
+                                   const char* sort_by,
+                                   uint64_t limit,
+                                   int maxmin,
+                                   const char* cursor, size_t cursor_sz,
+                                   enum hyperdex_client_returncode* status,
+                                   const struct hyperdex_client_attribute** attrs, size_t* attrs_sz,
+                                   const char** next_cursor, size_t* next_cursor_sz);
+
 int64_t
 hyperdex_client_group_del(struct hyperdex_client* client,
                           const char* space,
@@ -58,10 +58,26 @@ class Client
                     hyperdex_client_returncode* status,
                     const struct hyperdex_client_attribute** attrs, size_t* attrs_sz)
             { return hyperdex_client_get(m_cl, space, key, key_sz, status, attrs, attrs_sz); }
+        int64_t get_partial(const char* space, const char* key, size_t key_sz,
+                            const char** attrnames, size_t attrnames_sz,
+                            hyperdex_client_returncode* status,
+                            const struct hyperdex_client_attribute** attrs, size_t* attrs_sz)
+            { return hyperdex_client_get_partial(m_cl, space, key, key_sz, attrnames, attrnames_sz, status, attrs, attrs_sz); }
+        int64_t get_many(const char* space,
+                         const char** keys, const size_t* keys_sz, size_t keys_num,
+                         hyperdex_client_returncode* status,
+                         const struct hyperdex_client_attribute** attrs, size_t* attrs_sz)
+            { return hyperdex_client_get_many(m_cl, space, keys, keys_sz, keys_num, status, attrs, attrs_sz); }
         int64_t put(const char* space, const char* key, size_t key_sz,
                     const struct hyperdex_client_attribute* attrs, size_t attrs_sz,
                     hyperdex_client_returncode* status)
             { return hyperdex_client_put(m_cl, space, key, key_sz, attrs, attrs_sz, status); }
+        int64_t put_many(const char* space,
+                         const char** keys, const size_t* keys_sz, size_t keys_num,
+                         const struct hyperdex_client_attribute* attrs, const size_t* attrs_per_key,
+                         hyperdex_client_returncode* status,
+                         hyperdex_client_returncode* statuses)
+            { return hyperdex_client_put_many(m_cl, space, keys, keys_sz, keys_num, attrs, attrs_per_key, status, statuses); }
         int64_t cond_put(const char* space, const char* key, size_t key_sz,
                          const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
                          const struct hyperdex_client_attribute* attrs, size_t attrs_sz,
@@ -335,6 +351,18 @@ class Client
                        enum hyperdex_client_returncode* status,
                        const struct hyperdex_client_attribute** attrs, size_t* attrs_sz)
             { return hyperdex_client_search(m_cl, space, checks, checks_sz, status, attrs, attrs_sz); }
+        int64_t search_partial(const char* space,
+                               const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
+                               const char** attrnames, size_t attrnames_sz,
+                               enum hyperdex_client_returncode* status,
+                               const struct hyperdex_client_attribute** attrs, size_t* attrs_sz)
+            { return hyperdex_client_search_partial(m_cl, space, checks, checks_sz, attrnames, attrnames_sz, status, attrs, attrs_sz); }
+        int64_t search_limit(const char* space,
+                             const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
+                             uint64_t limit,
+                             enum hyperdex_client_returncode* status,
+                             const struct hyperdex_client_attribute** attrs, size_t* attrs_sz)
+            { return hyperdex_client_search_limit(m_cl, space, checks, checks_sz, limit, status, attrs, attrs_sz); }
         int64_t search_describe(const char* space,
                                 const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
                                 enum hyperdex_client_returncode* status, const char** str)
@@ -345,6 +373,21 @@ class Client
                               enum hyperdex_client_returncode* status,
                               const struct hyperdex_client_attribute** attrs, size_t* attrs_sz)
             { return hyperdex_client_sorted_search(m_cl, space, checks, checks_sz, sort_by, limit, maximize, status, attrs, attrs_sz); }
+        int64_t sorted_search_partial(const char* space,
+                                      const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
+                                      const char* sort_by, uint64_t limit, int maximize,
+                                      const char** attrnames, size_t attrnames_sz,
+                                      enum hyperdex_client_returncode* status,
+                                      const struct hyperdex_client_attribute** attrs, size_t* attrs_sz)
+            { return hyperdex_client_sorted_search_partial(m_cl, space, checks, checks_sz, sort_by, limit, maximize, attrnames, attrnames_sz, status, attrs, attrs_sz); }
+        int64_t sorted_search_page(const char* space,
+                                   const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
+                                   const char* sort_by, uint64_t limit, int maximize,
+                                   const char* cursor, size_t cursor_sz,
+                                   enum hyperdex_client_returncode* status,
+                                   const struct hyperdex_client_attribute** attrs, size_t* attrs_sz,
+                                   const char** next_cursor, size_t* next_cursor_sz)
+            { return hyperdex_client_sorted_search_page(m_cl, space, checks, checks_sz, sort_by, limit, maximize, cursor, cursor_sz, status, attrs, attrs_sz, next_cursor, next_cursor_sz); }
         int64_t group_del(const char* space,
                           const struct hyperdex_client_attribute_check* checks, size_t checks_sz,
                           enum hyperdex_client_returncode* status)
@@ -355,6 +398,8 @@ class Client
             { return hyperdex_client_count(m_cl, space, checks, checks_sz, status, result); }
 
     public:
+        void set_read_from_replicas(bool enable)
+            { hyperdex_client_set_read_from_replicas(m_cl, enable ? 1 : 0); }
         int64_t loop(int timeout, hyperdex_client_returncode* status)
             { return hyperdex_client_loop(m_cl, timeout, status); }
         std::string error_message()
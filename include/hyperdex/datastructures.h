@@ -79,6 +79,13 @@ hyperdex_ds_allocate_attribute_check(struct hyperdex_ds_arena* arena, size_t sz)
 struct hyperdex_client_map_attribute*
 hyperdex_ds_allocate_map_attribute(struct hyperdex_ds_arena* arena, size_t sz);
 
+/* arrays of keys and attribute names for the calls that take them */
+const char**
+hyperdex_ds_allocate_string_array(struct hyperdex_ds_arena* arena, size_t sz);
+
+size_t*
+hyperdex_ds_allocate_size_array(struct hyperdex_ds_arena* arena, size_t sz);
+
 /* pack/unpack ints/floats */
 void
 hyperdex_ds_pack_int(int64_t num, char* buf);
@@ -0,0 +1,313 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#define __STDC_LIMIT_MACROS
+
+// C
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// STL
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// e
+#include <e/buffer.h>
+#include <e/popt.h>
+#include <e/time.h>
+
+// HyperDex
+#include "common/attribute.h"
+#include "common/configuration.h"
+#include "common/hash.h"
+#include "common/hyperspace.h"
+#include "common/schema.h"
+#include "common/serialization.h"
+
+// Measures the cost of routing a key to its point leader as the number of
+// regions grows, comparing configuration::point_leader against the linear
+// scan over the key subspace that it replaced.
+
+using hyperdex::attribute;
+using hyperdex::configuration;
+using hyperdex::region;
+using hyperdex::region_id;
+using hyperdex::replica;
+using hyperdex::schema;
+using hyperdex::server_id;
+using hyperdex::space;
+using hyperdex::subspace;
+using hyperdex::virtual_server_id;
+
+static long _max_regions = 65536;
+static long _lookups = 1000000;
+static long _spaces = 16;
+static long _replicas = 3;
+
+namespace
+{
+
+const attribute attrs[] = {attribute("k", HYPERDATATYPE_STRING),
+                           attribute("v", HYPERDATATYPE_STRING)};
+
+// the regions of one space, as the original linear scan saw them
+struct flat_region
+{
+    flat_region(uint64_t l, uint64_t u, const virtual_server_id& v)
+        : lower(l), upper(u), vsi(v) {}
+    uint64_t lower;
+    uint64_t upper;
+    virtual_server_id vsi;
+};
+
+space
+make_space(const char* name, uint64_t* next_id, size_t num_regions,
+           std::vector<flat_region>* flat)
+{
+    schema sc;
+    sc.attrs_sz = 2;
+    sc.attrs = attrs;
+    space s(name, sc);
+    s.id = hyperdex::space_id(++*next_id);
+    s.subspaces.push_back(subspace());
+    subspace& ss(s.subspaces.back());
+    ss.id = hyperdex::subspace_id(++*next_id);
+    ss.attrs.push_back(0);
+    uint64_t width = UINT64_MAX / num_regions;
+
+    for (size_t i = 0; i < num_regions; ++i)
+    {
+        ss.regions.push_back(region());
+        region& r(ss.regions.back());
+        r.id = region_id(++*next_id);
+        r.lower_coord.push_back(i * width);
+        r.upper_coord.push_back(i + 1 == num_regions ? UINT64_MAX : (i + 1) * width - 1);
+
+        for (long j = 0; j < _replicas; ++j)
+        {
+            r.replicas.push_back(replica(server_id(j + 1), virtual_server_id(++*next_id)));
+        }
+
+        flat->push_back(flat_region(r.lower_coord[0], r.upper_coord[0], r.replicas[0].vsi));
+    }
+
+    return s;
+}
+
+bool
+make_configuration(const std::vector<space>& spaces, configuration* config)
+{
+    size_t sz = 5 * sizeof(uint64_t) + sizeof(uint64_t);
+
+    for (size_t i = 0; i < spaces.size(); ++i)
+    {
+        sz += pack_size(spaces[i]);
+    }
+
+    std::auto_ptr<e::buffer> buf(e::buffer::create(sz));
+    e::buffer::packer pa = buf->pack_at(0);
+    // cluster, version, flags, servers, spaces, transfers
+    pa = pa << uint64_t(1) << uint64_t(1) << uint64_t(0)
+            << uint64_t(0) << uint64_t(spaces.size()) << uint64_t(0);
+
+    for (size_t i = 0; i < spaces.size(); ++i)
+    {
+        pa = pa << spaces[i];
+    }
+
+    return !(buf->unpack_from(0) >> *config).error();
+}
+
+virtual_server_id
+linear_point_leader(const std::vector<std::string>& names, const char* target,
+                    const schema& sc, const std::vector<flat_region>& regions,
+                    const e::slice& key)
+{
+    size_t s = 0;
+
+    while (s < names.size() && strcmp(names[s].c_str(), target) != 0)
+    {
+        ++s;
+    }
+
+    if (s == names.size())
+    {
+        return virtual_server_id();
+    }
+
+    uint64_t h;
+    hyperdex::hash(sc, key, &h);
+
+    for (size_t i = 0; i < regions.size(); ++i)
+    {
+        if (regions[i].lower <= h && h <= regions[i].upper)
+        {
+            return regions[i].vsi;
+        }
+    }
+
+    abort();
+}
+
+} // namespace
+
+int
+main(int argc, const char* argv[])
+{
+    e::argparser ap;
+    ap.autohelp();
+    ap.arg().name('r', "max-regions")
+            .description("largest number of regions per space (default: 65536)")
+            .metavar("N").as_long(&_max_regions);
+    ap.arg().name('n', "lookups")
+            .description("lookups to time per measurement (default: 1000000)")
+            .metavar("N").as_long(&_lookups);
+    ap.arg().name('s', "spaces")
+            .description("number of spaces in the configuration (default: 16)")
+            .metavar("N").as_long(&_spaces);
+    ap.arg().name('f', "replicas")
+            .description("replicas per region (default: 3)")
+            .metavar("N").as_long(&_replicas);
+
+    if (!ap.parse(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (ap.args_sz() != 0 || _max_regions < 1 || _lookups < 1 ||
+        _spaces < 1 || _replicas < 1)
+    {
+        std::cerr << "invalid arguments" << std::endl;
+        ap.usage();
+        return EXIT_FAILURE;
+    }
+
+    // precompute the keys so that only routing is timed
+    std::vector<std::string> keys;
+
+    for (long i = 0; i < _lookups; ++i)
+    {
+        std::ostringstream ostr;
+        ostr << "key-" << i;
+        keys.push_back(ostr.str());
+    }
+
+    std::cout << std::setw(10) << "regions"
+              << std::setw(16) << "linear ns/op"
+              << std::setw(16) << "space ns/op"
+              << std::setw(16) << "region ns/op" << std::endl;
+
+    for (long num_regions = 1; num_regions <= _max_regions; num_regions *= 4)
+    {
+        std::vector<space> spaces;
+        std::vector<std::string> names;
+        std::vector<flat_region> flat;
+        uint64_t next_id = 0;
+
+        for (long i = 0; i < _spaces; ++i)
+        {
+            std::ostringstream ostr;
+            ostr << "space" << i;
+            names.push_back(ostr.str());
+        }
+
+        for (long i = 0; i < _spaces; ++i)
+        {
+            std::vector<flat_region> ignore;
+            // route against the last space so that the old scan pays for
+            // a strcmp against every other space
+            spaces.push_back(make_space(names[i].c_str(), &next_id, num_regions,
+                                        i + 1 == _spaces ? &flat : &ignore));
+        }
+
+        configuration config;
+
+        if (!make_configuration(spaces, &config))
+        {
+            std::cerr << "could not build configuration" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        const char* target = names.back().c_str();
+        const schema& sc(*config.get_schema(target));
+        region_id any_region(spaces.back().subspaces[0].regions[0].id);
+        uint64_t sink = 0;
+
+        // the new lookups must agree with the old scan
+        for (long i = 0; i < _lookups && i < 10000; ++i)
+        {
+            e::slice key(keys[i]);
+            virtual_server_id expected = linear_point_leader(names, target, sc, flat, key);
+
+            if (config.point_leader(target, key) != expected ||
+                config.point_leader(any_region, key) != expected)
+            {
+                std::cerr << "point_leader disagrees with linear scan for "
+                          << keys[i] << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+
+        uint64_t start = e::time();
+
+        for (long i = 0; i < _lookups; ++i)
+        {
+            sink += linear_point_leader(names, target, sc, flat, e::slice(keys[i])).get();
+        }
+
+        uint64_t linear = e::time() - start;
+        start = e::time();
+
+        for (long i = 0; i < _lookups; ++i)
+        {
+            sink += config.point_leader(target, e::slice(keys[i])).get();
+        }
+
+        uint64_t by_space = e::time() - start;
+        start = e::time();
+
+        for (long i = 0; i < _lookups; ++i)
+        {
+            sink += config.point_leader(any_region, e::slice(keys[i])).get();
+        }
+
+        uint64_t by_region = e::time() - start;
+        std::cout << std::setw(10) << num_regions
+                  << std::setw(16) << std::fixed << std::setprecision(1)
+                  << double(linear) / _lookups
+                  << std::setw(16) << double(by_space) / _lookups
+                  << std::setw(16) << double(by_region) / _lookups
+                  << (sink == 0 ? " " : "") << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
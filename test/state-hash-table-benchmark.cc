@@ -0,0 +1,342 @@
+// Copyright (c) 2014, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+#define __STDC_LIMIT_MACROS
+
+// C
+#include <stdint.h>
+#include <stdlib.h>
+
+// STL
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+// po6
+#include <po6/threads/mutex.h>
+#include <po6/threads/thread.h>
+
+// e
+#include <e/compat.h>
+#include <e/intrusive_ptr.h>
+#include <e/popt.h>
+#include <e/time.h>
+
+// HyperDex
+#include "daemon/state_hash_table.h"
+
+// Measures contention on state_hash_table the way replication_manager uses
+// it:  many threads look up or create the state for a key, lock it, and
+// release it, with roughly half of the releases garbage collecting the state.
+// A single stripe behaves like the old table with one global mutex.  A
+// concurrent iterator plays the part of replication_manager::retransmit.
+
+static long _threads = 16;
+static long _ops = 1000000;
+static long _keys = 65536;
+static long _stripes = hyperdex::state_hash_table<uint64_t, int>::DEFAULT_STRIPES;
+static bool _iterate = false;
+
+namespace
+{
+
+class bench_state
+{
+    public:
+        bench_state(uint64_t key);
+        ~bench_state() throw ();
+
+    public:
+        uint64_t state_key() const { return m_key; }
+        void lock() { m_mtx.lock(); }
+        void unlock() { m_mtx.unlock(); }
+        // every second visit leaves the state empty, like a key_state whose
+        // last operation just committed
+        bool finished() { return m_visits % 2 == 0; }
+        void mark_garbage() { m_marked_garbage = true; }
+        bool marked_garbage() const { return m_marked_garbage; }
+        void visit() { ++m_visits; }
+
+    private:
+        friend class e::intrusive_ptr<bench_state>;
+
+    private:
+        void inc() { __sync_add_and_fetch(&m_ref, 1); }
+        void dec() { if (__sync_sub_and_fetch(&m_ref, 1) == 0) delete this; }
+
+    private:
+        uint64_t m_key;
+        po6::threads::mutex m_mtx;
+        uint64_t m_visits;
+        bool m_marked_garbage;
+        size_t m_ref;
+
+    private:
+        bench_state(const bench_state&);
+        bench_state& operator = (const bench_state&);
+};
+
+bench_state :: bench_state(uint64_t key)
+    : m_key(key)
+    , m_mtx()
+    , m_visits(0)
+    , m_marked_garbage(false)
+    , m_ref(0)
+{
+}
+
+bench_state :: ~bench_state() throw ()
+{
+}
+
+typedef hyperdex::state_hash_table<uint64_t, bench_state> table_t;
+
+class bench
+{
+    public:
+        bench(size_t stripes, size_t threads);
+        ~bench() throw ();
+
+    public:
+        void worker(size_t idx);
+        void iterator();
+        // true if exactly the keys with an odd number of visits have state
+        bool verify();
+
+    public:
+        table_t table;
+        size_t threads;
+        std::vector<uint64_t> visits;
+        uint64_t done;
+        uint64_t iterated;
+
+    private:
+        bench(const bench&);
+        bench& operator = (const bench&);
+};
+
+bench :: bench(size_t stripes, size_t t)
+    : table(stripes)
+    , threads(t)
+    , visits(_keys, 0)
+    , done(0)
+    , iterated(0)
+{
+    table.set_empty_key(UINT64_MAX);
+    table.set_deleted_key(UINT64_MAX - 1);
+}
+
+bench :: ~bench() throw ()
+{
+}
+
+void
+bench :: worker(size_t idx)
+{
+    // a cheap per-thread generator so that the keys are not the bottleneck
+    uint64_t x = 0x9e3779b97f4a7c15ULL * (idx + 1);
+    long ops = _ops / threads;
+
+    for (long i = 0; i < ops; ++i)
+    {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        uint64_t key = x % _keys;
+        table_t::state_reference sr;
+        bench_state* st = table.get_or_create_state(key, &sr);
+        st->visit();
+        __sync_fetch_and_add(&visits[key], 1);
+    }
+}
+
+void
+bench :: iterator()
+{
+    while (!__sync_fetch_and_add(&done, 0))
+    {
+        for (table_t::iterator it(&table); it.valid(); it.next())
+        {
+            if (it.get()->marked_garbage())
+            {
+                std::cerr << "iterator returned a collected state" << std::endl;
+                abort();
+            }
+
+            __sync_fetch_and_add(&iterated, 1);
+        }
+    }
+}
+
+bool
+bench :: verify()
+{
+    std::vector<bool> seen(_keys, false);
+    size_t count = 0;
+
+    for (table_t::iterator it(&table); it.valid(); it.next())
+    {
+        uint64_t key = it.get()->state_key();
+
+        if (key >= uint64_t(_keys) || seen[key] || visits[key] % 2 == 0)
+        {
+            return false;
+        }
+
+        seen[key] = true;
+        ++count;
+    }
+
+    for (long i = 0; i < _keys; ++i)
+    {
+        if (visits[i] % 2 == 1)
+        {
+            --count;
+        }
+    }
+
+    return count == 0;
+}
+
+bool
+run(size_t stripes, size_t threads, double* ns_per_op, uint64_t* iterated)
+{
+    using namespace po6::threads;
+    bench b(stripes, threads);
+    std::vector<e::compat::shared_ptr<thread> > ts;
+    e::compat::shared_ptr<thread> it;
+
+    if (_iterate)
+    {
+        it.reset(new thread(make_thread_wrapper(&bench::iterator, &b)));
+        it->start();
+    }
+
+    uint64_t start = e::time();
+
+    for (size_t i = 0; i < threads; ++i)
+    {
+        e::compat::shared_ptr<thread> t(new thread(make_thread_wrapper(&bench::worker, &b, i)));
+        ts.push_back(t);
+        t->start();
+    }
+
+    for (size_t i = 0; i < ts.size(); ++i)
+    {
+        ts[i]->join();
+    }
+
+    uint64_t elapsed = e::time() - start;
+    __sync_fetch_and_add(&b.done, 1);
+
+    if (it)
+    {
+        it->join();
+    }
+
+    uint64_t ops = (_ops / threads) * threads;
+    *ns_per_op = double(elapsed) / ops;
+    *iterated = b.iterated;
+    return b.verify();
+}
+
+} // namespace
+
+int
+main(int argc, const char* argv[])
+{
+    e::argparser ap;
+    ap.autohelp();
+    ap.arg().name('t', "threads")
+            .description("largest number of worker threads (default: 16)")
+            .metavar("N").as_long(&_threads);
+    ap.arg().name('n', "ops")
+            .description("operations per measurement, split across threads (default: 1000000)")
+            .metavar("N").as_long(&_ops);
+    ap.arg().name('k', "keys")
+            .description("number of distinct keys (default: 65536)")
+            .metavar("N").as_long(&_keys);
+    ap.arg().name('s', "stripes")
+            .description("stripes in the striped table (default: 64)")
+            .metavar("N").as_long(&_stripes);
+    ap.arg().name('i', "iterate")
+            .description("iterate over the table concurrently, like retransmit")
+            .set_true(&_iterate);
+
+    if (!ap.parse(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (ap.args_sz() != 0 || _threads < 1 || _ops < 1 ||
+        _keys < 1 || _stripes < 1)
+    {
+        std::cerr << "invalid arguments" << std::endl;
+        ap.usage();
+        return EXIT_FAILURE;
+    }
+
+    std::cout << std::setw(10) << "threads"
+              << std::setw(18) << "1 stripe ns/op"
+              << std::setw(18) << "striped ns/op";
+
+    if (_iterate)
+    {
+        std::cout << std::setw(18) << "iterated";
+    }
+
+    std::cout << std::endl;
+
+    for (long threads = 1; threads <= _threads; threads *= 2)
+    {
+        double global = 0;
+        double striped = 0;
+        uint64_t iterated_global = 0;
+        uint64_t iterated_striped = 0;
+
+        if (!run(1, threads, &global, &iterated_global) ||
+            !run(_stripes, threads, &striped, &iterated_striped))
+        {
+            std::cerr << "table contents disagree with the operations performed" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        std::cout << std::setw(10) << threads
+                  << std::setw(18) << std::fixed << std::setprecision(1) << global
+                  << std::setw(18) << striped;
+
+        if (_iterate)
+        {
+            std::cout << std::setw(18) << iterated_striped;
+        }
+
+        std::cout << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
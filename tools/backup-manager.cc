@@ -33,10 +33,12 @@
 #include <sys/wait.h>
 
 // STL
+#include <sstream>
 #include <string>
 
 // HyperDex
 #include <hyperdex/admin.hpp>
+#include "tools/backup-sums.h"
 #include "tools/common.h"
 
 using hyperdex::connect_opts;
@@ -206,6 +208,33 @@ record_latest(const po6::pathname& base, const std::string& now)
     return true;
 }
 
+// DAEMONS lists each daemon in the backup set as "sid address path", where
+// path is the daemon's backup directory on its own host
+static bool
+record_daemons(const po6::pathname& backupdir, const std::vector<daemon_backup>& daemons)
+{
+    po6::pathname daemons_path = po6::join(backupdir, po6::pathname("DAEMONS"));
+    po6::io::fd out(open(daemons_path.get(), O_WRONLY|O_CREAT|O_TRUNC, S_IRUSR|S_IWUSR));
+    std::ostringstream ostr;
+
+    for (size_t i = 0; i < daemons.size(); ++i)
+    {
+        ostr << daemons[i].sid << " " << daemons[i].addr << " " << daemons[i].path << "\n";
+    }
+
+    std::string contents(ostr.str());
+
+    if (out.get() < 0 ||
+        out.xwrite(contents.data(), contents.size()) < static_cast<ssize_t>(contents.size()))
+    {
+        std::cerr << "could not record the daemons in DAEMONS: "
+                  << strerror(errno) << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
 static bool
 fork_exec_wait(const std::vector<std::string>& args)
 {
@@ -393,9 +422,31 @@ main(int argc, const char* argv[])
             if (!fork_exec_wait(args))
             {
                 success = false;
+                continue;
+            }
+
+            // checksum the copy so a restore can verify it
+            std::vector<hyperdex::file_sum> previous_sums;
+            std::vector<hyperdex::file_sum> sums;
+
+            if (prev)
+            {
+                hyperdex::read_sums(join(previous, pathname(buf)), &previous_sums);
+            }
+
+            if (!hyperdex::sum_directory(daemon_dir, previous_sums, &sums) ||
+                !hyperdex::write_sums(daemon_dir, sums))
+            {
+                std::cerr << "could not checksum the backup of " << daemons[i].sid << std::endl;
+                success = false;
             }
         }
 
+        if (!record_daemons(backupdir, daemons))
+        {
+            success = false;
+        }
+
         if (success && _cleanup)
         {
             for (size_t i = 0; i < daemons.size(); ++i)
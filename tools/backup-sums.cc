@@ -0,0 +1,263 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// C
+#include <cstdio>
+#include <cstring>
+
+// POSIX
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+// STL
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+// po6
+#include <po6/io/fd.h>
+
+// HyperDex
+#include "cityhash/city.h"
+#include "tools/backup-sums.h"
+
+#define SUMS_FILE "SUMS"
+#define SUM_CHUNK (1024ULL * 1024ULL)
+
+using hyperdex::file_sum;
+
+namespace
+{
+
+bool
+is_table(const std::string& name)
+{
+    const size_t sz = name.size();
+    return (sz > 4 && name.compare(sz - 4, 4, ".sst") == 0) ||
+           (sz > 4 && name.compare(sz - 4, 4, ".ldb") == 0);
+}
+
+bool
+file_sum_less(const file_sum& lhs, const file_sum& rhs)
+{
+    return lhs.name < rhs.name;
+}
+
+} // namespace
+
+bool
+hyperdex :: sum_file(const po6::pathname& path, uint64_t* size, uint64_t* hash)
+{
+    po6::io::fd fd(open(path.get(), O_RDONLY));
+
+    if (fd.get() < 0)
+    {
+        std::cerr << "could not open " << path.get() << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    std::vector<char> buf(SUM_CHUNK);
+    *size = 0;
+    *hash = 0;
+
+    // hash chunk by chunk, seeding each with the hash so far
+    while (true)
+    {
+        ssize_t amt = fd.xread(&buf[0], buf.size());
+
+        if (amt < 0)
+        {
+            std::cerr << "could not read " << path.get() << ": " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        if (amt == 0)
+        {
+            break;
+        }
+
+        *hash = CityHash64WithSeed(&buf[0], amt, *hash);
+        *size += amt;
+
+        if (static_cast<size_t>(amt) < buf.size())
+        {
+            break;
+        }
+    }
+
+    return true;
+}
+
+bool
+hyperdex :: sum_directory(const po6::pathname& dir,
+                          const std::vector<file_sum>& previous,
+                          std::vector<file_sum>* sums)
+{
+    DIR* d = opendir(dir.get());
+
+    if (!d)
+    {
+        std::cerr << "could not open " << dir.get() << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    std::map<std::string, const file_sum*> prev;
+
+    for (size_t i = 0; i < previous.size(); ++i)
+    {
+        prev[previous[i].name] = &previous[i];
+    }
+
+    struct dirent* ent = NULL;
+    bool success = true;
+    sums->clear();
+
+    while (success && (ent = readdir(d)))
+    {
+        std::string name(ent->d_name);
+        po6::pathname path(po6::join(dir, po6::pathname(name.c_str())));
+        struct stat st;
+
+        if (name == SUMS_FILE)
+        {
+            continue;
+        }
+
+        if (stat(path.get(), &st) < 0)
+        {
+            std::cerr << "could not stat " << path.get() << ": " << strerror(errno) << std::endl;
+            success = false;
+            continue;
+        }
+
+        if (!S_ISREG(st.st_mode))
+        {
+            continue;
+        }
+
+        std::map<std::string, const file_sum*>::iterator it = prev.find(name);
+
+        if (is_table(name) && it != prev.end() &&
+            it->second->size == static_cast<uint64_t>(st.st_size))
+        {
+            sums->push_back(*it->second);
+            continue;
+        }
+
+        file_sum fs;
+        fs.name = name;
+        success = sum_file(path, &fs.size, &fs.hash);
+        sums->push_back(fs);
+    }
+
+    closedir(d);
+    std::sort(sums->begin(), sums->end(), file_sum_less);
+    return success;
+}
+
+bool
+hyperdex :: read_sums(const po6::pathname& dir, std::vector<file_sum>* sums)
+{
+    po6::pathname path(po6::join(dir, po6::pathname(SUMS_FILE)));
+    po6::io::fd fd(open(path.get(), O_RDONLY));
+
+    if (fd.get() < 0)
+    {
+        std::cerr << "could not open " << path.get() << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    std::string contents;
+    std::vector<char> buf(SUM_CHUNK);
+    ssize_t amt;
+
+    while ((amt = fd.xread(&buf[0], buf.size())) > 0)
+    {
+        contents.append(&buf[0], amt);
+    }
+
+    if (amt < 0)
+    {
+        std::cerr << "could not read " << path.get() << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    std::istringstream istr(contents);
+    std::string line;
+    sums->clear();
+
+    while (std::getline(istr, line))
+    {
+        long long unsigned int hash;
+        long long unsigned int size;
+        std::vector<char> name(line.size() + 1);
+
+        if (sscanf(line.c_str(), "%llx %llu %s", &hash, &size, &name[0]) < 3)
+        {
+            std::cerr << path.get() << " is corrupt: \"" << line << "\"" << std::endl;
+            return false;
+        }
+
+        sums->push_back(file_sum(std::string(&name[0]), size, hash));
+    }
+
+    std::sort(sums->begin(), sums->end(), file_sum_less);
+    return true;
+}
+
+bool
+hyperdex :: write_sums(const po6::pathname& dir, const std::vector<file_sum>& sums)
+{
+    std::ostringstream ostr;
+
+    for (size_t i = 0; i < sums.size(); ++i)
+    {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%016llx %llu ",
+                 static_cast<long long unsigned int>(sums[i].hash),
+                 static_cast<long long unsigned int>(sums[i].size));
+        ostr << buf << sums[i].name << "\n";
+    }
+
+    std::string out(ostr.str());
+    po6::pathname path(po6::join(dir, po6::pathname(SUMS_FILE)));
+    po6::io::fd fd(open(path.get(), O_WRONLY|O_CREAT|O_TRUNC, S_IRUSR|S_IWUSR));
+
+    if (fd.get() < 0 ||
+        fd.xwrite(out.data(), out.size()) != static_cast<ssize_t>(out.size()))
+    {
+        std::cerr << "could not write " << path.get() << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    return true;
+}
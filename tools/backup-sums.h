@@ -0,0 +1,77 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+#ifndef hyperdex_tools_backup_sums_h_
+#define hyperdex_tools_backup_sums_h_
+
+// C
+#include <stdint.h>
+
+// STL
+#include <string>
+#include <vector>
+
+// po6
+#include <po6/pathname.h>
+
+// HyperDex
+#include "namespace.h"
+
+BEGIN_HYPERDEX_NAMESPACE
+
+// Each daemon directory in a backup set holds a "SUMS" file with one line per
+// file: its checksum, its size, and its name.
+class file_sum
+{
+    public:
+        file_sum() : name(), size(0), hash(0) {}
+        file_sum(const std::string& n, uint64_t s, uint64_t h)
+            : name(n), size(s), hash(h) {}
+
+    public:
+        std::string name;
+        uint64_t size;
+        uint64_t hash;
+};
+
+bool
+sum_file(const po6::pathname& path, uint64_t* size, uint64_t* hash);
+// sum every regular file in "dir" but SUMS itself; LevelDB tables never
+// change once written, so those in "previous" with the same name and size
+// are taken from there rather than read again
+bool
+sum_directory(const po6::pathname& dir,
+              const std::vector<file_sum>& previous,
+              std::vector<file_sum>* sums);
+bool
+read_sums(const po6::pathname& dir, std::vector<file_sum>* sums);
+bool
+write_sums(const po6::pathname& dir, const std::vector<file_sum>& sums);
+
+END_HYPERDEX_NAMESPACE
+
+#endif // hyperdex_tools_backup_sums_h_
@@ -0,0 +1,843 @@
+// Copyright (c) 2013, Cornell University
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//     * Redistributions of source code must retain the above copyright notice,
+//       this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above copyright
+//       notice, this list of conditions and the following disclaimer in the
+//       documentation and/or other materials provided with the distribution.
+//     * Neither the name of HyperDex nor the names of its contributors may be
+//       used to endorse or promote products derived from this software without
+//       specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+// C
+#include <cassert>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// POSIX
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// STL
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// po6
+#include <po6/io/fd.h>
+#include <po6/threads/mutex.h>
+#include <po6/threads/thread.h>
+
+// e
+#include <e/compat.h>
+#include <e/time.h>
+
+// HyperDex
+#include "tools/backup-sums.h"
+#include "tools/common.h"
+
+using po6::join;
+using po6::pathname;
+
+struct daemon_backup
+{
+    daemon_backup()
+        : sid(), addr(), path(), checkpoint(0), positions(), files(0), bytes(0), verified(false) {}
+    ~daemon_backup() {}
+    uint64_t sid;
+    std::string addr;
+    std::string path;
+    // filled in by verification
+    uint64_t checkpoint;
+    std::vector<std::pair<uint64_t, unsigned> > positions;
+    uint64_t files;
+    uint64_t bytes;
+    bool verified;
+};
+
+static void
+report_phase(const char* phase, uint64_t start)
+{
+    double secs = (e::time() - start) / 1000000000.;
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.3f", secs);
+    std::cout << phase << " took " << buf << "s" << std::endl;
+}
+
+static bool
+read_file(const pathname& path, std::string* contents)
+{
+    po6::io::fd fd(open(path.get(), O_RDONLY));
+
+    if (fd.get() < 0)
+    {
+        std::cerr << "could not open " << path.get() << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    char buf[4096];
+    ssize_t amt;
+    contents->clear();
+
+    while ((amt = fd.xread(buf, sizeof(buf))) > 0)
+    {
+        contents->append(buf, amt);
+    }
+
+    if (amt < 0)
+    {
+        std::cerr << "could not read " << path.get() << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// the backup set is either named explicitly or is the one in LATEST
+static bool
+find_backup_set(const pathname& base, const char* name, pathname* set)
+{
+    if (name)
+    {
+        *set = join(base, pathname(name));
+        return true;
+    }
+
+    std::string latest;
+
+    if (!read_file(join(base, pathname("LATEST")), &latest))
+    {
+        std::cerr << "name a backup with --name or take one with backup-manager" << std::endl;
+        return false;
+    }
+
+    *set = join(base, pathname(latest.c_str()));
+    return true;
+}
+
+static bool
+read_daemons(const pathname& set, std::vector<daemon_backup>* daemons)
+{
+    std::string contents;
+
+    if (!read_file(join(set, pathname("DAEMONS")), &contents))
+    {
+        return false;
+    }
+
+    std::istringstream istr(contents);
+    std::string line;
+
+    while (std::getline(istr, line))
+    {
+        long long unsigned int num;
+        std::vector<char> loc_buf(line.size() + 1);
+        std::vector<char> path_buf(line.size() + 1);
+
+        if (sscanf(line.c_str(), "%llu %s %[^\t\n]",
+                   &num, &loc_buf[0], &path_buf[0]) < 3)
+        {
+            std::cerr << "could not parse DAEMONS: \"" << line << "\"" << std::endl;
+            return false;
+        }
+
+        daemon_backup db;
+        db.sid = num;
+        db.addr = &loc_buf[0];
+        db.path = &path_buf[0];
+        daemons->push_back(db);
+    }
+
+    if (daemons->empty())
+    {
+        std::cerr << "the backup lists no daemons" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+static pathname
+daemon_dir(const pathname& set, const daemon_backup& db)
+{
+    char buf[21];
+    snprintf(buf, sizeof(buf), "%llu", static_cast<long long unsigned int>(db.sid));
+    return join(set, pathname(buf));
+}
+
+// the first line of CHECKPOINT names the checkpoint the backup covers; a
+// "snapshot" line says the daemon copied a snapshot taken once that
+// checkpoint was stable, rather than whatever was on disk when asked; each
+// "region <id> <position>" line gives the daemon's place in that region's
+// chain, counting from zero at the head
+static bool
+read_checkpoint(const pathname& dir, uint64_t* checkpoint,
+                std::vector<std::pair<uint64_t, unsigned> >* positions)
+{
+    std::string contents;
+
+    if (!read_file(join(dir, pathname("CHECKPOINT")), &contents))
+    {
+        return false;
+    }
+
+    long long unsigned int c;
+
+    if (sscanf(contents.c_str(), "checkpoint %llu", &c) < 1)
+    {
+        std::cerr << "could not parse " << join(dir, pathname("CHECKPOINT")).get() << std::endl;
+        return false;
+    }
+
+    if (contents.find("\nsnapshot\n") == std::string::npos)
+    {
+        std::cerr << join(dir, pathname("CHECKPOINT")).get()
+                  << " is not from a checkpoint snapshot; each replica may hold "
+                  << "different writes past the checkpoint, so take a new backup"
+                  << std::endl;
+        return false;
+    }
+
+    std::istringstream istr(contents);
+    std::string line;
+    positions->clear();
+
+    while (std::getline(istr, line))
+    {
+        long long unsigned int ri;
+        unsigned pos;
+
+        if (line.compare(0, 7, "region ") != 0)
+        {
+            continue;
+        }
+
+        if (sscanf(line.c_str(), "region %llu %u", &ri, &pos) < 2)
+        {
+            std::cerr << "could not parse " << join(dir, pathname("CHECKPOINT")).get()
+                      << ": \"" << line << "\"" << std::endl;
+            return false;
+        }
+
+        positions->push_back(std::make_pair(static_cast<uint64_t>(ri), pos));
+    }
+
+    *checkpoint = c;
+    return true;
+}
+
+static bool
+verify_daemon(const pathname& set, daemon_backup* db)
+{
+    pathname dir(daemon_dir(set, *db));
+    std::vector<hyperdex::file_sum> expected;
+    std::vector<hyperdex::file_sum> actual;
+    std::vector<hyperdex::file_sum> none;
+
+    if (!hyperdex::read_sums(dir, &expected) ||
+        !hyperdex::sum_directory(dir, none, &actual) ||
+        !read_checkpoint(dir, &db->checkpoint, &db->positions))
+    {
+        return false;
+    }
+
+    // both lists are sorted by name
+    bool success = true;
+    size_t e = 0;
+    size_t a = 0;
+
+    while (e < expected.size() || a < actual.size())
+    {
+        if (a == actual.size() ||
+            (e < expected.size() && expected[e].name < actual[a].name))
+        {
+            std::cerr << db->sid << ": " << expected[e].name << " is missing" << std::endl;
+            success = false;
+            ++e;
+        }
+        else if (e == expected.size() || actual[a].name < expected[e].name)
+        {
+            std::cerr << db->sid << ": " << actual[a].name << " is not in SUMS" << std::endl;
+            success = false;
+            ++a;
+        }
+        else
+        {
+            if (expected[e].size != actual[a].size ||
+                expected[e].hash != actual[a].hash)
+            {
+                std::cerr << db->sid << ": " << actual[a].name << " does not match its checksum" << std::endl;
+                success = false;
+            }
+
+            db->files += 1;
+            db->bytes += actual[a].size;
+            ++e;
+            ++a;
+        }
+    }
+
+    db->verified = success;
+    return success;
+}
+
+// each thread takes the next unverified daemon until none remain
+class verifier
+{
+    public:
+        verifier(const pathname& set, std::vector<daemon_backup>* daemons)
+            : m_set(set), m_daemons(daemons), m_mtx(), m_next(0) {}
+
+    public:
+        void run()
+        {
+            while (true)
+            {
+                size_t idx;
+
+                {
+                    po6::threads::mutex::hold hold(&m_mtx);
+
+                    if (m_next >= m_daemons->size())
+                    {
+                        return;
+                    }
+
+                    idx = m_next;
+                    ++m_next;
+                }
+
+                verify_daemon(m_set, &(*m_daemons)[idx]);
+            }
+        }
+
+    private:
+        verifier(const verifier&);
+        verifier& operator = (const verifier&);
+
+    private:
+        pathname m_set;
+        std::vector<daemon_backup>* m_daemons;
+        po6::threads::mutex m_mtx;
+        size_t m_next;
+};
+
+static bool
+verify_all(const pathname& set, std::vector<daemon_backup>* daemons, size_t jobs)
+{
+    verifier v(set, daemons);
+    std::vector<e::compat::shared_ptr<po6::threads::thread> > threads;
+
+    for (size_t i = 0; i < jobs && i < daemons->size(); ++i)
+    {
+        e::compat::shared_ptr<po6::threads::thread> t(new po6::threads::thread(
+                    po6::threads::make_thread_wrapper(&verifier::run, &v)));
+        threads.push_back(t);
+        t->start();
+    }
+
+    for (size_t i = 0; i < threads.size(); ++i)
+    {
+        threads[i]->join();
+    }
+
+    bool success = true;
+    uint64_t files = 0;
+    uint64_t bytes = 0;
+
+    for (size_t i = 0; i < daemons->size(); ++i)
+    {
+        const daemon_backup& db((*daemons)[i]);
+        success = success && db.verified;
+        files += db.files;
+        bytes += db.bytes;
+
+        // every daemon must have backed up at the same checkpoint, or the
+        // backups are not one consistent cut
+        if (db.verified && db.checkpoint != (*daemons)[0].checkpoint)
+        {
+            std::cerr << db.sid << ": backed up at checkpoint " << db.checkpoint
+                      << " but " << (*daemons)[0].sid << " backed up at checkpoint "
+                      << (*daemons)[0].checkpoint << std::endl;
+            success = false;
+        }
+    }
+
+    std::cout << "verified " << files << " files (" << bytes << " bytes) from "
+              << daemons->size() << " daemons at checkpoint "
+              << (*daemons)[0].checkpoint << std::endl;
+    return success;
+}
+
+// run the commands, at most "jobs" at a time
+static bool
+fork_exec_all(const std::vector<std::vector<std::string> >& cmds, size_t jobs)
+{
+    std::map<pid_t, size_t> running;
+    size_t next = 0;
+    bool success = true;
+
+    while (next < cmds.size() || !running.empty())
+    {
+        if (next < cmds.size() && running.size() < jobs)
+        {
+            pid_t child = fork();
+
+            if (child == 0)
+            {
+                std::vector<const char*> arg_ptrs;
+
+                for (size_t i = 0; i < cmds[next].size(); ++i)
+                {
+                    arg_ptrs.push_back(cmds[next][i].c_str());
+                }
+
+                arg_ptrs.push_back(NULL);
+                execvp(arg_ptrs[0], const_cast<char* const*>(&arg_ptrs[0]));
+                std::cerr << "could not exec: " << strerror(errno) << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            else if (child < 0)
+            {
+                std::cerr << "could not fork: " << strerror(errno) << std::endl;
+                success = false;
+                next = cmds.size();
+                continue;
+            }
+
+            running[child] = next;
+            ++next;
+            continue;
+        }
+
+        int status = 0;
+        pid_t child = waitpid(-1, &status, 0);
+
+        if (child < 0)
+        {
+            std::cerr << "could not wait for child: " << strerror(errno) << std::endl;
+            return false;
+        }
+
+        std::map<pid_t, size_t>::iterator it = running.find(child);
+
+        if (it == running.end())
+        {
+            continue;
+        }
+
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            std::cerr << "\"" << cmds[it->second][0];
+
+            for (size_t i = 1; i < cmds[it->second].size(); ++i)
+            {
+                std::cerr << " " << cmds[it->second][i];
+            }
+
+            std::cerr << "\" failed" << std::endl;
+            success = false;
+        }
+
+        running.erase(it);
+    }
+
+    return success;
+}
+
+static std::string
+remote(const char* user, const std::string& addr)
+{
+    return user ? std::string(user) + "@" + addr : addr;
+}
+
+// the daemon's data directory, which holds its backup directory unless
+// overridden
+static std::string
+data_dir(const char* dest, const daemon_backup& db)
+{
+    return dest ? std::string(dest) : std::string(pathname(db.path).dirname().get());
+}
+
+// Replicas of a region may disagree about writes in flight across the
+// checkpoint.  The replica furthest down the chain holds only writes that
+// every replica before it also holds, so its copy is the one to restore;
+// map each region to the index of that daemon.
+static void
+choose_sources(const std::vector<daemon_backup>& daemons,
+               std::map<uint64_t, size_t>* sources)
+{
+    std::map<uint64_t, unsigned> furthest;
+
+    for (size_t i = 0; i < daemons.size(); ++i)
+    {
+        for (size_t j = 0; j < daemons[i].positions.size(); ++j)
+        {
+            uint64_t ri = daemons[i].positions[j].first;
+            unsigned pos = daemons[i].positions[j].second;
+            std::map<uint64_t, unsigned>::iterator it = furthest.find(ri);
+
+            if (it == furthest.end() || it->second < pos)
+            {
+                furthest[ri] = pos;
+                (*sources)[ri] = i;
+            }
+        }
+    }
+}
+
+// the RECONCILE file tells the daemon which of its regions to replace with
+// another daemon's copy, copied alongside its data as restore-<sid>
+static bool
+write_reconcile(const std::vector<daemon_backup>& daemons,
+                const std::map<uint64_t, size_t>& sources,
+                size_t idx, std::string* path, std::vector<size_t>* needed)
+{
+    std::ostringstream ostr;
+    const daemon_backup& db(daemons[idx]);
+
+    for (size_t i = 0; i < db.positions.size(); ++i)
+    {
+        std::map<uint64_t, size_t>::const_iterator it;
+        it = sources.find(db.positions[i].first);
+        assert(it != sources.end());
+
+        if (it->second == idx)
+        {
+            continue;
+        }
+
+        ostr << "region " << db.positions[i].first
+             << " restore-" << daemons[it->second].sid << "\n";
+
+        if (std::find(needed->begin(), needed->end(), it->second) == needed->end())
+        {
+            needed->push_back(it->second);
+        }
+    }
+
+    char tmpl[] = "/tmp/hyperdex-restore-XXXXXX";
+    po6::io::fd fd(mkstemp(tmpl));
+
+    if (fd.get() < 0)
+    {
+        std::cerr << "could not create a temporary file: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    *path = tmpl;
+    std::string contents(ostr.str());
+
+    if (fd.xwrite(contents.data(), contents.size()) != static_cast<ssize_t>(contents.size()))
+    {
+        std::cerr << "could not write " << tmpl << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+int
+main(int argc, const char* argv[])
+{
+    const char* _data = ".";
+    const char* _name = NULL;
+    const char* _user = NULL;
+    const char* _dest = NULL;
+    const char* _coordinator = NULL;
+    long _coordinator_port = 1982;
+    const char* _coordinator_data = ".";
+    long _jobs = 4;
+    bool _verify_only = false;
+    bool _start = false;
+    e::argparser ap;
+    ap.autohelp();
+    ap.arg().name('b', "backup-dir")
+            .description("restore from backups in this directory (default: .)")
+            .metavar("dir").as_string(&_data);
+    ap.arg().name('n', "name")
+            .description("restore this backup (default: the one in LATEST)")
+            .metavar("name").as_string(&_name);
+    ap.arg().name('u', "user")
+            .description("username to use for ssh connections (default: this user)")
+            .metavar("user").as_string(&_user);
+    ap.arg().name('D', "data")
+            .description("restore into this directory on every daemon (default: the directory the daemon backed up from)")
+            .metavar("dir").as_string(&_dest);
+    ap.arg().name('j', "jobs")
+            .description("verify and copy this many daemons at once (default: 4)")
+            .metavar("N").as_long(&_jobs);
+    ap.arg().long_name("verify-only")
+            .description("check the backup and stop")
+            .set_true(&_verify_only);
+    ap.arg().long_name("start")
+            .description("restore the coordinator, then start each daemon on its restored data")
+            .set_true(&_start);
+    ap.arg().name('c', "coordinator")
+            .description("with --start, restore the coordinator on this host")
+            .metavar("addr").as_string(&_coordinator);
+    ap.arg().name('P', "coordinator-port")
+            .description("with --start, the restored coordinator listens on this port (default: 1982)")
+            .metavar("port").as_long(&_coordinator_port);
+    ap.arg().long_name("coordinator-data")
+            .description("with --start, keep the restored coordinator's data in this directory (default: .)")
+            .metavar("dir").as_string(&_coordinator_data);
+
+    if (!ap.parse(argc, argv))
+    {
+        return EXIT_FAILURE;
+    }
+
+    if (_jobs <= 0)
+    {
+        std::cerr << "--jobs must be positive" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (_start && !_coordinator)
+    {
+        std::cerr << "--start needs the --coordinator host to restore onto" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (_coordinator_port <= 0 || _coordinator_port >= (1 << 16))
+    {
+        std::cerr << "--coordinator-port must be a valid port" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        size_t jobs = _jobs;
+        pathname base(_data);
+        base = base.realpath();
+        pathname set;
+        std::vector<daemon_backup> daemons;
+
+        // scan: find the backup set and the daemons in it
+        uint64_t start = e::time();
+
+        if (!find_backup_set(base, _name, &set) ||
+            !read_daemons(set, &daemons))
+        {
+            return EXIT_FAILURE;
+        }
+
+        pathname coord(join(set, pathname("coordinator.bin")));
+        struct stat stbuf;
+
+        if (stat(coord.get(), &stbuf) < 0)
+        {
+            std::cerr << "could not find the coordinator backup " << coord.get()
+                      << ": " << strerror(errno) << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        report_phase("scan", start);
+
+        // verify: check every file against its checksum, and every daemon
+        // against the same checkpoint
+        start = e::time();
+
+        if (!verify_all(set, &daemons, jobs))
+        {
+            std::cerr << "the backup in " << set.get() << " failed verification" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        report_phase("verify", start);
+
+        if (_verify_only)
+        {
+            return EXIT_SUCCESS;
+        }
+
+        // copy: put each daemon's data back where the daemon will find it;
+        // the daemon keeps its identity and the restored coordinator maps
+        // it onto the same regions
+        start = e::time();
+        std::vector<std::vector<std::string> > cmds;
+
+        for (size_t i = 0; i < daemons.size(); ++i)
+        {
+            std::vector<std::string> args;
+            args.push_back("rsync");
+            args.push_back("-a");
+            args.push_back("--delete");
+            args.push_back("--exclude=SUMS");
+            args.push_back("--exclude=CHECKPOINT");
+            args.push_back("--exclude=backup-*");
+            args.push_back("--exclude=restore-*");
+            args.push_back("--");
+            args.push_back(std::string(daemon_dir(set, daemons[i]).get()) + "/");
+            args.push_back(remote(_user, daemons[i].addr) + ":" + data_dir(_dest, daemons[i]) + "/");
+            cmds.push_back(args);
+        }
+
+        if (!fork_exec_all(cmds, jobs))
+        {
+            return EXIT_FAILURE;
+        }
+
+        report_phase("copy", start);
+
+        // reconcile: every replica holds each write acknowledged before the
+        // checkpoint, but writes in flight across it may be on some replicas
+        // of a region and not others.  Each daemon that is not the tail of a
+        // region gets the tail's backup and a RECONCILE file naming it, and
+        // replaces its copy of the region before it serves anything.
+        start = e::time();
+        std::map<uint64_t, size_t> sources;
+        choose_sources(daemons, &sources);
+        std::vector<std::string> temps;
+        bool success = true;
+        cmds.clear();
+
+        for (size_t i = 0; success && i < daemons.size(); ++i)
+        {
+            std::string dest(remote(_user, daemons[i].addr) + ":" + data_dir(_dest, daemons[i]) + "/");
+            std::string tmp;
+            std::vector<size_t> needed;
+
+            if (!write_reconcile(daemons, sources, i, &tmp, &needed))
+            {
+                success = false;
+                break;
+            }
+
+            temps.push_back(tmp);
+
+            for (size_t j = 0; j < needed.size(); ++j)
+            {
+                std::ostringstream ostr;
+                ostr << "restore-" << daemons[needed[j]].sid << "/";
+                std::vector<std::string> args;
+                args.push_back("rsync");
+                args.push_back("-a");
+                args.push_back("--delete");
+                args.push_back("--exclude=SUMS");
+                args.push_back("--exclude=CHECKPOINT");
+                args.push_back("--exclude=backup-*");
+                args.push_back("--");
+                args.push_back(std::string(daemon_dir(set, daemons[needed[j]]).get()) + "/");
+                args.push_back(dest + ostr.str());
+                cmds.push_back(args);
+            }
+
+            std::vector<std::string> args;
+            args.push_back("rsync");
+            args.push_back("--");
+            args.push_back(tmp);
+            args.push_back(dest + "RECONCILE");
+            cmds.push_back(args);
+        }
+
+        success = success && fork_exec_all(cmds, jobs);
+
+        for (size_t i = 0; i < temps.size(); ++i)
+        {
+            unlink(temps[i].c_str());
+        }
+
+        if (!success)
+        {
+            return EXIT_FAILURE;
+        }
+
+        report_phase("reconcile", start);
+
+        if (!_start)
+        {
+            std::cout << "restore the coordinator with:  hyperdex coordinator --restore "
+                      << coord.get() << std::endl
+                      << "and only then start each daemon on its restored data" << std::endl;
+            return EXIT_SUCCESS;
+        }
+
+        // start: the coordinator comes up from its backup first, so that
+        // each daemon finds its old place in the configuration when it
+        // rejoins with the state saved in its data
+        start = e::time();
+        std::string coord_dest(remote(_user, _coordinator) + ":" + _coordinator_data + "/");
+        std::ostringstream port;
+        port << _coordinator_port;
+        std::vector<std::string> args;
+        args.push_back("rsync");
+        args.push_back("--");
+        args.push_back(coord.get());
+        args.push_back(coord_dest + "coordinator.bin");
+
+        if (!fork_exec_all(std::vector<std::vector<std::string> >(1, args), 1))
+        {
+            return EXIT_FAILURE;
+        }
+
+        args.clear();
+        args.push_back("ssh");
+        args.push_back(remote(_user, _coordinator));
+        args.push_back("hyperdex");
+        args.push_back("coordinator");
+        args.push_back("--listen=" + std::string(_coordinator));
+        args.push_back("--listen-port=" + port.str());
+        args.push_back("--data=" + std::string(_coordinator_data));
+        args.push_back("--restore=" + std::string(_coordinator_data) + "/coordinator.bin");
+
+        if (!fork_exec_all(std::vector<std::vector<std::string> >(1, args), 1))
+        {
+            return EXIT_FAILURE;
+        }
+
+        cmds.clear();
+
+        for (size_t i = 0; i < daemons.size(); ++i)
+        {
+            args.clear();
+            args.push_back("ssh");
+            args.push_back(remote(_user, daemons[i].addr));
+            args.push_back("hyperdex");
+            args.push_back("daemon");
+            args.push_back("--daemon");
+            args.push_back("--data=" + data_dir(_dest, daemons[i]));
+            cmds.push_back(args);
+        }
+
+        if (!fork_exec_all(cmds, jobs))
+        {
+            return EXIT_FAILURE;
+        }
+
+        report_phase("start", start);
+        std::cout << "each daemon removes its RECONCILE file once it has adopted "
+                  << "the regions it names; the restore-* directories may then be "
+                  << "deleted" << std::endl;
+        return EXIT_SUCCESS;
+    }
+    catch (std::exception& e)
+    {
+        std::cerr << "error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}